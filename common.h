@@ -2,8 +2,19 @@
 #include "libblake.h"
 
 #include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <inttypes.h>
+#include <pthread.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
 
 #if !defined(UINT_LEAST64_C) && defined(UINT64_C)
 # define UINT_LEAST64_C(X) UINT64_C(X)
@@ -46,12 +57,24 @@
 #  endif
 # endif
 #endif
+/* For functions written to be vectorised by the compiler: build them
+ * for wider vectors as well, and select the version at load time */
+#define TARGET_CLONES
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__ELF__) && defined(__has_attribute)
+# if __has_attribute(target_clones)
+#  undef TARGET_CLONES
+#  define TARGET_CLONES __attribute__((target_clones("avx2", "default")))
+# endif
+#endif
 #if defined(__has_builtin)
 # define HAS_BUILTIN(X) __has_builtin(X)
 #else
 # define HAS_BUILTIN(X) 0
 #endif
 
+/* <sys/uio.h> may define LITTLE_ENDIAN as a constant
+ * rather than as an indication of the byte order */
+#undef LITTLE_ENDIAN
 #if defined(__x86_64__) || defined(__i386__)
 # define LITTLE_ENDIAN
 #else
@@ -60,6 +83,12 @@
 
 #define CODE_KILLER(X) (X)
 
+#if defined(__GNUC__)
+# define ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+# define ALWAYS_INLINE inline
+#endif
+
 #define A 10
 #define B 11
 #define C 12
@@ -75,14 +104,388 @@ HIDDEN void libblake_internal_blakes_digest(struct libblake_blakes_state *state,
 HIDDEN void libblake_internal_blakeb_digest(struct libblake_blakeb_state *state, unsigned char *data, size_t len,
                                             size_t bits, const char *suffix, unsigned char *output, size_t words_out);
 
+HIDDEN void libblake_internal_blakes_stream_update(struct libblake_blakes_state *state, unsigned char *buffer, size_t *buffered,
+                                                   const unsigned char *data, size_t len);
+HIDDEN void libblake_internal_blakeb_stream_update(struct libblake_blakeb_state *state, unsigned char *buffer, size_t *buffered,
+                                                   const unsigned char *data, size_t len);
+
+HIDDEN void libblake_internal_blakes_stream_digest(struct libblake_blakes_state *state, unsigned char *buffer, size_t *buffered,
+                                                   const unsigned char *data, size_t len, size_t bits, const char *suffix,
+                                                   unsigned char *output, size_t words_out);
+HIDDEN void libblake_internal_blakeb_stream_digest(struct libblake_blakeb_state *state, unsigned char *buffer, size_t *buffered,
+                                                   const unsigned char *data, size_t len, size_t bits, const char *suffix,
+                                                   unsigned char *output, size_t words_out);
+
+HIDDEN void libblake_internal_blakes_stream_peek(const struct libblake_blakes_state *state, const unsigned char *buffer,
+                                                 size_t buffered, unsigned char *output, size_t words_out);
+HIDDEN void libblake_internal_blakeb_stream_peek(const struct libblake_blakeb_state *state, const unsigned char *buffer,
+                                                 size_t buffered, unsigned char *output, size_t words_out);
+
+HIDDEN size_t libblake_internal_blakes_updatev(struct libblake_blakes_state *state, const struct iovec *iov, size_t iovcnt);
+HIDDEN size_t libblake_internal_blakeb_updatev(struct libblake_blakeb_state *state, const struct iovec *iov, size_t iovcnt);
+
+HIDDEN void libblake_internal_blakes_digestv(struct libblake_blakes_state *state, const struct iovec *iov, size_t iovcnt,
+                                             size_t bits, const char *suffix, unsigned char *output, size_t words_out);
+HIDDEN void libblake_internal_blakeb_digestv(struct libblake_blakeb_state *state, const struct iovec *iov, size_t iovcnt,
+                                             size_t bits, const char *suffix, unsigned char *output, size_t words_out);
+
+HIDDEN int libblake_internal_update_fd(int fd, void (*update)(void *stream, const void *data, size_t len), void *stream);
+HIDDEN int libblake_internal_update_pipe(int fd, void (*update)(void *stream, const void *data, size_t len), void *stream);
+HIDDEN int libblake_internal_update_path(const char *path, void (*update)(void *stream, const void *data, size_t len), void *stream);
+
+/* Format used by the export and import functions */
+#define EXPORT_VERSION 1
+enum {
+	EXPORT_BLAKE224 = 1,
+	EXPORT_BLAKE256,
+	EXPORT_BLAKE384,
+	EXPORT_BLAKE512,
+	EXPORT_BLAKE2S,
+	EXPORT_BLAKE2B,
+	EXPORT_BLAKE2XS,
+	EXPORT_BLAKE2XB,
+	EXPORT_TREE_NODE,
+	EXPORT_CHECKPOINTS = 0x40,
+	EXPORT_STREAM = 0x80
+};
+
+#define BLAKE2S_LANES 8
+
+/* Lane-interleaved BLAKE2s states for libblake_internal_blake2s_compress_lanes */
+struct libblake_internal_blake2s_lanes {
+	uint_least32_t h[8][BLAKE2S_LANES];
+	uint_least32_t t[2][BLAKE2S_LANES];
+	uint_least32_t f[2][BLAKE2S_LANES];
+};
+
+#define BLAKE2B_LANES 4
+
+/* Lane-interleaved BLAKE2b states for libblake_internal_blake2b_compress_lanes */
+struct libblake_internal_blake2b_lanes {
+	uint_least64_t h[8][BLAKE2B_LANES];
+	uint_least64_t t[2][BLAKE2B_LANES];
+	uint_least64_t f[2][BLAKE2B_LANES];
+};
+
+/* Data queued for a stream in a scheduler */
+struct libblake_scheduler_job {
+	size_t stream;
+	const unsigned char *data;
+	size_t len;
+	int started;
+};
+
+/* Number of files processed concurrently by the hash_files functions */
+#define HASH_FILES_QUEUE_DEPTH 64
+
+/* Number of chunks hashed in parallel by a content-defined chunker */
+#define CHUNKER_GROUP 8
+
+/* Algorithm used by libblake_internal_hash_files; with `start`, `feed`,
+ * `run` and `finish`, a file is processed in a slot, in
+ * [0, HASH_FILES_QUEUE_DEPTH), and `hash_path` is used when files are
+ * processed on threads; `prefix` is input before each file */
+struct libblake_internal_hasher {
+	const unsigned char *prefix;
+	size_t prefix_len;
+	void *ctx;
+	void (*start)(void *ctx, size_t slot);
+	size_t (*feed)(void *ctx, size_t slot, const unsigned char *data, size_t len);
+	void (*run)(void *ctx);
+	void (*finish)(void *ctx, size_t slot, const unsigned char *data, size_t len, unsigned char *output);
+	int (*hash_path)(void *ctx, const char *path, unsigned char *output);
+};
+
+HIDDEN int libblake_internal_hash_files(const char *const paths[], size_t npaths, int flags,
+                                        const struct libblake_internal_hasher *hasher,
+                                        void (*callback)(void *user, size_t i, const unsigned char *digest, int error),
+                                        void *user);
+HIDDEN int libblake_internal_hash_files_uring(const char *const paths[], size_t npaths, int flags,
+                                              const struct libblake_internal_hasher *hasher,
+                                              void (*callback)(void *user, size_t i, const unsigned char *digest, int error),
+                                              void *user);
+HIDDEN int libblake_internal_hash_files_threads(const char *const paths[], size_t npaths,
+                                                const struct libblake_internal_hasher *hasher,
+                                                void (*callback)(void *user, size_t i, const unsigned char *digest, int error),
+                                                void *user);
+
+/* Algorithm used by libblake_internal_hash_file and libblake_internal_hash_tree;
+ * `init` initialises `stream` for the contents of a file or symbolic link
+ * (`directory` = 0) or for the listing of a directory (`directory` = 1),
+ * and `digest` stores `digest_len` bytes; `identity` identifies the
+ * algorithm, parameters and key in `cache`, which may be `NULL` */
+struct libblake_internal_file_hasher {
+	void *ctx;
+	size_t digest_len;
+	void (*init)(void *ctx, void *stream, int directory);
+	void (*update)(void *stream, const void *data, size_t len);
+	void (*digest)(void *ctx, void *stream, unsigned char *output);
+	struct libblake_digest_cache *cache;
+	unsigned char identity[32];
+};
+
+/* Storage for the `stream` argument to the functions in `struct libblake_internal_file_hasher` */
+union libblake_internal_file_stream {
+	struct libblake_blake2s_stream s;
+	struct libblake_blake2b_stream b;
+};
+
+struct libblake_internal_blake2s_file_context {
+	const struct libblake_blake2s_params *params;
+	struct libblake_blake2s_params dir_params;
+	unsigned char key_block[64];
+};
+
+struct libblake_internal_blake2b_file_context {
+	const struct libblake_blake2b_params *params;
+	struct libblake_blake2b_params dir_params;
+	unsigned char key_block[128];
+};
+
+HIDDEN void libblake_internal_blake2s_file_hasher(struct libblake_internal_file_hasher *hasher,
+                                                  struct libblake_internal_blake2s_file_context *ctx,
+                                                  const struct libblake_blake2s_params *params, const void *key,
+                                                  struct libblake_digest_cache *cache);
+HIDDEN void libblake_internal_blake2b_file_hasher(struct libblake_internal_file_hasher *hasher,
+                                                  struct libblake_internal_blake2b_file_context *ctx,
+                                                  const struct libblake_blake2b_params *params, const void *key,
+                                                  struct libblake_digest_cache *cache);
+HIDDEN int libblake_internal_hash_file(const struct libblake_internal_file_hasher *hasher, int fd, unsigned char *output);
+HIDDEN int libblake_internal_hash_tree(const char *path, size_t nthreads,
+                                       const struct libblake_internal_file_hasher *hasher, unsigned char *output);
+HIDDEN void libblake_internal_blake2s_identity(const struct libblake_blake2s_params *params, const void *key,
+                                               unsigned char identity[32]);
+HIDDEN void libblake_internal_blake2b_identity(const struct libblake_blake2b_params *params, const void *key,
+                                               unsigned char identity[32]);
+
+/* Algorithm used by libblake_internal_tree_update; `init` initialises
+ * `stream` (a `union libblake_internal_file_stream`) for the node at
+ * `node_offset` on level `node_depth`, which is the root if `root` is
+ * non-zero, and `digest` stores `inner_len` bytes, or `digest_len` bytes
+ * for the root; `fanout` is 0 if unlimited, and `identity` identifies
+ * the algorithm, parameters and key in the leaf digest store */
+struct libblake_internal_tree_hasher {
+	void *ctx;
+	size_t digest_len;
+	size_t inner_len;
+	uint_least64_t leaf_len;
+	uint_least64_t fanout;
+	size_t depth;
+	void (*init)(void *ctx, void *stream, uint_least64_t node_offset, size_t node_depth, int root);
+	void (*update)(void *stream, const void *data, size_t len);
+	void (*digest)(void *ctx, void *stream, int last_node, int root, unsigned char *output);
+	unsigned char identity[32];
+};
+
+struct libblake_internal_blake2s_tree_context {
+	struct libblake_blake2s_params params;
+	unsigned char key_block[64];
+};
+
+struct libblake_internal_blake2b_tree_context {
+	struct libblake_blake2b_params params;
+	unsigned char key_block[128];
+};
+
+/* Layout of a BLAKE2 hash tree and of its leaf digest store: level 0
+ * is the leaves, and each node on level `i` (`i` > 0) has up to
+ * `level_span[i]` children; the digests of each level except the
+ * root are stored, `inner_len` bytes each, at `level_offsets[i]`
+ * in the store, in order from level 0, after the header */
+#define TREE_MAX_LEVELS 66
+struct libblake_internal_tree_layout {
+	uint_least64_t size;
+	size_t nlevels;
+	uint_least64_t level_nodes[TREE_MAX_LEVELS];
+	uint_least64_t level_span[TREE_MAX_LEVELS];
+	uint_least64_t level_offsets[TREE_MAX_LEVELS];
+	uint_least64_t store_size;
+};
+
+/* Header of the file used as the leaf digest store for a hash tree; the
+ * header is invalidated while the store is updated, so that an update
+ * that did not complete causes the tree to be rebuilt; everything is
+ * stored in the native byte order */
+#define TREE_STORE_MAGIC "libblake-tree-v1"
+struct libblake_internal_tree_header {
+	char magic[16];
+	unsigned char identity[32];
+	uint_least64_t size;
+	uint_least64_t reserved;
+};
+
+HIDDEN int libblake_internal_blake2s_tree_hasher(struct libblake_internal_tree_hasher *hasher,
+                                                 struct libblake_internal_blake2s_tree_context *ctx,
+                                                 const struct libblake_blake2s_params *params, const void *key);
+HIDDEN int libblake_internal_blake2b_tree_hasher(struct libblake_internal_tree_hasher *hasher,
+                                                 struct libblake_internal_blake2b_tree_context *ctx,
+                                                 const struct libblake_blake2b_params *params, const void *key);
+HIDDEN int libblake_internal_tree_layout(struct libblake_internal_tree_layout *layout, uint_least64_t size,
+                                         const struct libblake_internal_tree_hasher *hasher);
+HIDDEN int libblake_internal_tree_update(int data_fd, int store_fd, const struct libblake_internal_tree_hasher *hasher,
+                                         const struct libblake_byte_range *ranges, size_t nranges, int rebuild,
+                                         unsigned char *output);
+HIDDEN int libblake_internal_tree_extent(const struct libblake_internal_tree_layout *layout,
+                                         const struct libblake_internal_tree_hasher *hasher, size_t node_depth,
+                                         uint_least64_t node_offset, uint_least64_t *offset, uint_least64_t *length);
+HIDDEN int libblake_internal_tree_node(const struct libblake_internal_tree_hasher *hasher, uint_least64_t size,
+                                       size_t node_depth, uint_least64_t node_offset, const void *data, size_t len,
+                                       struct libblake_tree_node *node);
+HIDDEN int libblake_internal_tree_merge(const struct libblake_internal_tree_hasher *hasher,
+                                        const struct libblake_tree_node *children, size_t nchildren,
+                                        struct libblake_tree_node *parent);
+
+/* The bucket, in the index of a block signature, for a weak checksum;
+ * the checksum is mixed as its high bits are poorly distributed */
+#define SIGNATURE_BUCKET(WEAK, BITS)\
+	((((WEAK) * UINT_LEAST32_C(0x9E3779B1)) & UINT_LEAST32_C(0xFFFFffff)) >> (32 - (BITS)))
+
+/* Maximum number of bits in the bucket numbers in a block signature */
+#define SIGNATURE_MAX_INDEX_BITS 24
+
+/* State used while a block signature is created; until it is finished,
+ * `sig->weak` and `sig->digests` are in block order, with room for
+ * `capacity` blocks, and the input after the last complete block is
+ * stored in `carry`; errors are recorded in `error` */
+struct libblake_internal_blake2b_signature_builder {
+	struct libblake_blake2b_signature *sig;
+	unsigned char *carry;
+	size_t ncarry;
+	size_t capacity;
+	int error;
+};
+
+HIDDEN int libblake_internal_blake2b_signature_init(struct libblake_internal_blake2b_signature_builder *builder,
+                                                    struct libblake_blake2b_signature *sig,
+                                                    const struct libblake_blake2b_params *params, const void *key,
+                                                    size_t block_size, size_t size_hint);
+HIDDEN void libblake_internal_blake2b_signature_update(void *builder, const void *data, size_t len);
+HIDDEN int libblake_internal_blake2b_signature_finish(struct libblake_internal_blake2b_signature_builder *builder);
+
+/* Number of blocks hashed in parallel by libblake_internal_blake2{s,b}_hash_blocks */
+#define HASH_BLOCKS_GROUP 8
+
+HIDDEN int libblake_internal_blake2s_hash_blocks(const struct libblake_blake2s_state *initial, const unsigned char *data,
+                                                 size_t block_size, size_t n, size_t digest_len,
+                                                 unsigned char *output, size_t output_stride);
+HIDDEN int libblake_internal_blake2b_hash_blocks(const struct libblake_blake2b_state *initial, const unsigned char *data,
+                                                 size_t block_size, size_t n, size_t digest_len,
+                                                 unsigned char *output, size_t output_stride);
+
+/* Layout of a verity hash tree: the hashes are stored in `slot_size`
+ * bytes each, `per_block` per block, and level 0 (the hashes of the
+ * data blocks) is stored last, after the higher levels */
+#define VERITY_MAX_LEVELS 64
+struct libblake_internal_verity_layout {
+	size_t block_size;
+	size_t digest_len;
+	size_t slot_size;
+	size_t per_block;
+	size_t nlevels;
+	uint_least64_t nblocks;
+	uint_least64_t level_blocks[VERITY_MAX_LEVELS];
+	uint_least64_t level_offsets[VERITY_MAX_LEVELS];
+	uint_least64_t size;
+};
+
+/* `hash_blocks` hashes `n` consecutive blocks, each `block_size` bytes long */
+struct libblake_internal_verity_hasher {
+	void *ctx;
+	int (*hash_blocks)(void *ctx, const unsigned char *data, size_t block_size, size_t n,
+	                   unsigned char *output, size_t output_stride);
+};
+
+HIDDEN int libblake_internal_verity_layout(struct libblake_internal_verity_layout *layout, uint_least64_t nblocks,
+                                           size_t block_size, size_t digest_len);
+HIDDEN int libblake_internal_verity_build(int data_fd, int hash_fd, size_t block_size, size_t digest_len, size_t nthreads,
+                                          const struct libblake_internal_verity_hasher *hasher, unsigned char *root);
+HIDDEN int libblake_internal_verity_verify(const void *tree, size_t tree_size, uint_least64_t nblocks,
+                                           size_t block_size, size_t digest_len,
+                                           const struct libblake_internal_verity_hasher *hasher,
+                                           const unsigned char *root, uint_least64_t index, const void *block);
+
+/* Layout of the file used by `struct libblake_digest_cache`: the header
+ * is followed by `nslots` records, forming an open-addressing hash table
+ * keyed by `dev`, `ino` and `identity`; everything is stored in the
+ * native byte order, so the file is only valid where it was created */
+#define DIGEST_CACHE_MAGIC "libblake-digests"
+struct libblake_internal_cache_header {
+	char magic[16];
+	uint_least64_t record_size;
+	uint_least64_t nslots;
+	uint_least64_t count;
+	uint_least64_t reserved;
+};
+struct libblake_internal_cache_record {
+	uint_least64_t dev;
+	uint_least64_t ino;
+	uint_least64_t size;
+	int_least64_t mtime_sec;
+	int_least64_t ctime_sec;
+	uint_least32_t mtime_nsec;
+	uint_least32_t ctime_nsec;
+	unsigned char identity[32];
+	unsigned char used;
+	unsigned char digest_len;
+	unsigned char digest[64];
+};
+
+HIDDEN int libblake_internal_digest_cache_lock(struct libblake_digest_cache *cache, int exclusive);
+HIDDEN void libblake_internal_digest_cache_unlock(struct libblake_digest_cache *cache);
+HIDDEN struct libblake_internal_cache_record *libblake_internal_digest_cache_find(struct libblake_internal_cache_header *header,
+                                                                                 const struct libblake_internal_cache_record *key);
+HIDDEN int libblake_internal_digest_cache_lookup(struct libblake_digest_cache *cache, const unsigned char identity[32],
+                                                 const struct stat *st, size_t digest_len, unsigned char *output);
+HIDDEN void libblake_internal_digest_cache_store(struct libblake_digest_cache *cache, const unsigned char identity[32],
+                                                 const struct stat *st, size_t digest_len, const unsigned char *digest);
+
+HIDDEN size_t libblake_internal_export(int id, size_t word_size, const void *words, size_t nwords,
+                                      const unsigned char *bytes, size_t nbytes, void *buffer, size_t size);
+HIDDEN int libblake_internal_import(int id, size_t word_size, void *words, size_t nwords, unsigned char *bytes,
+                                   size_t min_bytes, size_t *nbytesp, const void *buffer, size_t len);
+
+HIDDEN size_t libblake_internal_blakes_export(const struct libblake_blakes_state *state, int id, const unsigned char *buffered, size_t nbuffered,
+                                              void *buffer, size_t size);
+HIDDEN int libblake_internal_blakes_import(struct libblake_blakes_state *state, int id, unsigned char *buffered, size_t *nbufferedp,
+                                           const void *buffer, size_t len);
+HIDDEN size_t libblake_internal_blakeb_export(const struct libblake_blakeb_state *state, int id, const unsigned char *buffered, size_t nbuffered,
+                                              void *buffer, size_t size);
+HIDDEN int libblake_internal_blakeb_import(struct libblake_blakeb_state *state, int id, unsigned char *buffered, size_t *nbufferedp,
+                                           const void *buffer, size_t len);
+HIDDEN size_t libblake_internal_blake2s_export(const struct libblake_blake2s_state *state, int id, const unsigned char *buffered, size_t nbuffered,
+                                               void *buffer, size_t size);
+HIDDEN int libblake_internal_blake2s_import(struct libblake_blake2s_state *state, int id, unsigned char *buffered, size_t *nbufferedp,
+                                            const void *buffer, size_t len);
+HIDDEN size_t libblake_internal_blake2b_export(const struct libblake_blake2b_state *state, int id, const unsigned char *buffered, size_t nbuffered,
+                                               void *buffer, size_t size);
+HIDDEN int libblake_internal_blake2b_import(struct libblake_blake2b_state *state, int id, unsigned char *buffered, size_t *nbufferedp,
+                                            const void *buffer, size_t len);
+HIDDEN size_t libblake_internal_blake2xs_export(const struct libblake_blake2xs_state *state, int id, const unsigned char *buffered, size_t nbuffered,
+                                                void *buffer, size_t size);
+HIDDEN int libblake_internal_blake2xs_import(struct libblake_blake2xs_state *state, int id, unsigned char *buffered, size_t *nbufferedp,
+                                             const void *buffer, size_t len);
+HIDDEN size_t libblake_internal_blake2xb_export(const struct libblake_blake2xb_state *state, int id, const unsigned char *buffered, size_t nbuffered,
+                                                void *buffer, size_t size);
+HIDDEN int libblake_internal_blake2xb_import(struct libblake_blake2xb_state *state, int id, unsigned char *buffered, size_t *nbufferedp,
+                                             const void *buffer, size_t len);
+
 HIDDEN void libblake_internal_blake2s_compress(struct libblake_blake2s_state *state, const unsigned char *data);
 HIDDEN void libblake_internal_blake2b_compress(struct libblake_blake2b_state *state, const unsigned char *data);
+HIDDEN void libblake_internal_blake2s_compress_lanes(struct libblake_internal_blake2s_lanes *lanes,
+                                                     const unsigned char *const blocks[BLAKE2S_LANES]);
+HIDDEN void libblake_internal_blake2b_compress_lanes(struct libblake_internal_blake2b_lanes *lanes,
+                                                     const unsigned char *const blocks[BLAKE2B_LANES]);
 /* HIDDEN void libblake_internal_blake2b_compress_mm128_init(void); */
 /* HIDDEN void libblake_internal_blake2b_compress_mm256_init(void); */
 
 HIDDEN void libblake_internal_blake2xs_init0(struct libblake_blake2xs_state *state, const struct libblake_blake2xs_params *params);
 HIDDEN void libblake_internal_blake2xb_init0(struct libblake_blake2xb_state *state, const struct libblake_blake2xb_params *params);
 
+HIDDEN void libblake_internal_blake2s_stream_update(struct libblake_blake2s_state *state, unsigned char *buffer, size_t *buffered,
+                                                    const unsigned char *data, size_t len);
+HIDDEN void libblake_internal_blake2b_stream_update(struct libblake_blake2b_state *state, unsigned char *buffer, size_t *buffered,
+                                                    const unsigned char *data, size_t len);
+
 HIDDEN void libblake_internal_blake2s_output_digest(struct libblake_blake2s_state *state, size_t output_len, unsigned char *output);
 HIDDEN void libblake_internal_blake2b_output_digest(struct libblake_blake2b_state *state, size_t output_len, unsigned char *output);
 
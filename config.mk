@@ -5,7 +5,7 @@ CC = cc -std=c11
 
 CPPFLAGS = -D_DEFAULT_SOURCE -D_BSD_SOURCE -D_XOPEN_SOURCE=700 -D_GNU_SOURCE
 CFLAGS   = -Wall -O3
-LDFLAGS  = -s
+LDFLAGS  = -s -lpthread
 
 # These optimisations may not only break compatibility with
 # processors that the software was not compiled on, but they
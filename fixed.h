@@ -0,0 +1,214 @@
+/* See LICENSE file for copyright and license details. */
+
+/* Inline helpers for libblake_blake2{s,b}_fixed* and
+ * libblake_blake2{s,b}_iterate*; included after common.h */
+
+/* Initial state for libblake_blake2s_fixed*: like in libblake_blake2s, the
+ * parameter block is applied to the IV directly; the key block, if any, is
+ * compressed here, it is never the last block as the message is never empty */
+static ALWAYS_INLINE void
+libblake_internal_blake2s_fixed_init(struct libblake_blake2s_state *state, size_t output_len, const void *key, size_t key_len)
+{
+	unsigned char block[64];
+
+	state->h[0] = UINT_LEAST32_C(0x6A09E667) ^ UINT_LEAST32_C(0x01010000) ^ (uint_least32_t)(key_len << 8) ^ (uint_least32_t)output_len;
+	state->h[1] = UINT_LEAST32_C(0xBB67AE85);
+	state->h[2] = UINT_LEAST32_C(0x3C6EF372);
+	state->h[3] = UINT_LEAST32_C(0xA54FF53A);
+	state->h[4] = UINT_LEAST32_C(0x510E527F);
+	state->h[5] = UINT_LEAST32_C(0x9B05688C);
+	state->h[6] = UINT_LEAST32_C(0x1F83D9AB);
+	state->h[7] = UINT_LEAST32_C(0x5BE0CD19);
+	state->t[0] = 0;
+	state->t[1] = 0;
+	state->f[0] = 0;
+	state->f[1] = 0;
+
+	if (key_len) {
+		memcpy(block, key, key_len);
+		memset(&block[key_len], 0, sizeof(block) - key_len);
+		state->t[0] = 64;
+		libblake_internal_blake2s_compress(state, block);
+	}
+}
+
+/* Hash a message of exactly `len` bytes, where `len` is a positive
+ * constant, so that the counter (which never overflows into `t[1]`)
+ * and the padding of the last block are resolved at compile time;
+ * `state` is the state from libblake_internal_blake2s_fixed_init */
+static ALWAYS_INLINE void
+libblake_internal_blake2s_fixed(struct libblake_blake2s_state *state, const unsigned char *data, size_t len,
+                                size_t output_len, unsigned char *output)
+{
+	uint_least32_t t0 = state->t[0];
+	unsigned char block[64];
+	size_t i;
+
+	for (i = 0; i + 64 < len; i += 64) {
+		state->t[0] = t0 + (uint_least32_t)(i + 64);
+		libblake_internal_blake2s_compress(state, &data[i]);
+	}
+
+	state->t[0] = t0 + (uint_least32_t)len;
+	state->f[0] = UINT_LEAST32_C(0xFFFFffff);
+	if (len % 64) {
+		memcpy(block, &data[i], len - i);
+		memset(&block[len - i], 0, sizeof(block) - (len - i));
+		libblake_internal_blake2s_compress(state, block);
+	} else {
+		libblake_internal_blake2s_compress(state, &data[i]);
+	}
+
+	libblake_internal_blake2s_output_digest(state, output_len, output);
+}
+
+/* Hash `n` consecutive messages of exactly `len` bytes each, where `len`
+ * is a constant multiple of the block size; the messages are hashed in
+ * parallel in the lanes, which all have the same counter, so there is no
+ * bookkeeping besides the compressions; the digests are stored consecutively */
+static ALWAYS_INLINE void
+libblake_internal_blake2s_fixed_lanes(const struct libblake_blake2s_state *initial, const unsigned char *data, size_t len,
+                                      size_t n, size_t output_len, unsigned char *output)
+{
+	struct libblake_internal_blake2s_lanes lanes;
+	struct libblake_blake2s_state state;
+	const unsigned char *blocks[BLAKE2S_LANES];
+	size_t i, j, l;
+
+	for (; n >= BLAKE2S_LANES; n -= BLAKE2S_LANES) {
+		for (i = 0; i < 8; i++)
+			for (l = 0; l < BLAKE2S_LANES; l++)
+				lanes.h[i][l] = initial->h[i];
+		for (l = 0; l < BLAKE2S_LANES; l++) {
+			lanes.t[1][l] = 0;
+			lanes.f[1][l] = 0;
+		}
+		for (j = 0; j < len; j += 64) {
+			for (l = 0; l < BLAKE2S_LANES; l++) {
+				blocks[l] = &data[l * len + j];
+				lanes.t[0][l] = initial->t[0] + (uint_least32_t)(j + 64);
+				lanes.f[0][l] = j + 64 < len ? 0 : UINT_LEAST32_C(0xFFFFffff);
+			}
+			libblake_internal_blake2s_compress_lanes(&lanes, blocks);
+		}
+		for (l = 0; l < BLAKE2S_LANES; l++) {
+			for (i = 0; i < 8; i++)
+				state.h[i] = lanes.h[i][l];
+			libblake_internal_blake2s_output_digest(&state, output_len, &output[l * output_len]);
+		}
+		data = &data[BLAKE2S_LANES * len];
+		output = &output[BLAKE2S_LANES * output_len];
+	}
+
+	for (; n; n--) {
+		state = *initial;
+		libblake_internal_blake2s_fixed(&state, data, len, output_len, output);
+		data = &data[len];
+		output = &output[output_len];
+	}
+}
+
+/* Initial state for libblake_blake2b_fixed*: like in libblake_blake2b, the
+ * parameter block is applied to the IV directly; the key block, if any, is
+ * compressed here, it is never the last block as the message is never empty */
+static ALWAYS_INLINE void
+libblake_internal_blake2b_fixed_init(struct libblake_blake2b_state *state, size_t output_len, const void *key, size_t key_len)
+{
+	unsigned char block[128];
+
+	state->h[0] = UINT_LEAST64_C(0x6A09E667F3BCC908) ^ UINT_LEAST64_C(0x01010000) ^ (uint_least64_t)(key_len << 8) ^ (uint_least64_t)output_len;
+	state->h[1] = UINT_LEAST64_C(0xBB67AE8584CAA73B);
+	state->h[2] = UINT_LEAST64_C(0x3C6EF372FE94F82B);
+	state->h[3] = UINT_LEAST64_C(0xA54FF53A5F1D36F1);
+	state->h[4] = UINT_LEAST64_C(0x510E527FADE682D1);
+	state->h[5] = UINT_LEAST64_C(0x9B05688C2B3E6C1F);
+	state->h[6] = UINT_LEAST64_C(0x1F83D9ABFB41BD6B);
+	state->h[7] = UINT_LEAST64_C(0x5BE0CD19137E2179);
+	state->t[0] = 0;
+	state->t[1] = 0;
+	state->f[0] = 0;
+	state->f[1] = 0;
+
+	if (key_len) {
+		memcpy(block, key, key_len);
+		memset(&block[key_len], 0, sizeof(block) - key_len);
+		state->t[0] = 128;
+		libblake_internal_blake2b_compress(state, block);
+	}
+}
+
+/* Hash a message of exactly `len` bytes, where `len` is a positive
+ * constant, so that the counter (which never overflows into `t[1]`)
+ * and the padding of the last block are resolved at compile time;
+ * `state` is the state from libblake_internal_blake2b_fixed_init */
+static ALWAYS_INLINE void
+libblake_internal_blake2b_fixed(struct libblake_blake2b_state *state, const unsigned char *data, size_t len,
+                                size_t output_len, unsigned char *output)
+{
+	uint_least64_t t0 = state->t[0];
+	unsigned char block[128];
+	size_t i;
+
+	for (i = 0; i + 128 < len; i += 128) {
+		state->t[0] = t0 + (uint_least64_t)(i + 128);
+		libblake_internal_blake2b_compress(state, &data[i]);
+	}
+
+	state->t[0] = t0 + (uint_least64_t)len;
+	state->f[0] = UINT_LEAST64_C(0xFFFFffffFFFFffff);
+	if (len % 128) {
+		memcpy(block, &data[i], len - i);
+		memset(&block[len - i], 0, sizeof(block) - (len - i));
+		libblake_internal_blake2b_compress(state, block);
+	} else {
+		libblake_internal_blake2b_compress(state, &data[i]);
+	}
+
+	libblake_internal_blake2b_output_digest(state, output_len, output);
+}
+
+/* Hash `n` consecutive messages of exactly `len` bytes each, where `len`
+ * is a constant multiple of the block size; the messages are hashed in
+ * parallel in the lanes, which all have the same counter, so there is no
+ * bookkeeping besides the compressions; the digests are stored consecutively */
+static ALWAYS_INLINE void
+libblake_internal_blake2b_fixed_lanes(const struct libblake_blake2b_state *initial, const unsigned char *data, size_t len,
+                                      size_t n, size_t output_len, unsigned char *output)
+{
+	struct libblake_internal_blake2b_lanes lanes;
+	struct libblake_blake2b_state state;
+	const unsigned char *blocks[BLAKE2B_LANES];
+	size_t i, j, l;
+
+	for (; n >= BLAKE2B_LANES; n -= BLAKE2B_LANES) {
+		for (i = 0; i < 8; i++)
+			for (l = 0; l < BLAKE2B_LANES; l++)
+				lanes.h[i][l] = initial->h[i];
+		for (l = 0; l < BLAKE2B_LANES; l++) {
+			lanes.t[1][l] = 0;
+			lanes.f[1][l] = 0;
+		}
+		for (j = 0; j < len; j += 128) {
+			for (l = 0; l < BLAKE2B_LANES; l++) {
+				blocks[l] = &data[l * len + j];
+				lanes.t[0][l] = initial->t[0] + (uint_least64_t)(j + 128);
+				lanes.f[0][l] = j + 128 < len ? 0 : UINT_LEAST64_C(0xFFFFffffFFFFffff);
+			}
+			libblake_internal_blake2b_compress_lanes(&lanes, blocks);
+		}
+		for (l = 0; l < BLAKE2B_LANES; l++) {
+			for (i = 0; i < 8; i++)
+				state.h[i] = lanes.h[i][l];
+			libblake_internal_blake2b_output_digest(&state, output_len, &output[l * output_len]);
+		}
+		data = &data[BLAKE2B_LANES * len];
+		output = &output[BLAKE2B_LANES * output_len];
+	}
+
+	for (; n; n--) {
+		state = *initial;
+		libblake_internal_blake2b_fixed(&state, data, len, output_len, output);
+		data = &data[len];
+		output = &output[output_len];
+	}
+}
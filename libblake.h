@@ -5,6 +5,9 @@
 #include <stddef.h>
 #include <stdint.h>
 
+struct iovec;
+struct libblake_scheduler_job;
+
 #if defined(__clang__)
 # pragma clang diagnostic push
 # pragma clang diagnostic ignored "-Wpadded"
@@ -79,6 +82,183 @@ libblake_encode_hex(const void *data, size_t n, char out[/* static n * 2 + 1 */]
 LIBBLAKE_PUBLIC__ size_t
 libblake_decode_hex(const char *data, size_t n, void *out, int *validp);
 
+/**
+ * Persistent cache of file hashes, stored in a file
+ * 
+ * This structure should be opaque
+ */
+struct libblake_digest_cache {
+	int fd;
+	void *mutex;
+	void *map;
+	size_t map_size;
+};
+
+/**
+ * Open a persistent cache of file hashes
+ * 
+ * The cache can be passed to file hashing functions, such
+ * as `libblake_blake2b_hash_file`, which then look up each
+ * file's hash, by its device, inode number, size,
+ * modification time and change time, together with the
+ * algorithm, parameters and key, and only read the file
+ * if its hash was not found (or any of this has changed)
+ * 
+ * Hashes of files that are modified while they are hashed,
+ * or that were modified or had their status changed less
+ * than two seconds earlier, are not stored, since such files
+ * can be modified again without their timestamps changing
+ * 
+ * The cache is stored in `path`, which is created if it
+ * does not exist, in a format that is specific to the
+ * machine. It is memory-mapped and can be used by many
+ * threads and processes at the same time. Unusable
+ * contents are discarded rather than reported as an error.
+ * Keyed hashes are stored, but the keys are not
+ * 
+ * @param   cache  The cache to initialise
+ * @param   path   The file in which the cache is stored
+ * @return         0 on success, -1 on failure
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  -       Any error specified for open(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_digest_cache_open(struct libblake_digest_cache *cache, const char *path);
+
+/**
+ * Close a persistent cache of file hashes
+ * 
+ * @param  cache  The cache to close
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_digest_cache_close(struct libblake_digest_cache *cache);
+
+/**
+ * A range of bytes in a file
+ */
+struct libblake_byte_range {
+	/**
+	 * The offset of the first byte in the range
+	 */
+	uint_least64_t offset;
+
+	/**
+	 * The number of bytes in the range
+	 */
+	uint_least64_t length;
+};
+
+/**
+ * A node in a BLAKE2 hash tree, as calculated by
+ * `libblake_blake2s_tree_node`, `libblake_blake2b_tree_node`,
+ * `libblake_blake2s_tree_merge`, or `libblake_blake2b_tree_merge`
+ */
+struct libblake_tree_node {
+	/**
+	 * The size of the entire message, in bytes
+	 */
+	uint_least64_t size;
+
+	/**
+	 * The offset of the node on its level
+	 */
+	uint_least64_t node_offset;
+
+	/**
+	 * The level of the node, 0 for leaves
+	 */
+	uint_least8_t node_depth;
+
+	/**
+	 * Non-zero if the node is the root, in which
+	 * case `digest` is the hash of the message
+	 */
+	int root;
+
+	/**
+	 * The number of bytes in `digest`
+	 */
+	uint_least8_t digest_len;
+
+	/**
+	 * Identifies the algorithm, the parameters and
+	 * the key, without revealing the key
+	 */
+	unsigned char identity[32];
+
+	/**
+	 * The node's hash
+	 */
+	unsigned char digest[64];
+};
+
+/**
+ * Serialise a node in a BLAKE2 hash tree, so that it
+ * can be sent to another process or machine, the output
+ * is independent of the machine
+ * 
+ * @param   node    The node to serialise
+ * @param   buffer  Output buffer, may be `NULL` if `size` is 0
+ * @param   size    The size of `buffer`
+ * @return          The number of bytes required for the output; if
+ *                  greater than `size`, nothing is written to `buffer`
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_tree_node_export(const struct libblake_tree_node *node, void *buffer, size_t size);
+
+/**
+ * Restore a node in a BLAKE2 hash tree, serialised
+ * with `libblake_tree_node_export`
+ * 
+ * @param   node    Output parameter for the node
+ * @param   buffer  The serialised node
+ * @param   len     The number of bytes in `buffer`
+ * @return          0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `buffer` does not contain a node
+ *                  in a supported format
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_tree_node_import(struct libblake_tree_node *node, const void *buffer, size_t len);
+
+/**
+ * Calculate the weak rolling checksum, as used by rsync,
+ * of a block; unlike a hash, the checksum of a block
+ * can be calculated from the checksum of the block one
+ * byte before it, with `libblake_rolling_checksum_roll`,
+ * so that the checksums of the blocks at all positions
+ * in a file can be calculated quickly
+ * 
+ * @param   data  The block
+ * @param   len   The number of bytes in `data`
+ * @return        The checksum of the block
+ */
+LIBBLAKE_PUBLIC__ LIBBLAKE_PURE__ uint_least32_t
+libblake_rolling_checksum(const void *data, size_t len);
+
+/**
+ * Calculate the weak rolling checksum, as calculated
+ * by `libblake_rolling_checksum`, of the block one
+ * byte after a block with a known checksum
+ * 
+ * @param   sum  The checksum of the block
+ * @param   len  The number of bytes in the block
+ * @param   out  The first byte in the block, which
+ *               is not in the next block
+ * @param   in   The byte after the block, which is
+ *               the last byte in the next block
+ * @return       The checksum of the next block
+ */
+LIBBLAKE_PUBLIC__ inline uint_least32_t
+libblake_rolling_checksum_roll(uint_least32_t sum, size_t len, unsigned char out, unsigned char in) {
+	uint_least32_t a = sum & 0xFFFFUL;
+	uint_least32_t b = (sum >> 16) & 0xFFFFUL;
+	a = (a - (uint_least32_t)out + (uint_least32_t)in) & 0xFFFFUL;
+	b = (b - (uint_least32_t)len * (uint_least32_t)out + a) & 0xFFFFUL;
+	return a | (b << 16);
+}
+
 
 
 /*********************************** BLAKE ***********************************/
@@ -181,6 +361,62 @@ struct libblake_blake384_state { struct libblake_blakeb_state b; };
  */
 struct libblake_blake512_state { struct libblake_blakeb_state b; };
 
+/**
+ * Buffered state for BLAKE224 hashing
+ * 
+ * The buffer is two blocks large so that
+ * the padding can be added in it
+ * 
+ * This structure should be opaque
+ */
+struct libblake_blake224_stream {
+	struct libblake_blake224_state state;
+	size_t buffered;
+	unsigned char buffer[128];
+};
+
+/**
+ * Buffered state for BLAKE256 hashing
+ * 
+ * The buffer is two blocks large so that
+ * the padding can be added in it
+ * 
+ * This structure should be opaque
+ */
+struct libblake_blake256_stream {
+	struct libblake_blake256_state state;
+	size_t buffered;
+	unsigned char buffer[128];
+};
+
+/**
+ * Buffered state for BLAKE384 hashing
+ * 
+ * The buffer is two blocks large so that
+ * the padding can be added in it
+ * 
+ * This structure should be opaque
+ */
+struct libblake_blake384_stream {
+	struct libblake_blake384_state state;
+	size_t buffered;
+	unsigned char buffer[256];
+};
+
+/**
+ * Buffered state for BLAKE512 hashing
+ * 
+ * The buffer is two blocks large so that
+ * the padding can be added in it
+ * 
+ * This structure should be opaque
+ */
+struct libblake_blake512_stream {
+	struct libblake_blake512_state state;
+	size_t buffered;
+	unsigned char buffer[256];
+};
+
 
 
 /**
@@ -267,6 +503,275 @@ LIBBLAKE_PUBLIC__ void
 libblake_blake224_digest(struct libblake_blake224_state *state, void *data, size_t len, size_t bits,
                          const char *suffix, unsigned char output[static LIBBLAKE_BLAKE224_OUTPUT_SIZE]);
 
+/**
+ * Calculate the BLAKE224 hash of the input data
+ * 
+ * This function behaves like `libblake_blake224_digest`
+ * except it does not write to `data`, so no additional
+ * space is required, and `data` may be read-only; the
+ * last blocks are padded in a buffer on the stack
+ * 
+ * @param  state   The state of the hash function
+ * @param  data    The last data to process, may be `NULL`
+ *                 if `len` and `bits` are 0
+ * @param  len     The number of input whole bytes
+ * @param  bits    The number of input bits after the last whole bytes
+ *                 (may actually be greater than 7); these bits shall
+ *                 be stored in `data[len]`'s (addition bytes will be used
+ *                 if `bits > 8`) lower bits
+ * @param  suffix  String of '0's and '1's of addition bits to add to the
+ *                 end of the input, or `NULL` (or the empty string) if none;
+ *                 the first character corresponds to the lowest indexed
+ *                 additional bit, and the last character corresponds to
+ *                 the highest indexed additional bit
+ * @param  output  Output buffer for the hash, which will be stored in raw
+ *                 binary representation; the size of this buffer must be
+ *                 at least `LIBBLAKE_BLAKE224_OUTPUT_SIZE` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake224_digest_const(struct libblake_blake224_state *state, const void *data, size_t len, size_t bits,
+                               const char *suffix, unsigned char output[static LIBBLAKE_BLAKE224_OUTPUT_SIZE]);
+
+/**
+ * Process data for hashing with BLAKE224
+ * 
+ * This function behaves like `libblake_blake224_update`
+ * except the input is read from a list of buffers:
+ * the processed bytes are the first bytes of the
+ * concatenation of the buffers; blocks that straddle
+ * two buffers are copied, other blocks are processed
+ * where they are stored
+ * 
+ * @param   state   The state of the hash function
+ * @param   iov     The buffers to feed into the function, in order
+ * @param   iovcnt  The number of elements in `iov`
+ * @return          The number of processed bytes
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake224_updatev(struct libblake_blake224_state *state, const struct iovec *iov, size_t iovcnt);
+
+/**
+ * Calculate the BLAKE224 hash of the input data
+ * 
+ * This function behaves like `libblake_blake224_digest`
+ * except the input is read from a list of buffers,
+ * which are not modified, so no additional space
+ * is required
+ * 
+ * @param  state   The state of the hash function
+ * @param  iov     The last data to process, in order
+ * @param  iovcnt  The number of elements in `iov`
+ * @param  bits    The number of input bits after the last whole bytes
+ *                 (may actually be greater than 7); these bits shall be
+ *                 stored in the lower bits of the last bytes (the last
+ *                 byte if `bits < 8`) in the last non-empty buffer, and
+ *                 are included in its `iov_len`
+ * @param  suffix  String of '0's and '1's of addition bits to add to the
+ *                 end of the input, or `NULL` (or the empty string) if none;
+ *                 the first character corresponds to the lowest indexed
+ *                 additional bit, and the last character corresponds to
+ *                 the highest indexed additional bit
+ * @param  output  Output buffer for the hash, which will be stored in raw
+ *                 binary representation; the size of this buffer must be
+ *                 at least `LIBBLAKE_BLAKE224_OUTPUT_SIZE` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake224_digestv(struct libblake_blake224_state *state, const struct iovec *iov, size_t iovcnt, size_t bits,
+                          const char *suffix, unsigned char output[static LIBBLAKE_BLAKE224_OUTPUT_SIZE]);
+
+/**
+ * Initialise a buffered state for hashing with BLAKE224
+ * 
+ * @param  stream  The state to initialise
+ * @param  salt    16-byte salt to use, or `NULL` for an all-zeroes salt
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake224_stream_init2(struct libblake_blake224_stream *stream, const uint_least8_t salt[16]);
+
+/**
+ * Initialise a buffered state for hashing with
+ * BLAKE224 and an all-zeroes salt
+ * 
+ * @param  stream  The state to initialise
+ */
+LIBBLAKE_PUBLIC__ inline void
+libblake_blake224_stream_init(struct libblake_blake224_stream *stream) {
+	libblake_blake224_stream_init2(stream, NULL);
+}
+
+/**
+ * Process data for hashing with BLAKE224
+ * 
+ * Unlike `libblake_blake224_update`, this function
+ * processes all input data: any data in excess of
+ * a 64-byte multiple is stored in the state and
+ * is processed when more data is input or when
+ * `libblake_blake224_stream_digest` is called
+ * 
+ * @param  stream  The state of the hash function
+ * @param  data    The data to feed into the function
+ * @param  len     The number of bytes to process
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake224_stream_update(struct libblake_blake224_stream *stream, const void *data, size_t len);
+
+/**
+ * Process the contents of a file for BLAKE224 hashing
+ * 
+ * Holes in sparse files are hashed without being read,
+ * large regular files that are sealed against shrinking
+ * (see memfd_create(2)) are mapped into memory rather
+ * than read, other files are read with large buffers
+ * (a mapped file that is truncated while it is hashed
+ * would kill the process with SIGBUS), and if
+ * they are not regular files (for example pipes
+ * and sockets), they are read on a separate thread so
+ * that reading and hashing overlap; either way, the
+ * data is not copied more than
+ * `libblake_blake224_stream_update` requires
+ * 
+ * @param   stream  The state of the hash function
+ * @param   fd      The file descriptor to read, from its current
+ *                  offset until the end of the file
+ * @return          0 on success, -1 on failure; on failure,
+ *                  some data may have been processed
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  EIO     The file was truncated while it was being hashed
+ * @throws  -       Any error specified for fstat(3) or read(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake224_stream_update_fd(struct libblake_blake224_stream *stream, int fd);
+
+/**
+ * Process the contents of a file for BLAKE224 hashing,
+ * see `libblake_blake224_stream_update_fd` for details
+ * 
+ * @param   stream  The state of the hash function
+ * @param   path    The file to read
+ * @return          0 on success, -1 on failure; on failure,
+ *                  some data may have been processed
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  -       Any error specified for open(3), fstat(3) or read(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake224_stream_update_path(struct libblake_blake224_stream *stream, const char *path);
+
+/**
+ * Calculate the BLAKE224 hash of the input data
+ * 
+ * The `stream` parameter must have been initialised using
+ * the `libblake_blake224_stream_init` function, after which,
+ * but before this function is called,
+ * `libblake_blake224_stream_update` can be used to process
+ * data before this function is called. Unlike
+ * `libblake_blake224_digest`, this function does not
+ * write to `data`, so no additional space is required
+ * 
+ * @param  stream  The state of the hash function
+ * @param  data    The last data to process, may be `NULL`
+ *                 if `len` and `bits` are 0
+ * @param  len     The number of input whole bytes
+ * @param  bits    The number of input bits after the last whole bytes
+ *                 (may actually be greater than 7); these bits shall
+ *                 be stored in `data[len]`'s (addition bytes will be used
+ *                 if `bits > 8`) lower bits
+ * @param  suffix  String of '0's and '1's of addition bits to add to the
+ *                 end of the input, or `NULL` (or the empty string) if none;
+ *                 the first character corresponds to the lowest indexed
+ *                 additional bit, and the last character corresponds to
+ *                 the highest indexed additional bit
+ * @param  output  Output buffer for the hash, which will be stored in raw
+ *                 binary representation; the size of this buffer must be
+ *                 at least `LIBBLAKE_BLAKE224_OUTPUT_SIZE` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake224_stream_digest(struct libblake_blake224_stream *stream, const void *data, size_t len, size_t bits,
+                                const char *suffix, unsigned char output[static LIBBLAKE_BLAKE224_OUTPUT_SIZE]);
+
+/**
+ * Calculate the BLAKE224 hash of the data input so far,
+ * without finalising the state
+ * 
+ * Unlike `libblake_blake224_stream_digest`, `stream` is
+ * not modified, so more data can be input afterwards;
+ * this is cheaper than copying the stream and finalising
+ * the copy as only the state and the buffered data is
+ * copied
+ * 
+ * @param  stream  The state of the hash function
+ * @param  output  Output buffer for the hash, which will be stored in raw
+ *                 binary representation; the size of this buffer must be
+ *                 at least `LIBBLAKE_BLAKE224_OUTPUT_SIZE` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake224_stream_peek(const struct libblake_blake224_stream *stream, unsigned char output[static LIBBLAKE_BLAKE224_OUTPUT_SIZE]);
+
+/**
+ * Serialise a state for BLAKE224 hashing
+ * 
+ * The output is independent of the machine and of
+ * the library version's in-memory representation,
+ * and can be restored with `libblake_blake224_import`
+ * 
+ * @param   state   The state to serialise
+ * @param   buffer  Output buffer, may be `NULL` if `size` is 0
+ * @param   size    The size of `buffer`
+ * @return          The number of bytes required for the output; if
+ *                  greater than `size`, nothing is written to `buffer`
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake224_export(const struct libblake_blake224_state *state, void *buffer, size_t size);
+
+/**
+ * Restore a state for BLAKE224 hashing,
+ * serialised with `libblake_blake224_export`
+ * 
+ * @param   state   Output parameter for the state;
+ *                  not modified on failure
+ * @param   buffer  The serialised state
+ * @param   len     The number of bytes in `buffer`
+ * @return          0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `buffer` does not contain a state for
+ *                  BLAKE224 hashing in a supported format
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake224_import(struct libblake_blake224_state *state, const void *buffer, size_t len);
+
+/**
+ * Serialise a buffered state for BLAKE224 hashing
+ * 
+ * The output is independent of the machine and of
+ * the library version's in-memory representation,
+ * and can be restored with `libblake_blake224_stream_import`
+ * 
+ * @param   stream  The buffered state to serialise
+ * @param   buffer  Output buffer, may be `NULL` if `size` is 0
+ * @param   size    The size of `buffer`
+ * @return          The number of bytes required for the output; if
+ *                  greater than `size`, nothing is written to `buffer`
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake224_stream_export(const struct libblake_blake224_stream *stream, void *buffer, size_t size);
+
+/**
+ * Restore a buffered state for BLAKE224 hashing,
+ * serialised with `libblake_blake224_stream_export`
+ * 
+ * @param   stream  Output parameter for the buffered state;
+ *                  not modified on failure
+ * @param   buffer  The serialised buffered state
+ * @param   len     The number of bytes in `buffer`
+ * @return          0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `buffer` does not contain a buffered state for
+ *                  BLAKE224 hashing in a supported format
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake224_stream_import(struct libblake_blake224_stream *stream, const void *buffer, size_t len);
+
 
 
 /**
@@ -355,24 +860,293 @@ LIBBLAKE_PUBLIC__ void
 libblake_blake256_digest(struct libblake_blake256_state *state, void *data, size_t len, size_t bits,
                          const char *suffix, unsigned char output[static LIBBLAKE_BLAKE256_OUTPUT_SIZE]);
 
-
-
 /**
- * Initialise a state for hashing with BLAKE384
+ * Calculate the BLAKE256 hash of the input data
  * 
- * @param  state  The state to initialise
- * @param  salt   32-byte salt to use, or `NULL` for an all-zeroes salt
+ * This function behaves like `libblake_blake256_digest`
+ * except it does not write to `data`, so no additional
+ * space is required, and `data` may be read-only; the
+ * last blocks are padded in a buffer on the stack
+ * 
+ * @param  state   The state of the hash function
+ * @param  data    The last data to process, may be `NULL`
+ *                 if `len` and `bits` are 0
+ * @param  len     The number of input whole bytes
+ * @param  bits    The number of input bits after the last whole bytes
+ *                 (may actually be greater than 7); these bits shall
+ *                 be stored in `data[len]`'s (addition bytes will be used
+ *                 if `bits > 8`) lower bits
+ * @param  suffix  String of '0's and '1's of addition bits to add to the
+ *                 end of the input, or `NULL` (or the empty string) if none;
+ *                 the first character corresponds to the lowest indexed
+ *                 additional bit, and the last character corresponds to
+ *                 the highest indexed additional bit
+ * @param  output  Output buffer for the hash, which will be stored in raw
+ *                 binary representation; the size of this buffer must be
+ *                 at least `LIBBLAKE_BLAKE256_OUTPUT_SIZE` bytes
  */
 LIBBLAKE_PUBLIC__ void
-libblake_blake384_init2(struct libblake_blake384_state *state, const uint_least8_t salt[32]);
+libblake_blake256_digest_const(struct libblake_blake256_state *state, const void *data, size_t len, size_t bits,
+                               const char *suffix, unsigned char output[static LIBBLAKE_BLAKE256_OUTPUT_SIZE]);
 
 /**
- * Initialise a state for hashing with BLAKE384
- * and an all-zeroes salt
+ * Process data for hashing with BLAKE256
  * 
- * @param  state  The state to initialise
+ * This function behaves like `libblake_blake256_update`
+ * except the input is read from a list of buffers:
+ * the processed bytes are the first bytes of the
+ * concatenation of the buffers; blocks that straddle
+ * two buffers are copied, other blocks are processed
+ * where they are stored
+ * 
+ * @param   state   The state of the hash function
+ * @param   iov     The buffers to feed into the function, in order
+ * @param   iovcnt  The number of elements in `iov`
+ * @return          The number of processed bytes
  */
-LIBBLAKE_PUBLIC__ inline void
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake256_updatev(struct libblake_blake256_state *state, const struct iovec *iov, size_t iovcnt);
+
+/**
+ * Calculate the BLAKE256 hash of the input data
+ * 
+ * This function behaves like `libblake_blake256_digest`
+ * except the input is read from a list of buffers,
+ * which are not modified, so no additional space
+ * is required
+ * 
+ * @param  state   The state of the hash function
+ * @param  iov     The last data to process, in order
+ * @param  iovcnt  The number of elements in `iov`
+ * @param  bits    The number of input bits after the last whole bytes
+ *                 (may actually be greater than 7); these bits shall be
+ *                 stored in the lower bits of the last bytes (the last
+ *                 byte if `bits < 8`) in the last non-empty buffer, and
+ *                 are included in its `iov_len`
+ * @param  suffix  String of '0's and '1's of addition bits to add to the
+ *                 end of the input, or `NULL` (or the empty string) if none;
+ *                 the first character corresponds to the lowest indexed
+ *                 additional bit, and the last character corresponds to
+ *                 the highest indexed additional bit
+ * @param  output  Output buffer for the hash, which will be stored in raw
+ *                 binary representation; the size of this buffer must be
+ *                 at least `LIBBLAKE_BLAKE256_OUTPUT_SIZE` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake256_digestv(struct libblake_blake256_state *state, const struct iovec *iov, size_t iovcnt, size_t bits,
+                          const char *suffix, unsigned char output[static LIBBLAKE_BLAKE256_OUTPUT_SIZE]);
+
+/**
+ * Initialise a buffered state for hashing with BLAKE256
+ * 
+ * @param  stream  The state to initialise
+ * @param  salt    16-byte salt to use, or `NULL` for an all-zeroes salt
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake256_stream_init2(struct libblake_blake256_stream *stream, const uint_least8_t salt[16]);
+
+/**
+ * Initialise a buffered state for hashing with
+ * BLAKE256 and an all-zeroes salt
+ * 
+ * @param  stream  The state to initialise
+ */
+LIBBLAKE_PUBLIC__ inline void
+libblake_blake256_stream_init(struct libblake_blake256_stream *stream) {
+	libblake_blake256_stream_init2(stream, NULL);
+}
+
+/**
+ * Process data for hashing with BLAKE256
+ * 
+ * Unlike `libblake_blake256_update`, this function
+ * processes all input data: any data in excess of
+ * a 64-byte multiple is stored in the state and
+ * is processed when more data is input or when
+ * `libblake_blake256_stream_digest` is called
+ * 
+ * @param  stream  The state of the hash function
+ * @param  data    The data to feed into the function
+ * @param  len     The number of bytes to process
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake256_stream_update(struct libblake_blake256_stream *stream, const void *data, size_t len);
+
+/**
+ * Process the contents of a file for BLAKE256 hashing
+ * 
+ * Holes in sparse files are hashed without being read,
+ * large regular files that are sealed against shrinking
+ * (see memfd_create(2)) are mapped into memory rather
+ * than read, other files are read with large buffers
+ * (a mapped file that is truncated while it is hashed
+ * would kill the process with SIGBUS), and if
+ * they are not regular files (for example pipes
+ * and sockets), they are read on a separate thread so
+ * that reading and hashing overlap; either way, the
+ * data is not copied more than
+ * `libblake_blake256_stream_update` requires
+ * 
+ * @param   stream  The state of the hash function
+ * @param   fd      The file descriptor to read, from its current
+ *                  offset until the end of the file
+ * @return          0 on success, -1 on failure; on failure,
+ *                  some data may have been processed
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  EIO     The file was truncated while it was being hashed
+ * @throws  -       Any error specified for fstat(3) or read(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake256_stream_update_fd(struct libblake_blake256_stream *stream, int fd);
+
+/**
+ * Process the contents of a file for BLAKE256 hashing,
+ * see `libblake_blake256_stream_update_fd` for details
+ * 
+ * @param   stream  The state of the hash function
+ * @param   path    The file to read
+ * @return          0 on success, -1 on failure; on failure,
+ *                  some data may have been processed
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  -       Any error specified for open(3), fstat(3) or read(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake256_stream_update_path(struct libblake_blake256_stream *stream, const char *path);
+
+/**
+ * Calculate the BLAKE256 hash of the input data
+ * 
+ * The `stream` parameter must have been initialised using
+ * the `libblake_blake256_stream_init` function, after which,
+ * but before this function is called,
+ * `libblake_blake256_stream_update` can be used to process
+ * data before this function is called. Unlike
+ * `libblake_blake256_digest`, this function does not
+ * write to `data`, so no additional space is required
+ * 
+ * @param  stream  The state of the hash function
+ * @param  data    The last data to process, may be `NULL`
+ *                 if `len` and `bits` are 0
+ * @param  len     The number of input whole bytes
+ * @param  bits    The number of input bits after the last whole bytes
+ *                 (may actually be greater than 7); these bits shall
+ *                 be stored in `data[len]`'s (addition bytes will be used
+ *                 if `bits > 8`) lower bits
+ * @param  suffix  String of '0's and '1's of addition bits to add to the
+ *                 end of the input, or `NULL` (or the empty string) if none;
+ *                 the first character corresponds to the lowest indexed
+ *                 additional bit, and the last character corresponds to
+ *                 the highest indexed additional bit
+ * @param  output  Output buffer for the hash, which will be stored in raw
+ *                 binary representation; the size of this buffer must be
+ *                 at least `LIBBLAKE_BLAKE256_OUTPUT_SIZE` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake256_stream_digest(struct libblake_blake256_stream *stream, const void *data, size_t len, size_t bits,
+                                const char *suffix, unsigned char output[static LIBBLAKE_BLAKE256_OUTPUT_SIZE]);
+
+/**
+ * Calculate the BLAKE256 hash of the data input so far,
+ * without finalising the state
+ * 
+ * Unlike `libblake_blake256_stream_digest`, `stream` is
+ * not modified, so more data can be input afterwards;
+ * this is cheaper than copying the stream and finalising
+ * the copy as only the state and the buffered data is
+ * copied
+ * 
+ * @param  stream  The state of the hash function
+ * @param  output  Output buffer for the hash, which will be stored in raw
+ *                 binary representation; the size of this buffer must be
+ *                 at least `LIBBLAKE_BLAKE256_OUTPUT_SIZE` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake256_stream_peek(const struct libblake_blake256_stream *stream, unsigned char output[static LIBBLAKE_BLAKE256_OUTPUT_SIZE]);
+
+/**
+ * Serialise a state for BLAKE256 hashing
+ * 
+ * The output is independent of the machine and of
+ * the library version's in-memory representation,
+ * and can be restored with `libblake_blake256_import`
+ * 
+ * @param   state   The state to serialise
+ * @param   buffer  Output buffer, may be `NULL` if `size` is 0
+ * @param   size    The size of `buffer`
+ * @return          The number of bytes required for the output; if
+ *                  greater than `size`, nothing is written to `buffer`
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake256_export(const struct libblake_blake256_state *state, void *buffer, size_t size);
+
+/**
+ * Restore a state for BLAKE256 hashing,
+ * serialised with `libblake_blake256_export`
+ * 
+ * @param   state   Output parameter for the state;
+ *                  not modified on failure
+ * @param   buffer  The serialised state
+ * @param   len     The number of bytes in `buffer`
+ * @return          0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `buffer` does not contain a state for
+ *                  BLAKE256 hashing in a supported format
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake256_import(struct libblake_blake256_state *state, const void *buffer, size_t len);
+
+/**
+ * Serialise a buffered state for BLAKE256 hashing
+ * 
+ * The output is independent of the machine and of
+ * the library version's in-memory representation,
+ * and can be restored with `libblake_blake256_stream_import`
+ * 
+ * @param   stream  The buffered state to serialise
+ * @param   buffer  Output buffer, may be `NULL` if `size` is 0
+ * @param   size    The size of `buffer`
+ * @return          The number of bytes required for the output; if
+ *                  greater than `size`, nothing is written to `buffer`
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake256_stream_export(const struct libblake_blake256_stream *stream, void *buffer, size_t size);
+
+/**
+ * Restore a buffered state for BLAKE256 hashing,
+ * serialised with `libblake_blake256_stream_export`
+ * 
+ * @param   stream  Output parameter for the buffered state;
+ *                  not modified on failure
+ * @param   buffer  The serialised buffered state
+ * @param   len     The number of bytes in `buffer`
+ * @return          0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `buffer` does not contain a buffered state for
+ *                  BLAKE256 hashing in a supported format
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake256_stream_import(struct libblake_blake256_stream *stream, const void *buffer, size_t len);
+
+
+
+/**
+ * Initialise a state for hashing with BLAKE384
+ * 
+ * @param  state  The state to initialise
+ * @param  salt   32-byte salt to use, or `NULL` for an all-zeroes salt
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake384_init2(struct libblake_blake384_state *state, const uint_least8_t salt[32]);
+
+/**
+ * Initialise a state for hashing with BLAKE384
+ * and an all-zeroes salt
+ * 
+ * @param  state  The state to initialise
+ */
+LIBBLAKE_PUBLIC__ inline void
 libblake_blake384_init(struct libblake_blake384_state *state) {
 	libblake_blake384_init2(state, NULL);
 }
@@ -441,6 +1215,275 @@ LIBBLAKE_PUBLIC__ void
 libblake_blake384_digest(struct libblake_blake384_state *state, void *data, size_t len, size_t bits,
                          const char *suffix, unsigned char output[static LIBBLAKE_BLAKE384_OUTPUT_SIZE]);
 
+/**
+ * Calculate the BLAKE384 hash of the input data
+ * 
+ * This function behaves like `libblake_blake384_digest`
+ * except it does not write to `data`, so no additional
+ * space is required, and `data` may be read-only; the
+ * last blocks are padded in a buffer on the stack
+ * 
+ * @param  state   The state of the hash function
+ * @param  data    The last data to process, may be `NULL`
+ *                 if `len` and `bits` are 0
+ * @param  len     The number of input whole bytes
+ * @param  bits    The number of input bits after the last whole bytes
+ *                 (may actually be greater than 7); these bits shall
+ *                 be stored in `data[len]`'s (addition bytes will be used
+ *                 if `bits > 8`) lower bits
+ * @param  suffix  String of '0's and '1's of addition bits to add to the
+ *                 end of the input, or `NULL` (or the empty string) if none;
+ *                 the first character corresponds to the lowest indexed
+ *                 additional bit, and the last character corresponds to
+ *                 the highest indexed additional bit
+ * @param  output  Output buffer for the hash, which will be stored in raw
+ *                 binary representation; the size of this buffer must be
+ *                 at least `LIBBLAKE_BLAKE384_OUTPUT_SIZE` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake384_digest_const(struct libblake_blake384_state *state, const void *data, size_t len, size_t bits,
+                               const char *suffix, unsigned char output[static LIBBLAKE_BLAKE384_OUTPUT_SIZE]);
+
+/**
+ * Process data for hashing with BLAKE384
+ * 
+ * This function behaves like `libblake_blake384_update`
+ * except the input is read from a list of buffers:
+ * the processed bytes are the first bytes of the
+ * concatenation of the buffers; blocks that straddle
+ * two buffers are copied, other blocks are processed
+ * where they are stored
+ * 
+ * @param   state   The state of the hash function
+ * @param   iov     The buffers to feed into the function, in order
+ * @param   iovcnt  The number of elements in `iov`
+ * @return          The number of processed bytes
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake384_updatev(struct libblake_blake384_state *state, const struct iovec *iov, size_t iovcnt);
+
+/**
+ * Calculate the BLAKE384 hash of the input data
+ * 
+ * This function behaves like `libblake_blake384_digest`
+ * except the input is read from a list of buffers,
+ * which are not modified, so no additional space
+ * is required
+ * 
+ * @param  state   The state of the hash function
+ * @param  iov     The last data to process, in order
+ * @param  iovcnt  The number of elements in `iov`
+ * @param  bits    The number of input bits after the last whole bytes
+ *                 (may actually be greater than 7); these bits shall be
+ *                 stored in the lower bits of the last bytes (the last
+ *                 byte if `bits < 8`) in the last non-empty buffer, and
+ *                 are included in its `iov_len`
+ * @param  suffix  String of '0's and '1's of addition bits to add to the
+ *                 end of the input, or `NULL` (or the empty string) if none;
+ *                 the first character corresponds to the lowest indexed
+ *                 additional bit, and the last character corresponds to
+ *                 the highest indexed additional bit
+ * @param  output  Output buffer for the hash, which will be stored in raw
+ *                 binary representation; the size of this buffer must be
+ *                 at least `LIBBLAKE_BLAKE384_OUTPUT_SIZE` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake384_digestv(struct libblake_blake384_state *state, const struct iovec *iov, size_t iovcnt, size_t bits,
+                          const char *suffix, unsigned char output[static LIBBLAKE_BLAKE384_OUTPUT_SIZE]);
+
+/**
+ * Initialise a buffered state for hashing with BLAKE384
+ * 
+ * @param  stream  The state to initialise
+ * @param  salt    32-byte salt to use, or `NULL` for an all-zeroes salt
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake384_stream_init2(struct libblake_blake384_stream *stream, const uint_least8_t salt[32]);
+
+/**
+ * Initialise a buffered state for hashing with
+ * BLAKE384 and an all-zeroes salt
+ * 
+ * @param  stream  The state to initialise
+ */
+LIBBLAKE_PUBLIC__ inline void
+libblake_blake384_stream_init(struct libblake_blake384_stream *stream) {
+	libblake_blake384_stream_init2(stream, NULL);
+}
+
+/**
+ * Process data for hashing with BLAKE384
+ * 
+ * Unlike `libblake_blake384_update`, this function
+ * processes all input data: any data in excess of
+ * a 128-byte multiple is stored in the state and
+ * is processed when more data is input or when
+ * `libblake_blake384_stream_digest` is called
+ * 
+ * @param  stream  The state of the hash function
+ * @param  data    The data to feed into the function
+ * @param  len     The number of bytes to process
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake384_stream_update(struct libblake_blake384_stream *stream, const void *data, size_t len);
+
+/**
+ * Process the contents of a file for BLAKE384 hashing
+ * 
+ * Holes in sparse files are hashed without being read,
+ * large regular files that are sealed against shrinking
+ * (see memfd_create(2)) are mapped into memory rather
+ * than read, other files are read with large buffers
+ * (a mapped file that is truncated while it is hashed
+ * would kill the process with SIGBUS), and if
+ * they are not regular files (for example pipes
+ * and sockets), they are read on a separate thread so
+ * that reading and hashing overlap; either way, the
+ * data is not copied more than
+ * `libblake_blake384_stream_update` requires
+ * 
+ * @param   stream  The state of the hash function
+ * @param   fd      The file descriptor to read, from its current
+ *                  offset until the end of the file
+ * @return          0 on success, -1 on failure; on failure,
+ *                  some data may have been processed
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  EIO     The file was truncated while it was being hashed
+ * @throws  -       Any error specified for fstat(3) or read(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake384_stream_update_fd(struct libblake_blake384_stream *stream, int fd);
+
+/**
+ * Process the contents of a file for BLAKE384 hashing,
+ * see `libblake_blake384_stream_update_fd` for details
+ * 
+ * @param   stream  The state of the hash function
+ * @param   path    The file to read
+ * @return          0 on success, -1 on failure; on failure,
+ *                  some data may have been processed
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  -       Any error specified for open(3), fstat(3) or read(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake384_stream_update_path(struct libblake_blake384_stream *stream, const char *path);
+
+/**
+ * Calculate the BLAKE384 hash of the input data
+ * 
+ * The `stream` parameter must have been initialised using
+ * the `libblake_blake384_stream_init` function, after which,
+ * but before this function is called,
+ * `libblake_blake384_stream_update` can be used to process
+ * data before this function is called. Unlike
+ * `libblake_blake384_digest`, this function does not
+ * write to `data`, so no additional space is required
+ * 
+ * @param  stream  The state of the hash function
+ * @param  data    The last data to process, may be `NULL`
+ *                 if `len` and `bits` are 0
+ * @param  len     The number of input whole bytes
+ * @param  bits    The number of input bits after the last whole bytes
+ *                 (may actually be greater than 7); these bits shall
+ *                 be stored in `data[len]`'s (addition bytes will be used
+ *                 if `bits > 8`) lower bits
+ * @param  suffix  String of '0's and '1's of addition bits to add to the
+ *                 end of the input, or `NULL` (or the empty string) if none;
+ *                 the first character corresponds to the lowest indexed
+ *                 additional bit, and the last character corresponds to
+ *                 the highest indexed additional bit
+ * @param  output  Output buffer for the hash, which will be stored in raw
+ *                 binary representation; the size of this buffer must be
+ *                 at least `LIBBLAKE_BLAKE384_OUTPUT_SIZE` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake384_stream_digest(struct libblake_blake384_stream *stream, const void *data, size_t len, size_t bits,
+                                const char *suffix, unsigned char output[static LIBBLAKE_BLAKE384_OUTPUT_SIZE]);
+
+/**
+ * Calculate the BLAKE384 hash of the data input so far,
+ * without finalising the state
+ * 
+ * Unlike `libblake_blake384_stream_digest`, `stream` is
+ * not modified, so more data can be input afterwards;
+ * this is cheaper than copying the stream and finalising
+ * the copy as only the state and the buffered data is
+ * copied
+ * 
+ * @param  stream  The state of the hash function
+ * @param  output  Output buffer for the hash, which will be stored in raw
+ *                 binary representation; the size of this buffer must be
+ *                 at least `LIBBLAKE_BLAKE384_OUTPUT_SIZE` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake384_stream_peek(const struct libblake_blake384_stream *stream, unsigned char output[static LIBBLAKE_BLAKE384_OUTPUT_SIZE]);
+
+/**
+ * Serialise a state for BLAKE384 hashing
+ * 
+ * The output is independent of the machine and of
+ * the library version's in-memory representation,
+ * and can be restored with `libblake_blake384_import`
+ * 
+ * @param   state   The state to serialise
+ * @param   buffer  Output buffer, may be `NULL` if `size` is 0
+ * @param   size    The size of `buffer`
+ * @return          The number of bytes required for the output; if
+ *                  greater than `size`, nothing is written to `buffer`
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake384_export(const struct libblake_blake384_state *state, void *buffer, size_t size);
+
+/**
+ * Restore a state for BLAKE384 hashing,
+ * serialised with `libblake_blake384_export`
+ * 
+ * @param   state   Output parameter for the state;
+ *                  not modified on failure
+ * @param   buffer  The serialised state
+ * @param   len     The number of bytes in `buffer`
+ * @return          0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `buffer` does not contain a state for
+ *                  BLAKE384 hashing in a supported format
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake384_import(struct libblake_blake384_state *state, const void *buffer, size_t len);
+
+/**
+ * Serialise a buffered state for BLAKE384 hashing
+ * 
+ * The output is independent of the machine and of
+ * the library version's in-memory representation,
+ * and can be restored with `libblake_blake384_stream_import`
+ * 
+ * @param   stream  The buffered state to serialise
+ * @param   buffer  Output buffer, may be `NULL` if `size` is 0
+ * @param   size    The size of `buffer`
+ * @return          The number of bytes required for the output; if
+ *                  greater than `size`, nothing is written to `buffer`
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake384_stream_export(const struct libblake_blake384_stream *stream, void *buffer, size_t size);
+
+/**
+ * Restore a buffered state for BLAKE384 hashing,
+ * serialised with `libblake_blake384_stream_export`
+ * 
+ * @param   stream  Output parameter for the buffered state;
+ *                  not modified on failure
+ * @param   buffer  The serialised buffered state
+ * @param   len     The number of bytes in `buffer`
+ * @return          0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `buffer` does not contain a buffered state for
+ *                  BLAKE384 hashing in a supported format
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake384_stream_import(struct libblake_blake384_stream *stream, const void *buffer, size_t len);
+
 
 
 /**
@@ -529,26 +1572,302 @@ LIBBLAKE_PUBLIC__ void
 libblake_blake512_digest(struct libblake_blake512_state *state, void *data, size_t len, size_t bits,
                          const char *suffix, unsigned char output[static LIBBLAKE_BLAKE512_OUTPUT_SIZE]);
 
-
-
-/*********************************** BLAKE2 ***********************************/
-
-/**
- * The block size used by BLAKE2s; it will only
- * process a multiple of this number of bytes in
- * each call to `libblake_blake2s_update` or
- * `libblake_blake2s_force_update`
- */
-#define LIBBLAKE_BLAKE2S_BLOCK_SIZE 64
-
 /**
- * The block size used by BLAKE2b; it will only
- * process a multiple of this number of bytes in
+ * Calculate the BLAKE512 hash of the input data
+ * 
+ * This function behaves like `libblake_blake512_digest`
+ * except it does not write to `data`, so no additional
+ * space is required, and `data` may be read-only; the
+ * last blocks are padded in a buffer on the stack
+ * 
+ * @param  state   The state of the hash function
+ * @param  data    The last data to process, may be `NULL`
+ *                 if `len` and `bits` are 0
+ * @param  len     The number of input whole bytes
+ * @param  bits    The number of input bits after the last whole bytes
+ *                 (may actually be greater than 7); these bits shall
+ *                 be stored in `data[len]`'s (addition bytes will be used
+ *                 if `bits > 8`) lower bits
+ * @param  suffix  String of '0's and '1's of addition bits to add to the
+ *                 end of the input, or `NULL` (or the empty string) if none;
+ *                 the first character corresponds to the lowest indexed
+ *                 additional bit, and the last character corresponds to
+ *                 the highest indexed additional bit
+ * @param  output  Output buffer for the hash, which will be stored in raw
+ *                 binary representation; the size of this buffer must be
+ *                 at least `LIBBLAKE_BLAKE512_OUTPUT_SIZE` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake512_digest_const(struct libblake_blake512_state *state, const void *data, size_t len, size_t bits,
+                               const char *suffix, unsigned char output[static LIBBLAKE_BLAKE512_OUTPUT_SIZE]);
+
+/**
+ * Process data for hashing with BLAKE512
+ * 
+ * This function behaves like `libblake_blake512_update`
+ * except the input is read from a list of buffers:
+ * the processed bytes are the first bytes of the
+ * concatenation of the buffers; blocks that straddle
+ * two buffers are copied, other blocks are processed
+ * where they are stored
+ * 
+ * @param   state   The state of the hash function
+ * @param   iov     The buffers to feed into the function, in order
+ * @param   iovcnt  The number of elements in `iov`
+ * @return          The number of processed bytes
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake512_updatev(struct libblake_blake512_state *state, const struct iovec *iov, size_t iovcnt);
+
+/**
+ * Calculate the BLAKE512 hash of the input data
+ * 
+ * This function behaves like `libblake_blake512_digest`
+ * except the input is read from a list of buffers,
+ * which are not modified, so no additional space
+ * is required
+ * 
+ * @param  state   The state of the hash function
+ * @param  iov     The last data to process, in order
+ * @param  iovcnt  The number of elements in `iov`
+ * @param  bits    The number of input bits after the last whole bytes
+ *                 (may actually be greater than 7); these bits shall be
+ *                 stored in the lower bits of the last bytes (the last
+ *                 byte if `bits < 8`) in the last non-empty buffer, and
+ *                 are included in its `iov_len`
+ * @param  suffix  String of '0's and '1's of addition bits to add to the
+ *                 end of the input, or `NULL` (or the empty string) if none;
+ *                 the first character corresponds to the lowest indexed
+ *                 additional bit, and the last character corresponds to
+ *                 the highest indexed additional bit
+ * @param  output  Output buffer for the hash, which will be stored in raw
+ *                 binary representation; the size of this buffer must be
+ *                 at least `LIBBLAKE_BLAKE512_OUTPUT_SIZE` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake512_digestv(struct libblake_blake512_state *state, const struct iovec *iov, size_t iovcnt, size_t bits,
+                          const char *suffix, unsigned char output[static LIBBLAKE_BLAKE512_OUTPUT_SIZE]);
+
+/**
+ * Initialise a buffered state for hashing with BLAKE512
+ * 
+ * @param  stream  The state to initialise
+ * @param  salt    32-byte salt to use, or `NULL` for an all-zeroes salt
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake512_stream_init2(struct libblake_blake512_stream *stream, const uint_least8_t salt[32]);
+
+/**
+ * Initialise a buffered state for hashing with
+ * BLAKE512 and an all-zeroes salt
+ * 
+ * @param  stream  The state to initialise
+ */
+LIBBLAKE_PUBLIC__ inline void
+libblake_blake512_stream_init(struct libblake_blake512_stream *stream) {
+	libblake_blake512_stream_init2(stream, NULL);
+}
+
+/**
+ * Process data for hashing with BLAKE512
+ * 
+ * Unlike `libblake_blake512_update`, this function
+ * processes all input data: any data in excess of
+ * a 128-byte multiple is stored in the state and
+ * is processed when more data is input or when
+ * `libblake_blake512_stream_digest` is called
+ * 
+ * @param  stream  The state of the hash function
+ * @param  data    The data to feed into the function
+ * @param  len     The number of bytes to process
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake512_stream_update(struct libblake_blake512_stream *stream, const void *data, size_t len);
+
+/**
+ * Process the contents of a file for BLAKE512 hashing
+ * 
+ * Holes in sparse files are hashed without being read,
+ * large regular files that are sealed against shrinking
+ * (see memfd_create(2)) are mapped into memory rather
+ * than read, other files are read with large buffers
+ * (a mapped file that is truncated while it is hashed
+ * would kill the process with SIGBUS), and if
+ * they are not regular files (for example pipes
+ * and sockets), they are read on a separate thread so
+ * that reading and hashing overlap; either way, the
+ * data is not copied more than
+ * `libblake_blake512_stream_update` requires
+ * 
+ * @param   stream  The state of the hash function
+ * @param   fd      The file descriptor to read, from its current
+ *                  offset until the end of the file
+ * @return          0 on success, -1 on failure; on failure,
+ *                  some data may have been processed
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  EIO     The file was truncated while it was being hashed
+ * @throws  -       Any error specified for fstat(3) or read(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake512_stream_update_fd(struct libblake_blake512_stream *stream, int fd);
+
+/**
+ * Process the contents of a file for BLAKE512 hashing,
+ * see `libblake_blake512_stream_update_fd` for details
+ * 
+ * @param   stream  The state of the hash function
+ * @param   path    The file to read
+ * @return          0 on success, -1 on failure; on failure,
+ *                  some data may have been processed
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  -       Any error specified for open(3), fstat(3) or read(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake512_stream_update_path(struct libblake_blake512_stream *stream, const char *path);
+
+/**
+ * Calculate the BLAKE512 hash of the input data
+ * 
+ * The `stream` parameter must have been initialised using
+ * the `libblake_blake512_stream_init` function, after which,
+ * but before this function is called,
+ * `libblake_blake512_stream_update` can be used to process
+ * data before this function is called. Unlike
+ * `libblake_blake512_digest`, this function does not
+ * write to `data`, so no additional space is required
+ * 
+ * @param  stream  The state of the hash function
+ * @param  data    The last data to process, may be `NULL`
+ *                 if `len` and `bits` are 0
+ * @param  len     The number of input whole bytes
+ * @param  bits    The number of input bits after the last whole bytes
+ *                 (may actually be greater than 7); these bits shall
+ *                 be stored in `data[len]`'s (addition bytes will be used
+ *                 if `bits > 8`) lower bits
+ * @param  suffix  String of '0's and '1's of addition bits to add to the
+ *                 end of the input, or `NULL` (or the empty string) if none;
+ *                 the first character corresponds to the lowest indexed
+ *                 additional bit, and the last character corresponds to
+ *                 the highest indexed additional bit
+ * @param  output  Output buffer for the hash, which will be stored in raw
+ *                 binary representation; the size of this buffer must be
+ *                 at least `LIBBLAKE_BLAKE512_OUTPUT_SIZE` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake512_stream_digest(struct libblake_blake512_stream *stream, const void *data, size_t len, size_t bits,
+                                const char *suffix, unsigned char output[static LIBBLAKE_BLAKE512_OUTPUT_SIZE]);
+
+/**
+ * Calculate the BLAKE512 hash of the data input so far,
+ * without finalising the state
+ * 
+ * Unlike `libblake_blake512_stream_digest`, `stream` is
+ * not modified, so more data can be input afterwards;
+ * this is cheaper than copying the stream and finalising
+ * the copy as only the state and the buffered data is
+ * copied
+ * 
+ * @param  stream  The state of the hash function
+ * @param  output  Output buffer for the hash, which will be stored in raw
+ *                 binary representation; the size of this buffer must be
+ *                 at least `LIBBLAKE_BLAKE512_OUTPUT_SIZE` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake512_stream_peek(const struct libblake_blake512_stream *stream, unsigned char output[static LIBBLAKE_BLAKE512_OUTPUT_SIZE]);
+
+/**
+ * Serialise a state for BLAKE512 hashing
+ * 
+ * The output is independent of the machine and of
+ * the library version's in-memory representation,
+ * and can be restored with `libblake_blake512_import`
+ * 
+ * @param   state   The state to serialise
+ * @param   buffer  Output buffer, may be `NULL` if `size` is 0
+ * @param   size    The size of `buffer`
+ * @return          The number of bytes required for the output; if
+ *                  greater than `size`, nothing is written to `buffer`
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake512_export(const struct libblake_blake512_state *state, void *buffer, size_t size);
+
+/**
+ * Restore a state for BLAKE512 hashing,
+ * serialised with `libblake_blake512_export`
+ * 
+ * @param   state   Output parameter for the state;
+ *                  not modified on failure
+ * @param   buffer  The serialised state
+ * @param   len     The number of bytes in `buffer`
+ * @return          0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `buffer` does not contain a state for
+ *                  BLAKE512 hashing in a supported format
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake512_import(struct libblake_blake512_state *state, const void *buffer, size_t len);
+
+/**
+ * Serialise a buffered state for BLAKE512 hashing
+ * 
+ * The output is independent of the machine and of
+ * the library version's in-memory representation,
+ * and can be restored with `libblake_blake512_stream_import`
+ * 
+ * @param   stream  The buffered state to serialise
+ * @param   buffer  Output buffer, may be `NULL` if `size` is 0
+ * @param   size    The size of `buffer`
+ * @return          The number of bytes required for the output; if
+ *                  greater than `size`, nothing is written to `buffer`
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake512_stream_export(const struct libblake_blake512_stream *stream, void *buffer, size_t size);
+
+/**
+ * Restore a buffered state for BLAKE512 hashing,
+ * serialised with `libblake_blake512_stream_export`
+ * 
+ * @param   stream  Output parameter for the buffered state;
+ *                  not modified on failure
+ * @param   buffer  The serialised buffered state
+ * @param   len     The number of bytes in `buffer`
+ * @return          0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `buffer` does not contain a buffered state for
+ *                  BLAKE512 hashing in a supported format
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake512_stream_import(struct libblake_blake512_stream *stream, const void *buffer, size_t len);
+
+
+
+/*********************************** BLAKE2 ***********************************/
+
+/**
+ * The block size used by BLAKE2s; it will only
+ * process a multiple of this number of bytes in
+ * each call to `libblake_blake2s_update` or
+ * `libblake_blake2s_force_update`
+ */
+#define LIBBLAKE_BLAKE2S_BLOCK_SIZE 64
+
+/**
+ * The block size used by BLAKE2b; it will only
+ * process a multiple of this number of bytes in
  * each call to `libblake_blake2b_update` or
  * `libblake_blake2b_force_update`
  */
 #define LIBBLAKE_BLAKE2B_BLOCK_SIZE 128
 
+/**
+ * Flag for `libblake_blake2s_hash_files` and
+ * `libblake_blake2b_hash_files`: read files with
+ * O_DIRECT, bypassing the page cache, where supported
+ */
+#define LIBBLAKE_HASH_FILES_DIRECT 0x0001
+
 /**
  * BLAKE2s hashing parameters
  */
@@ -822,135 +2141,286 @@ struct libblake_blake2b_state {
 	uint_least64_t f[2];
 };
 
+/**
+ * Buffered state for BLAKE2s hashing
+ * 
+ * This structure should be opaque
+ */
+struct libblake_blake2s_stream {
+	struct libblake_blake2s_state state;
+	size_t buffered;
+	unsigned char buffer[64];
+};
 
-
 /**
- * Initialise a state for hashing with BLAKE2s
+ * Keyed state for BLAKE2s hashing that can be reused
+ * for any number of messages with the same key
  * 
- * For keyed mode, which is used for MAC and PRF,
- * after calling this function, the 64 first bytes
- * input to the hash function shall be the key
- * with NUL bytes appended to it (such that the
- * length is 64 bytes, which is double the maximum
- * allowed length of the key, but is the size
- * block size used by BLAKE2s)
+ * This structure should be opaque
+ */
+struct libblake_blake2s_prekeyed {
+	struct libblake_blake2s_state state;
+	struct libblake_blake2s_state initial;
+	unsigned char key_block[64];
+};
+
+/**
+ * State for BLAKE2s hashing of messages that consist of
+ * a constant prefix followed by a variable nonce, with
+ * the prefix processed as far as possible
  * 
- * @param  state   The state to initialise
- * @param  params  Hashing parameters
+ * This structure should be opaque
  */
-LIBBLAKE_PUBLIC__ void
-libblake_blake2s_init(struct libblake_blake2s_state *state, const struct libblake_blake2s_params *params);
+struct libblake_blake2s_midstate {
+	struct libblake_blake2s_state state;
+	size_t digest_len;
+	size_t tail_len;
+	unsigned char tail[64];
+};
 
 /**
- * Process data for hashing with BLAKE2s
+ * Compact state for BLAKE2s hashing
  * 
- * The function can only process multiples of 64 bytes,
- * but cannot process that last chunk of 64 bytes
- * unless a non-multiple of 64 bytes is input to the
- * function; any excess data will be ignored and must
- * be processed when more data is available or using
- * `libblake_blake2s_digest` when the end of the
- * input has been reached
+ * Unlike `struct libblake_blake2s_state`, this
+ * structure does not store the finalisation flags,
+ * which are always cleared until the last block
+ * is processed, and has no alignment padding
  * 
- * @param   state  The state of the hash function
- * @param   data   The data to feed into the function
- * @param   len    The maximum number of bytes to process
- * @return         The number of processed bytes
+ * This structure should be opaque
  */
-LIBBLAKE_PUBLIC__ size_t
-libblake_blake2s_update(struct libblake_blake2s_state *state, const void *data, size_t len);
+struct libblake_blake2s_compact_state {
+	uint_least32_t h[8];
+	uint_least32_t t[2];
+};
 
 /**
- * Process data for hashing with BLAKE2s
+ * Structure-of-arrays container for many BLAKE2s states
  * 
- * The function can only process multiples of 64 bytes,
- * any excess data will be ignored and must be
- * processed when more data is available or using
- * `libblake_blake2s_digest` when the end of the input
- * has been reached
+ * Each state word is stored in its own array, so that
+ * the same word from consecutive states are adjacent
+ * in memory
  * 
- * Unlike `libblake_blake2s_update`, this function
- * will all input data if `len` is a multiple of
- * 64, however the application must make sure that
- * there is more data to process
+ * This structure should be opaque
+ */
+struct libblake_blake2s_table {
+	size_t size;
+	uint_least32_t *words;
+};
+
+/**
+ * Scheduler that processes data for many BLAKE2s
+ * streams, stored in a `struct libblake_blake2s_table`,
+ * in parallel
  * 
- * @param   state  The state of the hash function
- * @param   data   The data to feed into the function
- * @param   len    The maximum number of bytes to process
- * @return         The number of processed bytes
+ * This structure should be opaque
  */
-LIBBLAKE_PUBLIC__ size_t
-libblake_blake2s_force_update(struct libblake_blake2s_state *state, const void *data, size_t len);
+struct libblake_blake2s_scheduler {
+	struct libblake_blake2s_table *table;
+	size_t max_jobs;
+	size_t njobs;
+	struct libblake_scheduler_job *jobs;
+};
 
 /**
- * Get the required allocation size of the
- * input buffer for `libblake_blake2s_digest`
+ * Index of intermediate BLAKE2s states, captured at
+ * regular intervals while hashing, that allows the
+ * hash of any prefix of the input to be calculated
+ * without processing the entire prefix again
  * 
- * @param   len  The number of input bytes
- * @return       The number bytes required for the input buffer
+ * This structure should be opaque
  */
-LIBBLAKE_PUBLIC__ LIBBLAKE_CONST__ size_t
-libblake_blake2s_digest_get_required_input_size(size_t len);
+struct libblake_blake2s_checkpoints {
+	size_t interval; /* in blocks */
+	size_t blocks; /* since last checkpoint */
+	size_t count;
+	size_t capacity;
+	uint_least32_t *words;
+};
 
 /**
- * Calculate the BLAKE2s hash of the input data
+ * Buffered state for BLAKE2b hashing
  * 
- * The `state` parameter must have been initialised using
- * the `libblake_blake2s_init` function, after which, but
- * before this function is called, `libblake_blake2s_update`
- * and `libblake_blake2s_force_update` can be used to
- * process data before this function is called. Already
- * processed data shall not be input to this function.
+ * This structure should be opaque
+ */
+struct libblake_blake2b_stream {
+	struct libblake_blake2b_state state;
+	size_t buffered;
+	unsigned char buffer[128];
+};
+
+/**
+ * Keyed state for BLAKE2b hashing that can be reused
+ * for any number of messages with the same key
  * 
- * @param  state       The state of the hash function
- * @param  data        Data to process; the function will write addition data to
- *                     the end, therefore the size of this buffer must be at least
- *                     `libblake_blake2s_digest_get_required_input_size(len)`
- *                     bytes large
- * @param  len         The number of input bytes
- * @param  last_node   Shall be non-0 the last node at each level in the
- *                     hashing tree, include the root node, however, it
- *                     shall be 0 if not using tree-hashing
- * @param  output_len  The number of bytes to write to `output_len`; this
- *                     shall be the value `params->digest_len` had when
- *                     `libblake_blake2s_init` was called, where `params`
- *                     is the second argument given to `libblake_blake2s_init`
- * @param  output      Output buffer for the hash, which will be stored in raw
- *                     binary representation; the size of this buffer must be
- *                     at least `output_len` bytes
+ * This structure should be opaque
  */
-LIBBLAKE_PUBLIC__ void
-libblake_blake2s_digest(struct libblake_blake2s_state *state, void *data, size_t len, int last_node,
-                        size_t output_len, unsigned char output[static output_len]);
+struct libblake_blake2b_prekeyed {
+	struct libblake_blake2b_state state;
+	struct libblake_blake2b_state initial;
+	unsigned char key_block[128];
+};
 
+/**
+ * State for BLAKE2b hashing of messages that consist of
+ * a constant prefix followed by a variable nonce, with
+ * the prefix processed as far as possible
+ * 
+ * This structure should be opaque
+ */
+struct libblake_blake2b_midstate {
+	struct libblake_blake2b_state state;
+	size_t digest_len;
+	size_t tail_len;
+	unsigned char tail[128];
+};
 
-
 /**
- * Initialise a state for hashing with BLAKE2b
+ * Compact state for BLAKE2b hashing
+ * 
+ * Unlike `struct libblake_blake2b_state`, this
+ * structure does not store the finalisation flags,
+ * which are always cleared until the last block
+ * is processed, and has no alignment padding
+ * 
+ * This structure should be opaque
+ */
+struct libblake_blake2b_compact_state {
+	uint_least64_t h[8];
+	uint_least64_t t[2];
+};
+
+/**
+ * Structure-of-arrays container for many BLAKE2b states
+ * 
+ * Each state word is stored in its own array, so that
+ * the same word from consecutive states are adjacent
+ * in memory
+ * 
+ * This structure should be opaque
+ */
+struct libblake_blake2b_table {
+	size_t size;
+	uint_least64_t *words;
+};
+
+/**
+ * Scheduler that processes data for many BLAKE2b
+ * streams, stored in a `struct libblake_blake2b_table`,
+ * in parallel
+ * 
+ * This structure should be opaque
+ */
+struct libblake_blake2b_scheduler {
+	struct libblake_blake2b_table *table;
+	size_t max_jobs;
+	size_t njobs;
+	struct libblake_scheduler_job *jobs;
+};
+
+/**
+ * Index of intermediate BLAKE2b states, captured at
+ * regular intervals while hashing, that allows the
+ * hash of any prefix of the input to be calculated
+ * without processing the entire prefix again
+ * 
+ * This structure should be opaque
+ */
+struct libblake_blake2b_checkpoints {
+	size_t interval; /* in blocks */
+	size_t blocks; /* since last checkpoint */
+	size_t count;
+	size_t capacity;
+	uint_least64_t *words;
+};
+
+/**
+ * Content-defined chunker that splits data into
+ * chunks and calculates their BLAKE2b hashes
+ * 
+ * This structure should be opaque
+ */
+struct libblake_blake2b_chunker {
+	struct libblake_blake2b_state initial;
+	size_t digest_len;
+	size_t min_size;
+	size_t avg_size;
+	size_t max_size;
+	uint_least64_t mask_s;
+	uint_least64_t mask_l;
+	uint_least64_t offset;
+	struct libblake_blake2b_table table;
+	struct libblake_blake2b_scheduler scheduler;
+};
+
+/**
+ * Chunk output by `libblake_blake2b_chunker_update`
+ */
+struct libblake_blake2b_chunk {
+	/**
+	 * The position of the chunk in the input
+	 */
+	uint_least64_t offset;
+
+	/**
+	 * The number of bytes in the chunk
+	 */
+	size_t length;
+
+	/**
+	 * The hash of the chunk, the chunker's
+	 * `params->digest_len` bytes long
+	 */
+	unsigned char digest[64];
+};
+
+/**
+ * Block signature of a file, for rsync-style
+ * synchronisation: the weak rolling checksum and
+ * the BLAKE2b hash of each fixed-size block
+ * 
+ * This structure should be opaque
+ */
+struct libblake_blake2b_signature {
+	struct libblake_blake2b_state initial;
+	size_t block_size;
+	size_t digest_len;
+	size_t nblocks;
+	uint_least64_t size;
+	size_t index_bits;
+	size_t *index;
+	uint_least32_t *weak;
+	size_t *blocks;
+	unsigned char *digests;
+};
+
+
+
+/**
+ * Initialise a state for hashing with BLAKE2s
  * 
  * For keyed mode, which is used for MAC and PRF,
- * after calling this function, the 128 first bytes
+ * after calling this function, the 64 first bytes
  * input to the hash function shall be the key
  * with NUL bytes appended to it (such that the
- * length is 128 bytes, which is double the maximum
+ * length is 64 bytes, which is double the maximum
  * allowed length of the key, but is the size
- * block size used by BLAKE2b)
+ * block size used by BLAKE2s)
  * 
  * @param  state   The state to initialise
  * @param  params  Hashing parameters
  */
 LIBBLAKE_PUBLIC__ void
-libblake_blake2b_init(struct libblake_blake2b_state *state, const struct libblake_blake2b_params *params);
+libblake_blake2s_init(struct libblake_blake2s_state *state, const struct libblake_blake2s_params *params);
 
 /**
- * Process data for hashing with BLAKE2b
+ * Process data for hashing with BLAKE2s
  * 
- * The function can only process multiples of 128 bytes,
- * but cannot process that last chunk of 128 bytes
- * unless a non-multiple of 128 bytes is input to the
+ * The function can only process multiples of 64 bytes,
+ * but cannot process that last chunk of 64 bytes
+ * unless a non-multiple of 64 bytes is input to the
  * function; any excess data will be ignored and must
  * be processed when more data is available or using
- * `libblake_blake2b_digest` when the end of the
+ * `libblake_blake2s_digest` when the end of the
  * input has been reached
  * 
  * @param   state  The state of the hash function
@@ -959,20 +2429,20 @@ libblake_blake2b_init(struct libblake_blake2b_state *state, const struct libblak
  * @return         The number of processed bytes
  */
 LIBBLAKE_PUBLIC__ size_t
-libblake_blake2b_update(struct libblake_blake2b_state *state, const void *data, size_t len);
+libblake_blake2s_update(struct libblake_blake2s_state *state, const void *data, size_t len);
 
 /**
- * Process data for hashing with BLAKE2b
+ * Process data for hashing with BLAKE2s
  * 
- * The function can only process multiples of 128 bytes,
+ * The function can only process multiples of 64 bytes,
  * any excess data will be ignored and must be
  * processed when more data is available or using
  * `libblake_blake2s_digest` when the end of the input
  * has been reached
  * 
- * Unlike `libblake_blake2b_update`, this function
+ * Unlike `libblake_blake2s_update`, this function
  * will all input data if `len` is a multiple of
- * 128, however the application must make sure that
+ * 64, however the application must make sure that
  * there is more data to process
  * 
  * @param   state  The state of the hash function
@@ -981,32 +2451,32 @@ libblake_blake2b_update(struct libblake_blake2b_state *state, const void *data,
  * @return         The number of processed bytes
  */
 LIBBLAKE_PUBLIC__ size_t
-libblake_blake2b_force_update(struct libblake_blake2b_state *state, const void *data, size_t len);
+libblake_blake2s_force_update(struct libblake_blake2s_state *state, const void *data, size_t len);
 
 /**
  * Get the required allocation size of the
- * input buffer for `libblake_blake2b_digest`
+ * input buffer for `libblake_blake2s_digest`
  * 
  * @param   len  The number of input bytes
  * @return       The number bytes required for the input buffer
  */
 LIBBLAKE_PUBLIC__ LIBBLAKE_CONST__ size_t
-libblake_blake2b_digest_get_required_input_size(size_t len);
+libblake_blake2s_digest_get_required_input_size(size_t len);
 
 /**
- * Calculate the BLAKE2b hash of the input data
+ * Calculate the BLAKE2s hash of the input data
  * 
  * The `state` parameter must have been initialised using
- * the `libblake_blake2b_init` function, after which, but
- * before this function is called, `libblake_blake2b_update`
- * and `libblake_blake2b_force_update` can be used to
+ * the `libblake_blake2s_init` function, after which, but
+ * before this function is called, `libblake_blake2s_update`
+ * and `libblake_blake2s_force_update` can be used to
  * process data before this function is called. Already
  * processed data shall not be input to this function.
  * 
  * @param  state       The state of the hash function
  * @param  data        Data to process; the function will write addition data to
  *                     the end, therefore the size of this buffer must be at least
- *                     `libblake_blake2b_digest_get_required_input_size(len)`
+ *                     `libblake_blake2s_digest_get_required_input_size(len)`
  *                     bytes large
  * @param  len         The number of input bytes
  * @param  last_node   Shall be non-0 the last node at each level in the
@@ -1014,15 +2484,2744 @@ libblake_blake2b_digest_get_required_input_size(size_t len);
  *                     shall be 0 if not using tree-hashing
  * @param  output_len  The number of bytes to write to `output_len`; this
  *                     shall be the value `params->digest_len` had when
- *                     `libblake_blake2b_init` was called, where `params`
- *                     is the second argument given to `libblake_blake2b_init`
+ *                     `libblake_blake2s_init` was called, where `params`
+ *                     is the second argument given to `libblake_blake2s_init`
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_digest(struct libblake_blake2s_state *state, void *data, size_t len, int last_node,
+                        size_t output_len, unsigned char output[static output_len]);
+
+/**
+ * Calculate the BLAKE2s hash of the input data
+ * 
+ * This function behaves like `libblake_blake2s_digest`
+ * except it does not write to `data`, so no additional
+ * space is required, and `data` may be read-only; the
+ * last block is padded in a buffer on the stack
+ * 
+ * @param  state       The state of the hash function
+ * @param  data        The last data to process, may be `NULL` if `len` is 0
+ * @param  len         The number of input bytes
+ * @param  last_node   Shall be non-0 the last node at each level in the
+ *                     hashing tree, include the root node, however, it
+ *                     shall be 0 if not using tree-hashing
+ * @param  output_len  The number of bytes to write to `output_len`; this
+ *                     shall be the value `params->digest_len` had when
+ *                     `libblake_blake2s_init` was called, where `params`
+ *                     is the second argument given to `libblake_blake2s_init`
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_digest_const(struct libblake_blake2s_state *state, const void *data, size_t len, int last_node,
+                              size_t output_len, unsigned char output[static output_len]);
+
+/**
+ * Process data for hashing with BLAKE2s
+ * 
+ * This function behaves like `libblake_blake2s_update`
+ * except the input is read from a list of buffers:
+ * the processed bytes are the first bytes of the
+ * concatenation of the buffers, and, as with
+ * `libblake_blake2s_update`, the last 64 bytes are
+ * never processed; blocks that straddle two buffers
+ * are copied, other blocks are processed where
+ * they are stored
+ * 
+ * @param   state   The state of the hash function
+ * @param   iov     The buffers to feed into the function, in order
+ * @param   iovcnt  The number of elements in `iov`
+ * @return          The number of processed bytes
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2s_updatev(struct libblake_blake2s_state *state, const struct iovec *iov, size_t iovcnt);
+
+/**
+ * Calculate the BLAKE2s hash of the input data
+ * 
+ * This function behaves like `libblake_blake2s_digest`
+ * except the input is read from a list of buffers,
+ * which are not modified, so no additional space
+ * is required
+ * 
+ * @param  state       The state of the hash function
+ * @param  iov         The last data to process, in order
+ * @param  iovcnt      The number of elements in `iov`
+ * @param  last_node   Shall be non-0 the last node at each level in the
+ *                     hashing tree, include the root node, however, it
+ *                     shall be 0 if not using tree-hashing
+ * @param  output_len  The number of bytes to write to `output_len`; this
+ *                     shall be the value `params->digest_len` had when
+ *                     `libblake_blake2s_init` was called, where `params`
+ *                     is the second argument given to `libblake_blake2s_init`
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_digestv(struct libblake_blake2s_state *state, const struct iovec *iov, size_t iovcnt, int last_node,
+                         size_t output_len, unsigned char output[static output_len]);
+
+/**
+ * Initialise a buffered state for hashing with BLAKE2s
+ * 
+ * For keyed mode, the key shall, as with
+ * `libblake_blake2s_init`, be input as the
+ * first 64 bytes, padded with NUL bytes
+ * 
+ * @param  stream  The state to initialise
+ * @param  params  Hashing parameters
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_stream_init(struct libblake_blake2s_stream *stream, const struct libblake_blake2s_params *params);
+
+/**
+ * Process data for hashing with BLAKE2s
+ * 
+ * Unlike `libblake_blake2s_update`, this function
+ * processes all input data: up to one block of
+ * data is stored in the state and is processed
+ * when more data is input or when
+ * `libblake_blake2s_stream_digest` is called
+ * 
+ * @param  stream  The state of the hash function
+ * @param  data    The data to feed into the function
+ * @param  len     The number of bytes to process
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_stream_update(struct libblake_blake2s_stream *stream, const void *data, size_t len);
+
+/**
+ * Process the contents of a file for BLAKE2s hashing
+ * 
+ * Holes in sparse files are hashed without being read,
+ * large regular files that are sealed against shrinking
+ * (see memfd_create(2)) are mapped into memory rather
+ * than read, other files are read with large buffers
+ * (a mapped file that is truncated while it is hashed
+ * would kill the process with SIGBUS), and if
+ * they are not regular files (for example pipes
+ * and sockets), they are read on a separate thread so
+ * that reading and hashing overlap; either way, the
+ * data is not copied more than
+ * `libblake_blake2s_stream_update` requires
+ * 
+ * @param   stream  The state of the hash function
+ * @param   fd      The file descriptor to read, from its current
+ *                  offset until the end of the file
+ * @return          0 on success, -1 on failure; on failure,
+ *                  some data may have been processed
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  EIO     The file was truncated while it was being hashed
+ * @throws  -       Any error specified for fstat(3) or read(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2s_stream_update_fd(struct libblake_blake2s_stream *stream, int fd);
+
+/**
+ * Process the contents of a file for BLAKE2s hashing,
+ * see `libblake_blake2s_stream_update_fd` for details
+ * 
+ * @param   stream  The state of the hash function
+ * @param   path    The file to read
+ * @return          0 on success, -1 on failure; on failure,
+ *                  some data may have been processed
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  -       Any error specified for open(3), fstat(3) or read(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2s_stream_update_path(struct libblake_blake2s_stream *stream, const char *path);
+
+/**
+ * Calculate the BLAKE2s hash of the input data
+ * 
+ * The `stream` parameter must have been initialised using
+ * the `libblake_blake2s_stream_init` function, after which,
+ * but before this function is called,
+ * `libblake_blake2s_stream_update` can be used to process
+ * data before this function is called. Unlike
+ * `libblake_blake2s_digest`, this function does not
+ * write to `data`, so no additional space is required
+ * 
+ * @param  stream      The state of the hash function
+ * @param  data        The last data to process, may be `NULL` if `len` is 0
+ * @param  len         The number of input bytes
+ * @param  last_node   Shall be non-0 the last node at each level in the
+ *                     hashing tree, include the root node, however, it
+ *                     shall be 0 if not using tree-hashing
+ * @param  output_len  The number of bytes to write to `output_len`; this
+ *                     shall be the value `params->digest_len` had when
+ *                     `libblake_blake2s_stream_init` was called, where
+ *                     `params` is the second argument given to
+ *                     `libblake_blake2s_stream_init`
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_stream_digest(struct libblake_blake2s_stream *stream, const void *data, size_t len, int last_node,
+                               size_t output_len, unsigned char output[static output_len]);
+
+/**
+ * Calculate the BLAKE2s hash of the data input so far,
+ * without finalising the state
+ * 
+ * Unlike `libblake_blake2s_stream_digest`, `stream` is
+ * not modified, so more data can be input afterwards;
+ * this is cheaper than copying the stream and finalising
+ * the copy as only the state and the buffered data is
+ * copied, and the only compression performed is the
+ * one of the final block
+ * 
+ * @param  stream      The state of the hash function
+ * @param  last_node   Shall be non-0 the last node at each level in the
+ *                     hashing tree, include the root node, however, it
+ *                     shall be 0 if not using tree-hashing
+ * @param  output_len  The number of bytes to write to `output_len`; this
+ *                     shall be the value `params->digest_len` had when
+ *                     `libblake_blake2s_stream_init` was called, where
+ *                     `params` is the second argument given to
+ *                     `libblake_blake2s_stream_init`
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_stream_peek(const struct libblake_blake2s_stream *stream, int last_node,
+                             size_t output_len, unsigned char output[static output_len]);
+
+/**
+ * Calculate the BLAKE2s hash of a message in one call
+ * 
+ * This is a shorthand for using `libblake_blake2s_init` followed
+ * by `libblake_blake2s_digest` for the common case of sequential
+ * (non-tree) hashing without salt and pepper: no parameter block
+ * is needed, and the input is not written to. It is not faster,
+ * as the time is spent in the compression function
+ * 
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ * @param  output_len  The hash size, in bytes, between 1 and 32 (inclusive)
+ * @param  data        The message, may be `NULL` if `len` is 0
+ * @param  len         The number of bytes in the message
+ * @param  key         The key, may be `NULL` if `key_len` is 0
+ * @param  key_len     The number of bytes in the key, at most 32,
+ *                     or 0 for unkeyed hashing
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s(void *output, size_t output_len, const void *data, size_t len, const void *key, size_t key_len);
+
+/**
+ * Calculate the BLAKE2s hash of a message of exactly 32 bytes
+ * 
+ * This is the same as `libblake_blake2s(output, output_len, data, 32,
+ * key, key_len)`, but the message length is known when the function
+ * is compiled, so the only work done is the compressions
+ * 
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ * @param  output_len  The hash size, in bytes, between 1 and 32 (inclusive)
+ * @param  data        The message, 32 bytes long
+ * @param  key         The key, may be `NULL` if `key_len` is 0
+ * @param  key_len     The number of bytes in the key, at most 32,
+ *                     or 0 for unkeyed hashing
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_fixed32(void *output, size_t output_len, const void *data, const void *key, size_t key_len);
+
+/**
+ * Calculate the BLAKE2s hash of a message of exactly 64 bytes
+ * 
+ * This is the same as `libblake_blake2s(output, output_len, data, 64,
+ * key, key_len)`, but the message length is known when the function
+ * is compiled, so the only work done is the compressions
+ * 
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ * @param  output_len  The hash size, in bytes, between 1 and 32 (inclusive)
+ * @param  data        The message, 64 bytes long
+ * @param  key         The key, may be `NULL` if `key_len` is 0
+ * @param  key_len     The number of bytes in the key, at most 32,
+ *                     or 0 for unkeyed hashing
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_fixed64(void *output, size_t output_len, const void *data, const void *key, size_t key_len);
+
+/**
+ * Calculate the BLAKE2s hash of a message of exactly 4096 bytes
+ * 
+ * This is the same as `libblake_blake2s(output, output_len, data, 4096,
+ * key, key_len)`, but the message length is known when the function
+ * is compiled, so the only work done is the compressions
+ * 
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ * @param  output_len  The hash size, in bytes, between 1 and 32 (inclusive)
+ * @param  data        The message, 4096 bytes long
+ * @param  key         The key, may be `NULL` if `key_len` is 0
+ * @param  key_len     The number of bytes in the key, at most 32,
+ *                     or 0 for unkeyed hashing
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_fixed4096(void *output, size_t output_len, const void *data, const void *key, size_t key_len);
+
+/**
+ * Calculate the BLAKE2s hash of a message of exactly 65536 bytes
+ * 
+ * This is the same as `libblake_blake2s(output, output_len, data, 65536,
+ * key, key_len)`, but the message length is known when the function
+ * is compiled, so the only work done is the compressions
+ * 
  * @param  output      Output buffer for the hash, which will be stored in raw
  *                     binary representation; the size of this buffer must be
  *                     at least `output_len` bytes
+ * @param  output_len  The hash size, in bytes, between 1 and 32 (inclusive)
+ * @param  data        The message, 65536 bytes long
+ * @param  key         The key, may be `NULL` if `key_len` is 0
+ * @param  key_len     The number of bytes in the key, at most 32,
+ *                     or 0 for unkeyed hashing
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_fixed65536(void *output, size_t output_len, const void *data, const void *key, size_t key_len);
+
+/**
+ * Calculate the BLAKE2s hashes of multiple consecutive
+ * messages, each exactly 4096 bytes long, with the same key
+ * 
+ * This is the same as calling `libblake_blake2s_fixed4096`
+ * for each message, but the messages are hashed in parallel
+ * 
+ * @param  output      Output buffer for the hashes, which will be stored in
+ *                     raw binary representation, `output_len` bytes each,
+ *                     in the same order as the messages; the size of this
+ *                     buffer must be at least `n * output_len` bytes
+ * @param  output_len  The hash size, in bytes, between 1 and 32 (inclusive)
+ * @param  data        The messages, `n * 4096` bytes in total
+ * @param  n           The number of messages
+ * @param  key         The key, may be `NULL` if `key_len` is 0
+ * @param  key_len     The number of bytes in the key, at most 32,
+ *                     or 0 for unkeyed hashing
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_fixed4096_many(void *output, size_t output_len, const void *data, size_t n, const void *key, size_t key_len);
+
+/**
+ * Calculate the BLAKE2s hashes of multiple consecutive
+ * messages, each exactly 65536 bytes long, with the same key
+ * 
+ * This is the same as calling `libblake_blake2s_fixed65536`
+ * for each message, but the messages are hashed in parallel
+ * 
+ * @param  output      Output buffer for the hashes, which will be stored in
+ *                     raw binary representation, `output_len` bytes each,
+ *                     in the same order as the messages; the size of this
+ *                     buffer must be at least `n * output_len` bytes
+ * @param  output_len  The hash size, in bytes, between 1 and 32 (inclusive)
+ * @param  data        The messages, `n * 65536` bytes in total
+ * @param  n           The number of messages
+ * @param  key         The key, may be `NULL` if `key_len` is 0
+ * @param  key_len     The number of bytes in the key, at most 32,
+ *                     or 0 for unkeyed hashing
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_fixed65536_many(void *output, size_t output_len, const void *data, size_t n, const void *key, size_t key_len);
+
+/**
+ * Calculate an iterated BLAKE2s hash, that is, hash a
+ * value, then hash the hash, and so on, as is done for
+ * key stretching and proofs of sequential work
+ * 
+ * This is the same as calling `libblake_blake2s` `iterations`
+ * times, with the output of each call as the message of the
+ * next call, but the hash is kept in registers between the
+ * iterations, and each iteration is a single compression
+ * 
+ * @param  output      Output buffer for the final hash, which will be stored
+ *                     in raw binary representation; the size of this buffer
+ *                     must be at least `output_len` bytes, and it may be
+ *                     the same buffer as `data`
+ * @param  output_len  The hash size, in bytes, between 1 and 32 (inclusive),
+ *                     which is also the size of each message
+ * @param  data        The initial value, `output_len` bytes long; it is
+ *                     copied to `output` if `iterations` is 0
+ * @param  iterations  The number of times to apply the hash function
+ * @param  key         The key, may be `NULL` if `key_len` is 0
+ * @param  key_len     The number of bytes in the key, at most 32,
+ *                     or 0 for unkeyed hashing
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_iterate(void *output, size_t output_len, const void *data, uint_least64_t iterations,
+                         const void *key, size_t key_len);
+
+/**
+ * Calculate iterated BLAKE2s hashes of multiple
+ * independent initial values, with the same key
+ * 
+ * This is the same as calling `libblake_blake2s_iterate`
+ * for each value, but the chains are advanced in parallel,
+ * 8 at a time, so there should preferably be a multiple
+ * of 8 values
+ * 
+ * @param  output      Output buffer for the final hashes, which will be
+ *                     stored in raw binary representation, `output_len`
+ *                     bytes each, in the same order as the initial values;
+ *                     the size of this buffer must be at least
+ *                     `n * output_len` bytes, and it may be the same
+ *                     buffer as `data`
+ * @param  output_len  The hash size, in bytes, between 1 and 32 (inclusive)
+ * @param  data        The initial values, `n * output_len` bytes in total
+ * @param  n           The number of initial values
+ * @param  iterations  The number of times to apply the hash function
+ *                     to each value
+ * @param  key         The key, may be `NULL` if `key_len` is 0
+ * @param  key_len     The number of bytes in the key, at most 32,
+ *                     or 0 for unkeyed hashing
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_iterate_many(void *output, size_t output_len, const void *data, size_t n, uint_least64_t iterations,
+                              const void *key, size_t key_len);
+
+/**
+ * Initialise a reusable keyed state for hashing with BLAKE2s
+ * 
+ * The key is processed once, by this function, rather
+ * than once per message; use `libblake_blake2s_prekeyed_init`
+ * or `libblake_blake2s_prekeyed_digest` for each message
+ * 
+ * @param  prekeyed  The state to initialise
+ * @param  params    Hashing parameters, `params->key_len`
+ *                   shall be the length of the key
+ * @param  key       The key, may be `NULL` if `params->key_len` is 0
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_prekey(struct libblake_blake2s_prekeyed *prekeyed, const struct libblake_blake2s_params *params,
+                        const void *key);
+
+/**
+ * Initialise a state for hashing with BLAKE2s,
+ * from a reusable keyed state, so that the key
+ * shall not be input to `libblake_blake2s_update`
+ * 
+ * This function cannot be used if the message is
+ * empty and the key is not, as the key block must
+ * then be processed as the last block; use
+ * `libblake_blake2s_prekeyed_digest` instead
+ * 
+ * @param  state     The state to initialise
+ * @param  prekeyed  The keyed state, initialised
+ *                   with `libblake_blake2s_prekey`
+ */
+LIBBLAKE_PUBLIC__ inline void
+libblake_blake2s_prekeyed_init(struct libblake_blake2s_state *state, const struct libblake_blake2s_prekeyed *prekeyed) {
+	*state = prekeyed->state;
+}
+
+/**
+ * Calculate the BLAKE2s hash of a message, using
+ * a reusable keyed state, which is not modified
+ * 
+ * Only the message is processed, making this function
+ * one compression cheaper than starting over with
+ * `libblake_blake2s_init`; `data` is not written to
+ * 
+ * @param  prekeyed    The keyed state, initialised
+ *                     with `libblake_blake2s_prekey`
+ * @param  data        The message, may be `NULL` if `len` is 0
+ * @param  len         The number of bytes in the message
+ * @param  last_node   Shall be non-0 the last node at each level in the
+ *                     hashing tree, include the root node, however, it
+ *                     shall be 0 if not using tree-hashing
+ * @param  output_len  The number of bytes to write to `output_len`; this
+ *                     shall be the value `params->digest_len` had when
+ *                     `libblake_blake2s_prekey` was called, where `params`
+ *                     is the second argument given to `libblake_blake2s_prekey`
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_prekeyed_digest(const struct libblake_blake2s_prekeyed *prekeyed, const void *data, size_t len,
+                                 int last_node, size_t output_len, unsigned char output[static output_len]);
+
+/**
+ * Initialise a state for BLAKE2s hashing of messages that
+ * consist of a constant prefix followed by a nonce, as
+ * in proofs of work where only the nonce is varied
+ * 
+ * The key and all complete blocks of the prefix are
+ * processed once, by this function, so that only the
+ * last block or two, which contain the nonce, are
+ * processed for each nonce
+ * 
+ * @param  midstate  The state to initialise
+ * @param  params    Hashing parameters, `params->key_len`
+ *                   shall be the length of the key
+ * @param  key       The key, may be `NULL` if `params->key_len` is 0
+ * @param  prefix    The prefix, may be `NULL` if `len` is 0
+ * @param  len       The number of bytes in the prefix
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_midstate_init(struct libblake_blake2s_midstate *midstate, const struct libblake_blake2s_params *params,
+                                const void *key, const void *prefix, size_t len);
+
+/**
+ * Calculate the BLAKE2s hash of a prefix followed by a nonce,
+ * as `libblake_blake2s_nonce_search` does, for example to
+ * verify a nonce found by `libblake_blake2s_nonce_search`
+ * 
+ * @param  midstate   The state, initialised with `libblake_blake2s_midstate_init`
+ * @param  nonce      The nonce, which will be appended to the prefix
+ *                    as a `nonce_len` bytes long little-endian integer
+ * @param  nonce_len  The number of bytes in the nonce, between 1 and 8 (inclusive)
+ * @param  output     Output buffer for the hash, which will be stored in raw
+ *                    binary representation; the size of this buffer must be
+ *                    at least `params->digest_len` bytes, where `params` is
+ *                    the second argument given to `libblake_blake2s_midstate_init`
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_midstate_digest(const struct libblake_blake2s_midstate *midstate, uint_least64_t nonce, size_t nonce_len,
+                                  unsigned char *output);
+
+/**
+ * Search for a nonce that, when appended to a prefix,
+ * gives a BLAKE2s hash below a target, as in proofs of work
+ * 
+ * The nonces are hashed in parallel, 8 at a time, from the
+ * state after the prefix, and the search stops as soon as
+ * a nonce is found; the hash is compared, as a big-endian
+ * integer, that is, byte by byte, to the target
+ * 
+ * @param   midstate   The state, initialised with `libblake_blake2s_midstate_init`
+ * @param   nonce_len  The number of bytes in the nonce, between 1 and 8 (inclusive);
+ *                     see `libblake_blake2s_midstate_digest`
+ * @param   first      The first nonce to try
+ * @param   count      The number of nonces to try, the nonces are
+ *                     tried in order from `first`, and wrap around
+ *                     if they do not fit in `nonce_len` bytes
+ * @param   target     The target, as many bytes as the hash
+ * @param   noncep     Output parameter for the first nonce whose
+ *                     hash is below (but not equal to) `target`
+ * @param   output     Output buffer for the hash of the found nonce,
+ *                     or `NULL`; the size of this buffer must be at
+ *                     least as many bytes as the hash
+ * @return             1 if a nonce was found, 0 otherwise
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2s_nonce_search(const struct libblake_blake2s_midstate *midstate, size_t nonce_len, uint_least64_t first,
+                               uint_least64_t count, const void *target, uint_least64_t *noncep, unsigned char *output);
+
+/**
+ * Verify BLAKE2s message authentication codes for
+ * many messages that use the same key
+ * 
+ * The messages are hashed in parallel, several
+ * at a time, using an interleaved compression
+ * function that the compiler can vectorise
+ * 
+ * The tags are compared in constant time
+ * 
+ * @param   prekeyed  The keyed state, initialised with
+ *                    `libblake_blake2s_prekey`; the parameters
+ *                    shall be for sequential (non-tree) hashing
+ * @param   n         The number of messages
+ * @param   messages  The messages, `messages[i]` may be `NULL` if `lens[i]` is 0
+ * @param   lens      `lens[i]` shall be the number of bytes in `messages[i]`
+ * @param   tags      The expected tags, `tags[i]` is the tag for `messages[i]`
+ * @param   tag_len   The number of bytes in each tag, this shall be the value
+ *                    `params->digest_len` had when `libblake_blake2s_prekey`
+ *                    was called, where `params` is the second argument given
+ *                    to `libblake_blake2s_prekey`
+ * @param   bitmap    Output bitmap of `(n + 7) / 8` bytes; the bit
+ *                    `1 << (i % 8)` in `bitmap[i / 8]` will be set if
+ *                    the tag for `messages[i]` is correct and cleared
+ *                    otherwise
+ * @return            The number of correct tags
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2s_prekeyed_verify_batch(const struct libblake_blake2s_prekeyed *prekeyed, size_t n,
+                                       const void *const messages[], const size_t lens[],
+                                       const void *const tags[], size_t tag_len, unsigned char bitmap[]);
+
+/**
+ * Store a state for BLAKE2s hashing in a compact form
+ * 
+ * The state must not have been finalised
+ * 
+ * @param  compact  Output parameter for the compact state
+ * @param  state    The state to store
+ */
+LIBBLAKE_PUBLIC__ inline void
+libblake_blake2s_compact(struct libblake_blake2s_compact_state *compact, const struct libblake_blake2s_state *state) {
+	unsigned int i;
+	for (i = 0; i < 8; i++)
+		compact->h[i] = state->h[i];
+	compact->t[0] = state->t[0];
+	compact->t[1] = state->t[1];
+}
+
+/**
+ * Restore a state for BLAKE2s hashing from its compact form
+ * 
+ * @param  state    Output parameter for the state
+ * @param  compact  The compact state, as stored by `libblake_blake2s_compact`
+ */
+LIBBLAKE_PUBLIC__ inline void
+libblake_blake2s_expand(struct libblake_blake2s_state *state, const struct libblake_blake2s_compact_state *compact) {
+	unsigned int i;
+	for (i = 0; i < 8; i++)
+		state->h[i] = compact->h[i];
+	state->t[0] = compact->t[0];
+	state->t[1] = compact->t[1];
+	state->f[0] = 0;
+	state->f[1] = 0;
+}
+
+/**
+ * Allocate a table of BLAKE2s states
+ * 
+ * The states are uninitialised; use `libblake_blake2s_table_store`
+ * to store an initialised state in the table
+ * 
+ * @param   table  The table to initialise
+ * @param   size   The number of states in the table
+ * @return         0 on success, -1 on failure
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2s_table_create(struct libblake_blake2s_table *table, size_t size);
+
+/**
+ * Deallocate a table of BLAKE2s states
+ * 
+ * @param  table  The table to deallocate
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_table_destroy(struct libblake_blake2s_table *table);
+
+/**
+ * Store a state for BLAKE2s hashing in a table
+ * 
+ * The state must not have been finalised
+ * 
+ * @param  table  The table
+ * @param  i      The index of the state in the table
+ * @param  state  The state to store
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_table_store(struct libblake_blake2s_table *table, size_t i, const struct libblake_blake2s_state *state);
+
+/**
+ * Load a state for BLAKE2s hashing from a table
+ * 
+ * @param  table  The table
+ * @param  i      The index of the state in the table
+ * @param  state  Output parameter for the state
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_table_load(const struct libblake_blake2s_table *table, size_t i, struct libblake_blake2s_state *state);
+
+/**
+ * Process data for hashing with BLAKE2s, using
+ * a state stored in a table
+ * 
+ * This function behaves like `libblake_blake2s_update`
+ * 
+ * @param   table  The table
+ * @param   i      The index of the state in the table
+ * @param   data   The data to feed into the function
+ * @param   len    The maximum number of bytes to process
+ * @return         The number of processed bytes
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2s_table_update(struct libblake_blake2s_table *table, size_t i, const void *data, size_t len);
+
+/**
+ * Create a scheduler that processes data for many
+ * BLAKE2s streams in parallel, 8 streams at a time,
+ * using an interleaved compression function that
+ * the compiler can vectorise
+ * 
+ * @param   scheduler  The scheduler to initialise
+ * @param   table      The table with the states of the streams; it
+ *                     must not be deallocated before the scheduler
+ * @param   max_jobs   The number of times `libblake_blake2s_scheduler_enqueue`
+ *                     can be called before the queue is processed automatically
+ * @return             0 on success, -1 on failure
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2s_scheduler_create(struct libblake_blake2s_scheduler *scheduler, struct libblake_blake2s_table *table,
+                                  size_t max_jobs);
+
+/**
+ * Deallocate a scheduler for BLAKE2s streams
+ * 
+ * Any queued data that has not been processed
+ * will be discarded
+ * 
+ * @param  scheduler  The scheduler to deallocate
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_scheduler_destroy(struct libblake_blake2s_scheduler *scheduler);
+
+/**
+ * Queue data for hashing with BLAKE2s, using
+ * a state stored in the scheduler's table
+ * 
+ * The number of bytes that will be processed
+ * is the same as for `libblake_blake2s_update`,
+ * however the data is not processed until
+ * `libblake_blake2s_scheduler_run` is called (or
+ * this function is called when the queue is full),
+ * so `data` must not be modified or deallocated
+ * until then, and the stream's state in the table
+ * must not be used until then
+ * 
+ * The same stream may be queued multiple times,
+ * in which case the data is processed in order
+ * 
+ * @param   scheduler  The scheduler
+ * @param   stream     The index of the stream's state in the table
+ * @param   data       The data to feed into the function
+ * @param   len        The maximum number of bytes to process
+ * @return             The number of bytes that will be processed
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2s_scheduler_enqueue(struct libblake_blake2s_scheduler *scheduler, size_t stream,
+                                   const void *data, size_t len);
+
+/**
+ * Process all data queued in a scheduler
+ * for BLAKE2s streams
+ * 
+ * Data from up to 8 different streams is processed
+ * at the same time; data queued for the same stream
+ * is processed in the order it was queued
+ * 
+ * @param  scheduler  The scheduler
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_scheduler_run(struct libblake_blake2s_scheduler *scheduler);
+
+/**
+ * Serialise a state for BLAKE2s hashing
+ * 
+ * The output is independent of the machine and of
+ * the library version's in-memory representation,
+ * and can be restored with `libblake_blake2s_import`
+ * 
+ * @param   state   The state to serialise
+ * @param   buffer  Output buffer, may be `NULL` if `size` is 0
+ * @param   size    The size of `buffer`
+ * @return          The number of bytes required for the output; if
+ *                  greater than `size`, nothing is written to `buffer`
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2s_export(const struct libblake_blake2s_state *state, void *buffer, size_t size);
+
+/**
+ * Restore a state for BLAKE2s hashing,
+ * serialised with `libblake_blake2s_export`
+ * 
+ * @param   state   Output parameter for the state;
+ *                  not modified on failure
+ * @param   buffer  The serialised state
+ * @param   len     The number of bytes in `buffer`
+ * @return          0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `buffer` does not contain a state for
+ *                  BLAKE2s hashing in a supported format
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2s_import(struct libblake_blake2s_state *state, const void *buffer, size_t len);
+
+/**
+ * Serialise a buffered state for BLAKE2s hashing
+ * 
+ * The output is independent of the machine and of
+ * the library version's in-memory representation,
+ * and can be restored with `libblake_blake2s_stream_import`
+ * 
+ * @param   stream  The buffered state to serialise
+ * @param   buffer  Output buffer, may be `NULL` if `size` is 0
+ * @param   size    The size of `buffer`
+ * @return          The number of bytes required for the output; if
+ *                  greater than `size`, nothing is written to `buffer`
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2s_stream_export(const struct libblake_blake2s_stream *stream, void *buffer, size_t size);
+
+/**
+ * Restore a buffered state for BLAKE2s hashing,
+ * serialised with `libblake_blake2s_stream_export`
+ * 
+ * @param   stream  Output parameter for the buffered state;
+ *                  not modified on failure
+ * @param   buffer  The serialised buffered state
+ * @param   len     The number of bytes in `buffer`
+ * @return          0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `buffer` does not contain a buffered state for
+ *                  BLAKE2s hashing in a supported format
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2s_stream_import(struct libblake_blake2s_stream *stream, const void *buffer, size_t len);
+
+/**
+ * Create an index of intermediate states for BLAKE2s
+ * hashing, with which the hash of any prefix of the
+ * input can be calculated by processing at most
+ * `interval` blocks (64 bytes each) of the prefix
+ * 
+ * @param   index     The index to initialise
+ * @param   state     The state the input will be hashed with; must
+ *                    not have processed any data yet, but may have
+ *                    a key (that is fed as the first block of input)
+ * @param   interval  The number of blocks between each captured state
+ * @return            0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `interval` is 0, or `state` has
+ *                  already processed data
+ * @throws  ENOMEM  Insufficient memory available
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2s_checkpoints_create(struct libblake_blake2s_checkpoints *index, const struct libblake_blake2s_state *state, size_t interval);
+
+/**
+ * Deallocate an index of intermediate states for BLAKE2s hashing
+ * 
+ * @param  index  The index to destroy
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_checkpoints_destroy(struct libblake_blake2s_checkpoints *index);
+
+/**
+ * Like `libblake_blake2s_update`, process data for BLAKE2s
+ * hashing, but also capture the intermediate states into
+ * an index as the data is processed
+ * 
+ * All input to `state`, since `libblake_blake2s_checkpoints_create`
+ * was called, must be processed with this function
+ * 
+ * @param   index       The index to add captured states to
+ * @param   state       The state of the hash function
+ * @param   data        The data to feed into the function
+ * @param   len         The maximum number of bytes to process
+ * @param   processedp  Output parameter for the number of processed bytes
+ * @return              0 on success, -1 on failure; on failure,
+ *                      no data will have been processed
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2s_checkpoints_update(struct libblake_blake2s_checkpoints *index, struct libblake_blake2s_state *state,
+                                    const void *data, size_t len, size_t *processedp);
+
+/**
+ * Load the last state, from an index of intermediate
+ * BLAKE2s states, that can be used to calculate the
+ * hash of a prefix of the input
+ * 
+ * The hash of the prefix is calculated by passing the
+ * input from the returned offset up to the end of the
+ * prefix to `libblake_blake2s_digest` or
+ * `libblake_blake2s_digest_const`
+ * 
+ * @param   index  The index
+ * @param   len    The length of the prefix, in bytes
+ * @param   state  Output parameter for the state
+ * @return         The number of bytes of input the state has
+ *                 processed; at most `len`
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2s_checkpoints_seek(const struct libblake_blake2s_checkpoints *index, size_t len, struct libblake_blake2s_state *state);
+
+/**
+ * Calculate the BLAKE2s hash of a prefix of the input
+ * using an index of intermediate states
+ * 
+ * Only the end of the prefix, after the last captured
+ * state before it, is read from `data`
+ * 
+ * @param  index       The index
+ * @param  data        The input, must contain at least `len` bytes
+ * @param  len         The length of the prefix, in bytes
+ * @param  last_node   Shall be non-0 the last node at each level in the
+ *                     hashing tree, include the root node, however, it
+ *                     shall be 0 if not using tree-hashing
+ * @param  output_len  The number of bytes to write to `output`; this
+ *                     shall be `params->digest_len` for the parameters
+ *                     the state was initialised with
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2s_checkpoints_digest(const struct libblake_blake2s_checkpoints *index, const void *data, size_t len, int last_node,
+                                    size_t output_len, unsigned char output[static output_len]);
+
+/**
+ * Serialise an index of intermediate states for BLAKE2s
+ * hashing, the output is independent of the machine
+ * 
+ * @param   index   The index to serialise
+ * @param   buffer  Output buffer, may be `NULL` if `size` is 0
+ * @param   size    The size of `buffer`
+ * @return          The number of bytes required for the output; if
+ *                  greater than `size`, nothing is written to `buffer`
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2s_checkpoints_export(const struct libblake_blake2s_checkpoints *index, void *buffer, size_t size);
+
+/**
+ * Restore an index of intermediate states for BLAKE2s
+ * hashing, serialised with `libblake_blake2s_checkpoints_export`
+ * 
+ * The index shall be deallocated with
+ * `libblake_blake2s_checkpoints_destroy`
+ * 
+ * @param   index   Output parameter for the index
+ * @param   buffer  The serialised index
+ * @param   len     The number of bytes in `buffer`
+ * @return          0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `buffer` does not contain an index for
+ *                  BLAKE2s hashing in a supported format
+ * @throws  ENOMEM  Insufficient memory available
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2s_checkpoints_import(struct libblake_blake2s_checkpoints *index, const void *buffer, size_t len);
+
+/**
+ * Calculate the BLAKE2s hashes of many files
+ * 
+ * Where io_uring is available, the files are read
+ * asynchronously, with many reads in flight at any time,
+ * and the data is hashed, for many files in parallel,
+ * while the next reads are in progress; otherwise the
+ * files are hashed on a pool of threads
+ * 
+ * The order in which the files are completed is unspecified.
+ * `callback` may be called from other threads than the calling
+ * thread, but it is never called concurrently, and never
+ * after this function has returned
+ * 
+ * @param   paths     The files to hash
+ * @param   npaths    The number of elements in `paths`
+ * @param   params    Hashing parameters, the same for each file
+ * @param   key       The key, `params->key_len` bytes long,
+ *                    may be `NULL` if `params->key_len` is 0
+ * @param   flags     0 or `LIBBLAKE_HASH_FILES_DIRECT`
+ * @param   callback  Function called once for each file, with `user`
+ *                    as the first argument, and the index of the file
+ *                    in `paths` as the second argument; on success
+ *                    the third argument is the hash, which is
+ *                    `params->digest_len` bytes long, and the fourth
+ *                    argument is 0; on failure the third argument is
+ *                    `NULL` and the fourth argument is the error number
+ * @param   user      User-defined data passed to `callback`
+ * @return            0 on success, -1 on failure; failures to read
+ *                    a file are reported via `callback` instead
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2s_hash_files(const char *const paths[], size_t npaths, const struct libblake_blake2s_params *params,
+                            const void *key, int flags,
+                            void (*callback)(void *user, size_t i, const unsigned char *digest, int error), void *user);
+
+/**
+ * Calculate the BLAKE2s hash of a file
+ * 
+ * The hash is the same as if the file's contents were
+ * processed with `libblake_blake2s_stream_update_fd`
+ * 
+ * @param   path    The file to hash
+ * @param   params  Hashing parameters
+ * @param   key     The key, `params->key_len` bytes long,
+ *                  may be `NULL` if `params->key_len` is 0
+ * @param   cache   Cache for the hash, if it is a regular
+ *                  file, see `libblake_digest_cache_open`,
+ *                  or `NULL`
+ * @param   output  Output buffer for the hash, which will be
+ *                  `params->digest_len` bytes long
+ * @return          0 on success, -1 on failure
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  -       Any error specified for open(3), fstat(3) or read(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2s_hash_file(const char *path, const struct libblake_blake2s_params *params,
+                           const void *key, struct libblake_digest_cache *cache, unsigned char *output);
+
+/**
+ * Calculate a BLAKE2s hash of a directory tree
+ * 
+ * Regular files are hashed as with `libblake_blake2s_stream_update_fd`,
+ * and symbolic links (except `path` itself, which is followed) are
+ * hashed as their target path. A directory is hashed, with
+ * `params->node_depth` incremented by 1, as a list of all its
+ * entries, except "." and "..", sorted by name in byte order,
+ * where each entry is recorded as 'f', 'l' or 'd' (for regular files,
+ * symbolic links and directories), followed by its name, a NUL byte,
+ * and its hash. If `path` is a file, its hash is calculated
+ * 
+ * The files and directories are processed in parallel, but the
+ * result does not depend on the number of threads
+ * 
+ * @param   path      The directory (or file) to hash
+ * @param   params    Hashing parameters, the same for each file
+ * @param   key       The key, `params->key_len` bytes long,
+ *                    may be `NULL` if `params->key_len` is 0
+ * @param   cache     Cache for the hashes of the regular files,
+ *                    see `libblake_digest_cache_open`, or `NULL`
+ * @param   nthreads  The maximum number of threads to use,
+ *                    0 for the number of online processors
+ * @param   output    Output buffer for the hash, which will be
+ *                    `params->digest_len` bytes long
+ * @return            0 on success, -1 on failure
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  EINVAL  The tree contains a file that is neither a
+ *                  regular file, a directory, nor a symbolic link
+ * @throws  EIO     A file was truncated while it was being hashed
+ * @throws  -       Any error specified for stat(3), lstat(3), readlink(3),
+ *                  opendir(3), readdir(3), open(3) or read(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2s_hash_tree(const char *path, const struct libblake_blake2s_params *params,
+                           const void *key, struct libblake_digest_cache *cache, size_t nthreads, unsigned char *output);
+
+/**
+ * Build a dm-verity-style hash tree, using BLAKE2s, over
+ * the blocks of a file, such as a filesystem image
+ * 
+ * The data is split into blocks of `block_size` bytes
+ * (the last block is padded with zeroes if partial), and
+ * level 0 of the tree is the hashes of these blocks; each
+ * following level is the hashes of the blocks of the level
+ * below it, until a level fits in a single block. Each hash
+ * is stored in the smallest power of two bytes it fits in,
+ * followed by zeroes, as is each block of hashes. The levels
+ * are stored from the highest level to level 0. The root
+ * hash is the hash of the block of the highest level
+ * 
+ * The file containing the tree is memory-mapped, and the
+ * blocks of each level are hashed in parallel, many
+ * at a time on each thread
+ * 
+ * @param   data_fd     The file to build the hash tree over,
+ *                      all of it is used regardless of its offset
+ * @param   hash_fd     The file to write the hash tree to, it will
+ *                      be truncated and must be opened for reading
+ *                      and writing
+ * @param   params      Hashing parameters, `params->key_len` must be 0
+ *                      but `params->salt` can be used
+ * @param   block_size  The block size, a power of two, and at least
+ *                      twice the size of each stored hash
+ * @param   nthreads    The maximum number of threads to use,
+ *                      0 for the number of online processors
+ * @param   root        Output buffer for the root hash, which will
+ *                      be `params->digest_len` bytes long
+ * @return              0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  The file is empty, `params->key_len` is not 0, or
+ *                  `block_size` is invalid
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  EIO     The file was truncated while it was being hashed
+ * @throws  -       Any error specified for fstat(3), ftruncate(3),
+ *                  mmap(3) or pread(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2s_verity_build(int data_fd, int hash_fd, const struct libblake_blake2s_params *params, size_t block_size,
+                               size_t nthreads, unsigned char *root);
+
+/**
+ * Verify a block of data against a hash tree built
+ * by `libblake_blake2s_verity_build`
+ * 
+ * Only the hash blocks on the path from the block
+ * to the root are read and hashed
+ * 
+ * @param   tree        The hash tree
+ * @param   tree_size   The size of `tree`, in bytes
+ * @param   nblocks     The number of data blocks the tree was built over
+ * @param   params      Hashing parameters, as used to build the tree
+ * @param   block_size  The block size, as used to build the tree
+ * @param   root        The trusted root hash
+ * @param   index       The index of the data block
+ * @param   block       The data block, `block_size` bytes long, padded
+ *                      with zeroes if it is a partial last block
+ * @return              1 if the block is valid, 0 if it is not
+ *                      or the tree is corrupt, -1 on failure
+ * 
+ * @throws  EINVAL  `params->key_len` is not 0, `block_size`
+ *                  is invalid, `index` is at least `nblocks`,
+ *                  or `tree_size` is too small for `nblocks`
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2s_verity_verify(const void *tree, size_t tree_size, uint_least64_t nblocks,
+                                const struct libblake_blake2s_params *params, size_t block_size,
+                                const unsigned char *root, uint_least64_t index, const void *block);
+
+/**
+ * Calculate the BLAKE2s tree hash of a file, and store the
+ * digests of the nodes so that the hash can be updated with
+ * `libblake_blake2s_tree_update` after parts of the file
+ * have been modified
+ * 
+ * The file is split into leaves of `params->leaf_len` bytes
+ * (the last leaf may be shorter, and an empty file has one
+ * empty leaf); each node on the level above has up to
+ * `params->fanout` children (unlimited if 0), and its input is
+ * the concatenation of their digests; the levels are added until
+ * a level with only one node, the root, is reached, or until the
+ * level at depth `params->depth - 1`, which is then the root
+ * regardless of the fan-out. Each node is hashed with its offset
+ * on its level as `node_offset`, and the level (0 for leaves) as
+ * `node_depth`, and the last node on each level is marked as
+ * such; every node is keyed, and every node except the root
+ * has a digest of `params->inner_len` bytes
+ * 
+ * The store is in a format that is specific to the machine
+ * 
+ * @param   data_fd   The file to hash, all of it is used regardless
+ *                    of its offset; it must support pread(3)
+ * @param   store_fd  The file to store the digests in, it will be
+ *                    truncated and must be opened for reading and writing
+ * @param   params    Hashing parameters; `params->node_offset` and
+ *                    `params->node_depth` must be 0, `params->fanout`
+ *                    must not be 1, `params->depth` must be at least 2,
+ *                    `params->leaf_len` must not be 0, and
+ *                    `params->inner_len` must be between 1 and 32
+ *                    (inclusive)
+ * @param   key       The key, `params->key_len` bytes long,
+ *                    may be `NULL` if `params->key_len` is 0
+ * @param   output    Output buffer for the root hash, which will
+ *                    be `params->digest_len` bytes long
+ * @return            0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `params` is invalid
+ * @throws  EFBIG   The store would be too large
+ * @throws  EIO     The file was truncated while it was being hashed
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  -       Any error specified for fstat(3), pread(3),
+ *                  ftruncate(3), mmap(3) or msync(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2s_tree_build(int data_fd, int store_fd, const struct libblake_blake2s_params *params,
+                            const void *key, unsigned char *output);
+
+/**
+ * Update the BLAKE2s tree hash of a file, calculated with
+ * `libblake_blake2s_tree_build`, after parts of the file
+ * have been modified
+ * 
+ * Only the leaves that overlap with the modified ranges are
+ * read and rehashed, along with their ancestors. If the size of
+ * the file has changed, the bytes after the old end of the file
+ * need not be listed as modified, and the last leaf is always
+ * rehashed; if the number of leaves has changed, all nodes above
+ * the leaves are rehashed (but the other leaves are not)
+ * 
+ * If the store was not created with the same parameters and key,
+ * or is unusable for any other reason, such as an update that did
+ * not complete (even because of a system crash), the tree is
+ * rebuilt as with `libblake_blake2s_tree_build`. The store
+ * must not be used by multiple threads or processes at the
+ * same time
+ * 
+ * @param   data_fd   The file to hash, all of it is used regardless
+ *                    of its offset; it must support pread(3)
+ * @param   store_fd  The file the digests are stored in, it must be
+ *                    opened for reading and writing
+ * @param   params    Hashing parameters, as for `libblake_blake2s_tree_build`
+ * @param   key       The key, `params->key_len` bytes long,
+ *                    may be `NULL` if `params->key_len` is 0
+ * @param   ranges    The ranges of bytes that have been modified since the
+ *                    store was last updated, may be `NULL` if `nranges` is 0;
+ *                    the ranges may overlap and may extend beyond the file
+ * @param   nranges   The number of elements in `ranges`
+ * @param   output    Output buffer for the root hash, which will
+ *                    be `params->digest_len` bytes long
+ * @return            0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `params` is invalid
+ * @throws  EFBIG   The store would be too large
+ * @throws  EIO     The file was truncated while it was being hashed
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  -       Any error specified for fstat(3), pread(3),
+ *                  ftruncate(3), mmap(3) or msync(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2s_tree_update(int data_fd, int store_fd, const struct libblake_blake2s_params *params,
+                             const void *key, const struct libblake_byte_range *ranges, size_t nranges,
+                             unsigned char *output);
+
+/**
+ * Get the range of bytes in a message that a node in
+ * its BLAKE2s hash tree, as described for
+ * `libblake_blake2s_tree_build`, is calculated over
+ * 
+ * @param   params       Hashing parameters, as for `libblake_blake2s_tree_build`
+ * @param   size         The size of the entire message, in bytes
+ * @param   node_offset  The offset of the node on its level
+ * @param   node_depth   The level of the node, 0 for leaves
+ * @param   range        Output parameter for the range
+ * @return               0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `params` is invalid, or the tree has no such node
+ * @throws  EFBIG   The message is too large for the parameters
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2s_tree_node_range(const struct libblake_blake2s_params *params, uint_least64_t size,
+                                 uint_least64_t node_offset, size_t node_depth, struct libblake_byte_range *range);
+
+/**
+ * Calculate a node in the BLAKE2s hash tree, as described
+ * for `libblake_blake2s_tree_build`, of a message
+ * 
+ * Only the part of the message below the node is needed,
+ * so that disjoint parts of the message can be hashed
+ * independently, for example on different machines, and
+ * the nodes combined with `libblake_blake2s_tree_merge`.
+ * If the node is the root, its digest is the hash of
+ * the message, as calculated by `libblake_blake2s_tree_build`
+ * 
+ * @param   node         Output parameter for the node
+ * @param   params       Hashing parameters, as for `libblake_blake2s_tree_build`
+ * @param   key          The key, `params->key_len` bytes long,
+ *                       may be `NULL` if `params->key_len` is 0
+ * @param   size         The size of the entire message, in bytes
+ * @param   node_offset  The offset of the node on its level
+ * @param   node_depth   The level of the node, 0 for leaves
+ * @param   data         The part of the message below the node, as
+ *                       returned by `libblake_blake2s_tree_node_range`
+ * @param   len          The number of bytes in `data`
+ * @return               0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `params` is invalid, the tree has no such
+ *                  node, or `len` is not the size of the node's
+ *                  part of the message
+ * @throws  EFBIG   The message is too large for the parameters
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2s_tree_node(struct libblake_tree_node *node, const struct libblake_blake2s_params *params, const void *key,
+                           uint_least64_t size, uint_least64_t node_offset, size_t node_depth, const void *data, size_t len);
+
+/**
+ * Calculate a node in a BLAKE2s hash tree from its children
+ * 
+ * The node is marked as the last node on its level if it
+ * is, and has a digest of `params->inner_len` bytes, or
+ * `params->digest_len` bytes if it is the root
+ * 
+ * @param   parent     Output parameter for the node, may be
+ *                     the same as the first element in `children`
+ * @param   params     Hashing parameters, as used to calculate the children
+ * @param   key        The key, `params->key_len` bytes long,
+ *                     may be `NULL` if `params->key_len` is 0
+ * @param   children   All children of the node, in order
+ * @param   nchildren  The number of elements in `children`
+ * @return             0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `params` is invalid, `children` is not exactly
+ *                  the children of one node, in order, or the
+ *                  children were calculated with other parameters
+ *                  or another key
+ * @throws  EFBIG   The message is too large for the parameters
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2s_tree_merge(struct libblake_tree_node *parent, const struct libblake_blake2s_params *params, const void *key,
+                            const struct libblake_tree_node *children, size_t nchildren);
+
+
+
+/**
+ * Initialise a state for hashing with BLAKE2b
+ * 
+ * For keyed mode, which is used for MAC and PRF,
+ * after calling this function, the 128 first bytes
+ * input to the hash function shall be the key
+ * with NUL bytes appended to it (such that the
+ * length is 128 bytes, which is double the maximum
+ * allowed length of the key, but is the size
+ * block size used by BLAKE2b)
+ * 
+ * @param  state   The state to initialise
+ * @param  params  Hashing parameters
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_init(struct libblake_blake2b_state *state, const struct libblake_blake2b_params *params);
+
+/**
+ * Process data for hashing with BLAKE2b
+ * 
+ * The function can only process multiples of 128 bytes,
+ * but cannot process that last chunk of 128 bytes
+ * unless a non-multiple of 128 bytes is input to the
+ * function; any excess data will be ignored and must
+ * be processed when more data is available or using
+ * `libblake_blake2b_digest` when the end of the
+ * input has been reached
+ * 
+ * @param   state  The state of the hash function
+ * @param   data   The data to feed into the function
+ * @param   len    The maximum number of bytes to process
+ * @return         The number of processed bytes
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2b_update(struct libblake_blake2b_state *state, const void *data, size_t len);
+
+/**
+ * Process data for hashing with BLAKE2b
+ * 
+ * The function can only process multiples of 128 bytes,
+ * any excess data will be ignored and must be
+ * processed when more data is available or using
+ * `libblake_blake2s_digest` when the end of the input
+ * has been reached
+ * 
+ * Unlike `libblake_blake2b_update`, this function
+ * will all input data if `len` is a multiple of
+ * 128, however the application must make sure that
+ * there is more data to process
+ * 
+ * @param   state  The state of the hash function
+ * @param   data   The data to feed into the function
+ * @param   len    The maximum number of bytes to process
+ * @return         The number of processed bytes
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2b_force_update(struct libblake_blake2b_state *state, const void *data, size_t len);
+
+/**
+ * Get the required allocation size of the
+ * input buffer for `libblake_blake2b_digest`
+ * 
+ * @param   len  The number of input bytes
+ * @return       The number bytes required for the input buffer
+ */
+LIBBLAKE_PUBLIC__ LIBBLAKE_CONST__ size_t
+libblake_blake2b_digest_get_required_input_size(size_t len);
+
+/**
+ * Calculate the BLAKE2b hash of the input data
+ * 
+ * The `state` parameter must have been initialised using
+ * the `libblake_blake2b_init` function, after which, but
+ * before this function is called, `libblake_blake2b_update`
+ * and `libblake_blake2b_force_update` can be used to
+ * process data before this function is called. Already
+ * processed data shall not be input to this function.
+ * 
+ * @param  state       The state of the hash function
+ * @param  data        Data to process; the function will write addition data to
+ *                     the end, therefore the size of this buffer must be at least
+ *                     `libblake_blake2b_digest_get_required_input_size(len)`
+ *                     bytes large
+ * @param  len         The number of input bytes
+ * @param  last_node   Shall be non-0 the last node at each level in the
+ *                     hashing tree, include the root node, however, it
+ *                     shall be 0 if not using tree-hashing
+ * @param  output_len  The number of bytes to write to `output_len`; this
+ *                     shall be the value `params->digest_len` had when
+ *                     `libblake_blake2b_init` was called, where `params`
+ *                     is the second argument given to `libblake_blake2b_init`
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_digest(struct libblake_blake2b_state *state, void *data, size_t len, int last_node,
+                        size_t output_len, unsigned char output[static output_len]);
+
+/**
+ * Calculate the BLAKE2b hash of the input data
+ * 
+ * This function behaves like `libblake_blake2b_digest`
+ * except it does not write to `data`, so no additional
+ * space is required, and `data` may be read-only; the
+ * last block is padded in a buffer on the stack
+ * 
+ * @param  state       The state of the hash function
+ * @param  data        The last data to process, may be `NULL` if `len` is 0
+ * @param  len         The number of input bytes
+ * @param  last_node   Shall be non-0 the last node at each level in the
+ *                     hashing tree, include the root node, however, it
+ *                     shall be 0 if not using tree-hashing
+ * @param  output_len  The number of bytes to write to `output_len`; this
+ *                     shall be the value `params->digest_len` had when
+ *                     `libblake_blake2b_init` was called, where `params`
+ *                     is the second argument given to `libblake_blake2b_init`
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_digest_const(struct libblake_blake2b_state *state, const void *data, size_t len, int last_node,
+                              size_t output_len, unsigned char output[static output_len]);
+
+/**
+ * Process data for hashing with BLAKE2b
+ * 
+ * This function behaves like `libblake_blake2b_update`
+ * except the input is read from a list of buffers:
+ * the processed bytes are the first bytes of the
+ * concatenation of the buffers, and, as with
+ * `libblake_blake2b_update`, the last 128 bytes are
+ * never processed; blocks that straddle two buffers
+ * are copied, other blocks are processed where
+ * they are stored
+ * 
+ * @param   state   The state of the hash function
+ * @param   iov     The buffers to feed into the function, in order
+ * @param   iovcnt  The number of elements in `iov`
+ * @return          The number of processed bytes
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2b_updatev(struct libblake_blake2b_state *state, const struct iovec *iov, size_t iovcnt);
+
+/**
+ * Calculate the BLAKE2b hash of the input data
+ * 
+ * This function behaves like `libblake_blake2b_digest`
+ * except the input is read from a list of buffers,
+ * which are not modified, so no additional space
+ * is required
+ * 
+ * @param  state       The state of the hash function
+ * @param  iov         The last data to process, in order
+ * @param  iovcnt      The number of elements in `iov`
+ * @param  last_node   Shall be non-0 the last node at each level in the
+ *                     hashing tree, include the root node, however, it
+ *                     shall be 0 if not using tree-hashing
+ * @param  output_len  The number of bytes to write to `output_len`; this
+ *                     shall be the value `params->digest_len` had when
+ *                     `libblake_blake2b_init` was called, where `params`
+ *                     is the second argument given to `libblake_blake2b_init`
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_digestv(struct libblake_blake2b_state *state, const struct iovec *iov, size_t iovcnt, int last_node,
+                         size_t output_len, unsigned char output[static output_len]);
+
+/**
+ * Initialise a buffered state for hashing with BLAKE2b
+ * 
+ * For keyed mode, the key shall, as with
+ * `libblake_blake2b_init`, be input as the
+ * first 128 bytes, padded with NUL bytes
+ * 
+ * @param  stream  The state to initialise
+ * @param  params  Hashing parameters
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_stream_init(struct libblake_blake2b_stream *stream, const struct libblake_blake2b_params *params);
+
+/**
+ * Process data for hashing with BLAKE2b
+ * 
+ * Unlike `libblake_blake2b_update`, this function
+ * processes all input data: up to one block of
+ * data is stored in the state and is processed
+ * when more data is input or when
+ * `libblake_blake2b_stream_digest` is called
+ * 
+ * @param  stream  The state of the hash function
+ * @param  data    The data to feed into the function
+ * @param  len     The number of bytes to process
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_stream_update(struct libblake_blake2b_stream *stream, const void *data, size_t len);
+
+/**
+ * Process the contents of a file for BLAKE2b hashing
+ * 
+ * Holes in sparse files are hashed without being read,
+ * large regular files that are sealed against shrinking
+ * (see memfd_create(2)) are mapped into memory rather
+ * than read, other files are read with large buffers
+ * (a mapped file that is truncated while it is hashed
+ * would kill the process with SIGBUS), and if
+ * they are not regular files (for example pipes
+ * and sockets), they are read on a separate thread so
+ * that reading and hashing overlap; either way, the
+ * data is not copied more than
+ * `libblake_blake2b_stream_update` requires
+ * 
+ * @param   stream  The state of the hash function
+ * @param   fd      The file descriptor to read, from its current
+ *                  offset until the end of the file
+ * @return          0 on success, -1 on failure; on failure,
+ *                  some data may have been processed
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  EIO     The file was truncated while it was being hashed
+ * @throws  -       Any error specified for fstat(3) or read(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_stream_update_fd(struct libblake_blake2b_stream *stream, int fd);
+
+/**
+ * Process the contents of a file for BLAKE2b hashing,
+ * see `libblake_blake2b_stream_update_fd` for details
+ * 
+ * @param   stream  The state of the hash function
+ * @param   path    The file to read
+ * @return          0 on success, -1 on failure; on failure,
+ *                  some data may have been processed
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  -       Any error specified for open(3), fstat(3) or read(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_stream_update_path(struct libblake_blake2b_stream *stream, const char *path);
+
+/**
+ * Calculate the BLAKE2b hash of the input data
+ * 
+ * The `stream` parameter must have been initialised using
+ * the `libblake_blake2b_stream_init` function, after which,
+ * but before this function is called,
+ * `libblake_blake2b_stream_update` can be used to process
+ * data before this function is called. Unlike
+ * `libblake_blake2b_digest`, this function does not
+ * write to `data`, so no additional space is required
+ * 
+ * @param  stream      The state of the hash function
+ * @param  data        The last data to process, may be `NULL` if `len` is 0
+ * @param  len         The number of input bytes
+ * @param  last_node   Shall be non-0 the last node at each level in the
+ *                     hashing tree, include the root node, however, it
+ *                     shall be 0 if not using tree-hashing
+ * @param  output_len  The number of bytes to write to `output_len`; this
+ *                     shall be the value `params->digest_len` had when
+ *                     `libblake_blake2b_stream_init` was called, where
+ *                     `params` is the second argument given to
+ *                     `libblake_blake2b_stream_init`
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_stream_digest(struct libblake_blake2b_stream *stream, const void *data, size_t len, int last_node,
+                               size_t output_len, unsigned char output[static output_len]);
+
+/**
+ * Calculate the BLAKE2b hash of the data input so far,
+ * without finalising the state
+ * 
+ * Unlike `libblake_blake2b_stream_digest`, `stream` is
+ * not modified, so more data can be input afterwards;
+ * this is cheaper than copying the stream and finalising
+ * the copy as only the state and the buffered data is
+ * copied, and the only compression performed is the
+ * one of the final block
+ * 
+ * @param  stream      The state of the hash function
+ * @param  last_node   Shall be non-0 the last node at each level in the
+ *                     hashing tree, include the root node, however, it
+ *                     shall be 0 if not using tree-hashing
+ * @param  output_len  The number of bytes to write to `output_len`; this
+ *                     shall be the value `params->digest_len` had when
+ *                     `libblake_blake2b_stream_init` was called, where
+ *                     `params` is the second argument given to
+ *                     `libblake_blake2b_stream_init`
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_stream_peek(const struct libblake_blake2b_stream *stream, int last_node,
+                             size_t output_len, unsigned char output[static output_len]);
+
+/**
+ * Calculate the BLAKE2b hash of a message in one call
+ * 
+ * This is a shorthand for using `libblake_blake2b_init` followed
+ * by `libblake_blake2b_digest` for the common case of sequential
+ * (non-tree) hashing without salt and pepper: no parameter block
+ * is needed, and the input is not written to. It is not faster,
+ * as the time is spent in the compression function
+ * 
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ * @param  output_len  The hash size, in bytes, between 1 and 64 (inclusive)
+ * @param  data        The message, may be `NULL` if `len` is 0
+ * @param  len         The number of bytes in the message
+ * @param  key         The key, may be `NULL` if `key_len` is 0
+ * @param  key_len     The number of bytes in the key, at most 64,
+ *                     or 0 for unkeyed hashing
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b(void *output, size_t output_len, const void *data, size_t len, const void *key, size_t key_len);
+
+/**
+ * Calculate the BLAKE2b hash of a message of exactly 32 bytes
+ * 
+ * This is the same as `libblake_blake2b(output, output_len, data, 32,
+ * key, key_len)`, but the message length is known when the function
+ * is compiled, so the only work done is the compressions
+ * 
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ * @param  output_len  The hash size, in bytes, between 1 and 64 (inclusive)
+ * @param  data        The message, 32 bytes long
+ * @param  key         The key, may be `NULL` if `key_len` is 0
+ * @param  key_len     The number of bytes in the key, at most 64,
+ *                     or 0 for unkeyed hashing
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_fixed32(void *output, size_t output_len, const void *data, const void *key, size_t key_len);
+
+/**
+ * Calculate the BLAKE2b hash of a message of exactly 64 bytes
+ * 
+ * This is the same as `libblake_blake2b(output, output_len, data, 64,
+ * key, key_len)`, but the message length is known when the function
+ * is compiled, so the only work done is the compressions
+ * 
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ * @param  output_len  The hash size, in bytes, between 1 and 64 (inclusive)
+ * @param  data        The message, 64 bytes long
+ * @param  key         The key, may be `NULL` if `key_len` is 0
+ * @param  key_len     The number of bytes in the key, at most 64,
+ *                     or 0 for unkeyed hashing
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_fixed64(void *output, size_t output_len, const void *data, const void *key, size_t key_len);
+
+/**
+ * Calculate the BLAKE2b hash of a message of exactly 4096 bytes
+ * 
+ * This is the same as `libblake_blake2b(output, output_len, data, 4096,
+ * key, key_len)`, but the message length is known when the function
+ * is compiled, so the only work done is the compressions
+ * 
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ * @param  output_len  The hash size, in bytes, between 1 and 64 (inclusive)
+ * @param  data        The message, 4096 bytes long
+ * @param  key         The key, may be `NULL` if `key_len` is 0
+ * @param  key_len     The number of bytes in the key, at most 64,
+ *                     or 0 for unkeyed hashing
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_fixed4096(void *output, size_t output_len, const void *data, const void *key, size_t key_len);
+
+/**
+ * Calculate the BLAKE2b hash of a message of exactly 65536 bytes
+ * 
+ * This is the same as `libblake_blake2b(output, output_len, data, 65536,
+ * key, key_len)`, but the message length is known when the function
+ * is compiled, so the only work done is the compressions
+ * 
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ * @param  output_len  The hash size, in bytes, between 1 and 64 (inclusive)
+ * @param  data        The message, 65536 bytes long
+ * @param  key         The key, may be `NULL` if `key_len` is 0
+ * @param  key_len     The number of bytes in the key, at most 64,
+ *                     or 0 for unkeyed hashing
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_fixed65536(void *output, size_t output_len, const void *data, const void *key, size_t key_len);
+
+/**
+ * Calculate the BLAKE2b hashes of multiple consecutive
+ * messages, each exactly 4096 bytes long, with the same key
+ * 
+ * This is the same as calling `libblake_blake2b_fixed4096`
+ * for each message, but the messages are hashed in parallel
+ * 
+ * @param  output      Output buffer for the hashes, which will be stored in
+ *                     raw binary representation, `output_len` bytes each,
+ *                     in the same order as the messages; the size of this
+ *                     buffer must be at least `n * output_len` bytes
+ * @param  output_len  The hash size, in bytes, between 1 and 64 (inclusive)
+ * @param  data        The messages, `n * 4096` bytes in total
+ * @param  n           The number of messages
+ * @param  key         The key, may be `NULL` if `key_len` is 0
+ * @param  key_len     The number of bytes in the key, at most 64,
+ *                     or 0 for unkeyed hashing
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_fixed4096_many(void *output, size_t output_len, const void *data, size_t n, const void *key, size_t key_len);
+
+/**
+ * Calculate the BLAKE2b hashes of multiple consecutive
+ * messages, each exactly 65536 bytes long, with the same key
+ * 
+ * This is the same as calling `libblake_blake2b_fixed65536`
+ * for each message, but the messages are hashed in parallel
+ * 
+ * @param  output      Output buffer for the hashes, which will be stored in
+ *                     raw binary representation, `output_len` bytes each,
+ *                     in the same order as the messages; the size of this
+ *                     buffer must be at least `n * output_len` bytes
+ * @param  output_len  The hash size, in bytes, between 1 and 64 (inclusive)
+ * @param  data        The messages, `n * 65536` bytes in total
+ * @param  n           The number of messages
+ * @param  key         The key, may be `NULL` if `key_len` is 0
+ * @param  key_len     The number of bytes in the key, at most 64,
+ *                     or 0 for unkeyed hashing
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_fixed65536_many(void *output, size_t output_len, const void *data, size_t n, const void *key, size_t key_len);
+
+/**
+ * Calculate an iterated BLAKE2b hash, that is, hash a
+ * value, then hash the hash, and so on, as is done for
+ * key stretching and proofs of sequential work
+ * 
+ * This is the same as calling `libblake_blake2b` `iterations`
+ * times, with the output of each call as the message of the
+ * next call, but the hash is kept in registers between the
+ * iterations, and each iteration is a single compression
+ * 
+ * @param  output      Output buffer for the final hash, which will be stored
+ *                     in raw binary representation; the size of this buffer
+ *                     must be at least `output_len` bytes, and it may be
+ *                     the same buffer as `data`
+ * @param  output_len  The hash size, in bytes, between 1 and 64 (inclusive),
+ *                     which is also the size of each message
+ * @param  data        The initial value, `output_len` bytes long; it is
+ *                     copied to `output` if `iterations` is 0
+ * @param  iterations  The number of times to apply the hash function
+ * @param  key         The key, may be `NULL` if `key_len` is 0
+ * @param  key_len     The number of bytes in the key, at most 64,
+ *                     or 0 for unkeyed hashing
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_iterate(void *output, size_t output_len, const void *data, uint_least64_t iterations,
+                         const void *key, size_t key_len);
+
+/**
+ * Calculate iterated BLAKE2b hashes of multiple
+ * independent initial values, with the same key
+ * 
+ * This is the same as calling `libblake_blake2b_iterate`
+ * for each value, but the chains are advanced in parallel,
+ * 4 at a time, so there should preferably be a multiple
+ * of 4 values
+ * 
+ * @param  output      Output buffer for the final hashes, which will be
+ *                     stored in raw binary representation, `output_len`
+ *                     bytes each, in the same order as the initial values;
+ *                     the size of this buffer must be at least
+ *                     `n * output_len` bytes, and it may be the same
+ *                     buffer as `data`
+ * @param  output_len  The hash size, in bytes, between 1 and 64 (inclusive)
+ * @param  data        The initial values, `n * output_len` bytes in total
+ * @param  n           The number of initial values
+ * @param  iterations  The number of times to apply the hash function
+ *                     to each value
+ * @param  key         The key, may be `NULL` if `key_len` is 0
+ * @param  key_len     The number of bytes in the key, at most 64,
+ *                     or 0 for unkeyed hashing
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_iterate_many(void *output, size_t output_len, const void *data, size_t n, uint_least64_t iterations,
+                              const void *key, size_t key_len);
+
+/**
+ * Initialise a reusable keyed state for hashing with BLAKE2b
+ * 
+ * The key is processed once, by this function, rather
+ * than once per message; use `libblake_blake2b_prekeyed_init`
+ * or `libblake_blake2b_prekeyed_digest` for each message
+ * 
+ * @param  prekeyed  The state to initialise
+ * @param  params    Hashing parameters, `params->key_len`
+ *                   shall be the length of the key
+ * @param  key       The key, may be `NULL` if `params->key_len` is 0
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_prekey(struct libblake_blake2b_prekeyed *prekeyed, const struct libblake_blake2b_params *params,
+                        const void *key);
+
+/**
+ * Initialise a state for hashing with BLAKE2b,
+ * from a reusable keyed state, so that the key
+ * shall not be input to `libblake_blake2b_update`
+ * 
+ * This function cannot be used if the message is
+ * empty and the key is not, as the key block must
+ * then be processed as the last block; use
+ * `libblake_blake2b_prekeyed_digest` instead
+ * 
+ * @param  state     The state to initialise
+ * @param  prekeyed  The keyed state, initialised
+ *                   with `libblake_blake2b_prekey`
+ */
+LIBBLAKE_PUBLIC__ inline void
+libblake_blake2b_prekeyed_init(struct libblake_blake2b_state *state, const struct libblake_blake2b_prekeyed *prekeyed) {
+	*state = prekeyed->state;
+}
+
+/**
+ * Calculate the BLAKE2b hash of a message, using
+ * a reusable keyed state, which is not modified
+ * 
+ * Only the message is processed, making this function
+ * one compression cheaper than starting over with
+ * `libblake_blake2b_init`; `data` is not written to
+ * 
+ * @param  prekeyed    The keyed state, initialised
+ *                     with `libblake_blake2b_prekey`
+ * @param  data        The message, may be `NULL` if `len` is 0
+ * @param  len         The number of bytes in the message
+ * @param  last_node   Shall be non-0 the last node at each level in the
+ *                     hashing tree, include the root node, however, it
+ *                     shall be 0 if not using tree-hashing
+ * @param  output_len  The number of bytes to write to `output_len`; this
+ *                     shall be the value `params->digest_len` had when
+ *                     `libblake_blake2b_prekey` was called, where `params`
+ *                     is the second argument given to `libblake_blake2b_prekey`
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_prekeyed_digest(const struct libblake_blake2b_prekeyed *prekeyed, const void *data, size_t len,
+                                 int last_node, size_t output_len, unsigned char output[static output_len]);
+
+/**
+ * Initialise a state for BLAKE2b hashing of messages that
+ * consist of a constant prefix followed by a nonce, as
+ * in proofs of work where only the nonce is varied
+ * 
+ * The key and all complete blocks of the prefix are
+ * processed once, by this function, so that only the
+ * last block or two, which contain the nonce, are
+ * processed for each nonce
+ * 
+ * @param  midstate  The state to initialise
+ * @param  params    Hashing parameters, `params->key_len`
+ *                   shall be the length of the key
+ * @param  key       The key, may be `NULL` if `params->key_len` is 0
+ * @param  prefix    The prefix, may be `NULL` if `len` is 0
+ * @param  len       The number of bytes in the prefix
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_midstate_init(struct libblake_blake2b_midstate *midstate, const struct libblake_blake2b_params *params,
+                                const void *key, const void *prefix, size_t len);
+
+/**
+ * Calculate the BLAKE2b hash of a prefix followed by a nonce,
+ * as `libblake_blake2b_nonce_search` does, for example to
+ * verify a nonce found by `libblake_blake2b_nonce_search`
+ * 
+ * @param  midstate   The state, initialised with `libblake_blake2b_midstate_init`
+ * @param  nonce      The nonce, which will be appended to the prefix
+ *                    as a `nonce_len` bytes long little-endian integer
+ * @param  nonce_len  The number of bytes in the nonce, between 1 and 8 (inclusive)
+ * @param  output     Output buffer for the hash, which will be stored in raw
+ *                    binary representation; the size of this buffer must be
+ *                    at least `params->digest_len` bytes, where `params` is
+ *                    the second argument given to `libblake_blake2b_midstate_init`
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_midstate_digest(const struct libblake_blake2b_midstate *midstate, uint_least64_t nonce, size_t nonce_len,
+                                  unsigned char *output);
+
+/**
+ * Search for a nonce that, when appended to a prefix,
+ * gives a BLAKE2b hash below a target, as in proofs of work
+ * 
+ * The nonces are hashed in parallel, 4 at a time, from the
+ * state after the prefix, and the search stops as soon as
+ * a nonce is found; the hash is compared, as a big-endian
+ * integer, that is, byte by byte, to the target
+ * 
+ * @param   midstate   The state, initialised with `libblake_blake2b_midstate_init`
+ * @param   nonce_len  The number of bytes in the nonce, between 1 and 8 (inclusive);
+ *                     see `libblake_blake2b_midstate_digest`
+ * @param   first      The first nonce to try
+ * @param   count      The number of nonces to try, the nonces are
+ *                     tried in order from `first`, and wrap around
+ *                     if they do not fit in `nonce_len` bytes
+ * @param   target     The target, as many bytes as the hash
+ * @param   noncep     Output parameter for the first nonce whose
+ *                     hash is below (but not equal to) `target`
+ * @param   output     Output buffer for the hash of the found nonce,
+ *                     or `NULL`; the size of this buffer must be at
+ *                     least as many bytes as the hash
+ * @return             1 if a nonce was found, 0 otherwise
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_nonce_search(const struct libblake_blake2b_midstate *midstate, size_t nonce_len, uint_least64_t first,
+                               uint_least64_t count, const void *target, uint_least64_t *noncep, unsigned char *output);
+
+/**
+ * Store a state for BLAKE2b hashing in a compact form
+ * 
+ * The state must not have been finalised
+ * 
+ * @param  compact  Output parameter for the compact state
+ * @param  state    The state to store
+ */
+LIBBLAKE_PUBLIC__ inline void
+libblake_blake2b_compact(struct libblake_blake2b_compact_state *compact, const struct libblake_blake2b_state *state) {
+	unsigned int i;
+	for (i = 0; i < 8; i++)
+		compact->h[i] = state->h[i];
+	compact->t[0] = state->t[0];
+	compact->t[1] = state->t[1];
+}
+
+/**
+ * Restore a state for BLAKE2b hashing from its compact form
+ * 
+ * @param  state    Output parameter for the state
+ * @param  compact  The compact state, as stored by `libblake_blake2b_compact`
+ */
+LIBBLAKE_PUBLIC__ inline void
+libblake_blake2b_expand(struct libblake_blake2b_state *state, const struct libblake_blake2b_compact_state *compact) {
+	unsigned int i;
+	for (i = 0; i < 8; i++)
+		state->h[i] = compact->h[i];
+	state->t[0] = compact->t[0];
+	state->t[1] = compact->t[1];
+	state->f[0] = 0;
+	state->f[1] = 0;
+}
+
+/**
+ * Allocate a table of BLAKE2b states
+ * 
+ * The states are uninitialised; use `libblake_blake2b_table_store`
+ * to store an initialised state in the table
+ * 
+ * @param   table  The table to initialise
+ * @param   size   The number of states in the table
+ * @return         0 on success, -1 on failure
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_table_create(struct libblake_blake2b_table *table, size_t size);
+
+/**
+ * Deallocate a table of BLAKE2b states
+ * 
+ * @param  table  The table to deallocate
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_table_destroy(struct libblake_blake2b_table *table);
+
+/**
+ * Store a state for BLAKE2b hashing in a table
+ * 
+ * The state must not have been finalised
+ * 
+ * @param  table  The table
+ * @param  i      The index of the state in the table
+ * @param  state  The state to store
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_table_store(struct libblake_blake2b_table *table, size_t i, const struct libblake_blake2b_state *state);
+
+/**
+ * Load a state for BLAKE2b hashing from a table
+ * 
+ * @param  table  The table
+ * @param  i      The index of the state in the table
+ * @param  state  Output parameter for the state
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_table_load(const struct libblake_blake2b_table *table, size_t i, struct libblake_blake2b_state *state);
+
+/**
+ * Process data for hashing with BLAKE2b, using
+ * a state stored in a table
+ * 
+ * This function behaves like `libblake_blake2b_update`
+ * 
+ * @param   table  The table
+ * @param   i      The index of the state in the table
+ * @param   data   The data to feed into the function
+ * @param   len    The maximum number of bytes to process
+ * @return         The number of processed bytes
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2b_table_update(struct libblake_blake2b_table *table, size_t i, const void *data, size_t len);
+
+/**
+ * Create a scheduler that processes data for many
+ * BLAKE2b streams in parallel, 4 streams at a time,
+ * using an interleaved compression function that
+ * the compiler can vectorise
+ * 
+ * @param   scheduler  The scheduler to initialise
+ * @param   table      The table with the states of the streams; it
+ *                     must not be deallocated before the scheduler
+ * @param   max_jobs   The number of times `libblake_blake2b_scheduler_enqueue`
+ *                     can be called before the queue is processed automatically
+ * @return             0 on success, -1 on failure
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_scheduler_create(struct libblake_blake2b_scheduler *scheduler, struct libblake_blake2b_table *table,
+                                  size_t max_jobs);
+
+/**
+ * Deallocate a scheduler for BLAKE2b streams
+ * 
+ * Any queued data that has not been processed
+ * will be discarded
+ * 
+ * @param  scheduler  The scheduler to deallocate
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_scheduler_destroy(struct libblake_blake2b_scheduler *scheduler);
+
+/**
+ * Queue data for hashing with BLAKE2b, using
+ * a state stored in the scheduler's table
+ * 
+ * The number of bytes that will be processed
+ * is the same as for `libblake_blake2b_update`,
+ * however the data is not processed until
+ * `libblake_blake2b_scheduler_run` is called (or
+ * this function is called when the queue is full),
+ * so `data` must not be modified or deallocated
+ * until then, and the stream's state in the table
+ * must not be used until then
+ * 
+ * The same stream may be queued multiple times,
+ * in which case the data is processed in order
+ * 
+ * @param   scheduler  The scheduler
+ * @param   stream     The index of the stream's state in the table
+ * @param   data       The data to feed into the function
+ * @param   len        The maximum number of bytes to process
+ * @return             The number of bytes that will be processed
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2b_scheduler_enqueue(struct libblake_blake2b_scheduler *scheduler, size_t stream,
+                                   const void *data, size_t len);
+
+/**
+ * Process all data queued in a scheduler
+ * for BLAKE2b streams
+ * 
+ * Data from up to 4 different streams is processed
+ * at the same time; data queued for the same stream
+ * is processed in the order it was queued
+ * 
+ * @param  scheduler  The scheduler
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_scheduler_run(struct libblake_blake2b_scheduler *scheduler);
+
+/**
+ * Serialise a state for BLAKE2b hashing
+ * 
+ * The output is independent of the machine and of
+ * the library version's in-memory representation,
+ * and can be restored with `libblake_blake2b_import`
+ * 
+ * @param   state   The state to serialise
+ * @param   buffer  Output buffer, may be `NULL` if `size` is 0
+ * @param   size    The size of `buffer`
+ * @return          The number of bytes required for the output; if
+ *                  greater than `size`, nothing is written to `buffer`
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2b_export(const struct libblake_blake2b_state *state, void *buffer, size_t size);
+
+/**
+ * Restore a state for BLAKE2b hashing,
+ * serialised with `libblake_blake2b_export`
+ * 
+ * @param   state   Output parameter for the state;
+ *                  not modified on failure
+ * @param   buffer  The serialised state
+ * @param   len     The number of bytes in `buffer`
+ * @return          0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `buffer` does not contain a state for
+ *                  BLAKE2b hashing in a supported format
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_import(struct libblake_blake2b_state *state, const void *buffer, size_t len);
+
+/**
+ * Serialise a buffered state for BLAKE2b hashing
+ * 
+ * The output is independent of the machine and of
+ * the library version's in-memory representation,
+ * and can be restored with `libblake_blake2b_stream_import`
+ * 
+ * @param   stream  The buffered state to serialise
+ * @param   buffer  Output buffer, may be `NULL` if `size` is 0
+ * @param   size    The size of `buffer`
+ * @return          The number of bytes required for the output; if
+ *                  greater than `size`, nothing is written to `buffer`
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2b_stream_export(const struct libblake_blake2b_stream *stream, void *buffer, size_t size);
+
+/**
+ * Restore a buffered state for BLAKE2b hashing,
+ * serialised with `libblake_blake2b_stream_export`
+ * 
+ * @param   stream  Output parameter for the buffered state;
+ *                  not modified on failure
+ * @param   buffer  The serialised buffered state
+ * @param   len     The number of bytes in `buffer`
+ * @return          0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `buffer` does not contain a buffered state for
+ *                  BLAKE2b hashing in a supported format
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_stream_import(struct libblake_blake2b_stream *stream, const void *buffer, size_t len);
+
+/**
+ * Create an index of intermediate states for BLAKE2b
+ * hashing, with which the hash of any prefix of the
+ * input can be calculated by processing at most
+ * `interval` blocks (128 bytes each) of the prefix
+ * 
+ * @param   index     The index to initialise
+ * @param   state     The state the input will be hashed with; must
+ *                    not have processed any data yet, but may have
+ *                    a key (that is fed as the first block of input)
+ * @param   interval  The number of blocks between each captured state
+ * @return            0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `interval` is 0, or `state` has
+ *                  already processed data
+ * @throws  ENOMEM  Insufficient memory available
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_checkpoints_create(struct libblake_blake2b_checkpoints *index, const struct libblake_blake2b_state *state, size_t interval);
+
+/**
+ * Deallocate an index of intermediate states for BLAKE2b hashing
+ * 
+ * @param  index  The index to destroy
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_checkpoints_destroy(struct libblake_blake2b_checkpoints *index);
+
+/**
+ * Like `libblake_blake2b_update`, process data for BLAKE2b
+ * hashing, but also capture the intermediate states into
+ * an index as the data is processed
+ * 
+ * All input to `state`, since `libblake_blake2b_checkpoints_create`
+ * was called, must be processed with this function
+ * 
+ * @param   index       The index to add captured states to
+ * @param   state       The state of the hash function
+ * @param   data        The data to feed into the function
+ * @param   len         The maximum number of bytes to process
+ * @param   processedp  Output parameter for the number of processed bytes
+ * @return              0 on success, -1 on failure; on failure,
+ *                      no data will have been processed
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_checkpoints_update(struct libblake_blake2b_checkpoints *index, struct libblake_blake2b_state *state,
+                                    const void *data, size_t len, size_t *processedp);
+
+/**
+ * Load the last state, from an index of intermediate
+ * BLAKE2b states, that can be used to calculate the
+ * hash of a prefix of the input
+ * 
+ * The hash of the prefix is calculated by passing the
+ * input from the returned offset up to the end of the
+ * prefix to `libblake_blake2b_digest` or
+ * `libblake_blake2b_digest_const`
+ * 
+ * @param   index  The index
+ * @param   len    The length of the prefix, in bytes
+ * @param   state  Output parameter for the state
+ * @return         The number of bytes of input the state has
+ *                 processed; at most `len`
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2b_checkpoints_seek(const struct libblake_blake2b_checkpoints *index, size_t len, struct libblake_blake2b_state *state);
+
+/**
+ * Calculate the BLAKE2b hash of a prefix of the input
+ * using an index of intermediate states
+ * 
+ * Only the end of the prefix, after the last captured
+ * state before it, is read from `data`
+ * 
+ * @param  index       The index
+ * @param  data        The input, must contain at least `len` bytes
+ * @param  len         The length of the prefix, in bytes
+ * @param  last_node   Shall be non-0 the last node at each level in the
+ *                     hashing tree, include the root node, however, it
+ *                     shall be 0 if not using tree-hashing
+ * @param  output_len  The number of bytes to write to `output`; this
+ *                     shall be `params->digest_len` for the parameters
+ *                     the state was initialised with
+ * @param  output      Output buffer for the hash, which will be stored in raw
+ *                     binary representation; the size of this buffer must be
+ *                     at least `output_len` bytes
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_checkpoints_digest(const struct libblake_blake2b_checkpoints *index, const void *data, size_t len, int last_node,
+                                    size_t output_len, unsigned char output[static output_len]);
+
+/**
+ * Serialise an index of intermediate states for BLAKE2b
+ * hashing, the output is independent of the machine
+ * 
+ * @param   index   The index to serialise
+ * @param   buffer  Output buffer, may be `NULL` if `size` is 0
+ * @param   size    The size of `buffer`
+ * @return          The number of bytes required for the output; if
+ *                  greater than `size`, nothing is written to `buffer`
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2b_checkpoints_export(const struct libblake_blake2b_checkpoints *index, void *buffer, size_t size);
+
+/**
+ * Restore an index of intermediate states for BLAKE2b
+ * hashing, serialised with `libblake_blake2b_checkpoints_export`
+ * 
+ * The index shall be deallocated with
+ * `libblake_blake2b_checkpoints_destroy`
+ * 
+ * @param   index   Output parameter for the index
+ * @param   buffer  The serialised index
+ * @param   len     The number of bytes in `buffer`
+ * @return          0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `buffer` does not contain an index for
+ *                  BLAKE2b hashing in a supported format
+ * @throws  ENOMEM  Insufficient memory available
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_checkpoints_import(struct libblake_blake2b_checkpoints *index, const void *buffer, size_t len);
+
+/**
+ * Calculate the BLAKE2b hashes of many files
+ * 
+ * Where io_uring is available, the files are read
+ * asynchronously, with many reads in flight at any time,
+ * and the data is hashed, for many files in parallel,
+ * while the next reads are in progress; otherwise the
+ * files are hashed on a pool of threads
+ * 
+ * The order in which the files are completed is unspecified.
+ * `callback` may be called from other threads than the calling
+ * thread, but it is never called concurrently, and never
+ * after this function has returned
+ * 
+ * @param   paths     The files to hash
+ * @param   npaths    The number of elements in `paths`
+ * @param   params    Hashing parameters, the same for each file
+ * @param   key       The key, `params->key_len` bytes long,
+ *                    may be `NULL` if `params->key_len` is 0
+ * @param   flags     0 or `LIBBLAKE_HASH_FILES_DIRECT`
+ * @param   callback  Function called once for each file, with `user`
+ *                    as the first argument, and the index of the file
+ *                    in `paths` as the second argument; on success
+ *                    the third argument is the hash, which is
+ *                    `params->digest_len` bytes long, and the fourth
+ *                    argument is 0; on failure the third argument is
+ *                    `NULL` and the fourth argument is the error number
+ * @param   user      User-defined data passed to `callback`
+ * @return            0 on success, -1 on failure; failures to read
+ *                    a file are reported via `callback` instead
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_hash_files(const char *const paths[], size_t npaths, const struct libblake_blake2b_params *params,
+                            const void *key, int flags,
+                            void (*callback)(void *user, size_t i, const unsigned char *digest, int error), void *user);
+
+/**
+ * Calculate the BLAKE2b hash of a file
+ * 
+ * The hash is the same as if the file's contents were
+ * processed with `libblake_blake2b_stream_update_fd`
+ * 
+ * @param   path    The file to hash
+ * @param   params  Hashing parameters
+ * @param   key     The key, `params->key_len` bytes long,
+ *                  may be `NULL` if `params->key_len` is 0
+ * @param   cache   Cache for the hash, if it is a regular
+ *                  file, see `libblake_digest_cache_open`,
+ *                  or `NULL`
+ * @param   output  Output buffer for the hash, which will be
+ *                  `params->digest_len` bytes long
+ * @return          0 on success, -1 on failure
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  -       Any error specified for open(3), fstat(3) or read(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_hash_file(const char *path, const struct libblake_blake2b_params *params,
+                           const void *key, struct libblake_digest_cache *cache, unsigned char *output);
+
+/**
+ * Calculate a BLAKE2b hash of a directory tree
+ * 
+ * Regular files are hashed as with `libblake_blake2b_stream_update_fd`,
+ * and symbolic links (except `path` itself, which is followed) are
+ * hashed as their target path. A directory is hashed, with
+ * `params->node_depth` incremented by 1, as a list of all its
+ * entries, except "." and "..", sorted by name in byte order,
+ * where each entry is recorded as 'f', 'l' or 'd' (for regular files,
+ * symbolic links and directories), followed by its name, a NUL byte,
+ * and its hash. If `path` is a file, its hash is calculated
+ * 
+ * The files and directories are processed in parallel, but the
+ * result does not depend on the number of threads
+ * 
+ * @param   path      The directory (or file) to hash
+ * @param   params    Hashing parameters, the same for each file
+ * @param   key       The key, `params->key_len` bytes long,
+ *                    may be `NULL` if `params->key_len` is 0
+ * @param   cache     Cache for the hashes of the regular files,
+ *                    see `libblake_digest_cache_open`, or `NULL`
+ * @param   nthreads  The maximum number of threads to use,
+ *                    0 for the number of online processors
+ * @param   output    Output buffer for the hash, which will be
+ *                    `params->digest_len` bytes long
+ * @return            0 on success, -1 on failure
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  EINVAL  The tree contains a file that is neither a
+ *                  regular file, a directory, nor a symbolic link
+ * @throws  EIO     A file was truncated while it was being hashed
+ * @throws  -       Any error specified for stat(3), lstat(3), readlink(3),
+ *                  opendir(3), readdir(3), open(3) or read(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_hash_tree(const char *path, const struct libblake_blake2b_params *params,
+                           const void *key, struct libblake_digest_cache *cache, size_t nthreads, unsigned char *output);
+
+/**
+ * Create a content-defined chunker, that splits input into
+ * chunks, at positions determined by the content, so that
+ * the chunks are unaffected by insertions and deletions
+ * in other chunks, and calculates the BLAKE2b hash of each
+ * chunk (as `libblake_blake2b` would calculate it)
+ * 
+ * The boundaries are found with FastCDC, a gear hash
+ * with normalised chunking, and the chunks are hashed
+ * in parallel, as soon as their boundaries are found,
+ * while they are still in the processor's cache
+ * 
+ * @param   chunker   The chunker to initialise
+ * @param   params    Hashing parameters, the same for each chunk
+ * @param   key       The key, `params->key_len` bytes long,
+ *                    may be `NULL` if `params->key_len` is 0
+ * @param   min_size  The minimum size of a chunk (except for the
+ *                    last chunk), must be at least 1
+ * @param   avg_size  The desired average size of a chunk, must be
+ *                    at least 8 and at least `min_size`; the
+ *                    chunking is most effective if it is a power
+ *                    of 2 and about 4 times `min_size`
+ * @param   max_size  The maximum size of a chunk, must be at
+ *                    least `avg_size`
+ * @return            0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  Invalid chunk sizes
+ * @throws  ENOMEM  Insufficient memory available
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_chunker_create(struct libblake_blake2b_chunker *chunker, const struct libblake_blake2b_params *params,
+                                const void *key, size_t min_size, size_t avg_size, size_t max_size);
+
+/**
+ * Deallocate a content-defined chunker
+ * 
+ * @param  chunker  The chunker to deallocate
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2b_chunker_destroy(struct libblake_blake2b_chunker *chunker);
+
+/**
+ * Split input into chunks, and hash them, with
+ * a content-defined chunker
+ * 
+ * Only complete chunks are output; the data after
+ * the last output chunk is not consumed, and must
+ * be input again, followed by more input, in the
+ * next call, unless `end` is non-zero and
+ * `max_chunks` was not reached, in which case all
+ * input is consumed
+ * 
+ * @param   chunker     The chunker
+ * @param   data        The data to split
+ * @param   len         The number of bytes in `data`
+ * @param   end         Non-zero if `data` ends the input
+ * @param   chunks      Output buffer for the chunks
+ * @param   max_chunks  The number of elements in `chunks`
+ * @param   nchunksp    Output parameter for the number of
+ *                      chunks stored in `chunks`
+ * @return              The number of consumed bytes, that is,
+ *                      the sum of the lengths of the output chunks
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2b_chunker_update(struct libblake_blake2b_chunker *chunker, const void *data, size_t len, int end,
+                                struct libblake_blake2b_chunk *chunks, size_t max_chunks, size_t *nchunksp);
+
+/**
+ * Build a dm-verity-style hash tree, using BLAKE2b, over
+ * the blocks of a file, such as a filesystem image
+ * 
+ * The data is split into blocks of `block_size` bytes
+ * (the last block is padded with zeroes if partial), and
+ * level 0 of the tree is the hashes of these blocks; each
+ * following level is the hashes of the blocks of the level
+ * below it, until a level fits in a single block. Each hash
+ * is stored in the smallest power of two bytes it fits in,
+ * followed by zeroes, as is each block of hashes. The levels
+ * are stored from the highest level to level 0. The root
+ * hash is the hash of the block of the highest level
+ * 
+ * The file containing the tree is memory-mapped, and the
+ * blocks of each level are hashed in parallel, many
+ * at a time on each thread
+ * 
+ * @param   data_fd     The file to build the hash tree over,
+ *                      all of it is used regardless of its offset
+ * @param   hash_fd     The file to write the hash tree to, it will
+ *                      be truncated and must be opened for reading
+ *                      and writing
+ * @param   params      Hashing parameters, `params->key_len` must be 0
+ *                      but `params->salt` can be used
+ * @param   block_size  The block size, a power of two, and at least
+ *                      twice the size of each stored hash
+ * @param   nthreads    The maximum number of threads to use,
+ *                      0 for the number of online processors
+ * @param   root        Output buffer for the root hash, which will
+ *                      be `params->digest_len` bytes long
+ * @return              0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  The file is empty, `params->key_len` is not 0, or
+ *                  `block_size` is invalid
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  EIO     The file was truncated while it was being hashed
+ * @throws  -       Any error specified for fstat(3), ftruncate(3),
+ *                  mmap(3) or pread(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_verity_build(int data_fd, int hash_fd, const struct libblake_blake2b_params *params, size_t block_size,
+                               size_t nthreads, unsigned char *root);
+
+/**
+ * Verify a block of data against a hash tree built
+ * by `libblake_blake2b_verity_build`
+ * 
+ * Only the hash blocks on the path from the block
+ * to the root are read and hashed
+ * 
+ * @param   tree        The hash tree
+ * @param   tree_size   The size of `tree`, in bytes
+ * @param   nblocks     The number of data blocks the tree was built over
+ * @param   params      Hashing parameters, as used to build the tree
+ * @param   block_size  The block size, as used to build the tree
+ * @param   root        The trusted root hash
+ * @param   index       The index of the data block
+ * @param   block       The data block, `block_size` bytes long, padded
+ *                      with zeroes if it is a partial last block
+ * @return              1 if the block is valid, 0 if it is not
+ *                      or the tree is corrupt, -1 on failure
+ * 
+ * @throws  EINVAL  `params->key_len` is not 0, `block_size`
+ *                  is invalid, `index` is at least `nblocks`,
+ *                  or `tree_size` is too small for `nblocks`
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_verity_verify(const void *tree, size_t tree_size, uint_least64_t nblocks,
+                                const struct libblake_blake2b_params *params, size_t block_size,
+                                const unsigned char *root, uint_least64_t index, const void *block);
+
+/**
+ * Calculate the BLAKE2b tree hash of a file, and store the
+ * digests of the nodes so that the hash can be updated with
+ * `libblake_blake2b_tree_update` after parts of the file
+ * have been modified
+ * 
+ * The file is split into leaves of `params->leaf_len` bytes
+ * (the last leaf may be shorter, and an empty file has one
+ * empty leaf); each node on the level above has up to
+ * `params->fanout` children (unlimited if 0), and its input is
+ * the concatenation of their digests; the levels are added until
+ * a level with only one node, the root, is reached, or until the
+ * level at depth `params->depth - 1`, which is then the root
+ * regardless of the fan-out. Each node is hashed with its offset
+ * on its level as `node_offset`, and the level (0 for leaves) as
+ * `node_depth`, and the last node on each level is marked as
+ * such; every node is keyed, and every node except the root
+ * has a digest of `params->inner_len` bytes
+ * 
+ * The store is in a format that is specific to the machine
+ * 
+ * @param   data_fd   The file to hash, all of it is used regardless
+ *                    of its offset; it must support pread(3)
+ * @param   store_fd  The file to store the digests in, it will be
+ *                    truncated and must be opened for reading and writing
+ * @param   params    Hashing parameters; `params->node_offset` and
+ *                    `params->node_depth` must be 0, `params->fanout`
+ *                    must not be 1, `params->depth` must be at least 2,
+ *                    `params->leaf_len` must not be 0, and
+ *                    `params->inner_len` must be between 1 and 64
+ *                    (inclusive)
+ * @param   key       The key, `params->key_len` bytes long,
+ *                    may be `NULL` if `params->key_len` is 0
+ * @param   output    Output buffer for the root hash, which will
+ *                    be `params->digest_len` bytes long
+ * @return            0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `params` is invalid
+ * @throws  EFBIG   The store would be too large
+ * @throws  EIO     The file was truncated while it was being hashed
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  -       Any error specified for fstat(3), pread(3),
+ *                  ftruncate(3), mmap(3) or msync(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_tree_build(int data_fd, int store_fd, const struct libblake_blake2b_params *params,
+                            const void *key, unsigned char *output);
+
+/**
+ * Update the BLAKE2b tree hash of a file, calculated with
+ * `libblake_blake2b_tree_build`, after parts of the file
+ * have been modified
+ * 
+ * Only the leaves that overlap with the modified ranges are
+ * read and rehashed, along with their ancestors. If the size of
+ * the file has changed, the bytes after the old end of the file
+ * need not be listed as modified, and the last leaf is always
+ * rehashed; if the number of leaves has changed, all nodes above
+ * the leaves are rehashed (but the other leaves are not)
+ * 
+ * If the store was not created with the same parameters and key,
+ * or is unusable for any other reason, such as an update that did
+ * not complete (even because of a system crash), the tree is
+ * rebuilt as with `libblake_blake2b_tree_build`. The store
+ * must not be used by multiple threads or processes at the
+ * same time
+ * 
+ * @param   data_fd   The file to hash, all of it is used regardless
+ *                    of its offset; it must support pread(3)
+ * @param   store_fd  The file the digests are stored in, it must be
+ *                    opened for reading and writing
+ * @param   params    Hashing parameters, as for `libblake_blake2b_tree_build`
+ * @param   key       The key, `params->key_len` bytes long,
+ *                    may be `NULL` if `params->key_len` is 0
+ * @param   ranges    The ranges of bytes that have been modified since the
+ *                    store was last updated, may be `NULL` if `nranges` is 0;
+ *                    the ranges may overlap and may extend beyond the file
+ * @param   nranges   The number of elements in `ranges`
+ * @param   output    Output buffer for the root hash, which will
+ *                    be `params->digest_len` bytes long
+ * @return            0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `params` is invalid
+ * @throws  EFBIG   The store would be too large
+ * @throws  EIO     The file was truncated while it was being hashed
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  -       Any error specified for fstat(3), pread(3),
+ *                  ftruncate(3), mmap(3) or msync(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_tree_update(int data_fd, int store_fd, const struct libblake_blake2b_params *params,
+                             const void *key, const struct libblake_byte_range *ranges, size_t nranges,
+                             unsigned char *output);
+
+/**
+ * Get the range of bytes in a message that a node in
+ * its BLAKE2b hash tree, as described for
+ * `libblake_blake2b_tree_build`, is calculated over
+ * 
+ * @param   params       Hashing parameters, as for `libblake_blake2b_tree_build`
+ * @param   size         The size of the entire message, in bytes
+ * @param   node_offset  The offset of the node on its level
+ * @param   node_depth   The level of the node, 0 for leaves
+ * @param   range        Output parameter for the range
+ * @return               0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `params` is invalid, or the tree has no such node
+ * @throws  EFBIG   The message is too large for the parameters
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_tree_node_range(const struct libblake_blake2b_params *params, uint_least64_t size,
+                                 uint_least64_t node_offset, size_t node_depth, struct libblake_byte_range *range);
+
+/**
+ * Calculate a node in the BLAKE2b hash tree, as described
+ * for `libblake_blake2b_tree_build`, of a message
+ * 
+ * Only the part of the message below the node is needed,
+ * so that disjoint parts of the message can be hashed
+ * independently, for example on different machines, and
+ * the nodes combined with `libblake_blake2b_tree_merge`.
+ * If the node is the root, its digest is the hash of
+ * the message, as calculated by `libblake_blake2b_tree_build`
+ * 
+ * @param   node         Output parameter for the node
+ * @param   params       Hashing parameters, as for `libblake_blake2b_tree_build`
+ * @param   key          The key, `params->key_len` bytes long,
+ *                       may be `NULL` if `params->key_len` is 0
+ * @param   size         The size of the entire message, in bytes
+ * @param   node_offset  The offset of the node on its level
+ * @param   node_depth   The level of the node, 0 for leaves
+ * @param   data         The part of the message below the node, as
+ *                       returned by `libblake_blake2b_tree_node_range`
+ * @param   len          The number of bytes in `data`
+ * @return               0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `params` is invalid, the tree has no such
+ *                  node, or `len` is not the size of the node's
+ *                  part of the message
+ * @throws  EFBIG   The message is too large for the parameters
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_tree_node(struct libblake_tree_node *node, const struct libblake_blake2b_params *params, const void *key,
+                           uint_least64_t size, uint_least64_t node_offset, size_t node_depth, const void *data, size_t len);
+
+/**
+ * Calculate a node in a BLAKE2b hash tree from its children
+ * 
+ * The node is marked as the last node on its level if it
+ * is, and has a digest of `params->inner_len` bytes, or
+ * `params->digest_len` bytes if it is the root
+ * 
+ * @param   parent     Output parameter for the node, may be
+ *                     the same as the first element in `children`
+ * @param   params     Hashing parameters, as used to calculate the children
+ * @param   key        The key, `params->key_len` bytes long,
+ *                     may be `NULL` if `params->key_len` is 0
+ * @param   children   All children of the node, in order
+ * @param   nchildren  The number of elements in `children`
+ * @return             0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `params` is invalid, `children` is not exactly
+ *                  the children of one node, in order, or the
+ *                  children were calculated with other parameters
+ *                  or another key
+ * @throws  EFBIG   The message is too large for the parameters
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_tree_merge(struct libblake_tree_node *parent, const struct libblake_blake2b_params *params, const void *key,
+                            const struct libblake_tree_node *children, size_t nchildren);
+
+/**
+ * Create the block signature of a file, for rsync-style
+ * synchronisation: the file is split into blocks of
+ * `block_size` bytes (the last block may be shorter),
+ * and the weak rolling checksum (as calculated by
+ * `libblake_rolling_checksum`) and the BLAKE2b hash (as
+ * `libblake_blake2b` would calculate it) of each block
+ * are calculated; the blocks are hashed in parallel
+ * 
+ * Short hashes, selected with `params->digest_len`,
+ * make the signature smaller, and are sufficient
+ * as a block is only compared against blocks
+ * with the same weak checksum
+ * 
+ * @param   sig         The signature to create, shall be deallocated
+ *                      with `libblake_blake2b_signature_destroy`
+ * @param   params      Hashing parameters, the same for each block
+ * @param   key         The key, `params->key_len` bytes long,
+ *                      may be `NULL` if `params->key_len` is 0
+ * @param   block_size  The number of bytes in each block, must be at least 1
+ * @param   data        The contents of the file
+ * @param   len         The number of bytes in `data`
+ * @return              0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `block_size` is 0
+ * @throws  ENOMEM  Insufficient memory available
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_signature_create(struct libblake_blake2b_signature *sig, const struct libblake_blake2b_params *params,
+                                  const void *key, size_t block_size, const void *data, size_t len);
+
+/**
+ * Create the block signature of a file, as
+ * `libblake_blake2b_signature_create` would,
+ * reading the file from a file descriptor
+ * 
+ * @param   sig         The signature to create, shall be deallocated
+ *                      with `libblake_blake2b_signature_destroy`
+ * @param   params      Hashing parameters, the same for each block
+ * @param   key         The key, `params->key_len` bytes long,
+ *                      may be `NULL` if `params->key_len` is 0
+ * @param   block_size  The number of bytes in each block, must be at least 1
+ * @param   fd          File descriptor to read the file from,
+ *                      it will be read until end of file
+ * @return              0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `block_size` is 0
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  EIO     The file was truncated while it was being hashed
+ * @throws  -       Any error specified for fstat(3) or read(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_signature_create_fd(struct libblake_blake2b_signature *sig, const struct libblake_blake2b_params *params,
+                                     const void *key, size_t block_size, int fd);
+
+/**
+ * Deallocate a block signature
+ * 
+ * @param  sig  The signature to deallocate
  */
 LIBBLAKE_PUBLIC__ void
-libblake_blake2b_digest(struct libblake_blake2b_state *state, void *data, size_t len, int last_node,
-                        size_t output_len, unsigned char output[static output_len]);
+libblake_blake2b_signature_destroy(struct libblake_blake2b_signature *sig);
+
+/**
+ * Look up a block in a block signature
+ * 
+ * The table is looked up with the weak checksum,
+ * which is calculated as the block is rolled over
+ * the new file, and the block is only hashed if
+ * a block in the signature has the same weak
+ * checksum; if multiple blocks match, the first
+ * of them is returned
+ * 
+ * @param   sig     The signature
+ * @param   weak    The weak checksum of the block, as calculated
+ *                  by `libblake_rolling_checksum` or
+ *                  `libblake_rolling_checksum_roll`
+ * @param   data    The block
+ * @param   len     The number of bytes in `data`
+ * @param   blockp  Output parameter for the index of the
+ *                  block, in the file, if it is found
+ * @return          1 if the block was found, 0 otherwise
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2b_signature_find(const struct libblake_blake2b_signature *sig, uint_least32_t weak,
+                                const void *data, size_t len, size_t *blockp);
 
 
 
@@ -1101,6 +5300,60 @@ struct libblake_blake2xb_state {
 	unsigned char intermediate[128];
 };
 
+/**
+ * Buffered state for BLAKE2Xs hashing
+ * 
+ * This structure should be opaque
+ */
+struct libblake_blake2xs_stream {
+	struct libblake_blake2xs_state state;
+	size_t buffered;
+	unsigned char buffer[64];
+};
+
+/**
+ * Compact state for BLAKE2Xs hashing
+ * 
+ * Unlike `struct libblake_blake2xs_state`, this
+ * structure does not store a copy of the parameters,
+ * but a pointer to them, and has no room for the
+ * intermediate hash; it can only be used before
+ * `libblake_blake2xs_predigest` is called
+ * 
+ * This structure should be opaque
+ */
+struct libblake_blake2xs_compact_state {
+	struct libblake_blake2s_compact_state b2s;
+	const struct libblake_blake2xs_params *params;
+};
+
+/**
+ * Buffered state for BLAKE2Xb hashing
+ * 
+ * This structure should be opaque
+ */
+struct libblake_blake2xb_stream {
+	struct libblake_blake2xb_state state;
+	size_t buffered;
+	unsigned char buffer[128];
+};
+
+/**
+ * Compact state for BLAKE2Xb hashing
+ * 
+ * Unlike `struct libblake_blake2xb_state`, this
+ * structure does not store a copy of the parameters,
+ * but a pointer to them, and has no room for the
+ * intermediate hash; it can only be used before
+ * `libblake_blake2xb_predigest` is called
+ * 
+ * This structure should be opaque
+ */
+struct libblake_blake2xb_compact_state {
+	struct libblake_blake2b_compact_state b2b;
+	const struct libblake_blake2xb_params *params;
+};
+
 
 
 /**
@@ -1197,6 +5450,26 @@ libblake_blake2xs_predigest(struct libblake_blake2xs_state *state, void *data, s
 	libblake_blake2s_digest(&state->b2s, data, len, last_node, (size_t)state->xof_params.digest_len, state->intermediate);
 }
 
+/**
+ * Perform intermediate hashing calculation for
+ * a BLAKE2Xs hash at the end of the input data
+ * 
+ * This function behaves like `libblake_blake2xs_predigest`
+ * except it does not write to `data`, so no additional
+ * space is required, and `data` may be read-only
+ * 
+ * @param  state       The state of the hash function
+ * @param  data        The last data to process, may be `NULL` if `len` is 0
+ * @param  len         The number of input bytes
+ * @param  last_node   Shall be non-0 the last node at each level in the
+ *                     hashing tree, include the root node, however, it
+ *                     shall be 0 if not using tree-hashing
+ */
+LIBBLAKE_PUBLIC__ inline void
+libblake_blake2xs_predigest_const(struct libblake_blake2xs_state *state, const void *data, size_t len, int last_node) {
+	libblake_blake2s_digest_const(&state->b2s, data, len, last_node, (size_t)state->xof_params.digest_len, state->intermediate);
+}
+
 /**
  * Calculate part of a BLAKE2Xs hashing
  * 
@@ -1222,6 +5495,231 @@ LIBBLAKE_PUBLIC__ void
 libblake_blake2xs_digest(const struct libblake_blake2xs_state *state, uint_least32_t i,
                          uint_least8_t len, unsigned char output[static len]);
 
+/**
+ * Initialise a buffered state for hashing with BLAKE2Xs
+ * 
+ * NB! BLAKE2X has not been finalised as of 2022-02-20
+ * 
+ * @param  stream  The state to initialise
+ * @param  params  Hashing parameters
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2xs_stream_init(struct libblake_blake2xs_stream *stream, const struct libblake_blake2xs_params *params);
+
+/**
+ * Process data for hashing with BLAKE2Xs
+ * 
+ * Unlike `libblake_blake2xs_update`, this function
+ * processes all input data: up to one block of
+ * data is stored in the state and is processed
+ * when more data is input or when
+ * `libblake_blake2xs_stream_predigest` is called
+ * 
+ * @param  stream  The state of the hash function
+ * @param  data    The data to feed into the function
+ * @param  len     The number of bytes to process
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2xs_stream_update(struct libblake_blake2xs_stream *stream, const void *data, size_t len);
+
+/**
+ * Process the contents of a file for BLAKE2Xs hashing
+ * 
+ * Holes in sparse files are hashed without being read,
+ * large regular files that are sealed against shrinking
+ * (see memfd_create(2)) are mapped into memory rather
+ * than read, other files are read with large buffers
+ * (a mapped file that is truncated while it is hashed
+ * would kill the process with SIGBUS), and if
+ * they are not regular files (for example pipes
+ * and sockets), they are read on a separate thread so
+ * that reading and hashing overlap; either way, the
+ * data is not copied more than
+ * `libblake_blake2xs_stream_update` requires
+ * 
+ * @param   stream  The state of the hash function
+ * @param   fd      The file descriptor to read, from its current
+ *                  offset until the end of the file
+ * @return          0 on success, -1 on failure; on failure,
+ *                  some data may have been processed
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  EIO     The file was truncated while it was being hashed
+ * @throws  -       Any error specified for fstat(3) or read(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2xs_stream_update_fd(struct libblake_blake2xs_stream *stream, int fd);
+
+/**
+ * Process the contents of a file for BLAKE2Xs hashing,
+ * see `libblake_blake2xs_stream_update_fd` for details
+ * 
+ * @param   stream  The state of the hash function
+ * @param   path    The file to read
+ * @return          0 on success, -1 on failure; on failure,
+ *                  some data may have been processed
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  -       Any error specified for open(3), fstat(3) or read(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2xs_stream_update_path(struct libblake_blake2xs_stream *stream, const char *path);
+
+/**
+ * Perform intermediate hashing calculation for
+ * a BLAKE2Xs hash at the end of the input data
+ * 
+ * The `stream` parameter must have been initialised using
+ * the `libblake_blake2xs_stream_init` function, after which,
+ * but before this function is called,
+ * `libblake_blake2xs_stream_update` can be used to process
+ * data before this function is called. Unlike
+ * `libblake_blake2xs_predigest`, this function does not
+ * write to `data`, so no additional space is required
+ * 
+ * @param  stream     The state of the hash function
+ * @param  data       The last data to process, may be `NULL` if `len` is 0
+ * @param  len        The number of input bytes
+ * @param  last_node  Shall be non-0 the last node at each level in the
+ *                    hashing tree, include the root node, however, it
+ *                    shall be 0 if not using tree-hashing
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2xs_stream_predigest(struct libblake_blake2xs_stream *stream, const void *data, size_t len, int last_node);
+
+/**
+ * Perform intermediate hashing calculation for a
+ * BLAKE2Xs hash of the data input so far, without
+ * finalising the state
+ * 
+ * Unlike `libblake_blake2xs_stream_predigest`, `stream`
+ * is not modified, so more data can be input afterwards;
+ * instead the result is stored in `snapshot`, which
+ * can then be used with `libblake_blake2xs_digest`
+ * 
+ * @param  stream     The state of the hash function
+ * @param  last_node  Shall be non-0 the last node at each level in the
+ *                    hashing tree, include the root node, however, it
+ *                    shall be 0 if not using tree-hashing
+ * @param  snapshot   Output parameter for the finalised copy of the state
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2xs_stream_peek(const struct libblake_blake2xs_stream *stream, int last_node, struct libblake_blake2xs_state *snapshot);
+
+/**
+ * Calculate part of a BLAKE2Xs hashing
+ * 
+ * This function is identical to `libblake_blake2xs_digest`
+ * 
+ * The `stream` parameter must have preprocessed
+ * using the `libblake_blake2xs_stream_predigest` function
+ * 
+ * @param  stream  The state of the hash function
+ * @param  i       The index of the portion of the hash that
+ *                 shall be calculated, that is, the offset in
+ *                 the hash divided by 32
+ * @param  len     Given the desired total hash length, in bytes,
+ *                 `length`, `len` shall be the minimum of `32`
+ *                 and `length - i * 32`
+ * @param  output  Output buffer for the hash offset by `i * 32`
+ */
+LIBBLAKE_PUBLIC__ inline void
+libblake_blake2xs_stream_digest(const struct libblake_blake2xs_stream *stream, uint_least32_t i,
+                                uint_least8_t len, unsigned char output[static len]) {
+	libblake_blake2xs_digest(&stream->state, i, len, output);
+}
+
+/**
+ * Store a state for BLAKE2Xs hashing in a compact form
+ * 
+ * The state must not have been finalised
+ * 
+ * @param  compact  Output parameter for the compact state
+ * @param  state    The state to store
+ * @param  params   The parameters `state` was initialised with; this
+ *                  is not copied, so it must be kept unmodified until
+ *                  `compact` is no longer used
+ */
+LIBBLAKE_PUBLIC__ inline void
+libblake_blake2xs_compact(struct libblake_blake2xs_compact_state *compact, const struct libblake_blake2xs_state *state,
+                          const struct libblake_blake2xs_params *params) {
+	libblake_blake2s_compact(&compact->b2s, &state->b2s);
+	compact->params = params;
+}
+
+/**
+ * Restore a state for BLAKE2Xs hashing from its compact form
+ * 
+ * @param  state    Output parameter for the state
+ * @param  compact  The compact state, as stored by `libblake_blake2xs_compact`
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2xs_expand(struct libblake_blake2xs_state *state, const struct libblake_blake2xs_compact_state *compact);
+
+/**
+ * Serialise a state for BLAKE2Xs hashing
+ * 
+ * The output is independent of the machine and of
+ * the library version's in-memory representation,
+ * and can be restored with `libblake_blake2xs_import`
+ * 
+ * @param   state   The state to serialise
+ * @param   buffer  Output buffer, may be `NULL` if `size` is 0
+ * @param   size    The size of `buffer`
+ * @return          The number of bytes required for the output; if
+ *                  greater than `size`, nothing is written to `buffer`
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2xs_export(const struct libblake_blake2xs_state *state, void *buffer, size_t size);
+
+/**
+ * Restore a state for BLAKE2Xs hashing,
+ * serialised with `libblake_blake2xs_export`
+ * 
+ * @param   state   Output parameter for the state;
+ *                  not modified on failure
+ * @param   buffer  The serialised state
+ * @param   len     The number of bytes in `buffer`
+ * @return          0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `buffer` does not contain a state for
+ *                  BLAKE2Xs hashing in a supported format
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2xs_import(struct libblake_blake2xs_state *state, const void *buffer, size_t len);
+
+/**
+ * Serialise a buffered state for BLAKE2Xs hashing
+ * 
+ * The output is independent of the machine and of
+ * the library version's in-memory representation,
+ * and can be restored with `libblake_blake2xs_stream_import`
+ * 
+ * @param   stream  The buffered state to serialise
+ * @param   buffer  Output buffer, may be `NULL` if `size` is 0
+ * @param   size    The size of `buffer`
+ * @return          The number of bytes required for the output; if
+ *                  greater than `size`, nothing is written to `buffer`
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2xs_stream_export(const struct libblake_blake2xs_stream *stream, void *buffer, size_t size);
+
+/**
+ * Restore a buffered state for BLAKE2Xs hashing,
+ * serialised with `libblake_blake2xs_stream_export`
+ * 
+ * @param   stream  Output parameter for the buffered state;
+ *                  not modified on failure
+ * @param   buffer  The serialised buffered state
+ * @param   len     The number of bytes in `buffer`
+ * @return          0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `buffer` does not contain a buffered state for
+ *                  BLAKE2Xs hashing in a supported format
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2xs_stream_import(struct libblake_blake2xs_stream *stream, const void *buffer, size_t len);
+
 
 
 /**
@@ -1318,6 +5816,26 @@ libblake_blake2xb_predigest(struct libblake_blake2xb_state *state, void *data, s
 	libblake_blake2b_digest(&state->b2b, data, len, last_node, state->xof_params.digest_len, state->intermediate);
 }
 
+/**
+ * Perform intermediate hashing calculation for
+ * a BLAKE2Xb hash at the end of the input data
+ * 
+ * This function behaves like `libblake_blake2xb_predigest`
+ * except it does not write to `data`, so no additional
+ * space is required, and `data` may be read-only
+ * 
+ * @param  state       The state of the hash function
+ * @param  data        The last data to process, may be `NULL` if `len` is 0
+ * @param  len         The number of input bytes
+ * @param  last_node   Shall be non-0 the last node at each level in the
+ *                     hashing tree, include the root node, however, it
+ *                     shall be 0 if not using tree-hashing
+ */
+LIBBLAKE_PUBLIC__ inline void
+libblake_blake2xb_predigest_const(struct libblake_blake2xb_state *state, const void *data, size_t len, int last_node) {
+	libblake_blake2b_digest_const(&state->b2b, data, len, last_node, (size_t)state->xof_params.digest_len, state->intermediate);
+}
+
 /**
  * Calculate part of a BLAKE2Xb hashing
  * 
@@ -1343,6 +5861,231 @@ LIBBLAKE_PUBLIC__ void
 libblake_blake2xb_digest(const struct libblake_blake2xb_state *state, uint_least32_t i,
                          uint_least8_t len, unsigned char output[static len]);
 
+/**
+ * Initialise a buffered state for hashing with BLAKE2Xb
+ * 
+ * NB! BLAKE2X has not been finalised as of 2022-02-20
+ * 
+ * @param  stream  The state to initialise
+ * @param  params  Hashing parameters
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2xb_stream_init(struct libblake_blake2xb_stream *stream, const struct libblake_blake2xb_params *params);
+
+/**
+ * Process data for hashing with BLAKE2Xb
+ * 
+ * Unlike `libblake_blake2xb_update`, this function
+ * processes all input data: up to one block of
+ * data is stored in the state and is processed
+ * when more data is input or when
+ * `libblake_blake2xb_stream_predigest` is called
+ * 
+ * @param  stream  The state of the hash function
+ * @param  data    The data to feed into the function
+ * @param  len     The number of bytes to process
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2xb_stream_update(struct libblake_blake2xb_stream *stream, const void *data, size_t len);
+
+/**
+ * Process the contents of a file for BLAKE2Xb hashing
+ * 
+ * Holes in sparse files are hashed without being read,
+ * large regular files that are sealed against shrinking
+ * (see memfd_create(2)) are mapped into memory rather
+ * than read, other files are read with large buffers
+ * (a mapped file that is truncated while it is hashed
+ * would kill the process with SIGBUS), and if
+ * they are not regular files (for example pipes
+ * and sockets), they are read on a separate thread so
+ * that reading and hashing overlap; either way, the
+ * data is not copied more than
+ * `libblake_blake2xb_stream_update` requires
+ * 
+ * @param   stream  The state of the hash function
+ * @param   fd      The file descriptor to read, from its current
+ *                  offset until the end of the file
+ * @return          0 on success, -1 on failure; on failure,
+ *                  some data may have been processed
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  EIO     The file was truncated while it was being hashed
+ * @throws  -       Any error specified for fstat(3) or read(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2xb_stream_update_fd(struct libblake_blake2xb_stream *stream, int fd);
+
+/**
+ * Process the contents of a file for BLAKE2Xb hashing,
+ * see `libblake_blake2xb_stream_update_fd` for details
+ * 
+ * @param   stream  The state of the hash function
+ * @param   path    The file to read
+ * @return          0 on success, -1 on failure; on failure,
+ *                  some data may have been processed
+ * 
+ * @throws  ENOMEM  Insufficient memory available
+ * @throws  -       Any error specified for open(3), fstat(3) or read(3)
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2xb_stream_update_path(struct libblake_blake2xb_stream *stream, const char *path);
+
+/**
+ * Perform intermediate hashing calculation for
+ * a BLAKE2Xb hash at the end of the input data
+ * 
+ * The `stream` parameter must have been initialised using
+ * the `libblake_blake2xb_stream_init` function, after which,
+ * but before this function is called,
+ * `libblake_blake2xb_stream_update` can be used to process
+ * data before this function is called. Unlike
+ * `libblake_blake2xb_predigest`, this function does not
+ * write to `data`, so no additional space is required
+ * 
+ * @param  stream     The state of the hash function
+ * @param  data       The last data to process, may be `NULL` if `len` is 0
+ * @param  len        The number of input bytes
+ * @param  last_node  Shall be non-0 the last node at each level in the
+ *                    hashing tree, include the root node, however, it
+ *                    shall be 0 if not using tree-hashing
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2xb_stream_predigest(struct libblake_blake2xb_stream *stream, const void *data, size_t len, int last_node);
+
+/**
+ * Perform intermediate hashing calculation for a
+ * BLAKE2Xb hash of the data input so far, without
+ * finalising the state
+ * 
+ * Unlike `libblake_blake2xb_stream_predigest`, `stream`
+ * is not modified, so more data can be input afterwards;
+ * instead the result is stored in `snapshot`, which
+ * can then be used with `libblake_blake2xb_digest`
+ * 
+ * @param  stream     The state of the hash function
+ * @param  last_node  Shall be non-0 the last node at each level in the
+ *                    hashing tree, include the root node, however, it
+ *                    shall be 0 if not using tree-hashing
+ * @param  snapshot   Output parameter for the finalised copy of the state
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2xb_stream_peek(const struct libblake_blake2xb_stream *stream, int last_node, struct libblake_blake2xb_state *snapshot);
+
+/**
+ * Calculate part of a BLAKE2Xb hashing
+ * 
+ * This function is identical to `libblake_blake2xb_digest`
+ * 
+ * The `stream` parameter must have preprocessed
+ * using the `libblake_blake2xb_stream_predigest` function
+ * 
+ * @param  stream  The state of the hash function
+ * @param  i       The index of the portion of the hash that
+ *                 shall be calculated, that is, the offset in
+ *                 the hash divided by 64
+ * @param  len     Given the desired total hash length, in bytes,
+ *                 `length`, `len` shall be the minimum of `64`
+ *                 and `length - i * 64`
+ * @param  output  Output buffer for the hash offset by `i * 64`
+ */
+LIBBLAKE_PUBLIC__ inline void
+libblake_blake2xb_stream_digest(const struct libblake_blake2xb_stream *stream, uint_least32_t i,
+                                uint_least8_t len, unsigned char output[static len]) {
+	libblake_blake2xb_digest(&stream->state, i, len, output);
+}
+
+/**
+ * Store a state for BLAKE2Xb hashing in a compact form
+ * 
+ * The state must not have been finalised
+ * 
+ * @param  compact  Output parameter for the compact state
+ * @param  state    The state to store
+ * @param  params   The parameters `state` was initialised with; this
+ *                  is not copied, so it must be kept unmodified until
+ *                  `compact` is no longer used
+ */
+LIBBLAKE_PUBLIC__ inline void
+libblake_blake2xb_compact(struct libblake_blake2xb_compact_state *compact, const struct libblake_blake2xb_state *state,
+                          const struct libblake_blake2xb_params *params) {
+	libblake_blake2b_compact(&compact->b2b, &state->b2b);
+	compact->params = params;
+}
+
+/**
+ * Restore a state for BLAKE2Xb hashing from its compact form
+ * 
+ * @param  state    Output parameter for the state
+ * @param  compact  The compact state, as stored by `libblake_blake2xb_compact`
+ */
+LIBBLAKE_PUBLIC__ void
+libblake_blake2xb_expand(struct libblake_blake2xb_state *state, const struct libblake_blake2xb_compact_state *compact);
+
+/**
+ * Serialise a state for BLAKE2Xb hashing
+ * 
+ * The output is independent of the machine and of
+ * the library version's in-memory representation,
+ * and can be restored with `libblake_blake2xb_import`
+ * 
+ * @param   state   The state to serialise
+ * @param   buffer  Output buffer, may be `NULL` if `size` is 0
+ * @param   size    The size of `buffer`
+ * @return          The number of bytes required for the output; if
+ *                  greater than `size`, nothing is written to `buffer`
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2xb_export(const struct libblake_blake2xb_state *state, void *buffer, size_t size);
+
+/**
+ * Restore a state for BLAKE2Xb hashing,
+ * serialised with `libblake_blake2xb_export`
+ * 
+ * @param   state   Output parameter for the state;
+ *                  not modified on failure
+ * @param   buffer  The serialised state
+ * @param   len     The number of bytes in `buffer`
+ * @return          0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `buffer` does not contain a state for
+ *                  BLAKE2Xb hashing in a supported format
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2xb_import(struct libblake_blake2xb_state *state, const void *buffer, size_t len);
+
+/**
+ * Serialise a buffered state for BLAKE2Xb hashing
+ * 
+ * The output is independent of the machine and of
+ * the library version's in-memory representation,
+ * and can be restored with `libblake_blake2xb_stream_import`
+ * 
+ * @param   stream  The buffered state to serialise
+ * @param   buffer  Output buffer, may be `NULL` if `size` is 0
+ * @param   size    The size of `buffer`
+ * @return          The number of bytes required for the output; if
+ *                  greater than `size`, nothing is written to `buffer`
+ */
+LIBBLAKE_PUBLIC__ size_t
+libblake_blake2xb_stream_export(const struct libblake_blake2xb_stream *stream, void *buffer, size_t size);
+
+/**
+ * Restore a buffered state for BLAKE2Xb hashing,
+ * serialised with `libblake_blake2xb_stream_export`
+ * 
+ * @param   stream  Output parameter for the buffered state;
+ *                  not modified on failure
+ * @param   buffer  The serialised buffered state
+ * @param   len     The number of bytes in `buffer`
+ * @return          0 on success, -1 on failure
+ * 
+ * @throws  EINVAL  `buffer` does not contain a buffered state for
+ *                  BLAKE2Xb hashing in a supported format
+ */
+LIBBLAKE_PUBLIC__ int
+libblake_blake2xb_stream_import(struct libblake_blake2xb_stream *stream, const void *buffer, size_t len);
+
 
 
 #if defined(__clang__)
@@ -0,0 +1,13 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake224_digest_const(struct libblake_blake224_state *state, const void *data, size_t len, size_t bits,
+                               const char *suffix, unsigned char output[static LIBBLAKE_BLAKE224_OUTPUT_SIZE])
+{
+	unsigned char buffer[128];
+	size_t buffered = 0;
+
+	libblake_internal_blakes_stream_digest(&state->s, buffer, &buffered,
+	                                       data, len, bits, suffix, output, 224 / 32);
+}
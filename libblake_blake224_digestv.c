@@ -0,0 +1,9 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake224_digestv(struct libblake_blake224_state *state, const struct iovec *iov, size_t iovcnt, size_t bits,
+                          const char *suffix, unsigned char output[static LIBBLAKE_BLAKE224_OUTPUT_SIZE])
+{
+	libblake_internal_blakes_digestv(&state->s, iov, iovcnt, bits, suffix, output, 224 / 32);
+}
@@ -0,0 +1,8 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+size_t
+libblake_blake224_export(const struct libblake_blake224_state *state, void *buffer, size_t size)
+{
+	return libblake_internal_blakes_export(&state->s, EXPORT_BLAKE224, NULL, 0, buffer, size);
+}
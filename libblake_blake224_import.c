@@ -0,0 +1,9 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake224_import(struct libblake_blake224_state *state, const void *buffer, size_t len)
+{
+	size_t nbuffered = 0;
+	return libblake_internal_blakes_import(&state->s, EXPORT_BLAKE224, NULL, &nbuffered, buffer, len);
+}
@@ -0,0 +1,10 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake224_stream_digest(struct libblake_blake224_stream *stream, const void *data, size_t len, size_t bits,
+                                const char *suffix, unsigned char output[static LIBBLAKE_BLAKE224_OUTPUT_SIZE])
+{
+	libblake_internal_blakes_stream_digest(&stream->state.s, stream->buffer, &stream->buffered,
+	                                       data, len, bits, suffix, output, 224 / 32);
+}
@@ -0,0 +1,4 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+extern inline void libblake_blake224_stream_init(struct libblake_blake224_stream *stream);
@@ -0,0 +1,9 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake224_stream_init2(struct libblake_blake224_stream *stream, const uint_least8_t salt[16])
+{
+	libblake_blake224_init2(&stream->state, salt);
+	stream->buffered = 0;
+}
@@ -0,0 +1,8 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake224_stream_update(struct libblake_blake224_stream *stream, const void *data, size_t len)
+{
+	libblake_internal_blakes_stream_update(&stream->state.s, stream->buffer, &stream->buffered, data, len);
+}
@@ -0,0 +1,8 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+size_t
+libblake_blake224_updatev(struct libblake_blake224_state *state, const struct iovec *iov, size_t iovcnt)
+{
+	return libblake_internal_blakes_updatev(&state->s, iov, iovcnt);
+}
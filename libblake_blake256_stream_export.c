@@ -0,0 +1,8 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+size_t
+libblake_blake256_stream_export(const struct libblake_blake256_stream *stream, void *buffer, size_t size)
+{
+	return libblake_internal_blakes_export(&stream->state.s, EXPORT_BLAKE256 | EXPORT_STREAM, stream->buffer, stream->buffered, buffer, size);
+}
@@ -0,0 +1,12 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake256_stream_import(struct libblake_blake256_stream *stream, const void *buffer, size_t len)
+{
+	size_t nbuffered = 63;
+	if (libblake_internal_blakes_import(&stream->state.s, EXPORT_BLAKE256 | EXPORT_STREAM, stream->buffer, &nbuffered, buffer, len))
+		return -1;
+	stream->buffered = nbuffered;
+	return 0;
+}
@@ -0,0 +1,9 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake256_stream_init2(struct libblake_blake256_stream *stream, const uint_least8_t salt[16])
+{
+	libblake_blake256_init2(&stream->state, salt);
+	stream->buffered = 0;
+}
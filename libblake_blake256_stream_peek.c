@@ -0,0 +1,8 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake256_stream_peek(const struct libblake_blake256_stream *stream, unsigned char output[static LIBBLAKE_BLAKE256_OUTPUT_SIZE])
+{
+	libblake_internal_blakes_stream_peek(&stream->state.s, stream->buffer, stream->buffered, output, 256 / 32);
+}
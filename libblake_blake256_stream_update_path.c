@@ -0,0 +1,14 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+static void
+update(void *stream, const void *data, size_t len)
+{
+	libblake_blake256_stream_update(stream, data, len);
+}
+
+int
+libblake_blake256_stream_update_path(struct libblake_blake256_stream *stream, const char *path)
+{
+	return libblake_internal_update_path(path, &update, stream);
+}
@@ -0,0 +1,58 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2b(void *output, size_t output_len, const void *data_, size_t len, const void *key, size_t key_len)
+{
+	struct libblake_blake2b_state state;
+	unsigned char block[128];
+	const unsigned char *data = data_;
+	size_t r;
+
+	/* Instead of going through libblake_blake2b_init, the
+	 * parameter block, which only has non-zero values in the
+	 * first word (digest length, key length, fan-out 1 and
+	 * depth 1) is applied to the IV directly */
+	state.h[0] = UINT_LEAST64_C(0x6A09E667F3BCC908) ^ UINT_LEAST64_C(0x01010000) ^ (uint_least64_t)(key_len << 8) ^ (uint_least64_t)output_len;
+	state.h[1] = UINT_LEAST64_C(0xBB67AE8584CAA73B);
+	state.h[2] = UINT_LEAST64_C(0x3C6EF372FE94F82B);
+	state.h[3] = UINT_LEAST64_C(0xA54FF53A5F1D36F1);
+	state.h[4] = UINT_LEAST64_C(0x510E527FADE682D1);
+	state.h[5] = UINT_LEAST64_C(0x9B05688C2B3E6C1F);
+	state.h[6] = UINT_LEAST64_C(0x1F83D9ABFB41BD6B);
+	state.h[7] = UINT_LEAST64_C(0x5BE0CD19137E2179);
+	state.t[0] = 0;
+	state.t[1] = 0;
+	state.f[0] = 0;
+	state.f[1] = 0;
+
+	if (key_len) {
+		memcpy(block, key, key_len);
+		memset(&block[key_len], 0, sizeof(block) - key_len);
+		state.t[0] = 128;
+		if (!len)
+			goto last;
+		libblake_internal_blake2b_compress(&state, block);
+	}
+
+	/* Messages of at most one block, which is the common
+	 * case for this function, go straight to the last block */
+	if (len > 128) {
+		r = libblake_blake2b_update(&state, data, len);
+		data = &data[r];
+		len -= r;
+	}
+
+	if (len)
+		memcpy(block, data, len);
+	memset(&block[len], 0, sizeof(block) - len);
+	state.t[0] = (state.t[0] + len) & UINT_LEAST64_C(0xFFFFffffFFFFffff);
+	if (UNLIKELY(state.t[0] < len))
+		state.t[1] = (state.t[1] + 1) & UINT_LEAST64_C(0xFFFFffffFFFFffff);
+
+last:
+	state.f[0] = UINT_LEAST64_C(0xFFFFffffFFFFffff);
+	libblake_internal_blake2b_compress(&state, block);
+
+	libblake_internal_blake2b_output_digest(&state, output_len, output);
+}
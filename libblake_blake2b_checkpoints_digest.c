@@ -0,0 +1,11 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2b_checkpoints_digest(const struct libblake_blake2b_checkpoints *index, const void *data, size_t len, int last_node,
+                                    size_t output_len, unsigned char output[static output_len])
+{
+	struct libblake_blake2b_state state;
+	size_t off = libblake_blake2b_checkpoints_seek(index, len, &state);
+	libblake_blake2b_digest_const(&state, &((const unsigned char *)data)[off], len - off, last_node, output_len, output);
+}
@@ -0,0 +1,17 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+size_t
+libblake_blake2b_checkpoints_export(const struct libblake_blake2b_checkpoints *index, void *buffer, size_t size)
+{
+	unsigned char bytes[16];
+	size_t i;
+
+	for (i = 0; i < 8; i++) {
+		bytes[i + 0] = (unsigned char)(((uint_least64_t)index->interval >> (i * 8)) & 255);
+		bytes[i + 8] = (unsigned char)(((uint_least64_t)index->blocks >> (i * 8)) & 255);
+	}
+
+	return libblake_internal_export(EXPORT_BLAKE2B | EXPORT_CHECKPOINTS, sizeof(*index->words),
+	                                index->words, index->count * 8, bytes, sizeof(bytes), buffer, size);
+}
@@ -0,0 +1,24 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+size_t
+libblake_blake2b_checkpoints_seek(const struct libblake_blake2b_checkpoints *index, size_t len, struct libblake_blake2b_state *state)
+{
+	size_t i;
+	uint_least64_t offset;
+
+	/* The checkpoint must be before the end of the prefix as
+	 * the last block must be compressed as the final block */
+	i = len ? (len - 1) / 128 / index->interval : 0;
+	if (i >= index->count)
+		i = index->count - 1;
+	offset = (uint_least64_t)i * (uint_least64_t)index->interval * 128;
+
+	memcpy(state->h, &index->words[i * 8], sizeof(state->h));
+	state->t[0] = offset;
+	state->t[1] = 0;
+	state->f[0] = 0;
+	state->f[1] = 0;
+
+	return (size_t)offset;
+}
@@ -0,0 +1,45 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake2b_chunker_create(struct libblake_blake2b_chunker *chunker, const struct libblake_blake2b_params *params,
+                                const void *key, size_t min_size, size_t avg_size, size_t max_size)
+{
+	unsigned char key_block[128];
+	unsigned int bits = 0;
+
+	if (!min_size || min_size > avg_size || avg_size > max_size || avg_size < 8) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* A boundary is found with the probability 2^-(bits + 1) per byte
+	 * before the average chunk size and 2^-(bits - 1) after it */
+	while ((avg_size >> bits) > 1)
+		bits += 1;
+	if (bits > 62)
+		bits = 62;
+	chunker->mask_s = ~(UINT_LEAST64_C(0xFFFFffffFFFFffff) >> (bits + 1)) & UINT_LEAST64_C(0xFFFFffffFFFFffff);
+	chunker->mask_l = ~(UINT_LEAST64_C(0xFFFFffffFFFFffff) >> (bits - 1)) & UINT_LEAST64_C(0xFFFFffffFFFFffff);
+	chunker->min_size = min_size;
+	chunker->avg_size = avg_size;
+	chunker->max_size = max_size;
+	chunker->offset = 0;
+	chunker->digest_len = (size_t)params->digest_len;
+
+	/* Chunks are never empty, so the key block is never the last block */
+	libblake_blake2b_init(&chunker->initial, params);
+	if (params->key_len) {
+		memset(key_block, 0, sizeof(key_block));
+		memcpy(key_block, key, (size_t)params->key_len);
+		libblake_blake2b_force_update(&chunker->initial, key_block, sizeof(key_block));
+	}
+
+	if (libblake_blake2b_table_create(&chunker->table, CHUNKER_GROUP))
+		return -1;
+	if (libblake_blake2b_scheduler_create(&chunker->scheduler, &chunker->table, CHUNKER_GROUP)) {
+		libblake_blake2b_table_destroy(&chunker->table);
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,9 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2b_chunker_destroy(struct libblake_blake2b_chunker *chunker)
+{
+	libblake_blake2b_scheduler_destroy(&chunker->scheduler);
+	libblake_blake2b_table_destroy(&chunker->table);
+}
@@ -0,0 +1,208 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+/* Random values used by the gear hash, one per byte value */
+static const uint_least64_t gear[256] = {
+	UINT_LEAST64_C(0x0B1E506961B24015), UINT_LEAST64_C(0xB50C2E7465D0A591),
+	UINT_LEAST64_C(0xF52E3794EC22473E), UINT_LEAST64_C(0x9883B1982D7B854A),
+	UINT_LEAST64_C(0x7B5C8BFA953F9537), UINT_LEAST64_C(0xFDD06F947867537F),
+	UINT_LEAST64_C(0x1EE845DAC3D872EB), UINT_LEAST64_C(0xE523934445C5CDC4),
+	UINT_LEAST64_C(0x19B949C377F188EA), UINT_LEAST64_C(0x0C640BBBA038B55D),
+	UINT_LEAST64_C(0x9E4C23A49497E6A8), UINT_LEAST64_C(0x06C17CD6E589557C),
+	UINT_LEAST64_C(0x50D8463B429FA265), UINT_LEAST64_C(0x1DDCE520A82B71B8),
+	UINT_LEAST64_C(0x54460C74733970EA), UINT_LEAST64_C(0x5D9BD87E26B4764B),
+	UINT_LEAST64_C(0x5DBAC96D27FABAFF), UINT_LEAST64_C(0x2F4A67006549DCF3),
+	UINT_LEAST64_C(0xC93BECF812ED2F70), UINT_LEAST64_C(0x0F050967E8ECD963),
+	UINT_LEAST64_C(0x75055A6CE7091307), UINT_LEAST64_C(0x910216E0E4A570B2),
+	UINT_LEAST64_C(0xCA116A1F97F6BE67), UINT_LEAST64_C(0xF96623A7B72567AB),
+	UINT_LEAST64_C(0x02764301DA655200), UINT_LEAST64_C(0xFC6A52EAD2E97562),
+	UINT_LEAST64_C(0x1FD14984161DB35E), UINT_LEAST64_C(0xB526B2ABD7EA5C35),
+	UINT_LEAST64_C(0xCB28A9E9B5D078B5), UINT_LEAST64_C(0xC35C85A656D2C2B7),
+	UINT_LEAST64_C(0x75F4246E8A8412BC), UINT_LEAST64_C(0x42B6341D2ABC7B8D),
+	UINT_LEAST64_C(0xF934E137955A8D94), UINT_LEAST64_C(0x7C4BB9BA0C95F6A4),
+	UINT_LEAST64_C(0x9E8668CDCF0363CB), UINT_LEAST64_C(0xF6440453746A0AB8),
+	UINT_LEAST64_C(0x1DA0C74A10408073), UINT_LEAST64_C(0x4CB6BE5677648ED6),
+	UINT_LEAST64_C(0x322C9072CC55F0B7), UINT_LEAST64_C(0x9261CB8D40C7247F),
+	UINT_LEAST64_C(0x3560675345FCEC39), UINT_LEAST64_C(0x84197F9A7E17D170),
+	UINT_LEAST64_C(0xFAF7A1D2B4CD1249), UINT_LEAST64_C(0x5DFDEE3D80E46F94),
+	UINT_LEAST64_C(0x4B0A0D07D38406D1), UINT_LEAST64_C(0xE1B1FE10C9CD569B),
+	UINT_LEAST64_C(0x772AEB1D31099340), UINT_LEAST64_C(0x82FFE195E8ACF6C0),
+	UINT_LEAST64_C(0xF39E1F124F948F0F), UINT_LEAST64_C(0xAE1880280463A7BD),
+	UINT_LEAST64_C(0xC6EBEF500EF69D21), UINT_LEAST64_C(0x0962B7EBE3F33D36),
+	UINT_LEAST64_C(0x7B88499EFCD9A11C), UINT_LEAST64_C(0x078E804E5C93547E),
+	UINT_LEAST64_C(0x4778A2C1920B74BA), UINT_LEAST64_C(0xA6BBB1CD77BA98A7),
+	UINT_LEAST64_C(0xA49DB3D6B4A2EB32), UINT_LEAST64_C(0x9A5F17FAA41D6543),
+	UINT_LEAST64_C(0xC6FDC0E027A37690), UINT_LEAST64_C(0xE28A977B7A85ACB5),
+	UINT_LEAST64_C(0x8DB0C6E7E7512BA5), UINT_LEAST64_C(0x86ECF1B4185DDAB2),
+	UINT_LEAST64_C(0xF181286EDDC4300D), UINT_LEAST64_C(0x001DB36FB9A60862),
+	UINT_LEAST64_C(0xCEE5C185799D4530), UINT_LEAST64_C(0x8F1CCFEEBCAB0086),
+	UINT_LEAST64_C(0x025E191BE35BEBE4), UINT_LEAST64_C(0x1E70E6778ED867DE),
+	UINT_LEAST64_C(0x58FDAD98BC1E3411), UINT_LEAST64_C(0x6862FA6BACDF39E4),
+	UINT_LEAST64_C(0xB4C60F3C5CEBBC19), UINT_LEAST64_C(0x5A557DDA25B9F175),
+	UINT_LEAST64_C(0xFD50F787B7317624), UINT_LEAST64_C(0xB37B4C7B1636E48E),
+	UINT_LEAST64_C(0x97834C59E74FA75A), UINT_LEAST64_C(0x4B0456035A7A5478),
+	UINT_LEAST64_C(0x88FC5B66D2FA04B7), UINT_LEAST64_C(0xEB37D640ACAB1A67),
+	UINT_LEAST64_C(0x7DC28E77E6A02BC6), UINT_LEAST64_C(0xED43F367E0566DB8),
+	UINT_LEAST64_C(0x062884322A62309A), UINT_LEAST64_C(0x4A923A992A6EC5FB),
+	UINT_LEAST64_C(0x511EE34996923DA7), UINT_LEAST64_C(0x3EE64D6C98274C4C),
+	UINT_LEAST64_C(0x1A0E0FC8DB4BD99D), UINT_LEAST64_C(0x971A309DBF2C0A9C),
+	UINT_LEAST64_C(0xDEF12101E0543EE2), UINT_LEAST64_C(0x3E5633FA1E2960EB),
+	UINT_LEAST64_C(0x010FDC4BF9209080), UINT_LEAST64_C(0x2E05432DA3E3515D),
+	UINT_LEAST64_C(0x8F9DF5E6B7DCCA7F), UINT_LEAST64_C(0x87E46E98DB80189B),
+	UINT_LEAST64_C(0x5582D73D92D8E787), UINT_LEAST64_C(0x70299E8BF2E701D8),
+	UINT_LEAST64_C(0x65AD0495B9876568), UINT_LEAST64_C(0x93C6DE9E2501CB05),
+	UINT_LEAST64_C(0xE7E550E34724BD0E), UINT_LEAST64_C(0xC2757CA8A30EEDE5),
+	UINT_LEAST64_C(0x2B6EF57260A52F37), UINT_LEAST64_C(0x53C8E5EB12FBFE61),
+	UINT_LEAST64_C(0x8DE952CEA220BDD6), UINT_LEAST64_C(0x5DCD975F3FAC02FF),
+	UINT_LEAST64_C(0xD1202C5C21BC9180), UINT_LEAST64_C(0xCA50089DCE7D095E),
+	UINT_LEAST64_C(0x338DA646E343F2DC), UINT_LEAST64_C(0x17EEA52759B274F3),
+	UINT_LEAST64_C(0x53F4CB92ADAC8F00), UINT_LEAST64_C(0xA101A5F93BD6A5E7),
+	UINT_LEAST64_C(0x6C5B987BE9A62029), UINT_LEAST64_C(0x4C221CBE217456A1),
+	UINT_LEAST64_C(0x61B3CD1E196184DE), UINT_LEAST64_C(0x7189E8FE406C879E),
+	UINT_LEAST64_C(0x2ABD6D98955DE20F), UINT_LEAST64_C(0xD46B8ED663707619),
+	UINT_LEAST64_C(0xD49A9B408EE29A45), UINT_LEAST64_C(0xA810E01A7E1C939E),
+	UINT_LEAST64_C(0xD6637DC68882B012), UINT_LEAST64_C(0x6983794C64A7DD2F),
+	UINT_LEAST64_C(0xAB0F83C6D6DBEFB7), UINT_LEAST64_C(0x0CA88455B251DF61),
+	UINT_LEAST64_C(0x1CBBED39EECA8F79), UINT_LEAST64_C(0xFC68DD7F3CD6D057),
+	UINT_LEAST64_C(0x004AF73937F3FE70), UINT_LEAST64_C(0x4DD0E8FA1C191870),
+	UINT_LEAST64_C(0xB520FE919746489C), UINT_LEAST64_C(0x2083D9A1F3A0C1C6),
+	UINT_LEAST64_C(0x7FB303B83A8A8F63), UINT_LEAST64_C(0x1D7CD71B36811518),
+	UINT_LEAST64_C(0x999BF35B08D8666D), UINT_LEAST64_C(0x7C5E07EB94B92432),
+	UINT_LEAST64_C(0xB2CD1489619B482C), UINT_LEAST64_C(0xFC97343CBD5885D5),
+	UINT_LEAST64_C(0x3FC99253DC14BA10), UINT_LEAST64_C(0x6C06FAAC3B72DA48),
+	UINT_LEAST64_C(0xE5712C2901E8B8EC), UINT_LEAST64_C(0xD33BF0F96C6F8948),
+	UINT_LEAST64_C(0x2554176CD702DB33), UINT_LEAST64_C(0x9409FA46D351B34D),
+	UINT_LEAST64_C(0xA22A7E0EE3578DD7), UINT_LEAST64_C(0xC510CD3D2DB286FC),
+	UINT_LEAST64_C(0x5FA5E9E877DB7AE4), UINT_LEAST64_C(0x9AE03E3D6F4F2D36),
+	UINT_LEAST64_C(0xB44F8059D2FA1F83), UINT_LEAST64_C(0xFFAE0F9710DBA860),
+	UINT_LEAST64_C(0xFBEECEAB991BBD87), UINT_LEAST64_C(0xEEC551200B3A5DD8),
+	UINT_LEAST64_C(0x1AC7110EDA387792), UINT_LEAST64_C(0x0225EF50E8CC7D09),
+	UINT_LEAST64_C(0x657E9BBA1043AB1E), UINT_LEAST64_C(0xE700795B0A19FCC1),
+	UINT_LEAST64_C(0x04035B9BBB1C3B70), UINT_LEAST64_C(0x59B5C95470A825AA),
+	UINT_LEAST64_C(0xEA1FE006CCDE56A9), UINT_LEAST64_C(0xF72A52348867ADA5),
+	UINT_LEAST64_C(0x86DC189846A46E38), UINT_LEAST64_C(0xA63E5ECB4B6463DC),
+	UINT_LEAST64_C(0x62DD0F0A8A4861A2), UINT_LEAST64_C(0x7872C7E49CD4CA10),
+	UINT_LEAST64_C(0x090C743A94584130), UINT_LEAST64_C(0xEC05DECBADF1427D),
+	UINT_LEAST64_C(0x9BB93AB8E4811A8D), UINT_LEAST64_C(0x26AC85374B66A05E),
+	UINT_LEAST64_C(0x199F1A69ED904781), UINT_LEAST64_C(0xB7023A442D853C71),
+	UINT_LEAST64_C(0xED0CAA6483CF7AE2), UINT_LEAST64_C(0x636A1621CEF8B590),
+	UINT_LEAST64_C(0x58E4F7CCBE69600F), UINT_LEAST64_C(0xE34C383B71589808),
+	UINT_LEAST64_C(0x023BA4332ADC9150), UINT_LEAST64_C(0x7DED2588C9A39FD3),
+	UINT_LEAST64_C(0xC16942F44909DDA2), UINT_LEAST64_C(0xBE525B92D8B9BA96),
+	UINT_LEAST64_C(0xE56BFF2467ECCCA5), UINT_LEAST64_C(0xAF38F72BC713E95C),
+	UINT_LEAST64_C(0x381AE40281CBDEB8), UINT_LEAST64_C(0x5AFD9E26F7CAE06C),
+	UINT_LEAST64_C(0x17A333AE9E05D4AA), UINT_LEAST64_C(0xD8A140DE6F4CA79F),
+	UINT_LEAST64_C(0x34F5117189C3E29E), UINT_LEAST64_C(0x729CD7031A46CB7C),
+	UINT_LEAST64_C(0xD5360FD08601A7D5), UINT_LEAST64_C(0xFFC38C2F8FA56245),
+	UINT_LEAST64_C(0xDE1B0810F2557635), UINT_LEAST64_C(0x495ADF5732243B05),
+	UINT_LEAST64_C(0xC7E373343CD05ED4), UINT_LEAST64_C(0x2BBA4929C9E4F6B3),
+	UINT_LEAST64_C(0xE047524387E61E00), UINT_LEAST64_C(0xF9DE3A2A64EEDD65),
+	UINT_LEAST64_C(0x3FA974A1BD543FCA), UINT_LEAST64_C(0x2B9B75CD88456C71),
+	UINT_LEAST64_C(0x29CD78E7BD8DD3CB), UINT_LEAST64_C(0x2539BC09AC3335EC),
+	UINT_LEAST64_C(0x0B65C4F6CE52CF8D), UINT_LEAST64_C(0x074A73E2FB7E34D2),
+	UINT_LEAST64_C(0xB77F6162C87AE192), UINT_LEAST64_C(0xF716B351D16F7791),
+	UINT_LEAST64_C(0x5142B60365DB0058), UINT_LEAST64_C(0xD891DF4B3FAF4931),
+	UINT_LEAST64_C(0xE79B3F5DECBA8D4E), UINT_LEAST64_C(0x62EEE7503783FB81),
+	UINT_LEAST64_C(0xEB7D5B173B6BB96C), UINT_LEAST64_C(0xB3115F80A74F6C69),
+	UINT_LEAST64_C(0x4CC6569196D2754E), UINT_LEAST64_C(0xD42276B3E3D7193C),
+	UINT_LEAST64_C(0x7C72AF4D7A8C1069), UINT_LEAST64_C(0xF303491B3E6B6C1E),
+	UINT_LEAST64_C(0xCF3597E28F68C1AC), UINT_LEAST64_C(0x588F94018C9BDD0E),
+	UINT_LEAST64_C(0x2C9A79B388AE9319), UINT_LEAST64_C(0x081F1881E08D8D23),
+	UINT_LEAST64_C(0xFC8D5F14A8139EB1), UINT_LEAST64_C(0x0F28B2783F8AB477),
+	UINT_LEAST64_C(0xB9EB53330347052E), UINT_LEAST64_C(0x290A00D8A7D03D4D),
+	UINT_LEAST64_C(0x22AEFBA4E7A1CF3D), UINT_LEAST64_C(0x62BD094463960FB1),
+	UINT_LEAST64_C(0x00FDE7FCB8F3185C), UINT_LEAST64_C(0x5F50ADEFA2962331),
+	UINT_LEAST64_C(0x3F6E85EB5E98E395), UINT_LEAST64_C(0x60DEF237489B4196),
+	UINT_LEAST64_C(0xB14AEBE3EF2E6BBB), UINT_LEAST64_C(0x0E39704F1D89297D),
+	UINT_LEAST64_C(0x0F3CE3CA0172F147), UINT_LEAST64_C(0x67DE662C6FDA773F),
+	UINT_LEAST64_C(0x8B7E4912CFEE452D), UINT_LEAST64_C(0xE9045A90CC24ACD6),
+	UINT_LEAST64_C(0x3E9A84AC9A9F5F36), UINT_LEAST64_C(0xAFE0A1DFFE92BB03),
+	UINT_LEAST64_C(0xB7E56CB27127C2BC), UINT_LEAST64_C(0x2497B2D32233904B),
+	UINT_LEAST64_C(0xD05B6F778F967462), UINT_LEAST64_C(0xE6B0024343863C0B),
+	UINT_LEAST64_C(0xEA2DBEAA5DFE8BFC), UINT_LEAST64_C(0x14AA33241DB88F01),
+	UINT_LEAST64_C(0x6E6C40754A40B61E), UINT_LEAST64_C(0xF9AF1A5190960458),
+	UINT_LEAST64_C(0x937C533DF564AD8E), UINT_LEAST64_C(0x1D94D6F7C9A4CFC0),
+	UINT_LEAST64_C(0x92C7703CB8E7979A), UINT_LEAST64_C(0xC8D7E73B297D4764),
+	UINT_LEAST64_C(0xBD2B43121CE2EAB9), UINT_LEAST64_C(0x794CEE8BB3B7F834),
+	UINT_LEAST64_C(0x3AE47C58C419D3D3), UINT_LEAST64_C(0x1DBAC4ACD70CE0E8),
+	UINT_LEAST64_C(0xEEAD59E7945E2DF7), UINT_LEAST64_C(0xE1DDB173A8BEF18C),
+	UINT_LEAST64_C(0x9179C76960CB6173), UINT_LEAST64_C(0x895AA37A37F16016),
+	UINT_LEAST64_C(0x99A7FA23A1931AAB), UINT_LEAST64_C(0xB04AFDA2024C807B),
+	UINT_LEAST64_C(0x0F3A5D26EC0AEFA5), UINT_LEAST64_C(0x906C0714199FD5DA),
+	UINT_LEAST64_C(0x573B665BB0DA26B7), UINT_LEAST64_C(0x169BA16670B4FE0A),
+	UINT_LEAST64_C(0x2766CEC002BC9419), UINT_LEAST64_C(0x6F6E6A3EAE24C793),
+};
+
+static size_t
+find_cut(const struct libblake_blake2b_chunker *chunker, const unsigned char *data, size_t len)
+{
+	uint_least64_t h = 0;
+	size_t i, normal;
+
+	/* Returns `len` if no boundary was found within the maximum chunk size */
+	if (len <= chunker->min_size)
+		return len;
+	if (len > chunker->max_size)
+		len = chunker->max_size;
+	normal = len < chunker->avg_size ? len : chunker->avg_size;
+
+	/* The gear hash only depends on the last 64 bytes, so bytes before
+	 * the minimum chunk size can be skipped; the mask is stricter before
+	 * the average size and looser after it, which narrows the distribution
+	 * of chunk sizes; the masks select high bits as they depend on more
+	 * bytes than the low bits */
+	for (i = chunker->min_size; i < normal; i++) {
+		h = ((h << 1) + gear[data[i]]) & UINT_LEAST64_C(0xFFFFffffFFFFffff);
+		if (!(h & chunker->mask_s))
+			return i + 1;
+	}
+	for (; i < len; i++) {
+		h = ((h << 1) + gear[data[i]]) & UINT_LEAST64_C(0xFFFFffffFFFFffff);
+		if (!(h & chunker->mask_l))
+			return i + 1;
+	}
+	return len;
+}
+
+size_t
+libblake_blake2b_chunker_update(struct libblake_blake2b_chunker *chunker, const void *data_, size_t len, int end,
+                                struct libblake_blake2b_chunk *chunks, size_t max_chunks, size_t *nchunksp)
+{
+	const unsigned char *data = data_;
+	struct libblake_blake2b_state state;
+	size_t off = 0, n = 0, group, cut, k, starts[CHUNKER_GROUP], done[CHUNKER_GROUP];
+	int more = 1;
+
+	while (more && n < max_chunks && off < len) {
+		/* Find the boundaries of a few chunks ... */
+		for (group = 0; group < CHUNKER_GROUP && n + group < max_chunks && off < len; group++) {
+			cut = find_cut(chunker, &data[off], len - off);
+			if (cut == len - off && cut < chunker->max_size && !end) {
+				/* The chunk may continue in the next input */
+				more = 0;
+				break;
+			}
+			starts[group] = off;
+			chunks[n + group].offset = chunker->offset;
+			chunks[n + group].length = cut;
+			chunker->offset += (uint_least64_t)cut;
+			off += cut;
+		}
+
+		/* ... and hash them, in parallel, while they are still in the cache */
+		for (k = 0; k < group; k++) {
+			libblake_blake2b_table_store(&chunker->table, k, &chunker->initial);
+			done[k] = libblake_blake2b_scheduler_enqueue(&chunker->scheduler, k, &data[starts[k]], chunks[n + k].length);
+		}
+		libblake_blake2b_scheduler_run(&chunker->scheduler);
+		for (k = 0; k < group; k++) {
+			libblake_blake2b_table_load(&chunker->table, k, &state);
+			libblake_blake2b_digest_const(&state, &data[starts[k] + done[k]], chunks[n + k].length - done[k],
+			                              0, chunker->digest_len, chunks[n + k].digest);
+		}
+		n += group;
+	}
+
+	*nchunksp = n;
+	return off;
+}
@@ -0,0 +1,8 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+size_t
+libblake_blake2b_export(const struct libblake_blake2b_state *state, void *buffer, size_t size)
+{
+	return libblake_internal_blake2b_export(state, EXPORT_BLAKE2B, NULL, 0, buffer, size);
+}
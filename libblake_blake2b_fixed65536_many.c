@@ -0,0 +1,13 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+#include "fixed.h"
+
+void
+libblake_blake2b_fixed65536_many(void *output, size_t output_len, const void *data, size_t n, const void *key, size_t key_len)
+{
+	struct libblake_blake2b_state state;
+
+	/* The key block is the same for all messages, so it is only compressed once */
+	libblake_internal_blake2b_fixed_init(&state, output_len, key, key_len);
+	libblake_internal_blake2b_fixed_lanes(&state, data, 65536, n, output_len, output);
+}
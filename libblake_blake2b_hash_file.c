@@ -0,0 +1,21 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake2b_hash_file(const char *path, const struct libblake_blake2b_params *params,
+                           const void *key, struct libblake_digest_cache *cache, unsigned char *output)
+{
+	struct libblake_internal_file_hasher hasher;
+	struct libblake_internal_blake2b_file_context ctx;
+	int fd, ret, saved_errno;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return -1;
+	libblake_internal_blake2b_file_hasher(&hasher, &ctx, params, key, cache);
+	ret = libblake_internal_hash_file(&hasher, fd, output);
+	saved_errno = errno;
+	close(fd);
+	errno = saved_errno;
+	return ret;
+}
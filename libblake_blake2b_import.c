@@ -0,0 +1,9 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake2b_import(struct libblake_blake2b_state *state, const void *buffer, size_t len)
+{
+	size_t nbuffered = 0;
+	return libblake_internal_blake2b_import(state, EXPORT_BLAKE2B, NULL, &nbuffered, buffer, len);
+}
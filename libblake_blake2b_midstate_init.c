@@ -0,0 +1,25 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2b_midstate_init(struct libblake_blake2b_midstate *midstate, const struct libblake_blake2b_params *params,
+                                const void *key, const void *prefix, size_t len)
+{
+	unsigned char key_block[128];
+	size_t off;
+
+	libblake_blake2b_init(&midstate->state, params);
+	midstate->digest_len = (size_t)params->digest_len;
+
+	/* The nonce is never empty, so neither the key block
+	 * nor the last complete block of the prefix is the last block */
+	if (params->key_len) {
+		memset(key_block, 0, sizeof(key_block));
+		memcpy(key_block, key, (size_t)params->key_len);
+		libblake_blake2b_force_update(&midstate->state, key_block, sizeof(key_block));
+	}
+	off = libblake_blake2b_force_update(&midstate->state, prefix, len);
+
+	midstate->tail_len = len - off;
+	memcpy(midstate->tail, &((const unsigned char *)prefix)[off], midstate->tail_len);
+}
@@ -0,0 +1,75 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake2b_nonce_search(const struct libblake_blake2b_midstate *midstate, size_t nonce_len, uint_least64_t first,
+                               uint_least64_t count, const void *target_, uint_least64_t *noncep, unsigned char *output)
+{
+	struct libblake_internal_blake2b_lanes lanes;
+	struct libblake_blake2b_state state;
+	const unsigned char *target = target_;
+	const unsigned char *block_ptrs[BLAKE2B_LANES];
+	unsigned char blocks[BLAKE2B_LANES][2 * 128], digest[64];
+	size_t len = midstate->tail_len + nonce_len, nblocks = (len + 127) / 128;
+	size_t digest_len = midstate->digest_len, i, j, l, n;
+	uint_least64_t t[2][2];
+	uint_least64_t nonce;
+
+	/* Only the blocks with the nonce, at most two, are hashed for
+	 * each nonce; their counters and finalisation flags are the same
+	 * in all lanes, and the rest of the blocks is the same for all nonces */
+	for (j = 0; j < nblocks; j++) {
+		n = j + 1 < nblocks ? (j + 1) * 128 : len;
+		t[j][0] = (midstate->state.t[0] + (uint_least64_t)n) & UINT_LEAST64_C(0xFFFFffffFFFFffff);
+		t[j][1] = (midstate->state.t[1] + (t[j][0] < (uint_least64_t)n)) & UINT_LEAST64_C(0xFFFFffffFFFFffff);
+	}
+	memset(blocks, 0, sizeof(blocks));
+	for (l = 0; l < BLAKE2B_LANES; l++)
+		memcpy(blocks[l], midstate->tail, midstate->tail_len);
+
+	while (count) {
+		/* In the last group, the unused lanes hash the first nonce again */
+		n = count < BLAKE2B_LANES ? (size_t)count : BLAKE2B_LANES;
+		for (l = 0; l < BLAKE2B_LANES; l++) {
+			nonce = first + (uint_least64_t)(l < n ? l : 0);
+			for (i = 0; i < nonce_len; i++)
+				blocks[l][midstate->tail_len + i] = (unsigned char)((nonce >> (i * 8)) & 255);
+		}
+
+		for (i = 0; i < 8; i++)
+			for (l = 0; l < BLAKE2B_LANES; l++)
+				lanes.h[i][l] = midstate->state.h[i];
+		for (j = 0; j < nblocks; j++) {
+			for (l = 0; l < BLAKE2B_LANES; l++) {
+				block_ptrs[l] = &blocks[l][j * 128];
+				lanes.t[0][l] = t[j][0];
+				lanes.t[1][l] = t[j][1];
+				lanes.f[0][l] = j + 1 < nblocks ? 0 : UINT_LEAST64_C(0xFFFFffffFFFFffff);
+				lanes.f[1][l] = 0;
+			}
+			libblake_internal_blake2b_compress_lanes(&lanes, block_ptrs);
+		}
+
+		/* The lanes are checked in order, so the nonce found is the
+		 * first in the range; the first byte of the hash usually
+		 * rules out a lane without the hash being encoded */
+		for (l = 0; l < n; l++) {
+			if ((unsigned char)(lanes.h[0][l] & 255) > target[0])
+				continue;
+			for (i = 0; i < 8; i++)
+				state.h[i] = lanes.h[i][l];
+			libblake_internal_blake2b_output_digest(&state, digest_len, digest);
+			if (memcmp(digest, target, digest_len) < 0) {
+				*noncep = first + (uint_least64_t)l;
+				if (output)
+					memcpy(output, digest, digest_len);
+				return 1;
+			}
+		}
+
+		first += (uint_least64_t)n;
+		count -= (uint_least64_t)n;
+	}
+
+	return 0;
+}
@@ -0,0 +1,18 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2b_prekey(struct libblake_blake2b_prekeyed *prekeyed, const struct libblake_blake2b_params *params,
+                        const void *key)
+{
+	size_t key_len = (size_t)params->key_len;
+
+	libblake_blake2b_init(&prekeyed->initial, params);
+	prekeyed->state = prekeyed->initial;
+
+	memset(prekeyed->key_block, 0, sizeof(prekeyed->key_block));
+	if (key_len) {
+		memcpy(prekeyed->key_block, key, key_len);
+		libblake_blake2b_force_update(&prekeyed->state, prekeyed->key_block, sizeof(prekeyed->key_block));
+	}
+}
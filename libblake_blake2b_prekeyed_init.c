@@ -0,0 +1,4 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+extern inline void libblake_blake2b_prekeyed_init(struct libblake_blake2b_state *state, const struct libblake_blake2b_prekeyed *prekeyed);
@@ -0,0 +1,26 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+size_t
+libblake_blake2b_scheduler_enqueue(struct libblake_blake2b_scheduler *scheduler, size_t stream,
+                                   const void *data, size_t len)
+{
+	struct libblake_scheduler_job *job;
+
+	/* Same as libblake_blake2b_update: the last
+	 * block is held back until more data is input */
+	if (len <= 128)
+		return 0;
+	len = (len - 1) / 128 * 128;
+
+	if (scheduler->njobs == scheduler->max_jobs)
+		libblake_blake2b_scheduler_run(scheduler);
+
+	job = &scheduler->jobs[scheduler->njobs++];
+	job->stream = stream;
+	job->data = data;
+	job->len = len;
+	job->started = 0;
+
+	return len;
+}
@@ -0,0 +1,14 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake2b_signature_create(struct libblake_blake2b_signature *sig, const struct libblake_blake2b_params *params,
+                                  const void *key, size_t block_size, const void *data, size_t len)
+{
+	struct libblake_internal_blake2b_signature_builder builder;
+
+	if (libblake_internal_blake2b_signature_init(&builder, sig, params, key, block_size, len))
+		return -1;
+	libblake_internal_blake2b_signature_update(&builder, data, len);
+	return libblake_internal_blake2b_signature_finish(&builder);
+}
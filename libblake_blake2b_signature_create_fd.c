@@ -0,0 +1,24 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake2b_signature_create_fd(struct libblake_blake2b_signature *sig, const struct libblake_blake2b_params *params,
+                                     const void *key, size_t block_size, int fd)
+{
+	struct libblake_internal_blake2b_signature_builder builder;
+	struct stat st;
+	size_t size_hint = 0;
+
+	/* The size is only used to allocate the table
+	 * once, so that it need not be grown */
+	if (fstat(fd, &st))
+		return -1;
+	if (S_ISREG(st.st_mode) && st.st_size > 0 && (uintmax_t)st.st_size <= (uintmax_t)SIZE_MAX)
+		size_hint = (size_t)st.st_size;
+
+	if (libblake_internal_blake2b_signature_init(&builder, sig, params, key, block_size, size_hint))
+		return -1;
+	if (libblake_internal_update_fd(fd, &libblake_internal_blake2b_signature_update, &builder) && !builder.error)
+		builder.error = errno;
+	return libblake_internal_blake2b_signature_finish(&builder);
+}
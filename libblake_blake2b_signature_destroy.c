@@ -0,0 +1,12 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2b_signature_destroy(struct libblake_blake2b_signature *sig)
+{
+	free(sig->index);
+	free(sig->weak);
+	free(sig->blocks);
+	free(sig->digests);
+	memset(sig, 0, sizeof(*sig));
+}
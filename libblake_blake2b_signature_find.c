@@ -0,0 +1,41 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake2b_signature_find(const struct libblake_blake2b_signature *sig, uint_least32_t weak,
+                                const void *data, size_t len, size_t *blockp)
+{
+	struct libblake_blake2b_state state;
+	unsigned char digest[64];
+	int hashed = 0;
+	size_t i, end, block_len;
+
+	if (!sig->nblocks || !len)
+		return 0;
+
+	/* Each bucket is sorted by weak checksum, and the block is only
+	 * hashed once it is known that there is a candidate for it */
+	i = sig->index[SIGNATURE_BUCKET(weak, sig->index_bits)];
+	end = sig->index[SIGNATURE_BUCKET(weak, sig->index_bits) + 1];
+	for (; i < end && sig->weak[i] <= weak; i++) {
+		if (sig->weak[i] != weak)
+			continue;
+		/* Only the last block may be shorter than the block size */
+		block_len = sig->block_size;
+		if (sig->blocks[i] + 1 == sig->nblocks && sig->size % sig->block_size)
+			block_len = (size_t)(sig->size % sig->block_size);
+		if (len != block_len)
+			continue;
+		if (!hashed) {
+			state = sig->initial;
+			libblake_blake2b_digest_const(&state, data, len, 0, sig->digest_len, digest);
+			hashed = 1;
+		}
+		if (!memcmp(digest, &sig->digests[i * sig->digest_len], sig->digest_len)) {
+			*blockp = sig->blocks[i];
+			return 1;
+		}
+	}
+
+	return 0;
+}
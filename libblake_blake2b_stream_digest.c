@@ -0,0 +1,10 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2b_stream_digest(struct libblake_blake2b_stream *stream, const void *data, size_t len, int last_node,
+                               size_t output_len, unsigned char output[static output_len])
+{
+	libblake_internal_blake2b_stream_update(&stream->state, stream->buffer, &stream->buffered, data, len);
+	libblake_blake2b_digest(&stream->state, stream->buffer, stream->buffered, last_node, output_len, output);
+}
@@ -0,0 +1,13 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2b_stream_peek(const struct libblake_blake2b_stream *stream, int last_node,
+                             size_t output_len, unsigned char output[static output_len])
+{
+	struct libblake_blake2b_state state = stream->state;
+	unsigned char buffer[128];
+
+	memcpy(buffer, stream->buffer, stream->buffered);
+	libblake_blake2b_digest(&state, buffer, stream->buffered, last_node, output_len, output);
+}
@@ -0,0 +1,8 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2b_stream_update(struct libblake_blake2b_stream *stream, const void *data, size_t len)
+{
+	libblake_internal_blake2b_stream_update(&stream->state, stream->buffer, &stream->buffered, data, len);
+}
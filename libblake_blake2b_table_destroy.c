@@ -0,0 +1,10 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2b_table_destroy(struct libblake_blake2b_table *table)
+{
+	free(table->words);
+	table->words = NULL;
+	table->size = 0;
+}
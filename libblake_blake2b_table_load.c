@@ -0,0 +1,16 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2b_table_load(const struct libblake_blake2b_table *table, size_t i, struct libblake_blake2b_state *state)
+{
+	const uint_least64_t *words = &table->words[i];
+	size_t j;
+
+	for (j = 0; j < 8; j++)
+		state->h[j] = words[j * table->size];
+	state->t[0] = words[8 * table->size];
+	state->t[1] = words[9 * table->size];
+	state->f[0] = 0;
+	state->f[1] = 0;
+}
@@ -0,0 +1,14 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2b_table_store(struct libblake_blake2b_table *table, size_t i, const struct libblake_blake2b_state *state)
+{
+	uint_least64_t *words = &table->words[i];
+	size_t j;
+
+	for (j = 0; j < 8; j++)
+		words[j * table->size] = state->h[j];
+	words[8 * table->size] = state->t[0];
+	words[9 * table->size] = state->t[1];
+}
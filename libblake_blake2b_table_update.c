@@ -0,0 +1,17 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+size_t
+libblake_blake2b_table_update(struct libblake_blake2b_table *table, size_t i, const void *data, size_t len)
+{
+	struct libblake_blake2b_state state;
+
+	if (len <= 128)
+		return 0;
+
+	libblake_blake2b_table_load(table, i, &state);
+	len = libblake_blake2b_update(&state, data, len);
+	libblake_blake2b_table_store(table, i, &state);
+
+	return len;
+}
@@ -0,0 +1,14 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake2b_tree_merge(struct libblake_tree_node *parent, const struct libblake_blake2b_params *params, const void *key,
+                            const struct libblake_tree_node *children, size_t nchildren)
+{
+	struct libblake_internal_tree_hasher hasher;
+	struct libblake_internal_blake2b_tree_context ctx;
+
+	if (libblake_internal_blake2b_tree_hasher(&hasher, &ctx, params, key))
+		return -1;
+	return libblake_internal_tree_merge(&hasher, children, nchildren, parent);
+}
@@ -0,0 +1,16 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+size_t
+libblake_blake2b_updatev(struct libblake_blake2b_state *state, const struct iovec *iov, size_t iovcnt)
+{
+	unsigned char buffer[128];
+	size_t buffered = 0, total = 0, i;
+
+	for (i = 0; i < iovcnt; i++) {
+		libblake_internal_blake2b_stream_update(state, buffer, &buffered, iov[i].iov_base, iov[i].iov_len);
+		total += iov[i].iov_len;
+	}
+
+	return total - buffered;
+}
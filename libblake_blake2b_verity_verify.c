@@ -0,0 +1,35 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+struct context {
+	struct libblake_blake2b_state initial;
+	size_t digest_len;
+};
+
+static int
+hash_blocks(void *ctx_, const unsigned char *data, size_t block_size, size_t n, unsigned char *output, size_t output_stride)
+{
+	struct context *ctx = ctx_;
+	return libblake_internal_blake2b_hash_blocks(&ctx->initial, data, block_size, n, ctx->digest_len, output, output_stride);
+}
+
+int
+libblake_blake2b_verity_verify(const void *tree, size_t tree_size, uint_least64_t nblocks,
+                                const struct libblake_blake2b_params *params, size_t block_size,
+                                const unsigned char *root, uint_least64_t index, const void *block)
+{
+	struct libblake_internal_verity_hasher hasher;
+	struct context ctx;
+
+	if (params->key_len) {
+		errno = EINVAL;
+		return -1;
+	}
+	libblake_blake2b_init(&ctx.initial, params);
+	ctx.digest_len = (size_t)params->digest_len;
+	hasher.ctx = &ctx;
+	hasher.hash_blocks = &hash_blocks;
+
+	return libblake_internal_verity_verify(tree, tree_size, nblocks, block_size, ctx.digest_len,
+	                                       &hasher, root, index, block);
+}
@@ -0,0 +1,58 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2s(void *output, size_t output_len, const void *data_, size_t len, const void *key, size_t key_len)
+{
+	struct libblake_blake2s_state state;
+	unsigned char block[64];
+	const unsigned char *data = data_;
+	size_t r;
+
+	/* Instead of going through libblake_blake2s_init, the
+	 * parameter block, which only has non-zero values in the
+	 * first word (digest length, key length, fan-out 1 and
+	 * depth 1) is applied to the IV directly */
+	state.h[0] = UINT_LEAST32_C(0x6A09E667) ^ UINT_LEAST32_C(0x01010000) ^ (uint_least32_t)(key_len << 8) ^ (uint_least32_t)output_len;
+	state.h[1] = UINT_LEAST32_C(0xBB67AE85);
+	state.h[2] = UINT_LEAST32_C(0x3C6EF372);
+	state.h[3] = UINT_LEAST32_C(0xA54FF53A);
+	state.h[4] = UINT_LEAST32_C(0x510E527F);
+	state.h[5] = UINT_LEAST32_C(0x9B05688C);
+	state.h[6] = UINT_LEAST32_C(0x1F83D9AB);
+	state.h[7] = UINT_LEAST32_C(0x5BE0CD19);
+	state.t[0] = 0;
+	state.t[1] = 0;
+	state.f[0] = 0;
+	state.f[1] = 0;
+
+	if (key_len) {
+		memcpy(block, key, key_len);
+		memset(&block[key_len], 0, sizeof(block) - key_len);
+		state.t[0] = 64;
+		if (!len)
+			goto last;
+		libblake_internal_blake2s_compress(&state, block);
+	}
+
+	/* Messages of at most one block, which is the common
+	 * case for this function, go straight to the last block */
+	if (len > 64) {
+		r = libblake_blake2s_update(&state, data, len);
+		data = &data[r];
+		len -= r;
+	}
+
+	if (len)
+		memcpy(block, data, len);
+	memset(&block[len], 0, sizeof(block) - len);
+	state.t[0] = (state.t[0] + len) & UINT_LEAST32_C(0xFFFFffff);
+	if (UNLIKELY(state.t[0] < len))
+		state.t[1] = (state.t[1] + 1) & UINT_LEAST32_C(0xFFFFffff);
+
+last:
+	state.f[0] = UINT_LEAST32_C(0xFFFFffff);
+	libblake_internal_blake2s_compress(&state, block);
+
+	libblake_internal_blake2s_output_digest(&state, output_len, output);
+}
@@ -0,0 +1,22 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake2s_checkpoints_create(struct libblake_blake2s_checkpoints *index, const struct libblake_blake2s_state *state, size_t interval)
+{
+	/* The offsets of the checkpoints are the byte counts of the
+	 * states, so the state must be at the start of the input */
+	if (!interval || state->t[0] || state->t[1] || state->f[0] || state->f[1]) {
+		errno = EINVAL;
+		return -1;
+	}
+	index->interval = interval;
+	index->blocks = 0;
+	index->count = 1;
+	index->capacity = 16;
+	index->words = malloc(index->capacity * 8 * sizeof(*index->words));
+	if (!index->words)
+		return -1;
+	memcpy(index->words, state->h, sizeof(state->h));
+	return 0;
+}
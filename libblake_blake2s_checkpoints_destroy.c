@@ -0,0 +1,11 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2s_checkpoints_destroy(struct libblake_blake2s_checkpoints *index)
+{
+	free(index->words);
+	index->words = NULL;
+	index->count = 0;
+	index->capacity = 0;
+}
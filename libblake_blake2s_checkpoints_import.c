@@ -0,0 +1,50 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake2s_checkpoints_import(struct libblake_blake2s_checkpoints *index, const void *buffer, size_t len)
+{
+	unsigned char bytes[16];
+	size_t i, count, nbytes = sizeof(bytes);
+	uint_least64_t interval = 0, blocks = 0;
+	uint_least32_t *words;
+
+	/* Header, at least one checkpoint, byte count, and the bytes */
+	if (len < 4 + 8 * sizeof(*words) + 4 + sizeof(bytes))
+		goto invalid;
+	count = len - (4 + 4 + sizeof(bytes));
+	if (count % (8 * sizeof(*words)))
+		goto invalid;
+	count /= 8 * sizeof(*words);
+
+	words = malloc(count * 8 * sizeof(*words));
+	if (!words)
+		return -1;
+	if (libblake_internal_import(EXPORT_BLAKE2S | EXPORT_CHECKPOINTS, sizeof(*words), words, count * 8,
+	                             bytes, sizeof(bytes), &nbytes, buffer, len))
+		goto fail;
+
+	for (i = 0; i < 8; i++) {
+		interval |= (uint_least64_t)bytes[i + 0] << (i * 8);
+		blocks |= (uint_least64_t)bytes[i + 8] << (i * 8);
+	}
+	if (!interval || interval > SIZE_MAX || blocks >= interval) {
+		errno = EINVAL;
+		goto fail;
+	}
+
+	index->interval = (size_t)interval;
+	index->blocks = (size_t)blocks;
+	index->count = count;
+	index->capacity = count;
+	index->words = words;
+	return 0;
+
+fail:
+	free(words);
+	return -1;
+
+invalid:
+	errno = EINVAL;
+	return -1;
+}
@@ -0,0 +1,46 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake2s_checkpoints_update(struct libblake_blake2s_checkpoints *index, struct libblake_blake2s_state *state,
+                                    const void *data_, size_t len, size_t *processedp)
+{
+	const unsigned char *data = data_;
+	size_t off = 0, need, capacity;
+	uint_least32_t *new;
+
+	/* Make room for all checkpoints before the loop, so that the
+	 * loop cannot fail and can capture the states as it goes */
+	need = (len ? (len - 1) / 64 : 0) + index->blocks;
+	need = index->count + need / index->interval;
+	if (need > index->capacity) {
+		capacity = index->capacity;
+		while (capacity < need)
+			capacity = capacity <= SIZE_MAX / 2 ? capacity * 2 : need;
+		if (capacity > SIZE_MAX / 8 / sizeof(*new)) {
+			errno = ENOMEM;
+			return -1;
+		}
+		new = realloc(index->words, capacity * 8 * sizeof(*new));
+		if (!new)
+			return -1;
+		index->words = new;
+		index->capacity = capacity;
+	}
+
+	for (; len - off > 64; off += 64) {
+		state->t[0] = (state->t[0] + 64) & UINT_LEAST32_C(0xFFFFffff);
+		if (UNLIKELY(state->t[0] < 64))
+			state->t[1] = (state->t[1] + 1) & UINT_LEAST32_C(0xFFFFffff);
+
+		libblake_internal_blake2s_compress(state, &data[off]);
+
+		if (++index->blocks == index->interval) {
+			index->blocks = 0;
+			memcpy(&index->words[index->count++ * 8], state->h, sizeof(state->h));
+		}
+	}
+
+	*processedp = off;
+	return 0;
+}
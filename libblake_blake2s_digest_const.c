@@ -0,0 +1,13 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2s_digest_const(struct libblake_blake2s_state *state, const void *data, size_t len, int last_node,
+                              size_t output_len, unsigned char output[static output_len])
+{
+	unsigned char buffer[64];
+	size_t buffered = 0;
+
+	libblake_internal_blake2s_stream_update(state, buffer, &buffered, data, len);
+	libblake_blake2s_digest(state, buffer, buffered, last_node, output_len, output);
+}
@@ -0,0 +1,15 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2s_digestv(struct libblake_blake2s_state *state, const struct iovec *iov, size_t iovcnt, int last_node,
+                         size_t output_len, unsigned char output[static output_len])
+{
+	unsigned char buffer[64];
+	size_t buffered = 0, i;
+
+	for (i = 0; i < iovcnt; i++)
+		libblake_internal_blake2s_stream_update(state, buffer, &buffered, iov[i].iov_base, iov[i].iov_len);
+
+	libblake_blake2s_digest(state, buffer, buffered, last_node, output_len, output);
+}
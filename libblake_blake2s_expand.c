@@ -0,0 +1,4 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+extern inline void libblake_blake2s_expand(struct libblake_blake2s_state *state, const struct libblake_blake2s_compact_state *compact);
@@ -0,0 +1,8 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+size_t
+libblake_blake2s_export(const struct libblake_blake2s_state *state, void *buffer, size_t size)
+{
+	return libblake_internal_blake2s_export(state, EXPORT_BLAKE2S, NULL, 0, buffer, size);
+}
@@ -0,0 +1,12 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+#include "fixed.h"
+
+void
+libblake_blake2s_fixed4096(void *output, size_t output_len, const void *data, const void *key, size_t key_len)
+{
+	struct libblake_blake2s_state state;
+
+	libblake_internal_blake2s_fixed_init(&state, output_len, key, key_len);
+	libblake_internal_blake2s_fixed(&state, data, 4096, output_len, output);
+}
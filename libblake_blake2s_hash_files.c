@@ -0,0 +1,96 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+struct context {
+	const struct libblake_blake2s_params *params;
+	const unsigned char *key_block;
+	struct libblake_blake2s_state initial;
+	struct libblake_blake2s_table table;
+	struct libblake_blake2s_scheduler scheduler;
+};
+
+static void
+start(void *ctx_, size_t slot)
+{
+	struct context *ctx = ctx_;
+	libblake_blake2s_table_store(&ctx->table, slot, &ctx->initial);
+}
+
+static size_t
+feed(void *ctx_, size_t slot, const unsigned char *data, size_t len)
+{
+	struct context *ctx = ctx_;
+	return libblake_blake2s_scheduler_enqueue(&ctx->scheduler, slot, data, len);
+}
+
+static void
+run(void *ctx_)
+{
+	struct context *ctx = ctx_;
+	libblake_blake2s_scheduler_run(&ctx->scheduler);
+}
+
+static void
+finish(void *ctx_, size_t slot, const unsigned char *data, size_t len, unsigned char *output)
+{
+	struct context *ctx = ctx_;
+	struct libblake_blake2s_state state;
+	libblake_blake2s_table_load(&ctx->table, slot, &state);
+	libblake_blake2s_digest_const(&state, data, len, 0, (size_t)ctx->params->digest_len, output);
+}
+
+static int
+hash_path(void *ctx_, const char *path, unsigned char *output)
+{
+	struct context *ctx = ctx_;
+	struct libblake_blake2s_stream stream;
+	libblake_blake2s_stream_init(&stream, ctx->params);
+	if (ctx->params->key_len)
+		libblake_blake2s_stream_update(&stream, ctx->key_block, 64);
+	if (libblake_blake2s_stream_update_path(&stream, path))
+		return -1;
+	libblake_blake2s_stream_digest(&stream, NULL, 0, 0, (size_t)ctx->params->digest_len, output);
+	return 0;
+}
+
+int
+libblake_blake2s_hash_files(const char *const paths[], size_t npaths, const struct libblake_blake2s_params *params,
+                            const void *key, int flags,
+                            void (*callback)(void *user, size_t i, const unsigned char *digest, int error), void *user)
+{
+	struct libblake_internal_hasher hasher;
+	struct context ctx;
+	unsigned char key_block[64];
+	int ret, saved_errno;
+
+	memset(key_block, 0, sizeof(key_block));
+	if (params->key_len)
+		memcpy(key_block, key, (size_t)params->key_len);
+
+	ctx.params = params;
+	ctx.key_block = key_block;
+	libblake_blake2s_init(&ctx.initial, params);
+	if (libblake_blake2s_table_create(&ctx.table, HASH_FILES_QUEUE_DEPTH))
+		return -1;
+	if (libblake_blake2s_scheduler_create(&ctx.scheduler, &ctx.table, HASH_FILES_QUEUE_DEPTH)) {
+		libblake_blake2s_table_destroy(&ctx.table);
+		return -1;
+	}
+
+	hasher.prefix = key_block;
+	hasher.prefix_len = params->key_len ? sizeof(key_block) : 0;
+	hasher.ctx = &ctx;
+	hasher.start = &start;
+	hasher.feed = &feed;
+	hasher.run = &run;
+	hasher.finish = &finish;
+	hasher.hash_path = &hash_path;
+
+	ret = libblake_internal_hash_files(paths, npaths, flags, &hasher, callback, user);
+
+	saved_errno = errno;
+	libblake_blake2s_scheduler_destroy(&ctx.scheduler);
+	libblake_blake2s_table_destroy(&ctx.table);
+	errno = saved_errno;
+	return ret;
+}
@@ -0,0 +1,12 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake2s_hash_tree(const char *path, const struct libblake_blake2s_params *params,
+                           const void *key, struct libblake_digest_cache *cache, size_t nthreads, unsigned char *output)
+{
+	struct libblake_internal_file_hasher hasher;
+	struct libblake_internal_blake2s_file_context ctx;
+	libblake_internal_blake2s_file_hasher(&hasher, &ctx, params, key, cache);
+	return libblake_internal_hash_tree(path, nthreads, &hasher, output);
+}
@@ -0,0 +1,126 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+#include "fixed.h"
+
+static uint_least32_t
+rotate_right(uint_least32_t x, int n)
+{
+	/* This is perfectly optimised by the compiler */
+	return ((x >> n) | (x << (32 - n))) & UINT_LEAST32_C(0xFFFFffff);
+}
+
+void
+libblake_blake2s_iterate(void *output, size_t output_len, const void *data_, uint_least64_t iterations,
+                         const void *key, size_t key_len)
+{
+	struct libblake_blake2s_state state;
+	const unsigned char *data = data_;
+	uint_least32_t v[16], m[16], word[8], mask[8], t0;
+	size_t i;
+
+	libblake_internal_blake2s_fixed_init(&state, output_len, key, key_len);
+	t0 = state.t[0] + (uint_least32_t)output_len;
+
+	/* The message is the previous hash, so it is never encoded as bytes
+	 * between iterations; instead the hash is truncated to the message
+	 * length with the masks, and the rest of the block is always zero */
+	for (i = 0; i < 8; i++)
+		word[i] = 0;
+	for (i = 0; i < output_len; i++)
+		word[i / 4] |= (uint_least32_t)data[i] << (i % 4 * 8);
+	for (i = 0; i < 8; i++) {
+		if ((i + 1) * 4 <= output_len)
+			mask[i] = UINT_LEAST32_C(0xFFFFffff);
+		else if (i * 4 < output_len)
+			mask[i] = (UINT_LEAST32_C(1) << (output_len % 4 * 8)) - 1;
+		else
+			mask[i] = 0;
+	}
+
+	m[0] = word[0];
+	m[1] = word[1];
+	m[2] = word[2];
+	m[3] = word[3];
+	m[4] = word[4];
+	m[5] = word[5];
+	m[6] = word[6];
+	m[7] = word[7];
+	m[8] = 0;
+	m[9] = 0;
+	m[A] = 0;
+	m[B] = 0;
+	m[C] = 0;
+	m[D] = 0;
+	m[E] = 0;
+	m[F] = 0;
+
+#define G2S(mj, mk, a, b, c, d)\
+	a = (a + b + mj) & UINT_LEAST32_C(0xFFFFffff);\
+	d = rotate_right(d ^ a, 16);\
+	c = (c + d) & UINT_LEAST32_C(0xFFFFffff);\
+	b = rotate_right(b ^ c, 12);\
+	a = (a + b + mk) & UINT_LEAST32_C(0xFFFFffff);\
+	d = rotate_right(d ^ a, 8);\
+	c = (c + d) & UINT_LEAST32_C(0xFFFFffff);\
+	b = rotate_right(b ^ c, 7)
+
+#define ROUND2S(S0, S1, S2, S3, S4, S5, S6, S7, S8, S9, SA, SB, SC, SD, SE, SF)\
+	G2S(m[S0], m[S1], v[0], v[4], v[8], v[C]);\
+	G2S(m[S2], m[S3], v[1], v[5], v[9], v[D]);\
+	G2S(m[S4], m[S5], v[2], v[6], v[A], v[E]);\
+	G2S(m[S6], m[S7], v[3], v[7], v[B], v[F]);\
+	G2S(m[S8], m[S9], v[0], v[5], v[A], v[F]);\
+	G2S(m[SA], m[SB], v[1], v[6], v[B], v[C]);\
+	G2S(m[SC], m[SD], v[2], v[7], v[8], v[D]);\
+	G2S(m[SE], m[SF], v[3], v[4], v[9], v[E])
+
+	/* Each iteration is one compression of the last and only block */
+	for (; iterations; iterations--) {
+		v[0] = state.h[0];
+		v[1] = state.h[1];
+		v[2] = state.h[2];
+		v[3] = state.h[3];
+		v[4] = state.h[4];
+		v[5] = state.h[5];
+		v[6] = state.h[6];
+		v[7] = state.h[7];
+		v[8] = UINT_LEAST32_C(0x6A09E667);
+		v[9] = UINT_LEAST32_C(0xBB67AE85);
+		v[A] = UINT_LEAST32_C(0x3C6EF372);
+		v[B] = UINT_LEAST32_C(0xA54FF53A);
+		v[C] = UINT_LEAST32_C(0x510E527F) ^ t0;
+		v[D] = UINT_LEAST32_C(0x9B05688C);
+		v[E] = UINT_LEAST32_C(0x1F83D9AB) ^ UINT_LEAST32_C(0xFFFFffff);
+		v[F] = UINT_LEAST32_C(0x5BE0CD19);
+
+		ROUND2S(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, A, B, C, D, E, F);
+		ROUND2S(E, A, 4, 8, 9, F, D, 6, 1, C, 0, 2, B, 7, 5, 3);
+		ROUND2S(B, 8, C, 0, 5, 2, F, D, A, E, 3, 6, 7, 1, 9, 4);
+		ROUND2S(7, 9, 3, 1, D, C, B, E, 2, 6, 5, A, 4, 0, F, 8);
+		ROUND2S(9, 0, 5, 7, 2, 4, A, F, E, 1, B, C, 6, 8, 3, D);
+		ROUND2S(2, C, 6, A, 0, B, 8, 3, 4, D, 7, 5, F, E, 1, 9);
+		ROUND2S(C, 5, 1, F, E, D, 4, A, 0, 7, 6, 3, 9, 2, 8, B);
+		ROUND2S(D, B, 7, E, C, 1, 3, 9, 5, 0, F, 4, 8, 6, 2, A);
+		ROUND2S(6, F, E, 9, B, 3, 0, 8, C, 2, D, 7, 1, 4, A, 5);
+		ROUND2S(A, 2, 8, 4, 7, 6, 1, 5, F, B, 9, E, 3, C, D, 0);
+
+		m[0] = (state.h[0] ^ v[0] ^ v[8]) & mask[0];
+		m[1] = (state.h[1] ^ v[1] ^ v[9]) & mask[1];
+		m[2] = (state.h[2] ^ v[2] ^ v[A]) & mask[2];
+		m[3] = (state.h[3] ^ v[3] ^ v[B]) & mask[3];
+		m[4] = (state.h[4] ^ v[4] ^ v[C]) & mask[4];
+		m[5] = (state.h[5] ^ v[5] ^ v[D]) & mask[5];
+		m[6] = (state.h[6] ^ v[6] ^ v[E]) & mask[6];
+		m[7] = (state.h[7] ^ v[7] ^ v[F]) & mask[7];
+	}
+
+	state.h[0] = m[0];
+	state.h[1] = m[1];
+	state.h[2] = m[2];
+	state.h[3] = m[3];
+	state.h[4] = m[4];
+	state.h[5] = m[5];
+	state.h[6] = m[6];
+	state.h[7] = m[7];
+	libblake_internal_blake2s_output_digest(&state, output_len, output);
+}
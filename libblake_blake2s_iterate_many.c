@@ -0,0 +1,71 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+#include "fixed.h"
+
+static void
+encode_uint32_le(unsigned char *out, uint_least32_t value)
+{
+	/* This is perfectly optimised by the compiler */
+	out[0] = (unsigned char)((value >>  0) & 255);
+	out[1] = (unsigned char)((value >>  8) & 255);
+	out[2] = (unsigned char)((value >> 16) & 255);
+	out[3] = (unsigned char)((value >> 24) & 255);
+}
+
+void
+libblake_blake2s_iterate_many(void *output_, size_t output_len, const void *data_, size_t n, uint_least64_t iterations,
+                              const void *key, size_t key_len)
+{
+	struct libblake_internal_blake2s_lanes lanes;
+	struct libblake_blake2s_state initial;
+	const unsigned char *data = data_;
+	unsigned char *output = output_, blocks[BLAKE2S_LANES][64];
+	const unsigned char *block_ptrs[BLAKE2S_LANES];
+	uint_least32_t mask[8], t0;
+	size_t i, l, words = (output_len + 3) / 4;
+	uint_least64_t k;
+
+	libblake_internal_blake2s_fixed_init(&initial, output_len, key, key_len);
+	t0 = initial.t[0] + (uint_least32_t)output_len;
+	for (i = 0; i < words; i++)
+		mask[i] = (i + 1) * 4 <= output_len ? UINT_LEAST32_C(0xFFFFffff) : (UINT_LEAST32_C(1) << (output_len % 4 * 8)) - 1;
+
+	/* The block after the message is always zero, and the lanes
+	 * all have the same counter, as all messages are equally long */
+	memset(blocks, 0, sizeof(blocks));
+	for (l = 0; l < BLAKE2S_LANES; l++) {
+		block_ptrs[l] = blocks[l];
+		lanes.t[0][l] = t0;
+		lanes.t[1][l] = 0;
+		lanes.f[0][l] = UINT_LEAST32_C(0xFFFFffff);
+		lanes.f[1][l] = 0;
+	}
+
+	/* The chains are advanced BLAKE2S_LANES at a time, each in its own lane,
+	 * and the hashes are only encoded as bytes into the blocks that
+	 * they are the messages in; the truncated tail of the last word
+	 * is masked off, so that the rest of the block remains zero */
+	for (; n >= BLAKE2S_LANES; n -= BLAKE2S_LANES) {
+		for (l = 0; l < BLAKE2S_LANES; l++)
+			memcpy(blocks[l], &data[l * output_len], output_len);
+		for (k = 0; k < iterations; k++) {
+			for (i = 0; i < 8; i++)
+				for (l = 0; l < BLAKE2S_LANES; l++)
+					lanes.h[i][l] = initial.h[i];
+			libblake_internal_blake2s_compress_lanes(&lanes, block_ptrs);
+			for (l = 0; l < BLAKE2S_LANES; l++)
+				for (i = 0; i < words; i++)
+					encode_uint32_le(&blocks[l][i * 4], lanes.h[i][l] & mask[i]);
+		}
+		for (l = 0; l < BLAKE2S_LANES; l++)
+			memcpy(&output[l * output_len], blocks[l], output_len);
+		data = &data[BLAKE2S_LANES * output_len];
+		output = &output[BLAKE2S_LANES * output_len];
+	}
+
+	for (; n; n--) {
+		libblake_blake2s_iterate(output, output_len, data, iterations, key, key_len);
+		data = &data[output_len];
+		output = &output[output_len];
+	}
+}
@@ -0,0 +1,17 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2s_midstate_digest(const struct libblake_blake2s_midstate *midstate, uint_least64_t nonce, size_t nonce_len,
+                                  unsigned char *output)
+{
+	struct libblake_blake2s_state state = midstate->state;
+	unsigned char buffer[64 + 8];
+	size_t i;
+
+	memcpy(buffer, midstate->tail, midstate->tail_len);
+	for (i = 0; i < nonce_len; i++)
+		buffer[midstate->tail_len + i] = (unsigned char)((nonce >> (i * 8)) & 255);
+
+	libblake_blake2s_digest_const(&state, buffer, midstate->tail_len + nonce_len, 0, midstate->digest_len, output);
+}
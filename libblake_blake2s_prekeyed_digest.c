@@ -0,0 +1,21 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2s_prekeyed_digest(const struct libblake_blake2s_prekeyed *prekeyed, const void *data, size_t len,
+                                 int last_node, size_t output_len, unsigned char output[static output_len])
+{
+	struct libblake_blake2s_state state;
+
+	/* The key has been processed iff the counter is non-zero; if it
+	 * has, but there is no message, the key block is the last block */
+	if (!len && prekeyed->state.t[0]) {
+		state = prekeyed->initial;
+		data = prekeyed->key_block;
+		len = sizeof(prekeyed->key_block);
+	} else {
+		state = prekeyed->state;
+	}
+
+	libblake_blake2s_digest_const(&state, data, len, last_node, output_len, output);
+}
@@ -0,0 +1,100 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+size_t
+libblake_blake2s_prekeyed_verify_batch(const struct libblake_blake2s_prekeyed *prekeyed, size_t n,
+                                       const void *const messages[], const size_t lens[],
+                                       const void *const tags[], size_t tag_len, unsigned char bitmap[])
+{
+	static const unsigned char zeroes[64] = {0};
+	struct libblake_internal_blake2s_lanes lanes;
+	const struct libblake_blake2s_state *start;
+	const unsigned char *blocks[BLAKE2S_LANES], *data[BLAKE2S_LANES], *tag;
+	unsigned char last[BLAKE2S_LANES][64];
+	size_t left[BLAKE2S_LANES], msg[BLAKE2S_LANES];
+	int busy[BLAKE2S_LANES], finishing[BLAKE2S_LANES];
+	size_t next = 0, passed = 0, active, i, l, k;
+	unsigned int diff, ok;
+
+	memset(bitmap, 0, (n + 7) / 8);
+	memset(busy, 0, sizeof(busy));
+	memset(&lanes, 0, sizeof(lanes));
+
+	/* Each lane hashes one message at a time, and takes the
+	 * next message as soon as it has finished, so messages
+	 * of different lengths do not leave lanes idle */
+	for (;;) {
+		active = 0;
+		for (l = 0; l < BLAKE2S_LANES; l++) {
+			if (!busy[l] && next < n) {
+				k = msg[l] = next++;
+				busy[l] = 1;
+				if (!lens[k] && prekeyed->state.t[0]) {
+					/* Empty message: the key block is the last block */
+					start = &prekeyed->initial;
+					data[l] = prekeyed->key_block;
+					left[l] = sizeof(prekeyed->key_block);
+				} else {
+					start = &prekeyed->state;
+					data[l] = messages[k];
+					left[l] = lens[k];
+				}
+				for (i = 0; i < 8; i++)
+					lanes.h[i][l] = start->h[i];
+				lanes.t[0][l] = start->t[0];
+				lanes.t[1][l] = start->t[1];
+				lanes.f[1][l] = 0;
+			}
+			active += (size_t)busy[l];
+		}
+		if (!active)
+			break;
+
+		for (l = 0; l < BLAKE2S_LANES; l++) {
+			finishing[l] = 0;
+			if (!busy[l]) {
+				/* Idle lanes compress a block of zeroes, rather than
+				 * `last[l]`, which may not have been written yet */
+				blocks[l] = zeroes;
+				continue;
+			}
+			if (left[l] > 64) {
+				blocks[l] = data[l];
+				data[l] = &data[l][64];
+				left[l] -= 64;
+				k = 64;
+				lanes.f[0][l] = 0;
+			} else {
+				if (left[l])
+					memcpy(last[l], data[l], left[l]);
+				memset(&last[l][left[l]], 0, 64 - left[l]);
+				blocks[l] = last[l];
+				k = left[l];
+				lanes.f[0][l] = UINT_LEAST32_C(0xFFFFffff);
+				finishing[l] = 1;
+			}
+			lanes.t[0][l] = (lanes.t[0][l] + (uint_least32_t)k) & UINT_LEAST32_C(0xFFFFffff);
+			if (lanes.t[0][l] < k)
+				lanes.t[1][l] = (lanes.t[1][l] + 1) & UINT_LEAST32_C(0xFFFFffff);
+		}
+
+		libblake_internal_blake2s_compress_lanes(&lanes, blocks);
+
+		for (l = 0; l < BLAKE2S_LANES; l++) {
+			if (!finishing[l])
+				continue;
+			k = msg[l];
+			tag = tags[k];
+			/* Constant time comparison */
+			diff = 0;
+			for (i = 0; i < tag_len; i++)
+				diff |= (unsigned int)((lanes.h[i / 4][l] >> (i % 4 * 8)) & 255) ^ (unsigned int)tag[i];
+			ok = ((diff - 1U) >> 8) & 1U;
+			bitmap[k / 8] |= (unsigned char)(ok << (k % 8));
+			passed += ok;
+			busy[l] = 0;
+		}
+	}
+
+	return passed;
+}
@@ -0,0 +1,19 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake2s_scheduler_create(struct libblake_blake2s_scheduler *scheduler, struct libblake_blake2s_table *table,
+                                  size_t max_jobs)
+{
+	if (!max_jobs)
+		max_jobs = 1;
+	if (max_jobs > SIZE_MAX / sizeof(*scheduler->jobs)) {
+		errno = ENOMEM;
+		return -1;
+	}
+	scheduler->table = table;
+	scheduler->max_jobs = max_jobs;
+	scheduler->njobs = 0;
+	scheduler->jobs = malloc(max_jobs * sizeof(*scheduler->jobs));
+	return scheduler->jobs ? 0 : -1;
+}
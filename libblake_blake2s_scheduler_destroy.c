@@ -0,0 +1,10 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2s_scheduler_destroy(struct libblake_blake2s_scheduler *scheduler)
+{
+	free(scheduler->jobs);
+	scheduler->jobs = NULL;
+	scheduler->njobs = 0;
+}
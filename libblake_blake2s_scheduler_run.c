@@ -0,0 +1,74 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2s_scheduler_run(struct libblake_blake2s_scheduler *scheduler)
+{
+	static const unsigned char zeroes[64] = {0};
+	struct libblake_internal_blake2s_lanes lanes;
+	struct libblake_scheduler_job *jobs = scheduler->jobs, *lane_job[BLAKE2S_LANES];
+	const unsigned char *blocks[BLAKE2S_LANES];
+	uint_least32_t *words = scheduler->table->words;
+	size_t size = scheduler->table->size;
+	size_t first = 0, active = 0, i, j, l;
+
+	memset(&lanes, 0, sizeof(lanes));
+	memset(lane_job, 0, sizeof(lane_job));
+
+	for (;;) {
+		/* Give each free lane the first unstarted job
+		 * whose stream is not already in another lane;
+		 * a later job for a stream that is in a lane
+		 * is thus never started before an earlier job */
+		for (i = first; active < BLAKE2S_LANES && i < scheduler->njobs; i++) {
+			if (jobs[i].started)
+				continue;
+			for (l = 0; l < BLAKE2S_LANES; l++)
+				if (lane_job[l] && lane_job[l]->stream == jobs[i].stream)
+					break;
+			if (l < BLAKE2S_LANES)
+				continue;
+			for (l = 0; lane_job[l]; l++);
+			lane_job[l] = &jobs[i];
+			jobs[i].started = 1;
+			active += 1;
+			for (j = 0; j < 8; j++)
+				lanes.h[j][l] = words[j * size + jobs[i].stream];
+			lanes.t[0][l] = words[8 * size + jobs[i].stream];
+			lanes.t[1][l] = words[9 * size + jobs[i].stream];
+		}
+		while (first < scheduler->njobs && jobs[first].started)
+			first++;
+		if (!active)
+			break;
+
+		for (l = 0; l < BLAKE2S_LANES; l++) {
+			if (!lane_job[l]) {
+				/* Idle lanes compress garbage that is never read */
+				blocks[l] = zeroes;
+				continue;
+			}
+			blocks[l] = lane_job[l]->data;
+			lane_job[l]->data = &lane_job[l]->data[64];
+			lane_job[l]->len -= 64;
+			lanes.t[0][l] = (lanes.t[0][l] + 64) & UINT_LEAST32_C(0xFFFFffff);
+			if (lanes.t[0][l] < 64)
+				lanes.t[1][l] = (lanes.t[1][l] + 1) & UINT_LEAST32_C(0xFFFFffff);
+		}
+
+		libblake_internal_blake2s_compress_lanes(&lanes, blocks);
+
+		for (l = 0; l < BLAKE2S_LANES; l++) {
+			if (!lane_job[l] || lane_job[l]->len)
+				continue;
+			for (j = 0; j < 8; j++)
+				words[j * size + lane_job[l]->stream] = lanes.h[j][l];
+			words[8 * size + lane_job[l]->stream] = lanes.t[0][l];
+			words[9 * size + lane_job[l]->stream] = lanes.t[1][l];
+			lane_job[l] = NULL;
+			active -= 1;
+		}
+	}
+
+	scheduler->njobs = 0;
+}
@@ -0,0 +1,12 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake2s_stream_import(struct libblake_blake2s_stream *stream, const void *buffer, size_t len)
+{
+	size_t nbuffered = 64;
+	if (libblake_internal_blake2s_import(&stream->state, EXPORT_BLAKE2S | EXPORT_STREAM, stream->buffer, &nbuffered, buffer, len))
+		return -1;
+	stream->buffered = nbuffered;
+	return 0;
+}
@@ -0,0 +1,9 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2s_stream_init(struct libblake_blake2s_stream *stream, const struct libblake_blake2s_params *params)
+{
+	libblake_blake2s_init(&stream->state, params);
+	stream->buffered = 0;
+}
@@ -0,0 +1,14 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+static void
+update(void *stream, const void *data, size_t len)
+{
+	libblake_blake2s_stream_update(stream, data, len);
+}
+
+int
+libblake_blake2s_stream_update_fd(struct libblake_blake2s_stream *stream, int fd)
+{
+	return libblake_internal_update_fd(fd, &update, stream);
+}
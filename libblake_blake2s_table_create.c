@@ -0,0 +1,15 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake2s_table_create(struct libblake_blake2s_table *table, size_t size)
+{
+	/* h[0], ..., h[7], t[0], t[1] */
+	if (size > SIZE_MAX / 10 / sizeof(*table->words)) {
+		errno = ENOMEM;
+		return -1;
+	}
+	table->size = size;
+	table->words = malloc((size ? size : 1) * 10 * sizeof(*table->words));
+	return table->words ? 0 : -1;
+}
@@ -0,0 +1,17 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+size_t
+libblake_blake2s_table_update(struct libblake_blake2s_table *table, size_t i, const void *data, size_t len)
+{
+	struct libblake_blake2s_state state;
+
+	if (len <= 64)
+		return 0;
+
+	libblake_blake2s_table_load(table, i, &state);
+	len = libblake_blake2s_update(&state, data, len);
+	libblake_blake2s_table_store(table, i, &state);
+
+	return len;
+}
@@ -0,0 +1,14 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake2s_tree_node(struct libblake_tree_node *node, const struct libblake_blake2s_params *params, const void *key,
+                           uint_least64_t size, uint_least64_t node_offset, size_t node_depth, const void *data, size_t len)
+{
+	struct libblake_internal_tree_hasher hasher;
+	struct libblake_internal_blake2s_tree_context ctx;
+
+	if (libblake_internal_blake2s_tree_hasher(&hasher, &ctx, params, key))
+		return -1;
+	return libblake_internal_tree_node(&hasher, size, node_depth, node_offset, data, len, node);
+}
@@ -0,0 +1,19 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake2s_tree_node_range(const struct libblake_blake2s_params *params, uint_least64_t size,
+                                 uint_least64_t node_offset, size_t node_depth, struct libblake_byte_range *range)
+{
+	struct libblake_internal_tree_hasher hasher;
+	struct libblake_internal_blake2s_tree_context ctx;
+	struct libblake_internal_tree_layout layout;
+	struct libblake_blake2s_params unkeyed = *params;
+
+	/* The key does not affect the shape of the tree */
+	unkeyed.key_len = 0;
+	if (libblake_internal_blake2s_tree_hasher(&hasher, &ctx, &unkeyed, NULL) ||
+	    libblake_internal_tree_layout(&layout, size, &hasher))
+		return -1;
+	return libblake_internal_tree_extent(&layout, &hasher, node_depth, node_offset, &range->offset, &range->length);
+}
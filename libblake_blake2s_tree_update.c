@@ -0,0 +1,15 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake2s_tree_update(int data_fd, int store_fd, const struct libblake_blake2s_params *params,
+                             const void *key, const struct libblake_byte_range *ranges, size_t nranges,
+                             unsigned char *output)
+{
+	struct libblake_internal_tree_hasher hasher;
+	struct libblake_internal_blake2s_tree_context ctx;
+
+	if (libblake_internal_blake2s_tree_hasher(&hasher, &ctx, params, key))
+		return -1;
+	return libblake_internal_tree_update(data_fd, store_fd, &hasher, ranges, nranges, 0, output);
+}
@@ -0,0 +1,33 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+struct context {
+	struct libblake_blake2s_state initial;
+	size_t digest_len;
+};
+
+static int
+hash_blocks(void *ctx_, const unsigned char *data, size_t block_size, size_t n, unsigned char *output, size_t output_stride)
+{
+	struct context *ctx = ctx_;
+	return libblake_internal_blake2s_hash_blocks(&ctx->initial, data, block_size, n, ctx->digest_len, output, output_stride);
+}
+
+int
+libblake_blake2s_verity_build(int data_fd, int hash_fd, const struct libblake_blake2s_params *params, size_t block_size,
+                               size_t nthreads, unsigned char *root)
+{
+	struct libblake_internal_verity_hasher hasher;
+	struct context ctx;
+
+	if (params->key_len) {
+		errno = EINVAL;
+		return -1;
+	}
+	libblake_blake2s_init(&ctx.initial, params);
+	ctx.digest_len = (size_t)params->digest_len;
+	hasher.ctx = &ctx;
+	hasher.hash_blocks = &hash_blocks;
+
+	return libblake_internal_verity_build(data_fd, hash_fd, block_size, ctx.digest_len, nthreads, &hasher, root);
+}
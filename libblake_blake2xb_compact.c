@@ -0,0 +1,5 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+extern inline void libblake_blake2xb_compact(struct libblake_blake2xb_compact_state *compact, const struct libblake_blake2xb_state *state,
+                                             const struct libblake_blake2xb_params *params);
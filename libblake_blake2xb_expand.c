@@ -0,0 +1,9 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2xb_expand(struct libblake_blake2xb_state *state, const struct libblake_blake2xb_compact_state *compact)
+{
+	libblake_blake2xb_init(state, compact->params);
+	libblake_blake2b_expand(&state->b2b, &compact->b2b);
+}
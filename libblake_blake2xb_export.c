@@ -0,0 +1,8 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+size_t
+libblake_blake2xb_export(const struct libblake_blake2xb_state *state, void *buffer, size_t size)
+{
+	return libblake_internal_blake2xb_export(state, EXPORT_BLAKE2XB, NULL, 0, buffer, size);
+}
@@ -0,0 +1,5 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+extern inline void libblake_blake2xb_stream_digest(const struct libblake_blake2xb_stream *stream, uint_least32_t i,
+                                                   uint_least8_t len, unsigned char output[static len]);
@@ -0,0 +1,8 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+size_t
+libblake_blake2xb_stream_export(const struct libblake_blake2xb_stream *stream, void *buffer, size_t size)
+{
+	return libblake_internal_blake2xb_export(&stream->state, EXPORT_BLAKE2XB | EXPORT_STREAM, stream->buffer, stream->buffered, buffer, size);
+}
@@ -0,0 +1,12 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake2xb_stream_import(struct libblake_blake2xb_stream *stream, const void *buffer, size_t len)
+{
+	size_t nbuffered = 128;
+	if (libblake_internal_blake2xb_import(&stream->state, EXPORT_BLAKE2XB | EXPORT_STREAM, stream->buffer, &nbuffered, buffer, len))
+		return -1;
+	stream->buffered = nbuffered;
+	return 0;
+}
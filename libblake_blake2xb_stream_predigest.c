@@ -0,0 +1,9 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2xb_stream_predigest(struct libblake_blake2xb_stream *stream, const void *data, size_t len, int last_node)
+{
+	libblake_internal_blake2b_stream_update(&stream->state.b2b, stream->buffer, &stream->buffered, data, len);
+	libblake_blake2xb_predigest(&stream->state, stream->buffer, stream->buffered, last_node);
+}
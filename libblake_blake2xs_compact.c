@@ -0,0 +1,5 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+extern inline void libblake_blake2xs_compact(struct libblake_blake2xs_compact_state *compact, const struct libblake_blake2xs_state *state,
+                                             const struct libblake_blake2xs_params *params);
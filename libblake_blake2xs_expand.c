@@ -0,0 +1,9 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2xs_expand(struct libblake_blake2xs_state *state, const struct libblake_blake2xs_compact_state *compact)
+{
+	libblake_blake2xs_init(state, compact->params);
+	libblake_blake2s_expand(&state->b2s, &compact->b2s);
+}
@@ -0,0 +1,9 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake2xs_import(struct libblake_blake2xs_state *state, const void *buffer, size_t len)
+{
+	size_t nbuffered = 0;
+	return libblake_internal_blake2xs_import(state, EXPORT_BLAKE2XS, NULL, &nbuffered, buffer, len);
+}
@@ -0,0 +1,4 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+extern inline void libblake_blake2xs_predigest_const(struct libblake_blake2xs_state *state, const void *data, size_t len, int last_node);
@@ -0,0 +1,9 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2xs_stream_init(struct libblake_blake2xs_stream *stream, const struct libblake_blake2xs_params *params)
+{
+	libblake_blake2xs_init(&stream->state, params);
+	stream->buffered = 0;
+}
@@ -0,0 +1,12 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2xs_stream_peek(const struct libblake_blake2xs_stream *stream, int last_node, struct libblake_blake2xs_state *snapshot)
+{
+	unsigned char buffer[64];
+
+	*snapshot = stream->state;
+	memcpy(buffer, stream->buffer, stream->buffered);
+	libblake_blake2xs_predigest(snapshot, buffer, stream->buffered, last_node);
+}
@@ -0,0 +1,8 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake2xs_stream_update(struct libblake_blake2xs_stream *stream, const void *data, size_t len)
+{
+	libblake_internal_blake2s_stream_update(&stream->state.b2s, stream->buffer, &stream->buffered, data, len);
+}
@@ -0,0 +1,13 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake384_digest_const(struct libblake_blake384_state *state, const void *data, size_t len, size_t bits,
+                               const char *suffix, unsigned char output[static LIBBLAKE_BLAKE384_OUTPUT_SIZE])
+{
+	unsigned char buffer[256];
+	size_t buffered = 0;
+
+	libblake_internal_blakeb_stream_digest(&state->b, buffer, &buffered,
+	                                       data, len, bits, suffix, output, 384 / 64);
+}
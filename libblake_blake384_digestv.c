@@ -0,0 +1,9 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake384_digestv(struct libblake_blake384_state *state, const struct iovec *iov, size_t iovcnt, size_t bits,
+                          const char *suffix, unsigned char output[static LIBBLAKE_BLAKE384_OUTPUT_SIZE])
+{
+	libblake_internal_blakeb_digestv(&state->b, iov, iovcnt, bits, suffix, output, 384 / 64);
+}
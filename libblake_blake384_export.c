@@ -0,0 +1,8 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+size_t
+libblake_blake384_export(const struct libblake_blake384_state *state, void *buffer, size_t size)
+{
+	return libblake_internal_blakeb_export(&state->b, EXPORT_BLAKE384, NULL, 0, buffer, size);
+}
@@ -0,0 +1,9 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake384_import(struct libblake_blake384_state *state, const void *buffer, size_t len)
+{
+	size_t nbuffered = 0;
+	return libblake_internal_blakeb_import(&state->b, EXPORT_BLAKE384, NULL, &nbuffered, buffer, len);
+}
@@ -0,0 +1,8 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+size_t
+libblake_blake384_stream_export(const struct libblake_blake384_stream *stream, void *buffer, size_t size)
+{
+	return libblake_internal_blakeb_export(&stream->state.b, EXPORT_BLAKE384 | EXPORT_STREAM, stream->buffer, stream->buffered, buffer, size);
+}
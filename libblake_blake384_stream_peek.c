@@ -0,0 +1,8 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake384_stream_peek(const struct libblake_blake384_stream *stream, unsigned char output[static LIBBLAKE_BLAKE384_OUTPUT_SIZE])
+{
+	libblake_internal_blakeb_stream_peek(&stream->state.b, stream->buffer, stream->buffered, output, 384 / 64);
+}
@@ -0,0 +1,9 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake512_import(struct libblake_blake512_state *state, const void *buffer, size_t len)
+{
+	size_t nbuffered = 0;
+	return libblake_internal_blakeb_import(&state->b, EXPORT_BLAKE512, NULL, &nbuffered, buffer, len);
+}
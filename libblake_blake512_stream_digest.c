@@ -0,0 +1,10 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake512_stream_digest(struct libblake_blake512_stream *stream, const void *data, size_t len, size_t bits,
+                                const char *suffix, unsigned char output[static LIBBLAKE_BLAKE512_OUTPUT_SIZE])
+{
+	libblake_internal_blakeb_stream_digest(&stream->state.b, stream->buffer, &stream->buffered,
+	                                       data, len, bits, suffix, output, 512 / 64);
+}
@@ -0,0 +1,14 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_blake512_stream_import(struct libblake_blake512_stream *stream, const void *buffer, size_t len)
+{
+	/* As the buffer must not contain a whole block that has
+	 * not been processed, the maximum is less for BLAKE */
+	size_t nbuffered = 127;
+	if (libblake_internal_blakeb_import(&stream->state.b, EXPORT_BLAKE512 | EXPORT_STREAM, stream->buffer, &nbuffered, buffer, len))
+		return -1;
+	stream->buffered = nbuffered;
+	return 0;
+}
@@ -0,0 +1,9 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake512_stream_init2(struct libblake_blake512_stream *stream, const uint_least8_t salt[32])
+{
+	libblake_blake512_init2(&stream->state, salt);
+	stream->buffered = 0;
+}
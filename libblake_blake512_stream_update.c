@@ -0,0 +1,8 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_blake512_stream_update(struct libblake_blake512_stream *stream, const void *data, size_t len)
+{
+	libblake_internal_blakeb_stream_update(&stream->state.b, stream->buffer, &stream->buffered, data, len);
+}
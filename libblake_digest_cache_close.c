@@ -0,0 +1,12 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_digest_cache_close(struct libblake_digest_cache *cache)
+{
+	if (cache->map)
+		munmap(cache->map, cache->map_size);
+	close(cache->fd);
+	pthread_mutex_destroy(cache->mutex);
+	free(cache->mutex);
+}
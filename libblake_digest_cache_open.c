@@ -0,0 +1,32 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_digest_cache_open(struct libblake_digest_cache *cache, const char *path)
+{
+	pthread_mutex_t *mutex;
+	int err;
+
+	mutex = malloc(sizeof(*mutex));
+	if (!mutex)
+		return -1;
+	if ((err = pthread_mutex_init(mutex, NULL))) {
+		free(mutex);
+		errno = err;
+		return -1;
+	}
+
+	/* The file is initialised when the first hash is stored */
+	cache->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+	if (cache->fd < 0) {
+		err = errno;
+		pthread_mutex_destroy(mutex);
+		free(mutex);
+		errno = err;
+		return -1;
+	}
+	cache->mutex = mutex;
+	cache->map = NULL;
+	cache->map_size = 0;
+	return 0;
+}
@@ -0,0 +1,99 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+/* Each operation in this file is a loop over the lanes, which
+ * the compiler turns into vector instructions (-O3 is required
+ * for GCC), without the need for any intrinsics; with only SSE2
+ * this is slower than compressing one block at a time, hence
+ * TARGET_CLONES */
+
+static uint_least64_t
+decode_uint64_le(const unsigned char *data)
+{
+	/* This is perfectly optimised by the compiler */
+	return (((uint_least64_t)(data[0] & 255)) <<  0) |
+	       (((uint_least64_t)(data[1] & 255)) <<  8) |
+	       (((uint_least64_t)(data[2] & 255)) << 16) |
+	       (((uint_least64_t)(data[3] & 255)) << 24) |
+	       (((uint_least64_t)(data[4] & 255)) << 32) |
+	       (((uint_least64_t)(data[5] & 255)) << 40) |
+	       (((uint_least64_t)(data[6] & 255)) << 48) |
+	       (((uint_least64_t)(data[7] & 255)) << 56);
+}
+
+static uint_least64_t
+rotate_right(uint_least64_t x, int n)
+{
+	/* This is perfectly optimised by the compiler */
+	return ((x >> n) | (x << (64 - n))) & UINT_LEAST64_C(0xFFFFffffFFFFffff);
+}
+
+TARGET_CLONES void
+libblake_internal_blake2b_compress_lanes(struct libblake_internal_blake2b_lanes *lanes,
+                                         const unsigned char *const blocks[BLAKE2B_LANES])
+{
+	static const uint_least64_t iv[8] = {
+		UINT_LEAST64_C(0x6A09E667F3BCC908), UINT_LEAST64_C(0xBB67AE8584CAA73B),
+		UINT_LEAST64_C(0x3C6EF372FE94F82B), UINT_LEAST64_C(0xA54FF53A5F1D36F1),
+		UINT_LEAST64_C(0x510E527FADE682D1), UINT_LEAST64_C(0x9B05688C2B3E6C1F),
+		UINT_LEAST64_C(0x1F83D9ABFB41BD6B), UINT_LEAST64_C(0x5BE0CD19137E2179)
+	};
+	uint_least64_t v[16][BLAKE2B_LANES], m[16][BLAKE2B_LANES];
+	size_t i, l;
+
+	for (l = 0; l < BLAKE2B_LANES; l++)
+		for (i = 0; i < 16; i++)
+			m[i][l] = decode_uint64_le(&blocks[l][i * 8]);
+
+	for (i = 0; i < 8; i++) {
+		for (l = 0; l < BLAKE2B_LANES; l++) {
+			v[i][l] = lanes->h[i][l];
+			v[i + 8][l] = iv[i];
+		}
+	}
+	for (l = 0; l < BLAKE2B_LANES; l++) {
+		v[C][l] ^= lanes->t[0][l];
+		v[D][l] ^= lanes->t[1][l];
+		v[E][l] ^= lanes->f[0][l];
+		v[F][l] ^= lanes->f[1][l];
+	}
+
+#define G2B(mj, mk, a, b, c, d)\
+	for (l = 0; l < BLAKE2B_LANES; l++) {\
+		a[l] = (a[l] + b[l] + mj[l]) & UINT_LEAST64_C(0xFFFFffffFFFFffff);\
+		d[l] = rotate_right(d[l] ^ a[l], 32);\
+		c[l] = (c[l] + d[l]) & UINT_LEAST64_C(0xFFFFffffFFFFffff);\
+		b[l] = rotate_right(b[l] ^ c[l], 24);\
+		a[l] = (a[l] + b[l] + mk[l]) & UINT_LEAST64_C(0xFFFFffffFFFFffff);\
+		d[l] = rotate_right(d[l] ^ a[l], 16);\
+		c[l] = (c[l] + d[l]) & UINT_LEAST64_C(0xFFFFffffFFFFffff);\
+		b[l] = rotate_right(b[l] ^ c[l], 63);\
+	}
+
+#define ROUND2B(S0, S1, S2, S3, S4, S5, S6, S7, S8, S9, SA, SB, SC, SD, SE, SF)\
+	G2B(m[S0], m[S1], v[0], v[4], v[8], v[C]);\
+	G2B(m[S2], m[S3], v[1], v[5], v[9], v[D]);\
+	G2B(m[S4], m[S5], v[2], v[6], v[A], v[E]);\
+	G2B(m[S6], m[S7], v[3], v[7], v[B], v[F]);\
+	G2B(m[S8], m[S9], v[0], v[5], v[A], v[F]);\
+	G2B(m[SA], m[SB], v[1], v[6], v[B], v[C]);\
+	G2B(m[SC], m[SD], v[2], v[7], v[8], v[D]);\
+	G2B(m[SE], m[SF], v[3], v[4], v[9], v[E])
+
+	ROUND2B(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, A, B, C, D, E, F);
+	ROUND2B(E, A, 4, 8, 9, F, D, 6, 1, C, 0, 2, B, 7, 5, 3);
+	ROUND2B(B, 8, C, 0, 5, 2, F, D, A, E, 3, 6, 7, 1, 9, 4);
+	ROUND2B(7, 9, 3, 1, D, C, B, E, 2, 6, 5, A, 4, 0, F, 8);
+	ROUND2B(9, 0, 5, 7, 2, 4, A, F, E, 1, B, C, 6, 8, 3, D);
+	ROUND2B(2, C, 6, A, 0, B, 8, 3, 4, D, 7, 5, F, E, 1, 9);
+	ROUND2B(C, 5, 1, F, E, D, 4, A, 0, 7, 6, 3, 9, 2, 8, B);
+	ROUND2B(D, B, 7, E, C, 1, 3, 9, 5, 0, F, 4, 8, 6, 2, A);
+	ROUND2B(6, F, E, 9, B, 3, 0, 8, C, 2, D, 7, 1, 4, A, 5);
+	ROUND2B(A, 2, 8, 4, 7, 6, 1, 5, F, B, 9, E, 3, C, D, 0);
+	ROUND2B(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, A, B, C, D, E, F);
+	ROUND2B(E, A, 4, 8, 9, F, D, 6, 1, C, 0, 2, B, 7, 5, 3);
+
+	for (i = 0; i < 8; i++)
+		for (l = 0; l < BLAKE2B_LANES; l++)
+			lanes->h[i][l] ^= v[i][l] ^ v[i + 8][l];
+}
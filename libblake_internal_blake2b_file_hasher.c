@@ -0,0 +1,51 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+static void
+init(void *ctx_, void *stream, int directory)
+{
+	struct libblake_internal_blake2b_file_context *ctx = ctx_;
+	libblake_blake2b_stream_init(stream, directory ? &ctx->dir_params : ctx->params);
+	if (ctx->params->key_len)
+		libblake_blake2b_stream_update(stream, ctx->key_block, sizeof(ctx->key_block));
+}
+
+static void
+update(void *stream, const void *data, size_t len)
+{
+	libblake_blake2b_stream_update(stream, data, len);
+}
+
+static void
+digest(void *ctx_, void *stream, unsigned char *output)
+{
+	struct libblake_internal_blake2b_file_context *ctx = ctx_;
+	libblake_blake2b_stream_digest(stream, NULL, 0, 0, (size_t)ctx->params->digest_len, output);
+}
+
+void
+libblake_internal_blake2b_file_hasher(struct libblake_internal_file_hasher *hasher,
+                                      struct libblake_internal_blake2b_file_context *ctx,
+                                      const struct libblake_blake2b_params *params, const void *key,
+                                      struct libblake_digest_cache *cache)
+{
+	ctx->params = params;
+	/* Directory listings are separated from file contents */
+	ctx->dir_params = *params;
+	ctx->dir_params.node_depth += 1;
+	memset(ctx->key_block, 0, sizeof(ctx->key_block));
+	if (params->key_len)
+		memcpy(ctx->key_block, key, (size_t)params->key_len);
+
+	hasher->ctx = ctx;
+	hasher->digest_len = (size_t)params->digest_len;
+	hasher->init = &init;
+	hasher->update = &update;
+	hasher->digest = &digest;
+	hasher->cache = cache;
+
+	/* The cache identifies the algorithm, the parameters and the key by
+	 * their hash, so that the key cannot be recovered from the cache */
+	if (cache)
+		libblake_internal_blake2b_identity(params, ctx->key_block, hasher->identity);
+}
@@ -0,0 +1,52 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_internal_blake2b_hash_blocks(const struct libblake_blake2b_state *initial, const unsigned char *data,
+                                      size_t block_size, size_t n, size_t digest_len,
+                                      unsigned char *output, size_t output_stride)
+{
+	struct libblake_blake2b_table table;
+	struct libblake_blake2b_scheduler scheduler;
+	struct libblake_blake2b_state state;
+	size_t i, k, m, done = 0;
+
+	/* Too few blocks to fill the lanes (verity verification hashes
+	 * one block per level) are hashed directly, as setting up the
+	 * table and scheduler would cost more than the hashing */
+	if (n < BLAKE2B_LANES) {
+		for (i = 0; i < n; i++) {
+			state = *initial;
+			libblake_blake2b_digest_const(&state, &data[i * block_size], block_size,
+			                              0, digest_len, &output[i * output_stride]);
+		}
+		return 0;
+	}
+
+	if (libblake_blake2b_table_create(&table, HASH_BLOCKS_GROUP))
+		return -1;
+	if (libblake_blake2b_scheduler_create(&scheduler, &table, HASH_BLOCKS_GROUP)) {
+		libblake_blake2b_table_destroy(&table);
+		return -1;
+	}
+
+	/* All blocks have the same length, so the same number of bytes is
+	 * processed by the scheduler, and left for the final block, in each */
+	for (i = 0; i < n; i += m) {
+		m = n - i < HASH_BLOCKS_GROUP ? n - i : HASH_BLOCKS_GROUP;
+		for (k = 0; k < m; k++) {
+			libblake_blake2b_table_store(&table, k, initial);
+			done = libblake_blake2b_scheduler_enqueue(&scheduler, k, &data[(i + k) * block_size], block_size);
+		}
+		libblake_blake2b_scheduler_run(&scheduler);
+		for (k = 0; k < m; k++) {
+			libblake_blake2b_table_load(&table, k, &state);
+			libblake_blake2b_digest_const(&state, &data[(i + k) * block_size + done], block_size - done,
+			                              0, digest_len, &output[(i + k) * output_stride]);
+		}
+	}
+
+	libblake_blake2b_scheduler_destroy(&scheduler);
+	libblake_blake2b_table_destroy(&table);
+	return 0;
+}
@@ -0,0 +1,95 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_internal_blake2b_signature_finish(struct libblake_internal_blake2b_signature_builder *builder)
+{
+	struct libblake_blake2b_signature *sig = builder->sig;
+	struct libblake_blake2b_state state;
+	uint_least32_t *weak = NULL, w;
+	unsigned char *digests = NULL, digest[64];
+	size_t *blocks = NULL, nbuckets, bucket, i, j, n, block;
+
+	if (builder->error)
+		goto fail;
+
+	/* The last block may be partial; there is always room for it */
+	if (builder->ncarry) {
+		n = sig->nblocks++;
+		sig->weak[n] = libblake_rolling_checksum(builder->carry, builder->ncarry);
+		state = sig->initial;
+		libblake_blake2b_digest_const(&state, builder->carry, builder->ncarry, 0, sig->digest_len,
+		                              &sig->digests[n * sig->digest_len]);
+	}
+	free(builder->carry);
+	builder->carry = NULL;
+
+	/* About one block per bucket */
+	for (sig->index_bits = 1; sig->index_bits < SIGNATURE_MAX_INDEX_BITS; sig->index_bits++)
+		if (((size_t)1 << sig->index_bits) >= sig->nblocks)
+			break;
+	nbuckets = (size_t)1 << sig->index_bits;
+	n = sig->nblocks ? sig->nblocks : 1;
+	sig->index = calloc(nbuckets + 1, sizeof(*sig->index));
+	weak = malloc(n * sizeof(*weak));
+	blocks = malloc(n * sizeof(*blocks));
+	digests = malloc(n * sig->digest_len);
+	if (!sig->index || !weak || !blocks || !digests) {
+		builder->error = ENOMEM;
+		goto fail;
+	}
+
+	/* Counting sort by bucket, which keeps the blocks in order within
+	 * each bucket; afterwards, `sig->index[i]` is the end of bucket `i`,
+	 * until it is shifted so that it is the start of bucket `i` */
+	for (i = 0; i < sig->nblocks; i++)
+		sig->index[SIGNATURE_BUCKET(sig->weak[i], sig->index_bits) + 1] += 1;
+	for (i = 1; i < nbuckets; i++)
+		sig->index[i] += sig->index[i - 1];
+	for (i = 0; i < sig->nblocks; i++) {
+		bucket = SIGNATURE_BUCKET(sig->weak[i], sig->index_bits);
+		j = sig->index[bucket]++;
+		weak[j] = sig->weak[i];
+		blocks[j] = i;
+		memcpy(&digests[j * sig->digest_len], &sig->digests[i * sig->digest_len], sig->digest_len);
+	}
+	memmove(&sig->index[1], &sig->index[0], nbuckets * sizeof(*sig->index));
+	sig->index[0] = 0;
+
+	/* Buckets are small, so insertion sort is used to sort them by
+	 * weak checksum; it is stable so equal checksums stay in block order */
+	for (bucket = 0; bucket < nbuckets; bucket++) {
+		for (i = sig->index[bucket] + 1; i < sig->index[bucket + 1]; i++) {
+			w = weak[i];
+			block = blocks[i];
+			memcpy(digest, &digests[i * sig->digest_len], sig->digest_len);
+			for (j = i; j > sig->index[bucket] && weak[j - 1] > w; j--) {
+				weak[j] = weak[j - 1];
+				blocks[j] = blocks[j - 1];
+				memcpy(&digests[j * sig->digest_len], &digests[(j - 1) * sig->digest_len], sig->digest_len);
+			}
+			weak[j] = w;
+			blocks[j] = block;
+			memcpy(&digests[j * sig->digest_len], digest, sig->digest_len);
+		}
+	}
+
+	free(sig->weak);
+	free(sig->digests);
+	sig->weak = weak;
+	sig->blocks = blocks;
+	sig->digests = digests;
+	return 0;
+
+fail:
+	free(builder->carry);
+	free(sig->index);
+	free(sig->weak);
+	free(sig->digests);
+	free(weak);
+	free(blocks);
+	free(digests);
+	memset(sig, 0, sizeof(*sig));
+	errno = builder->error;
+	return -1;
+}
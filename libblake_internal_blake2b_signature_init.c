@@ -0,0 +1,48 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_internal_blake2b_signature_init(struct libblake_internal_blake2b_signature_builder *builder,
+                                         struct libblake_blake2b_signature *sig,
+                                         const struct libblake_blake2b_params *params, const void *key,
+                                         size_t block_size, size_t size_hint)
+{
+	unsigned char key_block[128];
+
+	if (!block_size) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	memset(sig, 0, sizeof(*sig));
+	sig->block_size = block_size;
+	sig->digest_len = (size_t)params->digest_len;
+
+	/* Blocks are never empty, so the key block is never the last block */
+	libblake_blake2b_init(&sig->initial, params);
+	if (params->key_len) {
+		memset(key_block, 0, sizeof(key_block));
+		memcpy(key_block, key, (size_t)params->key_len);
+		libblake_blake2b_force_update(&sig->initial, key_block, sizeof(key_block));
+	}
+
+	builder->sig = sig;
+	builder->ncarry = 0;
+	builder->error = 0;
+	/* The hint is only used if it is reasonable */
+	builder->capacity = size_hint / block_size + 1;
+	if (builder->capacity > SIZE_MAX / 64)
+		builder->capacity = 1;
+	builder->carry = malloc(block_size);
+	sig->weak = malloc(builder->capacity * sizeof(*sig->weak));
+	sig->digests = malloc(builder->capacity * sig->digest_len);
+	if (!builder->carry || !sig->weak || !sig->digests) {
+		free(builder->carry);
+		free(sig->weak);
+		free(sig->digests);
+		memset(sig, 0, sizeof(*sig));
+		errno = ENOMEM;
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,85 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+static void
+add_blocks(struct libblake_internal_blake2b_signature_builder *builder, const unsigned char *data, size_t n)
+{
+	struct libblake_blake2b_signature *sig = builder->sig;
+	size_t capacity, i;
+	void *new;
+
+	/* There is always room for one more block, for
+	 * libblake_internal_blake2b_signature_finish */
+	if (sig->nblocks + n + 1 > builder->capacity) {
+		capacity = builder->capacity;
+		while (capacity < sig->nblocks + n + 1)
+			capacity *= 2;
+		if (capacity > SIZE_MAX / 64)
+			goto enomem;
+		new = realloc(sig->weak, capacity * sizeof(*sig->weak));
+		if (!new)
+			goto enomem;
+		sig->weak = new;
+		new = realloc(sig->digests, capacity * sig->digest_len);
+		if (!new)
+			goto enomem;
+		sig->digests = new;
+		builder->capacity = capacity;
+	}
+
+	/* All blocks are hashed in parallel, many at a time */
+	if (libblake_internal_blake2b_hash_blocks(&sig->initial, data, sig->block_size, n, sig->digest_len,
+	                                          &sig->digests[sig->nblocks * sig->digest_len], sig->digest_len)) {
+		builder->error = errno;
+		return;
+	}
+	for (i = 0; i < n; i++)
+		sig->weak[sig->nblocks + i] = libblake_rolling_checksum(&data[i * sig->block_size], sig->block_size);
+	sig->nblocks += n;
+	return;
+
+enomem:
+	builder->error = ENOMEM;
+}
+
+void
+libblake_internal_blake2b_signature_update(void *builder_, const void *data_, size_t len)
+{
+	struct libblake_internal_blake2b_signature_builder *builder = builder_;
+	size_t block_size = builder->sig->block_size, n;
+	const unsigned char *data = data_;
+
+	if (builder->error)
+		return;
+	builder->sig->size += (uint_least64_t)len;
+
+	/* Complete the block that the previous call ended in */
+	if (builder->ncarry) {
+		n = block_size - builder->ncarry < len ? block_size - builder->ncarry : len;
+		memcpy(&builder->carry[builder->ncarry], data, n);
+		builder->ncarry += n;
+		data = &data[n];
+		len -= n;
+		if (builder->ncarry < block_size)
+			return;
+		add_blocks(builder, builder->carry, 1);
+		builder->ncarry = 0;
+		if (builder->error)
+			return;
+	}
+
+	/* Hash the complete blocks in place */
+	n = len / block_size;
+	if (n) {
+		add_blocks(builder, data, n);
+		if (builder->error)
+			return;
+		data = &data[n * block_size];
+		len -= n * block_size;
+	}
+
+	if (len) {
+		memcpy(builder->carry, data, len);
+		builder->ncarry = len;
+	}
+}
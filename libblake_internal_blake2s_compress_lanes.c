@@ -0,0 +1,93 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+/* Each operation in this file is a loop over the lanes, which
+ * the compiler turns into vector instructions (-O3 is required
+ * for GCC), without the need for any intrinsics; with only SSE2
+ * this is slower than compressing one block at a time, hence
+ * TARGET_CLONES */
+
+static uint_least32_t
+decode_uint32_le(const unsigned char *data)
+{
+	/* This is perfectly optimised by the compiler */
+	return (((uint_least32_t)(data[0] & 255)) <<  0) |
+	       (((uint_least32_t)(data[1] & 255)) <<  8) |
+	       (((uint_least32_t)(data[2] & 255)) << 16) |
+	       (((uint_least32_t)(data[3] & 255)) << 24);
+}
+
+static uint_least32_t
+rotate_right(uint_least32_t x, int n)
+{
+	/* This is perfectly optimised by the compiler */
+	return ((x >> n) | (x << (32 - n))) & UINT_LEAST32_C(0xFFFFffff);
+}
+
+TARGET_CLONES void
+libblake_internal_blake2s_compress_lanes(struct libblake_internal_blake2s_lanes *lanes,
+                                         const unsigned char *const blocks[BLAKE2S_LANES])
+{
+	static const uint_least32_t iv[8] = {
+		UINT_LEAST32_C(0x6A09E667), UINT_LEAST32_C(0xBB67AE85),
+		UINT_LEAST32_C(0x3C6EF372), UINT_LEAST32_C(0xA54FF53A),
+		UINT_LEAST32_C(0x510E527F), UINT_LEAST32_C(0x9B05688C),
+		UINT_LEAST32_C(0x1F83D9AB), UINT_LEAST32_C(0x5BE0CD19)
+	};
+	uint_least32_t v[16][BLAKE2S_LANES], m[16][BLAKE2S_LANES];
+	size_t i, l;
+
+	for (l = 0; l < BLAKE2S_LANES; l++)
+		for (i = 0; i < 16; i++)
+			m[i][l] = decode_uint32_le(&blocks[l][i * 4]);
+
+	for (i = 0; i < 8; i++) {
+		for (l = 0; l < BLAKE2S_LANES; l++) {
+			v[i][l] = lanes->h[i][l];
+			v[i + 8][l] = iv[i];
+		}
+	}
+	for (l = 0; l < BLAKE2S_LANES; l++) {
+		v[C][l] ^= lanes->t[0][l];
+		v[D][l] ^= lanes->t[1][l];
+		v[E][l] ^= lanes->f[0][l];
+		v[F][l] ^= lanes->f[1][l];
+	}
+
+#define G2S(mj, mk, a, b, c, d)\
+	for (l = 0; l < BLAKE2S_LANES; l++) {\
+		a[l] = (a[l] + b[l] + mj[l]) & UINT_LEAST32_C(0xFFFFffff);\
+		d[l] = rotate_right(d[l] ^ a[l], 16);\
+		c[l] = (c[l] + d[l]) & UINT_LEAST32_C(0xFFFFffff);\
+		b[l] = rotate_right(b[l] ^ c[l], 12);\
+		a[l] = (a[l] + b[l] + mk[l]) & UINT_LEAST32_C(0xFFFFffff);\
+		d[l] = rotate_right(d[l] ^ a[l], 8);\
+		c[l] = (c[l] + d[l]) & UINT_LEAST32_C(0xFFFFffff);\
+		b[l] = rotate_right(b[l] ^ c[l], 7);\
+	}
+
+#define ROUND2S(S0, S1, S2, S3, S4, S5, S6, S7, S8, S9, SA, SB, SC, SD, SE, SF)\
+	G2S(m[S0], m[S1], v[0], v[4], v[8], v[C]);\
+	G2S(m[S2], m[S3], v[1], v[5], v[9], v[D]);\
+	G2S(m[S4], m[S5], v[2], v[6], v[A], v[E]);\
+	G2S(m[S6], m[S7], v[3], v[7], v[B], v[F]);\
+	G2S(m[S8], m[S9], v[0], v[5], v[A], v[F]);\
+	G2S(m[SA], m[SB], v[1], v[6], v[B], v[C]);\
+	G2S(m[SC], m[SD], v[2], v[7], v[8], v[D]);\
+	G2S(m[SE], m[SF], v[3], v[4], v[9], v[E])
+
+	ROUND2S(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, A, B, C, D, E, F);
+	ROUND2S(E, A, 4, 8, 9, F, D, 6, 1, C, 0, 2, B, 7, 5, 3);
+	ROUND2S(B, 8, C, 0, 5, 2, F, D, A, E, 3, 6, 7, 1, 9, 4);
+	ROUND2S(7, 9, 3, 1, D, C, B, E, 2, 6, 5, A, 4, 0, F, 8);
+	ROUND2S(9, 0, 5, 7, 2, 4, A, F, E, 1, B, C, 6, 8, 3, D);
+	ROUND2S(2, C, 6, A, 0, B, 8, 3, 4, D, 7, 5, F, E, 1, 9);
+	ROUND2S(C, 5, 1, F, E, D, 4, A, 0, 7, 6, 3, 9, 2, 8, B);
+	ROUND2S(D, B, 7, E, C, 1, 3, 9, 5, 0, F, 4, 8, 6, 2, A);
+	ROUND2S(6, F, E, 9, B, 3, 0, 8, C, 2, D, 7, 1, 4, A, 5);
+	ROUND2S(A, 2, 8, 4, 7, 6, 1, 5, F, B, 9, E, 3, C, D, 0);
+
+	for (i = 0; i < 8; i++)
+		for (l = 0; l < BLAKE2S_LANES; l++)
+			lanes->h[i][l] ^= v[i][l] ^ v[i + 8][l];
+}
@@ -0,0 +1,15 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+size_t
+libblake_internal_blake2s_export(const struct libblake_blake2s_state *state, int id, const unsigned char *buffered, size_t nbuffered,
+                                 void *buffer, size_t size)
+{
+	uint_least32_t words[12];
+
+	memcpy(&words[0], state->h, sizeof(state->h));
+	memcpy(&words[8], state->t, sizeof(state->t));
+	memcpy(&words[10], state->f, sizeof(state->f));
+
+	return libblake_internal_export(id, sizeof(*words), words, 12, buffered, nbuffered, buffer, size);
+}
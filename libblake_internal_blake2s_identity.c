@@ -0,0 +1,30 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_internal_blake2s_identity(const struct libblake_blake2s_params *params, const void *key, unsigned char identity[32])
+{
+	unsigned char buf[sizeof("BLAKE2s") + 18 + 2 * sizeof(params->salt) + 32];
+	size_t n = 0;
+	int i;
+
+	memcpy(&buf[n], "BLAKE2s", sizeof("BLAKE2s"));
+	n += sizeof("BLAKE2s");
+	buf[n++] = params->digest_len;
+	buf[n++] = params->key_len;
+	buf[n++] = params->fanout;
+	buf[n++] = params->depth;
+	for (i = 0; i < 4; i++)
+		buf[n++] = (unsigned char)(params->leaf_len >> (8 * i));
+	for (i = 0; i < 8; i++)
+		buf[n++] = (unsigned char)(params->node_offset >> (8 * i));
+	buf[n++] = params->node_depth;
+	buf[n++] = params->inner_len;
+	memcpy(&buf[n], params->salt, sizeof(params->salt));
+	n += sizeof(params->salt);
+	memcpy(&buf[n], params->pepper, sizeof(params->pepper));
+	n += sizeof(params->pepper);
+	memcpy(&buf[n], key, (size_t)params->key_len);
+	n += (size_t)params->key_len;
+	libblake_blake2s(identity, 32, buf, n, NULL, 0);
+}
@@ -0,0 +1,17 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_internal_blake2s_import(struct libblake_blake2s_state *state, int id, unsigned char *buffered, size_t *nbufferedp,
+                                 const void *buffer, size_t len)
+{
+	uint_least32_t words[12];
+
+	if (libblake_internal_import(id, sizeof(*words), words, 12, buffered, 0, nbufferedp, buffer, len))
+		return -1;
+
+	memcpy(state->h, &words[0], sizeof(state->h));
+	memcpy(state->t, &words[8], sizeof(state->t));
+	memcpy(state->f, &words[10], sizeof(state->f));
+	return 0;
+}
@@ -0,0 +1,31 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_internal_blake2s_stream_update(struct libblake_blake2s_state *state, unsigned char *buffer, size_t *buffered,
+                                        const unsigned char *data, size_t len)
+{
+	size_t n;
+
+	if (!len)
+		return;
+
+	if (*buffered) {
+		n = 64 - *buffered;
+		if (n > len)
+			n = len;
+		memcpy(&buffer[*buffered], data, n);
+		*buffered += n;
+		data = &data[n];
+		len -= n;
+		if (!len)
+			return;
+		/* The buffer is full, but since there is more
+		 * data, it does not contain the last block */
+		libblake_blake2s_force_update(state, buffer, 64);
+	}
+
+	n = libblake_blake2s_update(state, data, len);
+	memcpy(buffer, &data[n], len - n);
+	*buffered = len - n;
+}
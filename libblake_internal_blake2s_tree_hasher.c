@@ -0,0 +1,63 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+static void
+init(void *ctx_, void *stream, uint_least64_t node_offset, size_t node_depth, int root)
+{
+	struct libblake_internal_blake2s_tree_context *ctx = ctx_;
+	struct libblake_blake2s_params params = ctx->params;
+
+	/* Only the root has the requested digest length */
+	params.node_offset = node_offset;
+	params.node_depth = (uint_least8_t)node_depth;
+	if (!root)
+		params.digest_len = params.inner_len;
+	libblake_blake2s_stream_init(stream, &params);
+	if (params.key_len)
+		libblake_blake2s_stream_update(stream, ctx->key_block, sizeof(ctx->key_block));
+}
+
+static void
+update(void *stream, const void *data, size_t len)
+{
+	libblake_blake2s_stream_update(stream, data, len);
+}
+
+static void
+digest(void *ctx_, void *stream, int last_node, int root, unsigned char *output)
+{
+	struct libblake_internal_blake2s_tree_context *ctx = ctx_;
+	size_t len = (size_t)(root ? ctx->params.digest_len : ctx->params.inner_len);
+	libblake_blake2s_stream_digest(stream, NULL, 0, last_node, len, output);
+}
+
+int
+libblake_internal_blake2s_tree_hasher(struct libblake_internal_tree_hasher *hasher,
+                                      struct libblake_internal_blake2s_tree_context *ctx,
+                                      const struct libblake_blake2s_params *params, const void *key)
+{
+	/* The node offsets and depths are assigned to the nodes */
+	if (params->fanout == 1 || params->depth < 2 || !params->leaf_len ||
+	    !params->inner_len || params->inner_len > 32 ||
+	    params->node_offset || params->node_depth) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	ctx->params = *params;
+	memset(ctx->key_block, 0, sizeof(ctx->key_block));
+	if (params->key_len)
+		memcpy(ctx->key_block, key, (size_t)params->key_len);
+
+	hasher->ctx = ctx;
+	hasher->digest_len = (size_t)params->digest_len;
+	hasher->inner_len = (size_t)params->inner_len;
+	hasher->leaf_len = (uint_least64_t)params->leaf_len;
+	hasher->fanout = (uint_least64_t)params->fanout;
+	hasher->depth = (size_t)params->depth;
+	hasher->init = &init;
+	hasher->update = &update;
+	hasher->digest = &digest;
+	libblake_internal_blake2s_identity(params, ctx->key_block, hasher->identity);
+	return 0;
+}
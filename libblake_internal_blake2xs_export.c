@@ -0,0 +1,31 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+size_t
+libblake_internal_blake2xs_export(const struct libblake_blake2xs_state *state, int id, const unsigned char *buffered, size_t nbuffered,
+                                  void *buffer, size_t size)
+{
+	uint_least32_t words[15];
+	unsigned char bytes[86 + 64];
+
+	memcpy(&words[0], state->b2s.h, sizeof(state->b2s.h));
+	memcpy(&words[8], state->b2s.t, sizeof(state->b2s.t));
+	memcpy(&words[10], state->b2s.f, sizeof(state->b2s.f));
+	words[12] = (uint_least32_t)state->xof_params.leaf_len;
+	words[13] = (uint_least32_t)state->xof_params.node_offset;
+	words[14] = (uint_least32_t)state->xof_params.xof_len;
+
+	bytes[0] = (unsigned char)state->xof_params.digest_len;
+	bytes[1] = (unsigned char)state->xof_params.key_len;
+	bytes[2] = (unsigned char)state->xof_params.fanout;
+	bytes[3] = (unsigned char)state->xof_params.depth;
+	bytes[4] = (unsigned char)state->xof_params.node_depth;
+	bytes[5] = (unsigned char)state->xof_params.inner_len;
+	memcpy(&bytes[6], state->xof_params.salt, 8);
+	memcpy(&bytes[6 + 8], state->xof_params.pepper, 8);
+	memcpy(&bytes[6 + 2 * 8], state->intermediate, 64);
+	if (nbuffered)
+		memcpy(&bytes[86], buffered, nbuffered);
+
+	return libblake_internal_export(id, sizeof(*words), words, 15, bytes, 86 + nbuffered, buffer, size);
+}
@@ -0,0 +1,35 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_internal_blake2xs_import(struct libblake_blake2xs_state *state, int id, unsigned char *buffered, size_t *nbufferedp,
+                                  const void *buffer, size_t len)
+{
+	uint_least32_t words[15];
+	unsigned char bytes[86 + 64];
+	size_t nbytes = 86 + *nbufferedp;
+
+	if (libblake_internal_import(id, sizeof(*words), words, 15, bytes, 86, &nbytes, buffer, len))
+		return -1;
+
+	memcpy(state->b2s.h, &words[0], sizeof(state->b2s.h));
+	memcpy(state->b2s.t, &words[8], sizeof(state->b2s.t));
+	memcpy(state->b2s.f, &words[10], sizeof(state->b2s.f));
+	state->xof_params.leaf_len = (uint_least32_t)words[12];
+	state->xof_params.node_offset = (uint_least32_t)words[13];
+	state->xof_params.xof_len = (uint_least16_t)words[14];
+
+	state->xof_params.digest_len = (uint_least8_t)bytes[0];
+	state->xof_params.key_len = (uint_least8_t)bytes[1];
+	state->xof_params.fanout = (uint_least8_t)bytes[2];
+	state->xof_params.depth = (uint_least8_t)bytes[3];
+	state->xof_params.node_depth = (uint_least8_t)bytes[4];
+	state->xof_params.inner_len = (uint_least8_t)bytes[5];
+	memcpy(state->xof_params.salt, &bytes[6], 8);
+	memcpy(state->xof_params.pepper, &bytes[6 + 8], 8);
+	memcpy(state->intermediate, &bytes[6 + 2 * 8], 64);
+	*nbufferedp = nbytes - 86;
+	if (*nbufferedp)
+		memcpy(buffered, &bytes[86], *nbufferedp);
+	return 0;
+}
@@ -53,7 +53,7 @@ libblake_internal_blakeb_digest(struct libblake_blakeb_state *state, unsigned ch
 		state->t[0] = UINT_LEAST64_C(0xFFFFffffFFFFfc00) + (uint_least64_t)bits;
 		state->t[1] = (state->t[1] - 1) & UINT_LEAST64_C(0xFFFFffffFFFFffff);
 	} else {
-		state->t[1] -= (uint_least64_t)(1024U - bits);
+		state->t[0] -= (uint_least64_t)(1024U - bits);
 	}
 
 	if (bits < 1024 - (1 + 2 * 64)) {
@@ -63,7 +63,7 @@ libblake_internal_blakeb_digest(struct libblake_blakeb_state *state, unsigned ch
 		data += libblake_internal_blakeb_update(state, data, 1024 / 8);
 		state->t[0] = UINT_LEAST64_C(0xFFFFffffFFFFfc00);
 		state->t[1] = UINT_LEAST64_C(0xFFFFffffFFFFffff);
-		memset(data, 0, (1024 - 2 * 64) / 8 - len);
+		memset(data, 0, (1024 - 2 * 64) / 8);
 	}
 	if (words_out == 8)
 		data[(1024 - 2 * 64) / 8 - 1] |= 1;
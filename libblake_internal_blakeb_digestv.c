@@ -0,0 +1,32 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_internal_blakeb_digestv(struct libblake_blakeb_state *state, const struct iovec *iov, size_t iovcnt,
+                                 size_t bits, const char *suffix, unsigned char *output, size_t words_out)
+{
+	unsigned char buffer[256];
+	const unsigned char *last = NULL;
+	size_t buffered = 0, len = 0;
+
+	/* The partial byte, if any, is the last byte of the input,
+	 * and must not be processed as a whole byte, so it is
+	 * removed from the last non-empty segment and passed to
+	 * libblake_internal_blakeb_stream_digest separately */
+	bits &= 7;
+	if (bits) {
+		while (iovcnt && !iov[iovcnt - 1].iov_len)
+			iovcnt--;
+		if (iovcnt) {
+			len = iov[--iovcnt].iov_len - 1;
+			last = iov[iovcnt].iov_base;
+		} else {
+			bits = 0;
+		}
+	}
+
+	for (; iovcnt; iov++, iovcnt--)
+		libblake_internal_blakeb_stream_update(state, buffer, &buffered, iov->iov_base, iov->iov_len);
+
+	libblake_internal_blakeb_stream_digest(state, buffer, &buffered, last, len, bits, suffix, output, words_out);
+}
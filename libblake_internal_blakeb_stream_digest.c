@@ -0,0 +1,37 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_internal_blakeb_stream_digest(struct libblake_blakeb_state *state, unsigned char *buffer, size_t *buffered,
+                                       const unsigned char *data, size_t len, size_t bits, const char *suffix,
+                                       unsigned char *output, size_t words_out)
+{
+	size_t n;
+
+	len += bits >> 3;
+	bits &= 7;
+
+	libblake_internal_blakeb_stream_update(state, buffer, buffered, data, len);
+	n = *buffered;
+
+	/* `buffer` is two blocks large, which is enough for
+	 * libblake_internal_blakeb_digest unless the suffix is
+	 * very long, so the suffix is added here instead, and
+	 * each block is processed as soon as it is filled */
+	buffer[n] = bits ? data[len] : 0;
+	if (suffix) {
+		while (*suffix) {
+			buffer[n] |= (unsigned char)((*suffix++ & 1) << bits++);
+			if (bits == 8) {
+				bits = 0;
+				if (++n == 128) {
+					libblake_internal_blakeb_update(state, buffer, 128);
+					n = 0;
+				}
+				buffer[n] = 0;
+			}
+		}
+	}
+
+	libblake_internal_blakeb_digest(state, buffer, n, bits, NULL, output, words_out);
+}
@@ -0,0 +1,29 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_internal_blakeb_stream_update(struct libblake_blakeb_state *state, unsigned char *buffer, size_t *buffered,
+                                       const unsigned char *data, size_t len)
+{
+	size_t n;
+
+	if (!len)
+		return;
+
+	if (*buffered) {
+		n = 128 - *buffered;
+		if (n > len)
+			n = len;
+		memcpy(&buffer[*buffered], data, n);
+		*buffered += n;
+		data = &data[n];
+		len -= n;
+		if (*buffered < 128)
+			return;
+		libblake_internal_blakeb_update(state, buffer, 128);
+	}
+
+	n = libblake_internal_blakeb_update(state, data, len);
+	memcpy(buffer, &data[n], len - n);
+	*buffered = len - n;
+}
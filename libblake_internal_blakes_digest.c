@@ -49,7 +49,7 @@ libblake_internal_blakes_digest(struct libblake_blakes_state *state, unsigned ch
 		state->t[0] = UINT_LEAST32_C(0xFFFFfe00) + (uint_least32_t)bits;
 		state->t[1] = (state->t[1] - 1) & UINT_LEAST32_C(0xFFFFffff);
 	} else {
-		state->t[1] -= (uint_least32_t)(512U - bits);
+		state->t[0] -= (uint_least32_t)(512U - bits);
 	}
 
 	if (bits < 512 - (1 + 2 * 32)) {
@@ -59,7 +59,7 @@ libblake_internal_blakes_digest(struct libblake_blakes_state *state, unsigned ch
 		data += libblake_internal_blakes_update(state, data, 512 / 8);
 		state->t[0] = UINT_LEAST32_C(0xFFFFfe00);
 		state->t[1] = UINT_LEAST32_C(0xFFFFffff);
-		memset(data, 0, (512 - 2 * 32) / 8 - len);
+		memset(data, 0, (512 - 2 * 32) / 8);
 	}
 	if (words_out == 8)
 		data[(512 - 2 * 32) / 8 - 1] |= 1;
@@ -0,0 +1,15 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+size_t
+libblake_internal_blakes_export(const struct libblake_blakes_state *state, int id, const unsigned char *buffered, size_t nbuffered,
+                                void *buffer, size_t size)
+{
+	uint_least32_t words[14];
+
+	memcpy(&words[0], state->h, sizeof(state->h));
+	memcpy(&words[8], state->s, sizeof(state->s));
+	memcpy(&words[12], state->t, sizeof(state->t));
+
+	return libblake_internal_export(id, sizeof(*words), words, 14, buffered, nbuffered, buffer, size);
+}
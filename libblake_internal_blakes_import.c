@@ -0,0 +1,17 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_internal_blakes_import(struct libblake_blakes_state *state, int id, unsigned char *buffered, size_t *nbufferedp,
+                                const void *buffer, size_t len)
+{
+	uint_least32_t words[14];
+
+	if (libblake_internal_import(id, sizeof(*words), words, 14, buffered, 0, nbufferedp, buffer, len))
+		return -1;
+
+	memcpy(state->h, &words[0], sizeof(state->h));
+	memcpy(state->s, &words[8], sizeof(state->s));
+	memcpy(state->t, &words[12], sizeof(state->t));
+	return 0;
+}
@@ -0,0 +1,13 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_internal_blakes_stream_peek(const struct libblake_blakes_state *state, const unsigned char *buffer,
+                                     size_t buffered, unsigned char *output, size_t words_out)
+{
+	struct libblake_blakes_state copy = *state;
+	unsigned char block[128];
+
+	memcpy(block, buffer, buffered);
+	libblake_internal_blakes_digest(&copy, block, buffered, 0, NULL, output, words_out);
+}
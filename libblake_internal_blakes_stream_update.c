@@ -0,0 +1,29 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_internal_blakes_stream_update(struct libblake_blakes_state *state, unsigned char *buffer, size_t *buffered,
+                                       const unsigned char *data, size_t len)
+{
+	size_t n;
+
+	if (!len)
+		return;
+
+	if (*buffered) {
+		n = 64 - *buffered;
+		if (n > len)
+			n = len;
+		memcpy(&buffer[*buffered], data, n);
+		*buffered += n;
+		data = &data[n];
+		len -= n;
+		if (*buffered < 64)
+			return;
+		libblake_internal_blakes_update(state, buffer, 64);
+	}
+
+	n = libblake_internal_blakes_update(state, data, len);
+	memcpy(buffer, &data[n], len - n);
+	*buffered = len - n;
+}
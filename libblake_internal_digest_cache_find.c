@@ -0,0 +1,28 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+struct libblake_internal_cache_record *
+libblake_internal_digest_cache_find(struct libblake_internal_cache_header *header,
+                                    const struct libblake_internal_cache_record *key)
+{
+	struct libblake_internal_cache_record *records = (void *)&header[1];
+	uint_least64_t h, n, nslots = header->nslots;
+	size_t i;
+
+	h = key->dev * UINT_LEAST64_C(0x9E3779B97F4A7C15);
+	h ^= key->ino * UINT_LEAST64_C(0xC2B2AE3D27D4EB4F);
+	for (i = 0; i < 8; i++)
+		h ^= (uint_least64_t)key->identity[i] << (8 * i);
+	h ^= h >> 29;
+
+	/* The table is never full, so this finds either the record with
+	 * the same key or an unused record, unless the file is corrupt */
+	for (n = 0, i = (size_t)(h % nslots); n < nslots; n++, i = (size_t)((i + 1) % nslots)) {
+		if (!records[i].used)
+			return &records[i];
+		if (records[i].dev == key->dev && records[i].ino == key->ino &&
+		    !memcmp(records[i].identity, key->identity, sizeof(key->identity)))
+			return &records[i];
+	}
+	return NULL;
+}
@@ -0,0 +1,52 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_internal_digest_cache_lock(struct libblake_digest_cache *cache, int exclusive)
+{
+	const struct libblake_internal_cache_header *header;
+	struct stat st;
+	void *map;
+
+	/* flock(2) does not exclude threads sharing the file descriptor */
+	pthread_mutex_lock(cache->mutex);
+	while (flock(cache->fd, exclusive ? LOCK_EX : LOCK_SH))
+		if (errno != EINTR)
+			goto fail;
+
+	/* The file may have been grown by another process */
+	if (fstat(cache->fd, &st))
+		goto fail_flock;
+	if ((uintmax_t)st.st_size != (uintmax_t)cache->map_size) {
+		if (cache->map)
+			munmap(cache->map, cache->map_size);
+		cache->map = NULL;
+		cache->map_size = 0;
+		if ((uintmax_t)st.st_size > SIZE_MAX)
+			goto fail_flock;
+		if (st.st_size) {
+			map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, cache->fd, 0);
+			if (map == MAP_FAILED)
+				goto fail_flock;
+			cache->map = map;
+			cache->map_size = (size_t)st.st_size;
+		}
+	}
+
+	/* Returns 1 if the file has the expected layout, 0 if it must be reinitialised */
+	header = cache->map;
+	if (cache->map_size < sizeof(*header) ||
+	    memcmp(header->magic, DIGEST_CACHE_MAGIC, sizeof(header->magic)) ||
+	    header->record_size != sizeof(struct libblake_internal_cache_record) ||
+	    !header->nslots || header->count >= header->nslots ||
+	    header->nslots > (SIZE_MAX - sizeof(*header)) / sizeof(struct libblake_internal_cache_record) ||
+	    cache->map_size != sizeof(*header) + (size_t)header->nslots * sizeof(struct libblake_internal_cache_record))
+		return 0;
+	return 1;
+
+fail_flock:
+	flock(cache->fd, LOCK_UN);
+fail:
+	pthread_mutex_unlock(cache->mutex);
+	return -1;
+}
@@ -0,0 +1,34 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_internal_digest_cache_lookup(struct libblake_digest_cache *cache, const unsigned char identity[32],
+                                      const struct stat *st, size_t digest_len, unsigned char *output)
+{
+	struct libblake_internal_cache_record key, *record;
+	int ret, found = 0;
+
+	key.dev = (uint_least64_t)st->st_dev;
+	key.ino = (uint_least64_t)st->st_ino;
+	memcpy(key.identity, identity, sizeof(key.identity));
+
+	ret = libblake_internal_digest_cache_lock(cache, 0);
+	if (ret < 0)
+		return 0;
+	record = ret ? libblake_internal_digest_cache_find(cache->map, &key) : NULL;
+
+	/* Any change to the file changes at least one of these */
+	if (record && record->used &&
+	    record->size == (uint_least64_t)st->st_size &&
+	    record->mtime_sec == (int_least64_t)st->st_mtim.tv_sec &&
+	    record->mtime_nsec == (uint_least32_t)st->st_mtim.tv_nsec &&
+	    record->ctime_sec == (int_least64_t)st->st_ctim.tv_sec &&
+	    record->ctime_nsec == (uint_least32_t)st->st_ctim.tv_nsec &&
+	    record->digest_len == digest_len) {
+		memcpy(output, record->digest, digest_len);
+		found = 1;
+	}
+
+	libblake_internal_digest_cache_unlock(cache);
+	return found;
+}
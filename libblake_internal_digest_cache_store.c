@@ -0,0 +1,101 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+/* Initial number of records in the table */
+#define INITIAL_SLOTS 1024
+
+static int
+grow(struct libblake_digest_cache *cache, int valid)
+{
+	struct libblake_internal_cache_header *old = cache->map, *new;
+	struct libblake_internal_cache_record *records, *record;
+	uint_least64_t nslots = valid ? old->nslots * 2 : INITIAL_SLOTS, i;
+	size_t size;
+	void *map;
+
+	if (nslots > (SIZE_MAX - sizeof(*new)) / sizeof(*records)) {
+		errno = ENOMEM;
+		return -1;
+	}
+	size = sizeof(*new) + (size_t)nslots * sizeof(*records);
+
+	/* The table is rebuilt in memory, so that the file
+	 * remains usable if it cannot be written */
+	new = calloc(1, size);
+	if (!new)
+		return -1;
+	memcpy(new->magic, DIGEST_CACHE_MAGIC, sizeof(new->magic));
+	new->record_size = sizeof(*records);
+	new->nslots = nslots;
+	if (valid) {
+		records = (void *)&old[1];
+		for (i = 0; i < old->nslots; i++) {
+			if (!records[i].used)
+				continue;
+			record = libblake_internal_digest_cache_find(new, &records[i]);
+			*record = records[i];
+			new->count += 1;
+		}
+	}
+
+	if (ftruncate(cache->fd, (off_t)size))
+		goto fail;
+	map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, cache->fd, 0);
+	if (map == MAP_FAILED)
+		goto fail;
+	if (cache->map)
+		munmap(cache->map, cache->map_size);
+	cache->map = map;
+	cache->map_size = size;
+	memcpy(map, new, size);
+	free(new);
+	return 0;
+
+fail:
+	free(new);
+	return -1;
+}
+
+void
+libblake_internal_digest_cache_store(struct libblake_digest_cache *cache, const unsigned char identity[32],
+                                     const struct stat *st, size_t digest_len, const unsigned char *digest)
+{
+	struct libblake_internal_cache_header *header;
+	struct libblake_internal_cache_record key, *record;
+	int valid, saved_errno = errno;
+
+	memset(&key, 0, sizeof(key));
+	key.dev = (uint_least64_t)st->st_dev;
+	key.ino = (uint_least64_t)st->st_ino;
+	key.size = (uint_least64_t)st->st_size;
+	key.mtime_sec = (int_least64_t)st->st_mtim.tv_sec;
+	key.mtime_nsec = (uint_least32_t)st->st_mtim.tv_nsec;
+	key.ctime_sec = (int_least64_t)st->st_ctim.tv_sec;
+	key.ctime_nsec = (uint_least32_t)st->st_ctim.tv_nsec;
+	memcpy(key.identity, identity, sizeof(key.identity));
+	key.used = 1;
+	key.digest_len = (unsigned char)digest_len;
+	memcpy(key.digest, digest, digest_len);
+
+	/* The cache is only an optimisation, so failures are ignored */
+	valid = libblake_internal_digest_cache_lock(cache, 1);
+	if (valid < 0)
+		goto out;
+	header = cache->map;
+	if (!valid || header->count + 1 > header->nslots / 4 * 3) {
+		if (grow(cache, valid))
+			goto out_unlock;
+		header = cache->map;
+	}
+	record = libblake_internal_digest_cache_find(header, &key);
+	if (record) {
+		if (!record->used)
+			header->count += 1;
+		*record = key;
+	}
+
+out_unlock:
+	libblake_internal_digest_cache_unlock(cache);
+out:
+	errno = saved_errno;
+}
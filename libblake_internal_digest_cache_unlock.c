@@ -0,0 +1,9 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+void
+libblake_internal_digest_cache_unlock(struct libblake_digest_cache *cache)
+{
+	flock(cache->fd, LOCK_UN);
+	pthread_mutex_unlock(cache->mutex);
+}
@@ -0,0 +1,36 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+size_t
+libblake_internal_export(int id, size_t word_size, const void *words, size_t nwords,
+                         const unsigned char *bytes, size_t nbytes, void *buffer, size_t size)
+{
+	unsigned char *out = buffer;
+	size_t i, j, n = 4 + nwords * word_size + 4 + nbytes;
+	uint_least64_t word;
+
+	if (size < n)
+		return n;
+
+	out[0] = 'B';
+	out[1] = 'L';
+	out[2] = EXPORT_VERSION;
+	out[3] = (unsigned char)id;
+	out = &out[4];
+
+	for (i = 0; i < nwords; i++) {
+		if (word_size == 4)
+			word = (uint_least64_t)((const uint_least32_t *)words)[i];
+		else
+			word = ((const uint_least64_t *)words)[i];
+		for (j = 0; j < word_size; j++)
+			*out++ = (unsigned char)((word >> (j * 8)) & 255);
+	}
+
+	for (j = 0; j < 4; j++)
+		*out++ = (unsigned char)((nbytes >> (j * 8)) & 255);
+	if (nbytes)
+		memcpy(out, bytes, nbytes);
+
+	return n;
+}
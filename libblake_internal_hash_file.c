@@ -0,0 +1,58 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+/* A file modified less than this number of seconds ago may
+ * be modified again without its timestamps changing, since
+ * timestamps are stored with limited resolution (FAT uses
+ * 2 seconds) and taken from a coarse clock */
+#define RACY_SECONDS 2
+
+static int
+same_file(const struct stat *a, const struct stat *b)
+{
+	return a->st_dev == b->st_dev &&
+	       a->st_ino == b->st_ino &&
+	       a->st_size == b->st_size &&
+	       a->st_mtim.tv_sec == b->st_mtim.tv_sec &&
+	       a->st_mtim.tv_nsec == b->st_mtim.tv_nsec &&
+	       a->st_ctim.tv_sec == b->st_ctim.tv_sec &&
+	       a->st_ctim.tv_nsec == b->st_ctim.tv_nsec;
+}
+
+static int
+racily_clean(const struct stat *st)
+{
+	struct timespec now;
+	if (clock_gettime(CLOCK_REALTIME, &now))
+		return 1;
+	return st->st_mtim.tv_sec > now.tv_sec - RACY_SECONDS ||
+	       st->st_ctim.tv_sec > now.tv_sec - RACY_SECONDS;
+}
+
+int
+libblake_internal_hash_file(const struct libblake_internal_file_hasher *hasher, int fd, unsigned char *output)
+{
+	union libblake_internal_file_stream stream;
+	struct stat st, st_after;
+	int cache;
+
+	/* The metadata is read before the file, so that
+	 * the hash is not cached with a later modification
+	 * time if the file is modified while it is hashed */
+	cache = hasher->cache && !fstat(fd, &st) && S_ISREG(st.st_mode);
+	if (cache && libblake_internal_digest_cache_lookup(hasher->cache, hasher->identity, &st, hasher->digest_len, output))
+		return 0;
+
+	hasher->init(hasher->ctx, &stream, 0);
+	if (libblake_internal_update_fd(fd, hasher->update, &stream))
+		return -1;
+	hasher->digest(hasher->ctx, &stream, output);
+
+	/* The hash is not cached if the file was modified while
+	 * it was hashed, or if it was modified so recently that
+	 * it could be modified again without changing the
+	 * metadata (the file would be "racily clean") */
+	if (cache && !fstat(fd, &st_after) && same_file(&st, &st_after) && !racily_clean(&st))
+		libblake_internal_digest_cache_store(hasher->cache, hasher->identity, &st, hasher->digest_len, output);
+	return 0;
+}
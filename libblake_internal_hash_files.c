@@ -0,0 +1,15 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_internal_hash_files(const char *const paths[], size_t npaths, int flags,
+                             const struct libblake_internal_hasher *hasher,
+                             void (*callback)(void *user, size_t i, const unsigned char *digest, int error),
+                             void *user)
+{
+	if (!libblake_internal_hash_files_uring(paths, npaths, flags, hasher, callback, user))
+		return 0;
+	if (errno != ENOSYS)
+		return -1;
+	return libblake_internal_hash_files_threads(paths, npaths, hasher, callback, user);
+}
@@ -0,0 +1,76 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+/* The files are processed synchronously on each thread, so
+ * the number of threads is the I/O queue depth */
+#define MAX_THREADS 16
+
+struct shared {
+	pthread_mutex_t mutex;
+	const char *const *paths;
+	size_t npaths;
+	size_t next;
+	const struct libblake_internal_hasher *hasher;
+	void (*callback)(void *user, size_t i, const unsigned char *digest, int error);
+	void *user;
+};
+
+static void *
+worker(void *shared_)
+{
+	struct shared *shared = shared_;
+	unsigned char output[64];
+	size_t i;
+	int error;
+
+	pthread_mutex_lock(&shared->mutex);
+	while (shared->next < shared->npaths) {
+		i = shared->next++;
+		pthread_mutex_unlock(&shared->mutex);
+		error = shared->hasher->hash_path(shared->hasher->ctx, shared->paths[i], output) ? errno : 0;
+		pthread_mutex_lock(&shared->mutex);
+		/* The callback is called with the mutex held so that it is never called concurrently */
+		shared->callback(shared->user, i, error ? NULL : output, error);
+	}
+	pthread_mutex_unlock(&shared->mutex);
+
+	return NULL;
+}
+
+int
+libblake_internal_hash_files_threads(const char *const paths[], size_t npaths,
+                                     const struct libblake_internal_hasher *hasher,
+                                     void (*callback)(void *user, size_t i, const unsigned char *digest, int error),
+                                     void *user)
+{
+	pthread_t threads[MAX_THREADS];
+	struct shared shared;
+	size_t i, nthreads;
+	int err;
+
+	if ((err = pthread_mutex_init(&shared.mutex, NULL))) {
+		errno = err;
+		return -1;
+	}
+	shared.paths = paths;
+	shared.npaths = npaths;
+	shared.next = 0;
+	shared.hasher = hasher;
+	shared.callback = callback;
+	shared.user = user;
+
+	nthreads = npaths < MAX_THREADS ? npaths : MAX_THREADS;
+	for (i = 1; i < nthreads; i++)
+		if (pthread_create(&threads[i], NULL, &worker, &shared))
+			break;
+	nthreads = i;
+
+	/* The calling thread is a worker too, so
+	 * that it works even if no thread could be created */
+	worker(&shared);
+
+	for (i = 1; i < nthreads; i++)
+		pthread_join(threads[i], NULL);
+	pthread_mutex_destroy(&shared.mutex);
+	return 0;
+}
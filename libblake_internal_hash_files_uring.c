@@ -0,0 +1,327 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+#if defined(__linux__) && defined(__GNUC__)
+# include <linux/io_uring.h>
+# include <sys/syscall.h>
+#endif
+
+#if defined(__linux__) && defined(__GNUC__) && defined(__NR_io_uring_setup) && defined(IORING_OP_READ)
+
+/* Size of the reads */
+#define BUFFER_SIZE ((size_t)1 << 17)
+
+/* Space before the read data in each buffer, where input that could not
+ * be processed yet is moved; it is a multiple of the page size (assuming
+ * the most common size) so that reads are aligned as O_DIRECT requires */
+#define HEADROOM ((size_t)4096)
+
+struct ring {
+	int fd;
+	unsigned int *sq_head;
+	unsigned int *sq_tail;
+	unsigned int *sq_mask;
+	unsigned int *sq_array;
+	struct io_uring_sqe *sqes;
+	unsigned int *cq_head;
+	unsigned int *cq_tail;
+	unsigned int *cq_mask;
+	struct io_uring_cqe *cqes;
+	void *sq_map;
+	size_t sq_map_size;
+	void *cq_map;
+	size_t cq_map_size;
+	size_t sqes_size;
+	unsigned int to_submit;
+};
+
+struct slot {
+	int fd;
+	int direct;
+	int completed;
+	int result;
+	size_t path;
+	size_t carried;
+	uint_least64_t offset;
+	unsigned char *buffer;
+};
+
+static int
+ring_create(struct ring *ring, unsigned int entries)
+{
+	struct io_uring_params params;
+	struct io_uring_probe *probe;
+	unsigned char *sq, *cq;
+	long int ret;
+
+	memset(&params, 0, sizeof(params));
+	ret = syscall(__NR_io_uring_setup, entries, &params);
+	if (ret < 0)
+		return -1;
+	ring->fd = (int)ret;
+	ring->to_submit = 0;
+
+	/* IORING_OP_READ requires Linux 5.6 */
+	probe = calloc(1, sizeof(*probe) + 256 * sizeof(*probe->ops));
+	if (!probe)
+		goto fail_fd;
+	ret = syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_PROBE, probe, 256);
+	if (ret < 0 || probe->last_op < IORING_OP_READ || !(probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED)) {
+		free(probe);
+		goto fail_fd;
+	}
+	free(probe);
+
+	ring->sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+	ring->cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		if (ring->cq_map_size > ring->sq_map_size)
+			ring->sq_map_size = ring->cq_map_size;
+		ring->cq_map_size = 0;
+	}
+	ring->sq_map = mmap(NULL, ring->sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+	                    ring->fd, IORING_OFF_SQ_RING);
+	if (ring->sq_map == MAP_FAILED)
+		goto fail_fd;
+	ring->cq_map = ring->sq_map;
+	if (ring->cq_map_size) {
+		ring->cq_map = mmap(NULL, ring->cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+		                    ring->fd, IORING_OFF_CQ_RING);
+		if (ring->cq_map == MAP_FAILED)
+			goto fail_sq;
+	}
+	ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+	                  ring->fd, IORING_OFF_SQES);
+	if (ring->sqes == MAP_FAILED)
+		goto fail_cq;
+
+	sq = ring->sq_map;
+	cq = ring->cq_map;
+	ring->sq_head = (void *)&sq[params.sq_off.head];
+	ring->sq_tail = (void *)&sq[params.sq_off.tail];
+	ring->sq_mask = (void *)&sq[params.sq_off.ring_mask];
+	ring->sq_array = (void *)&sq[params.sq_off.array];
+	ring->cq_head = (void *)&cq[params.cq_off.head];
+	ring->cq_tail = (void *)&cq[params.cq_off.tail];
+	ring->cq_mask = (void *)&cq[params.cq_off.ring_mask];
+	ring->cqes = (void *)&cq[params.cq_off.cqes];
+	return 0;
+
+fail_cq:
+	if (ring->cq_map_size)
+		munmap(ring->cq_map, ring->cq_map_size);
+fail_sq:
+	munmap(ring->sq_map, ring->sq_map_size);
+fail_fd:
+	close(ring->fd);
+	return -1;
+}
+
+static void
+ring_destroy(struct ring *ring)
+{
+	munmap(ring->sqes, ring->sqes_size);
+	if (ring->cq_map_size)
+		munmap(ring->cq_map, ring->cq_map_size);
+	munmap(ring->sq_map, ring->sq_map_size);
+	close(ring->fd);
+}
+
+static void
+ring_read(struct ring *ring, size_t i, struct slot *slot)
+{
+	unsigned int tail = *ring->sq_tail, index = tail & *ring->sq_mask;
+	struct io_uring_sqe *sqe = &ring->sqes[index];
+
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = slot->fd;
+	sqe->addr = (uint_least64_t)(uintptr_t)&slot->buffer[HEADROOM];
+	sqe->len = (unsigned int)BUFFER_SIZE;
+	sqe->off = slot->offset;
+	sqe->user_data = (uint_least64_t)i;
+	ring->sq_array[index] = index;
+	__atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+	ring->to_submit += 1;
+}
+
+static int
+ring_enter(struct ring *ring)
+{
+	long int ret;
+	ret = syscall(__NR_io_uring_enter, ring->fd, ring->to_submit, 1U, IORING_ENTER_GETEVENTS, NULL, 0);
+	if (ret < 0)
+		return errno == EINTR ? 0 : -1;
+	ring->to_submit -= (unsigned int)ret;
+	return 0;
+}
+
+static int
+slot_open(struct slot *slot, const char *const paths[], size_t npaths, size_t *nextp, int flags,
+          const struct libblake_internal_hasher *hasher, size_t i,
+          void (*callback)(void *user, size_t i, const unsigned char *digest, int error), void *user)
+{
+	while (*nextp < npaths) {
+		slot->path = (*nextp)++;
+		slot->direct = 0;
+		slot->fd = -1;
+		if (flags & LIBBLAKE_HASH_FILES_DIRECT) {
+			/* Not all filesystems support O_DIRECT */
+			slot->fd = open(paths[slot->path], O_RDONLY | O_CLOEXEC | O_DIRECT);
+			slot->direct = slot->fd >= 0;
+		}
+		if (slot->fd < 0)
+			slot->fd = open(paths[slot->path], O_RDONLY | O_CLOEXEC);
+		if (slot->fd < 0) {
+			callback(user, slot->path, NULL, errno);
+			continue;
+		}
+		slot->offset = 0;
+		slot->carried = hasher->prefix_len;
+		if (hasher->prefix_len)
+			memcpy(&slot->buffer[HEADROOM - hasher->prefix_len], hasher->prefix, hasher->prefix_len);
+		hasher->start(hasher->ctx, i);
+		return 1;
+	}
+	slot->fd = -1;
+	return 0;
+}
+
+int
+libblake_internal_hash_files_uring(const char *const paths[], size_t npaths, int flags,
+                                   const struct libblake_internal_hasher *hasher,
+                                   void (*callback)(void *user, size_t i, const unsigned char *digest, int error),
+                                   void *user)
+{
+	struct slot slots[HASH_FILES_QUEUE_DEPTH];
+	struct ring ring;
+	struct io_uring_cqe *cqe;
+	unsigned char *buffers, *data, output[64];
+	void *mem;
+	size_t i, nslots, next = 0, active = 0, len, done;
+	unsigned int head;
+	int saved_errno;
+
+	nslots = npaths < HASH_FILES_QUEUE_DEPTH ? npaths : HASH_FILES_QUEUE_DEPTH;
+	if (!nslots)
+		return 0;
+
+	if (ring_create(&ring, HASH_FILES_QUEUE_DEPTH)) {
+		errno = ENOSYS;
+		return -1;
+	}
+	if (posix_memalign(&mem, HEADROOM, nslots * (HEADROOM + BUFFER_SIZE))) {
+		ring_destroy(&ring);
+		errno = ENOMEM;
+		return -1;
+	}
+	buffers = mem;
+
+	for (i = 0; i < nslots; i++) {
+		slots[i].buffer = &buffers[i * (HEADROOM + BUFFER_SIZE)];
+		slots[i].completed = 0;
+		if (slot_open(&slots[i], paths, npaths, &next, flags, hasher, i, callback, user)) {
+			ring_read(&ring, i, &slots[i]);
+			active += 1;
+		}
+	}
+
+	while (active) {
+		if (ring_enter(&ring))
+			goto fail;
+
+		/* Queue all completed reads for hashing */
+		head = *ring.cq_head;
+		while (head != __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE)) {
+			cqe = &ring.cqes[head++ & *ring.cq_mask];
+			i = (size_t)cqe->user_data;
+			slots[i].completed = 1;
+			slots[i].result = cqe->res;
+			if (cqe->res > 0) {
+				data = &slots[i].buffer[HEADROOM - slots[i].carried];
+				len = slots[i].carried + (size_t)cqe->res;
+				done = hasher->feed(hasher->ctx, i, data, len);
+				slots[i].offset += (uint_least64_t)cqe->res;
+				slots[i].carried = len - done;
+			}
+		}
+		__atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+
+		/* The buffers cannot be reused until the queued data has been processed */
+		hasher->run(hasher->ctx);
+
+		for (i = 0; i < nslots; i++) {
+			if (!slots[i].completed)
+				continue;
+			slots[i].completed = 0;
+			if (slots[i].result > 0) {
+				/* Move input held back for the next read, or the final block, into the headroom */
+				data = &slots[i].buffer[HEADROOM + (size_t)slots[i].result];
+				memmove(&slots[i].buffer[HEADROOM - slots[i].carried], data - slots[i].carried, slots[i].carried);
+				if (slots[i].direct && (slots[i].offset % HEADROOM)) {
+					/* Unaligned offset, presumably at the end of the file */
+					if (fcntl(slots[i].fd, F_SETFL, fcntl(slots[i].fd, F_GETFL) & ~O_DIRECT) < 0)
+						goto fail;
+					slots[i].direct = 0;
+				}
+			} else if (slots[i].result == -EINTR || slots[i].result == -EAGAIN) {
+				/* Retry */
+			} else if (slots[i].result == -EINVAL && slots[i].direct) {
+				/* O_DIRECT was not supported for this file after all */
+				if (fcntl(slots[i].fd, F_SETFL, fcntl(slots[i].fd, F_GETFL) & ~O_DIRECT) < 0)
+					goto fail;
+				slots[i].direct = 0;
+			} else {
+				if (!slots[i].result) {
+					data = &slots[i].buffer[HEADROOM - slots[i].carried];
+					hasher->finish(hasher->ctx, i, data, slots[i].carried, output);
+					callback(user, slots[i].path, output, 0);
+				} else {
+					callback(user, slots[i].path, NULL, -slots[i].result);
+				}
+				close(slots[i].fd);
+				if (!slot_open(&slots[i], paths, npaths, &next, flags, hasher, i, callback, user)) {
+					active -= 1;
+					continue;
+				}
+			}
+			ring_read(&ring, i, &slots[i]);
+		}
+	}
+
+	free(buffers);
+	ring_destroy(&ring);
+	return 0;
+
+fail:
+	saved_errno = errno;
+	/* The kernel may still write to the buffers until the ring is closed */
+	ring_destroy(&ring);
+	for (i = 0; i < nslots; i++)
+		if (slots[i].fd >= 0)
+			close(slots[i].fd);
+	free(buffers);
+	errno = saved_errno;
+	return -1;
+}
+
+#else
+
+int
+libblake_internal_hash_files_uring(const char *const paths[], size_t npaths, int flags,
+                                   const struct libblake_internal_hasher *hasher,
+                                   void (*callback)(void *user, size_t i, const unsigned char *digest, int error),
+                                   void *user)
+{
+	(void) paths;
+	(void) npaths;
+	(void) flags;
+	(void) hasher;
+	(void) callback;
+	(void) user;
+	errno = ENOSYS;
+	return -1;
+}
+
+#endif
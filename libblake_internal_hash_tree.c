@@ -0,0 +1,332 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+/* Upper limit for the number of threads */
+#define MAX_THREADS 16
+
+struct node {
+	struct node *parent;
+	struct node *next_job;
+	struct node **children; /* Sorted by name */
+	size_t nchildren;
+	size_t pending; /* Number of children without a digest */
+	char *path;
+	size_t name_off;
+	unsigned char type;
+	unsigned char digest[64];
+};
+
+struct shared {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	struct node *jobs; /* Stack of nodes to process */
+	int done;
+	int error;
+	const struct libblake_internal_file_hasher *hasher;
+};
+
+static void
+free_node(struct node *node)
+{
+	size_t i;
+	for (i = 0; i < node->nchildren; i++)
+		free_node(node->children[i]);
+	free(node->children);
+	free(node->path);
+	free(node);
+}
+
+static int
+compare_nodes(const void *a_, const void *b_)
+{
+	const struct node *a = *(const struct node *const *)a_;
+	const struct node *b = *(const struct node *const *)b_;
+	return strcmp(&a->path[a->name_off], &b->path[b->name_off]);
+}
+
+static void
+finish_directory(struct shared *shared, struct node *dir)
+{
+	const struct libblake_internal_file_hasher *hasher = shared->hasher;
+	union libblake_internal_file_stream stream;
+	struct node *child;
+	size_t i;
+
+	/* Each entry is recorded as its type, its name
+	 * (including the terminating NUL byte), and its hash */
+	hasher->init(hasher->ctx, &stream, 1);
+	for (i = 0; i < dir->nchildren; i++) {
+		child = dir->children[i];
+		hasher->update(&stream, &child->type, 1);
+		hasher->update(&stream, &child->path[child->name_off], strlen(&child->path[child->name_off]) + 1);
+		hasher->update(&stream, child->digest, hasher->digest_len);
+		free_node(child);
+	}
+	hasher->digest(hasher->ctx, &stream, dir->digest);
+
+	free(dir->children);
+	dir->children = NULL;
+	dir->nchildren = 0;
+}
+
+static void
+complete(struct shared *shared, struct node *node)
+{
+	struct node *parent;
+	size_t pending;
+
+	/* The last child to complete finishes its directory */
+	for (;;) {
+		pthread_mutex_lock(&shared->mutex);
+		parent = node->parent;
+		if (!parent) {
+			shared->done = 1;
+			pthread_cond_broadcast(&shared->cond);
+			pthread_mutex_unlock(&shared->mutex);
+			return;
+		}
+		pending = --parent->pending;
+		pthread_mutex_unlock(&shared->mutex);
+		if (pending)
+			return;
+		finish_directory(shared, parent);
+		node = parent;
+	}
+}
+
+static int
+list_directory(struct shared *shared, struct node *dir)
+{
+	struct dirent *f;
+	struct node *child, **new;
+	size_t size = 0, len, dirlen = strlen(dir->path), i;
+	int saved_errno;
+	DIR *d;
+
+	d = opendir(dir->path);
+	if (!d)
+		return -1;
+	for (errno = 0; (f = readdir(d)); errno = 0) {
+		if (f->d_name[0] == '.' && (!f->d_name[1] || (f->d_name[1] == '.' && !f->d_name[2])))
+			continue;
+		if (dir->nchildren == size) {
+			size = size ? size * 2 : 16;
+			new = realloc(dir->children, size * sizeof(*dir->children));
+			if (!new)
+				goto fail;
+			dir->children = new;
+		}
+		child = calloc(1, sizeof(*child));
+		if (!child)
+			goto fail;
+		len = strlen(f->d_name);
+		child->path = malloc(dirlen + len + 2);
+		if (!child->path) {
+			free(child);
+			goto fail;
+		}
+		memcpy(child->path, dir->path, dirlen);
+		child->path[dirlen] = '/';
+		memcpy(&child->path[dirlen + 1], f->d_name, len + 1);
+		child->name_off = dirlen + 1;
+		child->parent = dir;
+		dir->children[dir->nchildren++] = child;
+	}
+	if (errno)
+		goto fail;
+	closedir(d);
+
+	/* The order of the entries determines the hash of the directory */
+	qsort(dir->children, dir->nchildren, sizeof(*dir->children), &compare_nodes);
+
+	if (!dir->nchildren) {
+		finish_directory(shared, dir);
+		complete(shared, dir);
+		return 0;
+	}
+
+	pthread_mutex_lock(&shared->mutex);
+	dir->pending = dir->nchildren;
+	for (i = dir->nchildren; i--;) {
+		dir->children[i]->next_job = shared->jobs;
+		shared->jobs = dir->children[i];
+	}
+	pthread_cond_broadcast(&shared->cond);
+	pthread_mutex_unlock(&shared->mutex);
+	return 0;
+
+fail:
+	saved_errno = errno;
+	closedir(d);
+	errno = saved_errno;
+	return -1;
+}
+
+static int
+hash_link(struct shared *shared, struct node *node, size_t size)
+{
+	const struct libblake_internal_file_hasher *hasher = shared->hasher;
+	union libblake_internal_file_stream stream;
+	ssize_t r;
+	char *target;
+
+	/* `size` is only a hint, it is 0 on some filesystems */
+	for (size = size + 1 > 64 ? size + 1 : 64;; size *= 2) {
+		target = malloc(size);
+		if (!target)
+			return -1;
+		r = readlink(node->path, target, size);
+		if (r < 0) {
+			free(target);
+			return -1;
+		}
+		if ((size_t)r < size)
+			break;
+		free(target);
+	}
+
+	hasher->init(hasher->ctx, &stream, 0);
+	hasher->update(&stream, target, (size_t)r);
+	hasher->digest(hasher->ctx, &stream, node->digest);
+	free(target);
+	return 0;
+}
+
+static int
+hash_file(struct shared *shared, struct node *node)
+{
+	int fd, ret, saved_errno;
+
+	fd = open(node->path, O_RDONLY | O_CLOEXEC | (node->parent ? O_NOFOLLOW : 0));
+	if (fd < 0)
+		return -1;
+	ret = libblake_internal_hash_file(shared->hasher, fd, node->digest);
+	saved_errno = errno;
+	close(fd);
+	errno = saved_errno;
+	return ret;
+}
+
+static int
+process(struct shared *shared, struct node *node)
+{
+	struct stat st;
+
+	/* Symbolic links are hashed as links, except the root */
+	if (node->parent ? lstat(node->path, &st) : stat(node->path, &st))
+		return -1;
+
+	if (S_ISDIR(st.st_mode)) {
+		node->type = 'd';
+		return list_directory(shared, node);
+	} else if (S_ISREG(st.st_mode)) {
+		node->type = 'f';
+		if (hash_file(shared, node))
+			return -1;
+	} else if (S_ISLNK(st.st_mode)) {
+		node->type = 'l';
+		if (hash_link(shared, node, (size_t)st.st_size))
+			return -1;
+	} else {
+		/* Reading FIFOs and devices may block indefinitely */
+		errno = EINVAL;
+		return -1;
+	}
+
+	complete(shared, node);
+	return 0;
+}
+
+static void *
+worker(void *shared_)
+{
+	struct shared *shared = shared_;
+	struct node *node;
+	int error;
+
+	pthread_mutex_lock(&shared->mutex);
+	for (;;) {
+		while (!shared->jobs && !shared->done)
+			pthread_cond_wait(&shared->cond, &shared->mutex);
+		if (shared->done)
+			break;
+		node = shared->jobs;
+		shared->jobs = node->next_job;
+		pthread_mutex_unlock(&shared->mutex);
+		error = process(shared, node) ? errno : 0;
+		pthread_mutex_lock(&shared->mutex);
+		if (error) {
+			if (!shared->error)
+				shared->error = error;
+			shared->done = 1;
+			pthread_cond_broadcast(&shared->cond);
+		}
+	}
+	pthread_mutex_unlock(&shared->mutex);
+
+	return NULL;
+}
+
+int
+libblake_internal_hash_tree(const char *path, size_t nthreads,
+                            const struct libblake_internal_file_hasher *hasher, unsigned char *output)
+{
+	pthread_t threads[MAX_THREADS];
+	struct shared shared;
+	struct node *root;
+	long int ncpus;
+	size_t i;
+	int err;
+
+	if (!nthreads) {
+		ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+		nthreads = ncpus > 0 ? (size_t)ncpus : 1;
+	}
+	if (nthreads > MAX_THREADS)
+		nthreads = MAX_THREADS;
+
+	root = calloc(1, sizeof(*root));
+	if (!root)
+		return -1;
+	root->path = strdup(path);
+	if (!root->path) {
+		free(root);
+		return -1;
+	}
+
+	if ((err = pthread_mutex_init(&shared.mutex, NULL)))
+		goto fail;
+	if ((err = pthread_cond_init(&shared.cond, NULL))) {
+		pthread_mutex_destroy(&shared.mutex);
+		goto fail;
+	}
+	shared.jobs = root;
+	shared.done = 0;
+	shared.error = 0;
+	shared.hasher = hasher;
+
+	for (i = 1; i < nthreads; i++)
+		if (pthread_create(&threads[i], NULL, &worker, &shared))
+			break;
+	nthreads = i;
+
+	/* The calling thread is a worker too, so
+	 * that it works even if no thread could be created */
+	worker(&shared);
+
+	for (i = 1; i < nthreads; i++)
+		pthread_join(threads[i], NULL);
+	pthread_cond_destroy(&shared.cond);
+	pthread_mutex_destroy(&shared.mutex);
+
+	if ((err = shared.error))
+		goto fail;
+	memcpy(output, root->digest, hasher->digest_len);
+	free_node(root);
+	return 0;
+
+fail:
+	free_node(root);
+	errno = err;
+	return -1;
+}
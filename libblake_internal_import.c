@@ -0,0 +1,40 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_internal_import(int id, size_t word_size, void *words, size_t nwords,
+                         unsigned char *bytes, size_t min_bytes, size_t *nbytesp, const void *buffer, size_t len)
+{
+	const unsigned char *in = buffer;
+	size_t i, j, nbytes, n = 4 + nwords * word_size + 4;
+	uint_least64_t word;
+
+	if (len < n || in[0] != 'B' || in[1] != 'L' || in[2] != EXPORT_VERSION || in[3] != (unsigned char)id)
+		goto invalid;
+
+	in = &in[n - 4];
+	for (nbytes = 0, j = 0; j < 4; j++)
+		nbytes |= (size_t)(in[j] & 255) << (j * 8);
+	if (nbytes < min_bytes || nbytes > *nbytesp || len - n != nbytes)
+		goto invalid;
+
+	in = &((const unsigned char *)buffer)[4];
+	for (i = 0; i < nwords; i++) {
+		for (word = 0, j = 0; j < word_size; j++)
+			word |= (uint_least64_t)(*in++ & 255) << (j * 8);
+		if (word_size == 4)
+			((uint_least32_t *)words)[i] = (uint_least32_t)word;
+		else
+			((uint_least64_t *)words)[i] = word;
+	}
+
+	in = &in[4];
+	if (nbytes)
+		memcpy(bytes, in, nbytes);
+	*nbytesp = nbytes;
+	return 0;
+
+invalid:
+	errno = EINVAL;
+	return -1;
+}
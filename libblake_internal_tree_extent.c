@@ -0,0 +1,31 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_internal_tree_extent(const struct libblake_internal_tree_layout *layout,
+                              const struct libblake_internal_tree_hasher *hasher, size_t node_depth,
+                              uint_least64_t node_offset, uint_least64_t *offset, uint_least64_t *length)
+{
+	uint_least64_t lo, hi, end;
+	size_t level;
+
+	if (node_depth >= layout->nlevels || node_offset >= layout->level_nodes[node_depth]) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* Find the leaves below the node; the end is only multiplied
+	 * when the product does not exceed the number of nodes */
+	lo = node_offset;
+	hi = node_offset + 1;
+	for (level = node_depth; level; level--) {
+		lo *= layout->level_span[level];
+		hi = hi <= layout->level_nodes[level - 1] / layout->level_span[level] ? hi * layout->level_span[level]
+		                                                                        : layout->level_nodes[level - 1];
+	}
+
+	*offset = lo * hasher->leaf_len;
+	end = hi < layout->level_nodes[0] ? hi * hasher->leaf_len : layout->size;
+	*length = end - *offset;
+	return 0;
+}
@@ -0,0 +1,51 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_internal_tree_layout(struct libblake_internal_tree_layout *layout, uint_least64_t size,
+                              const struct libblake_internal_tree_hasher *hasher)
+{
+	uint_least64_t nodes, offset, bytes;
+	size_t i;
+
+	/* An empty message is hashed as one empty leaf */
+	nodes = size / hasher->leaf_len + (size % hasher->leaf_len ? 1 : 0);
+	layout->size = size;
+	layout->level_nodes[0] = nodes ? nodes : 1;
+	layout->level_span[0] = 0;
+
+	/* There is always a root above the leaves; the level at the
+	 * maximum depth is the root whatever the fan-out is */
+	for (i = 1;; i++) {
+		nodes = layout->level_nodes[i - 1];
+		if (i > 1 && nodes == 1)
+			break;
+		if (!hasher->fanout || i + 1 == hasher->depth || nodes <= hasher->fanout) {
+			layout->level_span[i] = nodes;
+			layout->level_nodes[i] = 1;
+		} else {
+			layout->level_span[i] = hasher->fanout;
+			layout->level_nodes[i] = nodes / hasher->fanout + (nodes % hasher->fanout ? 1 : 0);
+		}
+	}
+	layout->nlevels = i;
+
+	offset = sizeof(struct libblake_internal_tree_header);
+	for (i = 0; i + 1 < layout->nlevels; i++) {
+		layout->level_offsets[i] = offset;
+		bytes = layout->level_nodes[i] * (uint_least64_t)hasher->inner_len;
+		if (bytes / hasher->inner_len != layout->level_nodes[i] || offset + bytes < offset)
+			goto too_big;
+		offset += bytes;
+	}
+	layout->store_size = offset;
+
+	/* The store is mapped into memory */
+	if (offset > (uint_least64_t)SIZE_MAX || (off_t)offset < 0 || (uint_least64_t)(off_t)offset != offset)
+		goto too_big;
+	return 0;
+
+too_big:
+	errno = EFBIG;
+	return -1;
+}
@@ -0,0 +1,61 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_internal_tree_merge(const struct libblake_internal_tree_hasher *hasher,
+                             const struct libblake_tree_node *children, size_t nchildren,
+                             struct libblake_tree_node *parent)
+{
+	struct libblake_internal_tree_layout layout;
+	union libblake_internal_file_stream stream;
+	uint_least64_t first, span, count, offset;
+	size_t depth, i;
+	int root;
+
+	if (!nchildren)
+		goto invalid;
+	if (libblake_internal_tree_layout(&layout, children[0].size, hasher))
+		return -1;
+
+	/* The children must be all children of one node, in order */
+	depth = (size_t)children[0].node_depth + 1;
+	if (depth >= layout.nlevels)
+		goto invalid;
+	first = children[0].node_offset;
+	span = layout.level_span[depth];
+	offset = first / span;
+	if (first % span || first >= layout.level_nodes[depth - 1])
+		goto invalid;
+	count = layout.level_nodes[depth - 1] - first;
+	if ((uint_least64_t)nchildren != (count < span ? count : span))
+		goto invalid;
+	for (i = 0; i < nchildren; i++) {
+		if (children[i].size != children[0].size ||
+		    children[i].node_depth != children[0].node_depth ||
+		    children[i].node_offset != first + (uint_least64_t)i ||
+		    children[i].root ||
+		    (size_t)children[i].digest_len != hasher->inner_len ||
+		    memcmp(children[i].identity, hasher->identity, sizeof(hasher->identity)))
+			goto invalid;
+	}
+
+	root = depth + 1 == layout.nlevels;
+	hasher->init(hasher->ctx, &stream, offset, depth, root);
+	for (i = 0; i < nchildren; i++)
+		hasher->update(&stream, children[i].digest, hasher->inner_len);
+
+	/* `parent` may overlap with `children` */
+	parent->size = layout.size;
+	parent->node_offset = offset;
+	parent->node_depth = (uint_least8_t)depth;
+	parent->root = root;
+	parent->digest_len = (uint_least8_t)(root ? hasher->digest_len : hasher->inner_len);
+	memcpy(parent->identity, hasher->identity, sizeof(parent->identity));
+	memset(parent->digest, 0, sizeof(parent->digest));
+	hasher->digest(hasher->ctx, &stream, offset + 1 == layout.level_nodes[depth], root, parent->digest);
+	return 0;
+
+invalid:
+	errno = EINVAL;
+	return -1;
+}
@@ -0,0 +1,59 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+static void
+hash_node(const struct libblake_internal_tree_hasher *hasher, const struct libblake_internal_tree_layout *layout,
+          size_t depth, uint_least64_t offset, const unsigned char *data, uint_least64_t data_offset,
+          int root, unsigned char *output)
+{
+	union libblake_internal_file_stream stream;
+	unsigned char digest[64];
+	uint_least64_t child, end;
+
+	/* The inner nodes are hashed depth-first, with the children's
+	 * digests fed to the parent's stream as they are calculated, so
+	 * that only one stream per level is needed whatever the fan-out;
+	 * `data` is the message from the byte at `data_offset` */
+	hasher->init(hasher->ctx, &stream, offset, depth, root);
+	if (!depth) {
+		end = offset + 1 < layout->level_nodes[0] ? (offset + 1) * hasher->leaf_len : layout->size;
+		hasher->update(&stream, &data[offset * hasher->leaf_len - data_offset],
+		               (size_t)(end - offset * hasher->leaf_len));
+	} else {
+		child = offset * layout->level_span[depth];
+		end = layout->level_nodes[depth - 1] - child;
+		end = child + (end < layout->level_span[depth] ? end : layout->level_span[depth]);
+		for (; child < end; child++) {
+			hash_node(hasher, layout, depth - 1, child, data, data_offset, 0, digest);
+			hasher->update(&stream, digest, hasher->inner_len);
+		}
+	}
+	hasher->digest(hasher->ctx, &stream, offset + 1 == layout->level_nodes[depth], root, output);
+}
+
+int
+libblake_internal_tree_node(const struct libblake_internal_tree_hasher *hasher, uint_least64_t size,
+                            size_t node_depth, uint_least64_t node_offset, const void *data, size_t len,
+                            struct libblake_tree_node *node)
+{
+	struct libblake_internal_tree_layout layout;
+	uint_least64_t offset, length;
+
+	if (libblake_internal_tree_layout(&layout, size, hasher) ||
+	    libblake_internal_tree_extent(&layout, hasher, node_depth, node_offset, &offset, &length))
+		return -1;
+	if ((uint_least64_t)len != length) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	node->size = size;
+	node->node_offset = node_offset;
+	node->node_depth = (uint_least8_t)node_depth;
+	node->root = node_depth + 1 == layout.nlevels;
+	node->digest_len = (uint_least8_t)(node->root ? hasher->digest_len : hasher->inner_len);
+	memcpy(node->identity, hasher->identity, sizeof(node->identity));
+	memset(node->digest, 0, sizeof(node->digest));
+	hash_node(hasher, &layout, node_depth, node_offset, data, offset, node->root, node->digest);
+	return 0;
+}
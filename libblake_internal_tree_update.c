@@ -0,0 +1,258 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+/* Buffer size used when the leaves are read */
+#define READ_SIZE ((size_t)1 << 17)
+
+/* Range of nodes, on one level, that must be rehashed */
+struct interval {
+	uint_least64_t lo;
+	uint_least64_t hi;
+};
+
+static int
+compare_intervals(const void *a_, const void *b_)
+{
+	const struct interval *a = a_, *b = b_;
+	return a->lo < b->lo ? -1 : a->lo > b->lo;
+}
+
+static size_t
+merge_intervals(struct interval *intervals, size_t n)
+{
+	size_t i, j;
+
+	qsort(intervals, n, sizeof(*intervals), &compare_intervals);
+	for (i = 0, j = 0; i < n; i++) {
+		if (j && intervals[i].lo <= intervals[j - 1].hi) {
+			if (intervals[i].hi > intervals[j - 1].hi)
+				intervals[j - 1].hi = intervals[i].hi;
+		} else {
+			intervals[j++] = intervals[i];
+		}
+	}
+	return j;
+}
+
+static int
+hash_leaves(int data_fd, const struct libblake_internal_tree_hasher *hasher,
+            const struct libblake_internal_tree_layout *layout, const struct interval *interval,
+            unsigned char *buf, unsigned char *digests)
+{
+	union libblake_internal_file_stream stream;
+	uint_least64_t leaf = interval->lo, pos, end, leaf_end;
+	size_t k, n;
+	ssize_t r;
+
+	/* The leaves in the interval are contiguous in the file, so they are
+	 * read in large reads, each of which may span multiple leaves */
+	pos = leaf * hasher->leaf_len;
+	end = interval->hi * hasher->leaf_len;
+	if (end / hasher->leaf_len != interval->hi || end > layout->size)
+		end = layout->size;
+
+	hasher->init(hasher->ctx, &stream, leaf, 0, 0);
+	while (pos < end) {
+		r = pread(data_fd, buf, end - pos < READ_SIZE ? (size_t)(end - pos) : READ_SIZE, (off_t)pos);
+		if (r <= 0) {
+			if (!r) {
+				/* The file was truncated while it was being hashed */
+				errno = EIO;
+				return -1;
+			}
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		for (k = 0; k < (size_t)r; k += n) {
+			leaf_end = (leaf + 1) * hasher->leaf_len;
+			n = leaf_end - pos < (size_t)r - k ? (size_t)(leaf_end - pos) : (size_t)r - k;
+			hasher->update(&stream, &buf[k], n);
+			pos += n;
+			if (pos == leaf_end && leaf + 1 < interval->hi) {
+				hasher->digest(hasher->ctx, &stream, leaf + 1 == layout->level_nodes[0], 0,
+				               &digests[leaf * hasher->inner_len]);
+				hasher->init(hasher->ctx, &stream, ++leaf, 0, 0);
+			}
+		}
+	}
+	hasher->digest(hasher->ctx, &stream, leaf + 1 == layout->level_nodes[0], 0, &digests[leaf * hasher->inner_len]);
+
+	return 0;
+}
+
+static void
+hash_inner(const struct libblake_internal_tree_hasher *hasher, const struct libblake_internal_tree_layout *layout,
+           size_t level, const struct interval *interval, unsigned char *map, unsigned char *output)
+{
+	union libblake_internal_file_stream stream;
+	uint_least64_t node, child, nchildren;
+	int root = level + 1 == layout->nlevels;
+	const unsigned char *children = &map[layout->level_offsets[level - 1]];
+
+	/* The children's digests are contiguous in the store */
+	for (node = interval->lo; node < interval->hi; node++) {
+		child = node * layout->level_span[level];
+		nchildren = layout->level_nodes[level - 1] - child;
+		if (nchildren > layout->level_span[level])
+			nchildren = layout->level_span[level];
+		hasher->init(hasher->ctx, &stream, node, level, root);
+		hasher->update(&stream, &children[child * hasher->inner_len], (size_t)(nchildren * hasher->inner_len));
+		hasher->digest(hasher->ctx, &stream, node + 1 == layout->level_nodes[level], root,
+		               root ? output : &map[layout->level_offsets[level] + node * hasher->inner_len]);
+	}
+}
+
+static int
+read_header(int store_fd, const struct libblake_internal_tree_hasher *hasher, struct libblake_internal_tree_layout *old)
+{
+	struct libblake_internal_tree_header header;
+	struct stat st;
+	ssize_t r;
+
+	/* Returns 1 if the store is valid, 0 if it is not, and -1 on failure */
+	do {
+		r = pread(store_fd, &header, sizeof(header), 0);
+	} while (r < 0 && errno == EINTR);
+	if (r < 0)
+		return -1;
+	if ((size_t)r != sizeof(header) ||
+	    memcmp(header.magic, TREE_STORE_MAGIC, sizeof(header.magic)) ||
+	    memcmp(header.identity, hasher->identity, sizeof(header.identity)))
+		return 0;
+	if (libblake_internal_tree_layout(old, header.size, hasher))
+		return 0;
+	if (fstat(store_fd, &st))
+		return -1;
+	return st.st_size >= 0 && (uint_least64_t)st.st_size == old->store_size;
+}
+
+int
+libblake_internal_tree_update(int data_fd, int store_fd, const struct libblake_internal_tree_hasher *hasher,
+                              const struct libblake_byte_range *ranges, size_t nranges, int rebuild,
+                              unsigned char *output)
+{
+	struct libblake_internal_tree_layout layout, old;
+	struct libblake_internal_tree_header *header;
+	struct interval *intervals = NULL;
+	unsigned char *map = MAP_FAILED, *buf = NULL;
+	uint_least64_t end, span;
+	size_t n = 0, i, j, level;
+	struct stat st;
+	int r, restructure, saved_errno;
+
+	if (fstat(data_fd, &st))
+		return -1;
+	if (libblake_internal_tree_layout(&layout, (uint_least64_t)st.st_size, hasher))
+		return -1;
+
+	if (!rebuild) {
+		r = read_header(store_fd, hasher, &old);
+		if (r < 0)
+			return -1;
+		rebuild = !r;
+	}
+
+	if (nranges > SIZE_MAX / sizeof(*intervals) - 1) {
+		errno = ENOMEM;
+		return -1;
+	}
+	intervals = malloc((rebuild ? 1 : nranges + 1) * sizeof(*intervals));
+	buf = malloc(READ_SIZE);
+	if (!intervals || !buf) {
+		errno = ENOMEM;
+		goto fail;
+	}
+
+	/* Find the leaves that must be rehashed */
+	if (rebuild) {
+		intervals[n].lo = 0;
+		intervals[n++].hi = layout.level_nodes[0];
+	} else {
+		for (i = 0; i < nranges; i++) {
+			if (!ranges[i].length || ranges[i].offset >= layout.size)
+				continue;
+			end = ranges[i].offset + ranges[i].length;
+			if (end < ranges[i].offset || end > layout.size)
+				end = layout.size;
+			intervals[n].lo = ranges[i].offset / hasher->leaf_len;
+			intervals[n++].hi = (end - 1) / hasher->leaf_len + 1;
+		}
+		/* If the size has changed, so has the last leaf, and the
+		 * leaf that was the last leaf is no longer marked as such */
+		if (old.size != layout.size) {
+			intervals[n].lo = (old.level_nodes[0] < layout.level_nodes[0] ? old.level_nodes[0] : layout.level_nodes[0]) - 1;
+			intervals[n++].hi = layout.level_nodes[0];
+		}
+		n = merge_intervals(intervals, n);
+	}
+	/* If the number of leaves has changed, the
+	 * whole tree above the leaves is rebuilt */
+	restructure = rebuild || old.level_nodes[0] != layout.level_nodes[0];
+
+	if (ftruncate(store_fd, (off_t)layout.store_size))
+		goto fail;
+	map = mmap(NULL, (size_t)layout.store_size, PROT_READ | PROT_WRITE, MAP_SHARED, store_fd, 0);
+	if (map == MAP_FAILED)
+		goto fail;
+	header = (void *)map;
+	/* The store is marked as unusable, on disk, before it is
+	 * modified, so that it is rebuilt if the update is interrupted,
+	 * even by a system crash, rather than left half updated */
+	memset(header->magic, 0, sizeof(header->magic));
+	if (msync(map, sizeof(*header), MS_SYNC))
+		goto fail;
+
+#ifdef POSIX_FADV_SEQUENTIAL
+	if (rebuild)
+		posix_fadvise(data_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+	for (i = 0; i < n; i++)
+		if (hash_leaves(data_fd, hasher, &layout, &intervals[i], buf, &map[layout.level_offsets[0]]))
+			goto fail;
+
+	for (level = 1; level < layout.nlevels; level++) {
+		if (restructure || level + 1 == layout.nlevels) {
+			/* The root is always hashed, as it is not stored */
+			n = 1;
+			intervals[0].lo = 0;
+			intervals[0].hi = layout.level_nodes[level];
+		} else {
+			/* The intervals remain sorted, but may now be adjacent or overlap */
+			span = layout.level_span[level];
+			for (i = 0, j = 0; i < n; i++) {
+				intervals[i].lo /= span;
+				intervals[i].hi = (intervals[i].hi - 1) / span + 1;
+				if (j && intervals[i].lo <= intervals[j - 1].hi)
+					intervals[j - 1].hi = intervals[i].hi;
+				else
+					intervals[j++] = intervals[i];
+			}
+			n = j;
+		}
+		for (i = 0; i < n; i++)
+			hash_inner(hasher, &layout, level, &intervals[i], map, output);
+	}
+
+	/* The digests must reach the disk before the store is marked as usable */
+	memcpy(header->identity, hasher->identity, sizeof(header->identity));
+	header->size = layout.size;
+	header->reserved = 0;
+	if (msync(map, (size_t)layout.store_size, MS_SYNC))
+		goto fail;
+	memcpy(header->magic, TREE_STORE_MAGIC, sizeof(header->magic));
+
+	munmap(map, (size_t)layout.store_size);
+	free(intervals);
+	free(buf);
+	return 0;
+
+fail:
+	saved_errno = errno;
+	if (map != MAP_FAILED)
+		munmap(map, (size_t)layout.store_size);
+	free(intervals);
+	free(buf);
+	errno = saved_errno;
+	return -1;
+}
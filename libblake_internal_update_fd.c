@@ -0,0 +1,214 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+/* Regular files (or data segments in sparse files) at least this
+ * large are mapped into memory, if they cannot be truncated */
+#define MMAP_THRESHOLD ((off_t)1 << 20)
+
+/* Files are mapped in windows of this size, so that the
+ * address space is not exhausted on 32-bit systems */
+#define MMAP_WINDOW ((size_t)1 << 28)
+
+/* Buffer size used when the file is read */
+#define READ_SIZE ((size_t)1 << 17)
+
+/* Holes in sparse files are hashed from this instead of being read */
+static const unsigned char zeroes[(size_t)1 << 16];
+
+static int
+cannot_shrink(int fd)
+{
+	/* Accessing a mapping beyond the end of the file raises SIGBUS, so
+	 * only files whose size cannot be reduced while they are hashed
+	 * (sealed memfds) are mapped; others may be modified concurrently */
+#if defined(F_GET_SEALS) && defined(F_SEAL_SHRINK)
+	int seals = fcntl(fd, F_GET_SEALS);
+	return seals >= 0 && (seals & F_SEAL_SHRINK);
+#else
+	(void) fd;
+	return 0;
+#endif
+}
+
+static off_t
+update_mmap(int fd, off_t off, off_t end, void (*update)(void *stream, const void *data, size_t len), void *stream)
+{
+	long int pagesize = sysconf(_SC_PAGESIZE);
+	size_t len, skip;
+	unsigned char *map;
+
+	if (pagesize <= 0)
+		pagesize = 4096;
+
+	while (off < end) {
+		/* mmap(2) requires a page-aligned offset */
+		skip = (size_t)(off % (off_t)pagesize);
+		len = end - off > (off_t)(MMAP_WINDOW - skip) ? MMAP_WINDOW : (size_t)(end - off) + skip;
+		map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, off - (off_t)skip);
+		if (map == MAP_FAILED)
+			break;
+#ifdef MADV_HUGEPAGE
+		madvise(map, len, MADV_HUGEPAGE);
+#endif
+		madvise(map, len, MADV_SEQUENTIAL);
+		update(stream, &map[skip], len - skip);
+		munmap(map, len);
+		off += (off_t)(len - skip);
+	}
+
+	/* If mmap(2) failed, the caller will read the rest */
+	return off;
+}
+
+static int
+update_pread(int fd, off_t off, off_t end, void *buf, void (*update)(void *stream, const void *data, size_t len), void *stream)
+{
+	ssize_t r;
+
+	while (off < end) {
+		r = pread(fd, buf, end - off < (off_t)READ_SIZE ? (size_t)(end - off) : READ_SIZE, off);
+		if (r <= 0) {
+			if (!r) {
+				/* The file was truncated while it was hashed */
+				errno = EIO;
+				return -1;
+			}
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		update(stream, buf, (size_t)r);
+		off += (off_t)r;
+	}
+
+	return 0;
+}
+
+static int
+update_sparse(int fd, off_t off, off_t end, int mappable, void *buf,
+              void (*update)(void *stream, const void *data, size_t len), void *stream)
+{
+#if defined(SEEK_DATA) && defined(SEEK_HOLE)
+	struct stat st;
+	off_t data, hole, n;
+
+	while (off < end) {
+		data = lseek(fd, off, SEEK_DATA);
+		if (data < 0) {
+			if (errno != ENXIO)
+				return -1;
+			/* ENXIO is also returned beyond the end of the file, so
+			 * unless the file still reaches `end` it was truncated,
+			 * and hashing zeroes in place of the lost data would
+			 * give a digest for contents the file never had */
+			if (fstat(fd, &st))
+				return -1;
+			if (st.st_size < end) {
+				errno = EIO;
+				return -1;
+			}
+			data = end; /* The file ends with a hole */
+		}
+		if (data > end)
+			data = end;
+		for (; off < data; off += n) {
+			n = data - off < (off_t)sizeof(zeroes) ? data - off : (off_t)sizeof(zeroes);
+			update(stream, zeroes, (size_t)n);
+		}
+		if (off == end)
+			break;
+
+		hole = lseek(fd, data, SEEK_HOLE);
+		if (hole < 0)
+			return -1;
+		if (hole > end)
+			hole = end;
+		off = data;
+		if (mappable && hole - data >= MMAP_THRESHOLD)
+			off = update_mmap(fd, data, hole, update, stream);
+		if (update_pread(fd, off, hole, buf, update, stream))
+			return -1;
+		off = hole;
+	}
+
+	return 0;
+#else
+	(void) mappable;
+	return update_pread(fd, off, end, buf, update, stream);
+#endif
+}
+
+int
+libblake_internal_update_fd(int fd, void (*update)(void *stream, const void *data, size_t len), void *stream)
+{
+	struct stat st;
+	void *buf;
+	ssize_t r;
+	off_t pos, hole;
+	int mappable, saved_errno;
+
+	if (fstat(fd, &st))
+		return -1;
+
+	if (!S_ISREG(st.st_mode)) {
+		/* For pipes, sockets and such, reading and hashing on
+		 * the same thread would leave the writer idle while hashing */
+		r = libblake_internal_update_pipe(fd, update, stream);
+		if (r <= 0)
+			return (int)r;
+	}
+
+	/* The buffer is a multiple of all block sizes, and aligned
+	 * to pages, so whole blocks are processed directly from it
+	 * and the kernel can copy into it efficiently */
+	if (posix_memalign(&buf, 4096, READ_SIZE)) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+	pos = S_ISREG(st.st_mode) ? lseek(fd, 0, SEEK_CUR) : -1;
+	if (pos >= 0 && pos < st.st_size) {
+		mappable = cannot_shrink(fd);
+#ifdef SEEK_HOLE
+		/* Every file has a virtual hole at its end */
+		hole = lseek(fd, pos, SEEK_HOLE);
+#else
+		hole = -1;
+#endif
+		if (hole >= 0 && hole < st.st_size) {
+			if (update_sparse(fd, pos, st.st_size, mappable, buf, update, stream))
+				goto fail;
+			pos = st.st_size;
+		} else if (mappable && st.st_size - pos >= MMAP_THRESHOLD) {
+			pos = update_mmap(fd, pos, st.st_size, update, stream);
+		} else {
+#ifdef POSIX_FADV_SEQUENTIAL
+			posix_fadvise(fd, pos, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+		}
+		/* Leave the file offset where read(2) would have left it,
+		 * the rest, including anything appended, is read below */
+		if (lseek(fd, pos, SEEK_SET) < 0)
+			goto fail;
+	}
+
+	for (;;) {
+		r = read(fd, buf, READ_SIZE);
+		if (r <= 0) {
+			if (!r)
+				break;
+			if (errno == EINTR)
+				continue;
+			goto fail;
+		}
+		update(stream, buf, (size_t)r);
+	}
+	free(buf);
+	return 0;
+
+fail:
+	saved_errno = errno;
+	free(buf);
+	errno = saved_errno;
+	return -1;
+}
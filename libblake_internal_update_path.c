@@ -0,0 +1,17 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_internal_update_path(const char *path, void (*update)(void *stream, const void *data, size_t len), void *stream)
+{
+	int fd, ret, saved_errno;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return -1;
+	ret = libblake_internal_update_fd(fd, update, stream);
+	saved_errno = errno;
+	close(fd);
+	errno = saved_errno;
+	return ret;
+}
@@ -0,0 +1,156 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+#if defined(__GNUC__)
+
+/* Number of buffers in the ring, and their size; the size is a
+ * multiple of all block sizes so whole blocks are processed in place */
+#define SLOTS 8
+#define SLOT_SIZE ((size_t)1 << 16)
+
+/* Number of times the ring is polled before going to sleep */
+#define SPIN 1000
+
+struct ring {
+	/* Only written by the reader; except `head`, which is only
+	 * written by the hasher; these are accessed without locking */
+	size_t head;
+	size_t tail;
+	size_t lens[SLOTS];
+	int error;
+	int fd;
+	unsigned char *buffers;
+
+	/* Only used when a thread has to wait */
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	int waiting[2]; /* [1] for the reader, [0] for the hasher */
+};
+
+static void
+wait_for(struct ring *ring, size_t *index, size_t value, int full)
+{
+	size_t i;
+
+	/* `*index` is the other thread's index; wait until the ring is
+	 * not full (`full`) or not empty (`!full`), where `value` is this
+	 * thread's index */
+#define READY() (full ? value - __atomic_load_n(index, __ATOMIC_SEQ_CST) < SLOTS\
+                      : value != __atomic_load_n(index, __ATOMIC_SEQ_CST))
+
+	for (i = 0; i < SPIN; i++)
+		if (READY())
+			return;
+
+	pthread_mutex_lock(&ring->mutex);
+	__atomic_store_n(&ring->waiting[full], 1, __ATOMIC_SEQ_CST);
+	while (!READY())
+		pthread_cond_wait(&ring->cond, &ring->mutex);
+	__atomic_store_n(&ring->waiting[full], 0, __ATOMIC_SEQ_CST);
+	pthread_mutex_unlock(&ring->mutex);
+
+#undef READY
+}
+
+static void
+publish(struct ring *ring, size_t *index, size_t value, int full)
+{
+	/* Wake the other thread if it is waiting, `full` is the same as for wait_for */
+	__atomic_store_n(index, value, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&ring->waiting[!full], __ATOMIC_SEQ_CST)) {
+		pthread_mutex_lock(&ring->mutex);
+		pthread_cond_signal(&ring->cond);
+		pthread_mutex_unlock(&ring->mutex);
+	}
+}
+
+static void *
+reader(void *ring_)
+{
+	struct ring *ring = ring_;
+	size_t tail = 0, slot;
+	ssize_t r;
+
+	for (;;) {
+		wait_for(ring, &ring->head, tail, 1);
+		slot = tail % SLOTS;
+		r = read(ring->fd, &ring->buffers[slot * SLOT_SIZE], SLOT_SIZE);
+		if (r < 0 && errno == EINTR)
+			continue;
+		/* An empty buffer marks the end of the input, or an error */
+		ring->lens[slot] = r > 0 ? (size_t)r : 0;
+		if (r < 0)
+			ring->error = errno;
+		publish(ring, &ring->tail, ++tail, 1);
+		if (r <= 0)
+			break;
+	}
+
+	return NULL;
+}
+
+int
+libblake_internal_update_pipe(int fd, void (*update)(void *stream, const void *data, size_t len), void *stream)
+{
+	struct ring ring;
+	pthread_t thread;
+	size_t head = 0, slot;
+	void *buffers;
+
+	/* Page-aligned for the kernel's sake */
+	if (posix_memalign(&buffers, 4096, SLOTS * SLOT_SIZE))
+		return 1;
+	ring.head = 0;
+	ring.tail = 0;
+	ring.error = 0;
+	ring.fd = fd;
+	ring.buffers = buffers;
+	ring.waiting[0] = 0;
+	ring.waiting[1] = 0;
+	if (pthread_mutex_init(&ring.mutex, NULL))
+		goto fail_buffers;
+	if (pthread_cond_init(&ring.cond, NULL))
+		goto fail_mutex;
+	if (pthread_create(&thread, NULL, &reader, &ring))
+		goto fail_cond;
+
+	for (;;) {
+		wait_for(&ring, &ring.tail, head, 0);
+		slot = head % SLOTS;
+		if (!ring.lens[slot])
+			break;
+		update(stream, &ring.buffers[slot * SLOT_SIZE], ring.lens[slot]);
+		publish(&ring, &ring.head, ++head, 0);
+	}
+
+	pthread_join(thread, NULL);
+	pthread_cond_destroy(&ring.cond);
+	pthread_mutex_destroy(&ring.mutex);
+	free(buffers);
+	if (ring.error) {
+		errno = ring.error;
+		return -1;
+	}
+	return 0;
+
+fail_cond:
+	pthread_cond_destroy(&ring.cond);
+fail_mutex:
+	pthread_mutex_destroy(&ring.mutex);
+fail_buffers:
+	free(buffers);
+	return 1;
+}
+
+#else
+
+int
+libblake_internal_update_pipe(int fd, void (*update)(void *stream, const void *data, size_t len), void *stream)
+{
+	(void) fd;
+	(void) update;
+	(void) stream;
+	return 1;
+}
+
+#endif
@@ -0,0 +1,220 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+/* Upper limit for the number of threads */
+#define MAX_THREADS 64
+
+/* Minimum number of blocks per thread, so that threads
+ * are not started for small levels near the top */
+#define MIN_BLOCKS_PER_THREAD 256
+
+/* Buffer size, per thread, used when the data is read */
+#define READ_SIZE ((size_t)1 << 20)
+
+struct range {
+	const struct libblake_internal_verity_hasher *hasher;
+	const unsigned char *data; /* `NULL` if read from `fd` */
+	int fd;
+	off_t offset;
+	size_t block_size;
+	size_t n;
+	unsigned char *output;
+	size_t output_stride;
+	int error;
+};
+
+static void *
+hash_range(void *range_)
+{
+	struct range *range = range_;
+	unsigned char *buf = NULL;
+	size_t per_read, n, done, got;
+	ssize_t r;
+
+	range->error = 0;
+	if (range->data) {
+		if (range->hasher->hash_blocks(range->hasher->ctx, range->data, range->block_size, range->n,
+		                               range->output, range->output_stride))
+			goto fail;
+		return NULL;
+	}
+
+	/* The data file is read rather than mapped into memory,
+	 * as the process would be killed by SIGBUS if the file
+	 * were truncated while mapped; a truncation is an error */
+	per_read = READ_SIZE / range->block_size ? READ_SIZE / range->block_size : 1;
+	buf = malloc(per_read * range->block_size);
+	if (!buf) {
+		errno = ENOMEM;
+		goto fail;
+	}
+	for (done = 0; done < range->n; done += n) {
+		n = range->n - done < per_read ? range->n - done : per_read;
+		for (got = 0; got < n * range->block_size; got += (size_t)r) {
+			r = pread(range->fd, &buf[got], n * range->block_size - got,
+			          range->offset + (off_t)(done * range->block_size + got));
+			if (r <= 0) {
+				if (!r) {
+					errno = EIO;
+					goto fail;
+				}
+				if (errno != EINTR)
+					goto fail;
+				r = 0;
+			}
+		}
+		if (range->hasher->hash_blocks(range->hasher->ctx, buf, range->block_size, n,
+		                               &range->output[done * range->output_stride], range->output_stride))
+			goto fail;
+	}
+	free(buf);
+	return NULL;
+
+fail:
+	range->error = errno;
+	free(buf);
+	return NULL;
+}
+
+static int
+hash_level(const struct libblake_internal_verity_hasher *hasher, const unsigned char *data, int fd, size_t block_size,
+           size_t n, unsigned char *output, size_t output_stride, size_t nthreads)
+{
+	pthread_t threads[MAX_THREADS];
+	struct range ranges[MAX_THREADS];
+	size_t i, off = 0, created;
+
+	if (nthreads > n / MIN_BLOCKS_PER_THREAD)
+		nthreads = n / MIN_BLOCKS_PER_THREAD ? n / MIN_BLOCKS_PER_THREAD : 1;
+
+	/* The blocks are hashed independently, so each thread gets a contiguous range */
+	for (i = 0; i < nthreads; i++) {
+		ranges[i].hasher = hasher;
+		ranges[i].data = data ? &data[off * block_size] : NULL;
+		ranges[i].fd = fd;
+		ranges[i].offset = (off_t)(off * block_size);
+		ranges[i].block_size = block_size;
+		ranges[i].n = n / nthreads + (i < n % nthreads);
+		ranges[i].output = &output[off * output_stride];
+		ranges[i].output_stride = output_stride;
+		off += ranges[i].n;
+	}
+	for (created = 1; created < nthreads; created++)
+		if (pthread_create(&threads[created], NULL, &hash_range, &ranges[created]))
+			break;
+
+	/* The calling thread takes the first range, and the ranges
+	 * of any threads that could not be created */
+	hash_range(&ranges[0]);
+	for (i = created; i < nthreads; i++)
+		hash_range(&ranges[i]);
+	for (i = 1; i < created; i++)
+		pthread_join(threads[i], NULL);
+
+	for (i = 0; i < nthreads; i++) {
+		if (ranges[i].error) {
+			errno = ranges[i].error;
+			return -1;
+		}
+	}
+	return 0;
+}
+
+int
+libblake_internal_verity_build(int data_fd, int hash_fd, size_t block_size, size_t digest_len, size_t nthreads,
+                               const struct libblake_internal_verity_hasher *hasher, unsigned char *root)
+{
+	struct libblake_internal_verity_layout layout;
+	struct stat st;
+	unsigned char *tree = NULL, *last = NULL;
+	size_t size, full, level, got;
+	long int ncpus;
+	ssize_t r;
+	int saved_errno;
+
+	if (!nthreads) {
+		ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+		nthreads = ncpus > 0 ? (size_t)ncpus : 1;
+	}
+	if (nthreads > MAX_THREADS)
+		nthreads = MAX_THREADS;
+
+	if (fstat(data_fd, &st))
+		return -1;
+	if (!block_size || st.st_size <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+	if ((uintmax_t)st.st_size > SIZE_MAX) {
+		errno = ENOMEM;
+		return -1;
+	}
+	size = (size_t)st.st_size;
+	full = size / block_size;
+	if (libblake_internal_verity_layout(&layout, full + (size % block_size ? 1 : 0), block_size, digest_len))
+		return -1;
+	if ((uintmax_t)layout.size > SIZE_MAX) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+#ifdef POSIX_FADV_SEQUENTIAL
+	posix_fadvise(data_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+	/* Truncating the file first zeroes any padding */
+	if (ftruncate(hash_fd, 0) || ftruncate(hash_fd, (off_t)layout.size))
+		return -1;
+	tree = mmap(NULL, (size_t)layout.size, PROT_READ | PROT_WRITE, MAP_SHARED, hash_fd, 0);
+	if (tree == MAP_FAILED)
+		return -1;
+
+	/* Level 0 is the hashes of the data blocks, where
+	 * the last block is padded with zeroes if partial */
+	if (hash_level(hasher, NULL, data_fd, block_size, full, &tree[layout.level_offsets[0]], layout.slot_size, nthreads))
+		goto fail;
+	if (size % block_size) {
+		last = calloc(1, block_size);
+		if (!last)
+			goto fail;
+		for (got = 0; got < size % block_size; got += (size_t)r) {
+			r = pread(data_fd, &last[got], size % block_size - got, (off_t)(full * block_size + got));
+			if (r <= 0) {
+				if (!r) {
+					/* The file was truncated while it was being hashed */
+					errno = EIO;
+					goto fail;
+				}
+				if (errno != EINTR)
+					goto fail;
+				r = 0;
+			}
+		}
+		if (hasher->hash_blocks(hasher->ctx, last, block_size, 1,
+		                        &tree[layout.level_offsets[0] + full * layout.slot_size], 0))
+			goto fail;
+		free(last);
+		last = NULL;
+	}
+
+	/* Each other level is the hashes of the blocks of the level below it */
+	for (level = 1; level < layout.nlevels; level++) {
+		if (hash_level(hasher, &tree[layout.level_offsets[level - 1]], -1, block_size,
+		               (size_t)layout.level_blocks[level - 1], &tree[layout.level_offsets[level]],
+		               layout.slot_size, nthreads))
+			goto fail;
+	}
+
+	if (hasher->hash_blocks(hasher->ctx, &tree[layout.level_offsets[layout.nlevels - 1]], block_size, 1, root, 0))
+		goto fail;
+
+	munmap(tree, (size_t)layout.size);
+	return 0;
+
+fail:
+	saved_errno = errno;
+	free(last);
+	munmap(tree, (size_t)layout.size);
+	errno = saved_errno;
+	return -1;
+}
@@ -0,0 +1,36 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_internal_verity_layout(struct libblake_internal_verity_layout *layout, uint_least64_t nblocks,
+                                size_t block_size, size_t digest_len)
+{
+	uint_least64_t n, offset = 0;
+	size_t i;
+
+	/* As in dm-verity, each hash is padded to a power of two bytes */
+	for (layout->slot_size = 1; layout->slot_size < digest_len; layout->slot_size <<= 1);
+	if (!nblocks || !digest_len || (block_size & (block_size - 1)) || block_size < 2 * layout->slot_size) {
+		errno = EINVAL;
+		return -1;
+	}
+	layout->block_size = block_size;
+	layout->digest_len = digest_len;
+	layout->per_block = block_size / layout->slot_size;
+	layout->nblocks = nblocks;
+
+	n = nblocks;
+	for (i = 0; !i || n > 1; i++) {
+		n = n / layout->per_block + (n % layout->per_block ? 1 : 0);
+		layout->level_blocks[i] = n;
+	}
+	layout->nlevels = i;
+
+	/* The highest level, which is a single block, is stored first */
+	for (i = layout->nlevels; i--;) {
+		layout->level_offsets[i] = offset;
+		offset += layout->level_blocks[i] * (uint_least64_t)block_size;
+	}
+	layout->size = offset;
+	return 0;
+}
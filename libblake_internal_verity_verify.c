@@ -0,0 +1,34 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_internal_verity_verify(const void *tree_, size_t tree_size, uint_least64_t nblocks,
+                                size_t block_size, size_t digest_len,
+                                const struct libblake_internal_verity_hasher *hasher,
+                                const unsigned char *root, uint_least64_t index, const void *block)
+{
+	struct libblake_internal_verity_layout layout;
+	const unsigned char *tree = tree_, *hash_block;
+	unsigned char digest[64];
+	size_t level;
+
+	if (libblake_internal_verity_layout(&layout, nblocks, block_size, digest_len))
+		return -1;
+	if (index >= nblocks || (uintmax_t)tree_size < (uintmax_t)layout.size) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* Each hash must match the hash stored in the level above it, up to the root */
+	if (hasher->hash_blocks(hasher->ctx, block, block_size, 1, digest, 0))
+		return -1;
+	for (level = 0; level < layout.nlevels; level++) {
+		hash_block = &tree[layout.level_offsets[level] + index / layout.per_block * block_size];
+		if (memcmp(&hash_block[index % layout.per_block * layout.slot_size], digest, digest_len))
+			return 0;
+		if (hasher->hash_blocks(hasher->ctx, hash_block, block_size, 1, digest, 0))
+			return -1;
+		index /= layout.per_block;
+	}
+	return !memcmp(digest, root, digest_len);
+}
@@ -0,0 +1,20 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+uint_least32_t
+libblake_rolling_checksum(const void *data_, size_t len)
+{
+	const unsigned char *data = data_;
+	uint_least32_t a = 0, b = 0;
+	size_t i;
+
+	/* Only the low 16 bits are kept, so overflow does not matter;
+	 * the sum of the running sums is the sum of each byte multiplied
+	 * by the number of bytes from it to the end of the block */
+	for (i = 0; i < len; i++) {
+		a += (uint_least32_t)data[i];
+		b += a;
+	}
+
+	return (a & UINT_LEAST32_C(0xFFFF)) | ((b & UINT_LEAST32_C(0xFFFF)) << 16);
+}
@@ -0,0 +1,4 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+extern inline uint_least32_t libblake_rolling_checksum_roll(uint_least32_t sum, size_t len, unsigned char out, unsigned char in);
@@ -0,0 +1,20 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+size_t
+libblake_tree_node_export(const struct libblake_tree_node *node, void *buffer, size_t size)
+{
+	uint_least64_t words[5];
+	unsigned char bytes[sizeof(node->identity) + sizeof(node->digest)];
+
+	words[0] = node->size;
+	words[1] = node->node_offset;
+	words[2] = (uint_least64_t)node->node_depth;
+	words[3] = (uint_least64_t)!!node->root;
+	words[4] = (uint_least64_t)node->digest_len;
+	memcpy(bytes, node->identity, sizeof(node->identity));
+	memcpy(&bytes[sizeof(node->identity)], node->digest, (size_t)node->digest_len);
+
+	return libblake_internal_export(EXPORT_TREE_NODE, sizeof(*words), words, 5,
+	                                bytes, sizeof(node->identity) + (size_t)node->digest_len, buffer, size);
+}
@@ -0,0 +1,29 @@
+/* See LICENSE file for copyright and license details. */
+#include "common.h"
+
+int
+libblake_tree_node_import(struct libblake_tree_node *node, const void *buffer, size_t len)
+{
+	uint_least64_t words[5];
+	unsigned char bytes[sizeof(node->identity) + sizeof(node->digest)];
+	size_t nbytes = sizeof(bytes);
+
+	if (libblake_internal_import(EXPORT_TREE_NODE, sizeof(*words), words, 5, bytes,
+	                             sizeof(node->identity) + 1, &nbytes, buffer, len))
+		return -1;
+	if (words[2] >= TREE_MAX_LEVELS || words[3] > 1 || words[4] > sizeof(node->digest) ||
+	    nbytes != sizeof(node->identity) + (size_t)words[4]) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	node->size = words[0];
+	node->node_offset = words[1];
+	node->node_depth = (uint_least8_t)words[2];
+	node->root = (int)words[3];
+	node->digest_len = (uint_least8_t)words[4];
+	memcpy(node->identity, bytes, sizeof(node->identity));
+	memset(node->digest, 0, sizeof(node->digest));
+	memcpy(node->digest, &bytes[sizeof(node->identity)], (size_t)node->digest_len);
+	return 0;
+}
@@ -5,6 +5,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "libblake.h"
@@ -47,6 +52,7 @@ digest_blake1(int length, const void *msg, size_t msglen, size_t bits)
 		struct libblake_blake##BITS##_state s##BITS;\
 		req = libblake_blake##BITS##_digest_get_required_input_size(msglen, bits, NULL);\
 		data = malloc(req);\
+		memset(data, 0xA5, req);\
 		memcpy(data, msg, msglen + (bits + 7) / 8);\
 		libblake_blake##BITS##_init(&s##BITS);\
 		libblake_blake##BITS##_digest(&s##BITS, data, msglen, bits, NULL, buf);\
@@ -86,6 +92,13 @@ digest_blake1(int length, const void *msg, size_t msglen, size_t bits)
 # define CHECK_BLAKE512_HEX(MSG, EXPECTED) CHECK_BLAKE1_HEX(512, MSG, EXPECTED)
 #endif
 
+#define CHECK_BLAKE1_ZEROES(LENGTH, N, EXPECTED)\
+	(memset(buf, 0, N), failed |= !check_blake1_(LENGTH, #N" NUL bytes", buf, N, 0, EXPECTED))
+#define CHECK_BLAKE224_ZEROES(N, EXPECTED) CHECK_BLAKE1_ZEROES(224, N, EXPECTED)
+#define CHECK_BLAKE256_ZEROES(N, EXPECTED) CHECK_BLAKE1_ZEROES(256, N, EXPECTED)
+#define CHECK_BLAKE384_ZEROES(N, EXPECTED) CHECK_BLAKE1_ZEROES(384, N, EXPECTED)
+#define CHECK_BLAKE512_ZEROES(N, EXPECTED) CHECK_BLAKE1_ZEROES(512, N, EXPECTED)
+
 #define CHECK_BLAKE1_BITS(LENGTH, MSG, BITS, EXPECTED)\
 	failed |= !check_blake1_(LENGTH, "0x"MSG, buf, libblake_decode_hex(MSG, SIZE_MAX, buf, &(int){0}), BITS, EXPECTED)
 #define CHECK_BLAKE224_BITS(MSG, BITS, EXPECTED) CHECK_BLAKE1_BITS(224, MSG, BITS, EXPECTED)
@@ -126,6 +139,22 @@ check_blake1(void)
 	CHECK_BLAKE384_STR("", "c6cbd89c926ab525c242e6621f2f5fa73aa4afe3d9e24aed727faaadd6af38b620bdb623dd2b4788b1c8086984af8706");
 	CHECK_BLAKE512_STR("", "a8cfbbd73726062df0c6864dda65defe58ef0cc52a5625090fa17601e1eecd1b628e94f396ae402a00acc9eab77b4d4c2e852aaaa25a636d80af3fc7913ef5b8");
 
+	CHECK_BLAKE224_ZEROES(72, "f5aa00dd1cb847e3140372af7b5c46b4888d82c8c0a917913cfb5d04");
+	CHECK_BLAKE256_ZEROES(72, "d419bad32d504fb7d44d460c42c5593fe544fa4c135dec31e21bd9abdcc22d41");
+	CHECK_BLAKE384_ZEROES(144, "0b9845dd429566cdab772ba195d271effe2d0211f16991d766ba749447c5cde569780b2daa66c4b224a2ec2e5d09174c");
+	CHECK_BLAKE512_ZEROES(144, "313717d608e9cf758dcb1eb0f0c3cf9fc150b2d500fb33f51c52afc99d358a2f1374b8a38bba7974e7f6ef79cab16f22ce1e649d6e01ad9589c213045d545dde");
+
+	/* The padding does not fit in the last block and an extra block is needed,
+	 * the latter with an unaligned tail after a full block */
+	CHECK_BLAKE224_ZEROES(56, "15b58442b1b486ec9ea2305ab597e751cb754ed29f80c336171b061c");
+	CHECK_BLAKE256_ZEROES(56, "26ae7c289ebb79c9f3af2285023ab1037a9a6db63f0d6b6c6bbd199ab1627508");
+	CHECK_BLAKE224_ZEROES(120, "286aa9b64d1cf6cd72a34bf02939311802b5139ae842a6d81d52ea10");
+	CHECK_BLAKE256_ZEROES(120, "a48187b6556da878712df64af27acc800b0e0c492c9f82cd9ecf9354acfac0d7");
+	CHECK_BLAKE384_ZEROES(112, "b01c01344401bc6018a6ae65b12f6e700376e3ddde900e189f3ba45f09fe9a737ff40ded23d9ee4211535ed1d399702a");
+	CHECK_BLAKE512_ZEROES(112, "aa42836448c9db34e0e45a49f916b54c25c9eefe3f9f65db0c13654bcbd9a938c24251f3bedb7105fa4ea54292ce9ebf5adea15ce530fb71cdf409387a78c6ff");
+	CHECK_BLAKE384_ZEROES(240, "98e2b8507abb76729aa8b8423981780e8617bb6b75c9398e1318a5c0b6f15c4fcd3f057f20baf3217c782e437a31f28c");
+	CHECK_BLAKE512_ZEROES(240, "638d5f35b931eadfd47e0cbace1fc2bae7ed492c7b77e544d9558f899c24bbe327cc8cb1d558120147381cf20afe87902f6b3479198c99fd5408e91f823e88c5");
+
 	CHECK_BLAKE512_STR("The quick brown fox jumps over the lazy dog",
 	                   "1f7e26f63b6ad25a0896fd978fd050a1766391d2fd0471a77afb975e5034b7ad2d9ccf8dfb47abbbe656e1b82fbc634ba42ce186e8dc5e1ce09a885d41f43451");
 
@@ -347,6 +376,205 @@ check_blake1(void)
 	return failed;
 }
 
+static void
+fill_pattern(unsigned char *buf, size_t n, unsigned int seed)
+{
+	size_t i;
+	for (i = 0; i < n; i++) {
+		seed = seed * 1103515245U + 12345U;
+		buf[i] = (unsigned char)(seed >> 16);
+	}
+}
+
+static size_t
+next_chunk_size(size_t *i)
+{
+	static const size_t sizes[] = {1, 7, 64, 3, 130, 0, 128, 63, 200, 65, 127, 256, 2};
+	return sizes[(*i)++ % (sizeof(sizes) / sizeof(*sizes))];
+}
+
+static int
+check_blake1_stream(void)
+{
+	static const char *suffixes[] = {NULL, "", "01", "1101", NULL};
+	static unsigned char msg[1024];
+	unsigned char expected[LIBBLAKE_BLAKE512_OUTPUT_SIZE], result[LIBBLAKE_BLAKE512_OUTPUT_SIZE];
+	char long_suffix[1201];
+	unsigned char *data;
+	size_t len, bits, i, k, off, n, req;
+	const char *suffix;
+	int failed = 0;
+
+	fill_pattern(msg, sizeof(msg), 1);
+	for (i = 0; i < sizeof(long_suffix) - 1; i++)
+		long_suffix[i] = "01"[(i * 7 / 3) & 1];
+	long_suffix[i] = '\0';
+
+#define CHECK(BITS)\
+	do {\
+		struct libblake_blake##BITS##_state s##BITS;\
+		struct libblake_blake##BITS##_stream st##BITS;\
+		req = libblake_blake##BITS##_digest_get_required_input_size(len, bits, suffix);\
+		data = calloc(1, req);\
+		memcpy(data, msg, len + (bits + 7) / 8);\
+		libblake_blake##BITS##_init(&s##BITS);\
+		libblake_blake##BITS##_digest(&s##BITS, data, len, bits, suffix, expected);\
+		free(data);\
+		libblake_blake##BITS##_stream_init(&st##BITS);\
+		for (off = 0, k = 0; len - off > 256; off += n) {\
+			n = next_chunk_size(&k);\
+			libblake_blake##BITS##_stream_update(&st##BITS, &msg[off], n);\
+		}\
+		libblake_blake##BITS##_stream_digest(&st##BITS, &msg[off], len - off, bits, suffix, result);\
+		if (memcmp(result, expected, LIBBLAKE_BLAKE##BITS##_OUTPUT_SIZE)) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_blake%i_stream_digest failed for %zu bytes and %zu bits with suffix %s\n",\
+			        BITS, len, bits, suffix ? suffix : "(null)");\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+	} while (0)
+
+	suffixes[4] = long_suffix;
+	for (len = 0; len < 700; len += len < 260 ? 1 : 37) {
+		for (bits = 0; bits < 12; bits += 3) {
+			for (i = 0; i < sizeof(suffixes) / sizeof(*suffixes); i++) {
+				suffix = suffixes[i];
+				CHECK(224);
+				CHECK(256);
+				CHECK(384);
+				CHECK(512);
+			}
+		}
+	}
+
+#undef CHECK
+
+	return failed;
+}
+
+static unsigned char *
+readonly_copy(const unsigned char *data1, size_t len1, const unsigned char *data2, size_t len2)
+{
+	unsigned char *ret;
+	if (!len1 && !len2)
+		return NULL;
+	ret = mmap(NULL, len1 + len2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (ret == MAP_FAILED)
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	memcpy(ret, data1, len1);
+	if (len2)
+		memcpy(&ret[len1], data2, len2);
+	if (mprotect(ret, len1 + len2, PROT_READ))
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	return ret;
+}
+
+static size_t
+make_iovec(struct iovec *iov, size_t max, const unsigned char *data, size_t len, size_t *k)
+{
+	size_t n, cnt = 0;
+	while (len && cnt + 2 < max) {
+		n = next_chunk_size(k);
+		if (n > len)
+			n = len;
+		iov[cnt].iov_base = (void *)data;
+		iov[cnt++].iov_len = n;
+		data = &data[n];
+		len -= n;
+	}
+	if (len) {
+		iov[cnt].iov_base = (void *)data;
+		iov[cnt++].iov_len = len;
+	}
+	if (*k & 1) {
+		iov[cnt].iov_base = NULL;
+		iov[cnt++].iov_len = 0;
+	}
+	return cnt;
+}
+
+static void
+skip_iovec(struct iovec **iovp, size_t *cntp, size_t n)
+{
+	while (n && n >= (*iovp)->iov_len) {
+		n -= (*iovp)->iov_len;
+		++*iovp;
+		--*cntp;
+	}
+	if (n) {
+		(*iovp)->iov_base = &((unsigned char *)(*iovp)->iov_base)[n];
+		(*iovp)->iov_len -= n;
+	}
+}
+
+static int
+check_blake1_unpadded(void)
+{
+	static const char *suffixes[] = {NULL, "01", "1101"};
+	static unsigned char msg[1024];
+	unsigned char expected[LIBBLAKE_BLAKE512_OUTPUT_SIZE], result[LIBBLAKE_BLAKE512_OUTPUT_SIZE];
+	struct iovec iovbuf[64], *iov;
+	unsigned char *data;
+	size_t len, bits, i, k = 0, n, cnt, req;
+	const char *suffix;
+	int failed = 0;
+
+	fill_pattern(msg, sizeof(msg), 2);
+
+#define CHECK(BITS)\
+	do {\
+		struct libblake_blake##BITS##_state s##BITS;\
+		req = libblake_blake##BITS##_digest_get_required_input_size(len, bits, suffix);\
+		data = calloc(1, req);\
+		memcpy(data, msg, len + (bits + 7) / 8);\
+		libblake_blake##BITS##_init(&s##BITS);\
+		libblake_blake##BITS##_digest(&s##BITS, data, len, bits, suffix, expected);\
+		free(data);\
+		libblake_blake##BITS##_init(&s##BITS);\
+		iov = iovbuf;\
+		cnt = make_iovec(iov, sizeof(iovbuf) / sizeof(*iovbuf), msg, len, &k);\
+		n = libblake_blake##BITS##_updatev(&s##BITS, iov, cnt);\
+		cnt = make_iovec(iov, sizeof(iovbuf) / sizeof(*iovbuf), &msg[n], len - n + (bits + 7) / 8, &k);\
+		libblake_blake##BITS##_digestv(&s##BITS, iov, cnt, bits, suffix, result);\
+		if (memcmp(result, expected, LIBBLAKE_BLAKE##BITS##_OUTPUT_SIZE)) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_blake%i_digestv failed for %zu bytes and %zu bits with suffix %s\n",\
+			        BITS, len, bits, suffix ? suffix : "(null)");\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+		data = readonly_copy(msg, len + (bits + 7) / 8, NULL, 0);\
+		libblake_blake##BITS##_init(&s##BITS);\
+		libblake_blake##BITS##_digest_const(&s##BITS, data, len, bits, suffix, result);\
+		if (data)\
+			munmap(data, len + (bits + 7) / 8);\
+		if (memcmp(result, expected, LIBBLAKE_BLAKE##BITS##_OUTPUT_SIZE)) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_blake%i_digest_const failed for %zu bytes and %zu bits with suffix %s\n",\
+			        BITS, len, bits, suffix ? suffix : "(null)");\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+	} while (0)
+
+	for (len = 0; len < 700; len += len < 260 ? 1 : 37) {
+		for (bits = 0; bits < 12; bits += 3) {
+			for (i = 0; i < sizeof(suffixes) / sizeof(*suffixes); i++) {
+				suffix = suffixes[i];
+				CHECK(224);
+				CHECK(256);
+				CHECK(384);
+				CHECK(512);
+			}
+		}
+	}
+
+#undef CHECK
+
+	return failed;
+}
+
 static char *
 read_file(const char *path)
 {
@@ -766,25 +994,2787 @@ hash_blake2xb(unsigned char **msg, size_t msglen, size_t *msgsize,
 		libblake_blake2xb_digest(&state, i, rem, &(*out)[off]);
 }
 
-int
-main(void)
+static void
+stream_feed(void (*update)(void *stream, const void *data, size_t len), void *stream,
+            const unsigned char *data, size_t len, size_t *remaining)
 {
-	int failed = 0;
+	size_t off, n, k = 0;
+	for (off = 0; len - off > 256; off += n) {
+		n = next_chunk_size(&k);
+		update(stream, &data[off], n);
+	}
+	*remaining = len - off;
+}
 
-	libblake_init();
+static void
+blake2s_stream_update(void *stream, const void *data, size_t len)
+{
+	libblake_blake2s_stream_update(stream, data, len);
+}
 
-	/* TODO check macro constants */
+static void
+blake2b_stream_update(void *stream, const void *data, size_t len)
+{
+	libblake_blake2b_stream_update(stream, data, len);
+}
 
-	CHECK_HEX(1, 00, 12, 32, 00, 45, 67, 82, 9A, B0, CD, FE, FF, 80, 08, CC, 28);
-	CHECK_HEX(0, 00, 12, 32, 00, 45, 67, 82, 9a, b0, cd, fe, ff, 80, 08, cc, 28);
+static void
+blake2xs_stream_update(void *stream, const void *data, size_t len)
+{
+	libblake_blake2xs_stream_update(stream, data, len);
+}
 
-	failed |= check_blake1();
-	/* TODO need tests for BLAKE1 with salt and suffix */
-	failed |= check_kat_file("kat/blake2s", "BLAKE2s", &hash_blake2s);
-	failed |= check_kat_file("kat/blake2b", "BLAKE2b", &hash_blake2b);
-	/* TODO need tests for BLAKE2[sb] with salt and pepper */
-	failed |= check_kat_file("kat/blake2xs", "BLAKE2Xs", &hash_blake2xs);
-	failed |= check_kat_file("kat/blake2xb", "BLAKE2Xb", &hash_blake2xb);
+static void
+blake2xb_stream_update(void *stream, const void *data, size_t len)
+{
+	libblake_blake2xb_stream_update(stream, data, len);
+}
+
+static void
+hash_blake2s_stream(unsigned char **msg, size_t msglen, size_t *msgsize,
+                    unsigned char **key, size_t keylen, size_t *keysize,
+                    size_t hashlen,
+                    unsigned char **out, size_t *outlen, size_t *outsize,
+                    size_t testno, size_t test_lineno, const char *path)
+{
+	struct libblake_blake2s_params params;
+	struct libblake_blake2s_stream stream;
+	unsigned char keyblock[64];
+	size_t rem;
+
+	memset(&params, 0, sizeof(params));
+	params.digest_len = (uint_least8_t)hashlen;
+	params.fanout = 1;
+	params.depth = 1;
+	params.key_len = (uint_least8_t)keylen;
+
+	*outlen = hashlen;
+	if (*outlen > *outsize) {
+		*out = realloc(*out, *outsize = *outlen);
+		if (!*out)
+			ERROR("Internal test error: %s\n", strerror(ENOMEM)); /* $covered$ */
+	}
+
+	if (keylen > 32)
+		ERROR("Internal test error: corrupted test at line %zu in file %s, key is too long\n", test_lineno, path); /* $covered$ */
+
+	memset(*out, 0xCC, *outsize);
+	libblake_blake2s_stream_init(&stream, &params);
+	if (keylen) {
+		memset(keyblock, 0, sizeof(keyblock));
+		memcpy(keyblock, *key, keylen);
+		libblake_blake2s_stream_update(&stream, keyblock, 1);
+		libblake_blake2s_stream_update(&stream, &keyblock[1], sizeof(keyblock) - 1);
+	}
+	stream_feed(&blake2s_stream_update, &stream, *msg, msglen, &rem);
+	libblake_blake2s_stream_digest(&stream, &(*msg)[msglen - rem], rem, 0, *outlen, *out);
+}
+
+static void
+hash_blake2b_stream(unsigned char **msg, size_t msglen, size_t *msgsize,
+                    unsigned char **key, size_t keylen, size_t *keysize,
+                    size_t hashlen,
+                    unsigned char **out, size_t *outlen, size_t *outsize,
+                    size_t testno, size_t test_lineno, const char *path)
+{
+	struct libblake_blake2b_params params;
+	struct libblake_blake2b_stream stream;
+	unsigned char keyblock[128];
+	size_t rem;
+
+	memset(&params, 0, sizeof(params));
+	params.digest_len = (uint_least8_t)hashlen;
+	params.fanout = 1;
+	params.depth = 1;
+	params.key_len = (uint_least8_t)keylen;
+
+	*outlen = hashlen;
+	if (*outlen > *outsize) {
+		*out = realloc(*out, *outsize = *outlen);
+		if (!*out)
+			ERROR("Internal test error: %s\n", strerror(ENOMEM)); /* $covered$ */
+	}
+
+	if (keylen > 64)
+		ERROR("Internal test error: corrupted test at line %zu in file %s, key is too long\n", test_lineno, path); /* $covered$ */
+
+	memset(*out, 0xCC, *outsize);
+	libblake_blake2b_stream_init(&stream, &params);
+	if (keylen) {
+		memset(keyblock, 0, sizeof(keyblock));
+		memcpy(keyblock, *key, keylen);
+		libblake_blake2b_stream_update(&stream, keyblock, 1);
+		libblake_blake2b_stream_update(&stream, &keyblock[1], sizeof(keyblock) - 1);
+	}
+	stream_feed(&blake2b_stream_update, &stream, *msg, msglen, &rem);
+	libblake_blake2b_stream_digest(&stream, &(*msg)[msglen - rem], rem, 0, *outlen, *out);
+}
+
+static void
+hash_blake2xs_stream(unsigned char **msg, size_t msglen, size_t *msgsize,
+                     unsigned char **key, size_t keylen, size_t *keysize,
+                     size_t hashlen,
+                     unsigned char **out, size_t *outlen, size_t *outsize,
+                     size_t testno, size_t test_lineno, const char *path)
+{
+	struct libblake_blake2xs_params params;
+	struct libblake_blake2xs_stream stream;
+	unsigned char keyblock[64];
+	size_t rem, i, off;
+
+	memset(&params, 0, sizeof(params));
+	params.digest_len = 32;
+	params.key_len = (uint_least8_t)keylen;
+	params.fanout = 1;
+	params.depth = 1;
+	params.xof_len = (uint_least16_t)hashlen;
+
+	*outlen = hashlen;
+	if (*outlen > *outsize) {
+		*out = realloc(*out, *outsize = *outlen);
+		if (!*out)
+			ERROR("Internal test error: %s\n", strerror(ENOMEM)); /* $covered$ */
+	}
+
+	if (keylen > 64)
+		ERROR("Internal test error: corrupted test at line %zu in file %s, key is too long\n", test_lineno, path); /* $covered$ */
+
+	memset(*out, 0xCC, *outsize);
+	libblake_blake2xs_stream_init(&stream, &params);
+	if (keylen) {
+		memset(keyblock, 0, sizeof(keyblock));
+		memcpy(keyblock, *key, keylen);
+		libblake_blake2xs_stream_update(&stream, keyblock, sizeof(keyblock));
+	}
+	stream_feed(&blake2xs_stream_update, &stream, *msg, msglen, &rem);
+	libblake_blake2xs_stream_predigest(&stream, &(*msg)[msglen - rem], rem, 0);
+
+	for (i = 0, rem = *outlen, off = 0; rem >= 32; i++, rem -= 32, off += 32)
+		libblake_blake2xs_stream_digest(&stream, i, 32, &(*out)[off]);
+	if (rem)
+		libblake_blake2xs_stream_digest(&stream, i, rem, &(*out)[off]);
+}
+
+static void
+hash_blake2xb_stream(unsigned char **msg, size_t msglen, size_t *msgsize,
+                     unsigned char **key, size_t keylen, size_t *keysize,
+                     size_t hashlen,
+                     unsigned char **out, size_t *outlen, size_t *outsize,
+                     size_t testno, size_t test_lineno, const char *path)
+{
+	struct libblake_blake2xb_params params;
+	struct libblake_blake2xb_stream stream;
+	unsigned char keyblock[128];
+	size_t rem, i, off;
+
+	memset(&params, 0, sizeof(params));
+	params.digest_len = 64;
+	params.key_len = (uint_least8_t)keylen;
+	params.fanout = 1;
+	params.depth = 1;
+	params.xof_len = (uint_least32_t)hashlen;
+
+	*outlen = hashlen;
+	if (*outlen > *outsize) {
+		*out = realloc(*out, *outsize = *outlen);
+		if (!*out)
+			ERROR("Internal test error: %s\n", strerror(ENOMEM)); /* $covered$ */
+	}
+
+	if (keylen > 128)
+		ERROR("Internal test error: corrupted test at line %zu in file %s, key is too long\n", test_lineno, path); /* $covered$ */
+
+	memset(*out, 0xCC, *outsize);
+	libblake_blake2xb_stream_init(&stream, &params);
+	if (keylen) {
+		memset(keyblock, 0, sizeof(keyblock));
+		memcpy(keyblock, *key, keylen);
+		libblake_blake2xb_stream_update(&stream, keyblock, sizeof(keyblock));
+	}
+	stream_feed(&blake2xb_stream_update, &stream, *msg, msglen, &rem);
+	libblake_blake2xb_stream_predigest(&stream, &(*msg)[msglen - rem], rem, 0);
+
+	for (i = 0, rem = *outlen, off = 0; rem >= 64; i++, rem -= 64, off += 64)
+		libblake_blake2xb_stream_digest(&stream, i, 64, &(*out)[off]);
+	if (rem)
+		libblake_blake2xb_stream_digest(&stream, i, rem, &(*out)[off]);
+}
+
+static void
+hash_blake2s_iovec(unsigned char **msg, size_t msglen, size_t *msgsize,
+                    unsigned char **key, size_t keylen, size_t *keysize,
+                    size_t hashlen,
+                    unsigned char **out, size_t *outlen, size_t *outsize,
+                    size_t testno, size_t test_lineno, const char *path)
+{
+	struct libblake_blake2s_params params;
+	struct libblake_blake2s_state state;
+	unsigned char keyblock[64];
+	struct iovec iovbuf[64], *iov = iovbuf;
+	size_t cnt = 0, n, k = testno;
+
+	memset(&params, 0, sizeof(params));
+	params.digest_len = (uint_least8_t)hashlen;
+	params.fanout = 1;
+	params.depth = 1;
+	params.key_len = (uint_least8_t)keylen;
+
+	*outlen = hashlen;
+	if (*outlen > *outsize) {
+		*out = realloc(*out, *outsize = *outlen);
+		if (!*out)
+			ERROR("Internal test error: %s\n", strerror(ENOMEM)); /* $covered$ */
+	}
+
+	if (keylen > 32)
+		ERROR("Internal test error: corrupted test at line %zu in file %s, key is too long\n", test_lineno, path); /* $covered$ */
+
+	memset(*out, 0xCC, *outsize);
+	libblake_blake2s_init(&state, &params);
+	if (keylen) {
+		memset(keyblock, 0, sizeof(keyblock));
+		memcpy(keyblock, *key, keylen);
+		iov[0].iov_base = keyblock;
+		iov[0].iov_len = sizeof(keyblock);
+		cnt = 1;
+	}
+	cnt += make_iovec(&iov[cnt], sizeof(iovbuf) / sizeof(*iovbuf) - cnt, *msg, msglen, &k);
+	n = libblake_blake2s_updatev(&state, iov, cnt);
+	skip_iovec(&iov, &cnt, n);
+	libblake_blake2s_digestv(&state, iov, cnt, 0, *outlen, *out);
+}
+
+static void
+hash_blake2b_iovec(unsigned char **msg, size_t msglen, size_t *msgsize,
+                    unsigned char **key, size_t keylen, size_t *keysize,
+                    size_t hashlen,
+                    unsigned char **out, size_t *outlen, size_t *outsize,
+                    size_t testno, size_t test_lineno, const char *path)
+{
+	struct libblake_blake2b_params params;
+	struct libblake_blake2b_state state;
+	unsigned char keyblock[128];
+	struct iovec iovbuf[64], *iov = iovbuf;
+	size_t cnt = 0, n, k = testno;
+
+	memset(&params, 0, sizeof(params));
+	params.digest_len = (uint_least8_t)hashlen;
+	params.fanout = 1;
+	params.depth = 1;
+	params.key_len = (uint_least8_t)keylen;
+
+	*outlen = hashlen;
+	if (*outlen > *outsize) {
+		*out = realloc(*out, *outsize = *outlen);
+		if (!*out)
+			ERROR("Internal test error: %s\n", strerror(ENOMEM)); /* $covered$ */
+	}
+
+	if (keylen > 64)
+		ERROR("Internal test error: corrupted test at line %zu in file %s, key is too long\n", test_lineno, path); /* $covered$ */
+
+	memset(*out, 0xCC, *outsize);
+	libblake_blake2b_init(&state, &params);
+	if (keylen) {
+		memset(keyblock, 0, sizeof(keyblock));
+		memcpy(keyblock, *key, keylen);
+		iov[0].iov_base = keyblock;
+		iov[0].iov_len = sizeof(keyblock);
+		cnt = 1;
+	}
+	cnt += make_iovec(&iov[cnt], sizeof(iovbuf) / sizeof(*iovbuf) - cnt, *msg, msglen, &k);
+	n = libblake_blake2b_updatev(&state, iov, cnt);
+	skip_iovec(&iov, &cnt, n);
+	libblake_blake2b_digestv(&state, iov, cnt, 0, *outlen, *out);
+}
+
+static void
+hash_blake2s_const(unsigned char **msg, size_t msglen, size_t *msgsize,
+                   unsigned char **key, size_t keylen, size_t *keysize,
+                   size_t hashlen,
+                   unsigned char **out, size_t *outlen, size_t *outsize,
+                   size_t testno, size_t test_lineno, const char *path)
+{
+	struct libblake_blake2s_params params;
+	struct libblake_blake2s_state state;
+	unsigned char keyblock[64], *data;
+	size_t len;
+
+	memset(&params, 0, sizeof(params));
+	params.digest_len = (uint_least8_t)hashlen;
+	params.fanout = 1;
+	params.depth = 1;
+	params.key_len = (uint_least8_t)keylen;
+
+	*outlen = hashlen;
+	if (*outlen > *outsize) {
+		*out = realloc(*out, *outsize = *outlen);
+		if (!*out)
+			ERROR("Internal test error: %s\n", strerror(ENOMEM)); /* $covered$ */
+	}
+
+	if (keylen > 32)
+		ERROR("Internal test error: corrupted test at line %zu in file %s, key is too long\n", test_lineno, path); /* $covered$ */
+
+	memset(*out, 0xCC, *outsize);
+	memset(keyblock, 0, sizeof(keyblock));
+	if (keylen)
+		memcpy(keyblock, *key, keylen);
+	len = (keylen ? sizeof(keyblock) : 0) + msglen;
+	data = readonly_copy(keyblock, keylen ? sizeof(keyblock) : 0, *msg, msglen);
+
+	libblake_blake2s_init(&state, &params);
+	libblake_blake2s_digest_const(&state, data, len, 0, *outlen, *out);
+
+	if (data)
+		munmap(data, len);
+}
+
+static void
+hash_blake2b_const(unsigned char **msg, size_t msglen, size_t *msgsize,
+                   unsigned char **key, size_t keylen, size_t *keysize,
+                   size_t hashlen,
+                   unsigned char **out, size_t *outlen, size_t *outsize,
+                   size_t testno, size_t test_lineno, const char *path)
+{
+	struct libblake_blake2b_params params;
+	struct libblake_blake2b_state state;
+	unsigned char keyblock[128], *data;
+	size_t len;
+
+	memset(&params, 0, sizeof(params));
+	params.digest_len = (uint_least8_t)hashlen;
+	params.fanout = 1;
+	params.depth = 1;
+	params.key_len = (uint_least8_t)keylen;
+
+	*outlen = hashlen;
+	if (*outlen > *outsize) {
+		*out = realloc(*out, *outsize = *outlen);
+		if (!*out)
+			ERROR("Internal test error: %s\n", strerror(ENOMEM)); /* $covered$ */
+	}
+
+	if (keylen > 64)
+		ERROR("Internal test error: corrupted test at line %zu in file %s, key is too long\n", test_lineno, path); /* $covered$ */
+
+	memset(*out, 0xCC, *outsize);
+	memset(keyblock, 0, sizeof(keyblock));
+	if (keylen)
+		memcpy(keyblock, *key, keylen);
+	len = (keylen ? sizeof(keyblock) : 0) + msglen;
+	data = readonly_copy(keyblock, keylen ? sizeof(keyblock) : 0, *msg, msglen);
+
+	libblake_blake2b_init(&state, &params);
+	libblake_blake2b_digest_const(&state, data, len, 0, *outlen, *out);
+
+	if (data)
+		munmap(data, len);
+}
+
+static void
+hash_blake2xs_const(unsigned char **msg, size_t msglen, size_t *msgsize,
+                    unsigned char **key, size_t keylen, size_t *keysize,
+                    size_t hashlen,
+                    unsigned char **out, size_t *outlen, size_t *outsize,
+                    size_t testno, size_t test_lineno, const char *path)
+{
+	struct libblake_blake2xs_params params;
+	struct libblake_blake2xs_state state;
+	unsigned char keyblock[64], *data;
+	size_t len, rem, i, off;
+
+	memset(&params, 0, sizeof(params));
+	params.digest_len = 32;
+	params.key_len = (uint_least8_t)keylen;
+	params.fanout = 1;
+	params.depth = 1;
+	params.xof_len = (uint_least16_t)hashlen;
+
+	*outlen = hashlen;
+	if (*outlen > *outsize) {
+		*out = realloc(*out, *outsize = *outlen);
+		if (!*out)
+			ERROR("Internal test error: %s\n", strerror(ENOMEM)); /* $covered$ */
+	}
+
+	if (keylen > 64)
+		ERROR("Internal test error: corrupted test at line %zu in file %s, key is too long\n", test_lineno, path); /* $covered$ */
+
+	memset(*out, 0xCC, *outsize);
+	memset(keyblock, 0, sizeof(keyblock));
+	if (keylen)
+		memcpy(keyblock, *key, keylen);
+	len = (keylen ? sizeof(keyblock) : 0) + msglen;
+	data = readonly_copy(keyblock, keylen ? sizeof(keyblock) : 0, *msg, msglen);
+
+	libblake_blake2xs_init(&state, &params);
+	libblake_blake2xs_predigest_const(&state, data, len, 0);
+
+	for (i = 0, rem = *outlen, off = 0; rem >= 32; i++, rem -= 32, off += 32)
+		libblake_blake2xs_digest(&state, i, 32, &(*out)[off]);
+	if (rem)
+		libblake_blake2xs_digest(&state, i, rem, &(*out)[off]);
+
+	if (data)
+		munmap(data, len);
+}
+
+static void
+hash_blake2xb_const(unsigned char **msg, size_t msglen, size_t *msgsize,
+                    unsigned char **key, size_t keylen, size_t *keysize,
+                    size_t hashlen,
+                    unsigned char **out, size_t *outlen, size_t *outsize,
+                    size_t testno, size_t test_lineno, const char *path)
+{
+	struct libblake_blake2xb_params params;
+	struct libblake_blake2xb_state state;
+	unsigned char keyblock[128], *data;
+	size_t len, rem, i, off;
+
+	memset(&params, 0, sizeof(params));
+	params.digest_len = 64;
+	params.key_len = (uint_least8_t)keylen;
+	params.fanout = 1;
+	params.depth = 1;
+	params.xof_len = (uint_least32_t)hashlen;
+
+	*outlen = hashlen;
+	if (*outlen > *outsize) {
+		*out = realloc(*out, *outsize = *outlen);
+		if (!*out)
+			ERROR("Internal test error: %s\n", strerror(ENOMEM)); /* $covered$ */
+	}
+
+	if (keylen > 128)
+		ERROR("Internal test error: corrupted test at line %zu in file %s, key is too long\n", test_lineno, path); /* $covered$ */
+
+	memset(*out, 0xCC, *outsize);
+	memset(keyblock, 0, sizeof(keyblock));
+	if (keylen)
+		memcpy(keyblock, *key, keylen);
+	len = (keylen ? sizeof(keyblock) : 0) + msglen;
+	data = readonly_copy(keyblock, keylen ? sizeof(keyblock) : 0, *msg, msglen);
+
+	libblake_blake2xb_init(&state, &params);
+	libblake_blake2xb_predigest_const(&state, data, len, 0);
+
+	for (i = 0, rem = *outlen, off = 0; rem >= 64; i++, rem -= 64, off += 64)
+		libblake_blake2xb_digest(&state, i, 64, &(*out)[off]);
+	if (rem)
+		libblake_blake2xb_digest(&state, i, rem, &(*out)[off]);
+
+	if (data)
+		munmap(data, len);
+}
+
+static void
+hash_blake2s_oneshot(unsigned char **msg, size_t msglen, size_t *msgsize,
+                     unsigned char **key, size_t keylen, size_t *keysize,
+                     size_t hashlen,
+                     unsigned char **out, size_t *outlen, size_t *outsize,
+                     size_t testno, size_t test_lineno, const char *path)
+{
+	*outlen = hashlen;
+	if (*outlen > *outsize) {
+		*out = realloc(*out, *outsize = *outlen);
+		if (!*out)
+			ERROR("Internal test error: %s\n", strerror(ENOMEM)); /* $covered$ */
+	}
+
+	if (keylen > 32)
+		ERROR("Internal test error: corrupted test at line %zu in file %s, key is too long\n", test_lineno, path); /* $covered$ */
+
+	memset(*out, 0xCC, *outsize);
+	libblake_blake2s(*out, *outlen, *msg, msglen, *key, keylen);
+}
+
+static void
+hash_blake2b_oneshot(unsigned char **msg, size_t msglen, size_t *msgsize,
+                     unsigned char **key, size_t keylen, size_t *keysize,
+                     size_t hashlen,
+                     unsigned char **out, size_t *outlen, size_t *outsize,
+                     size_t testno, size_t test_lineno, const char *path)
+{
+	*outlen = hashlen;
+	if (*outlen > *outsize) {
+		*out = realloc(*out, *outsize = *outlen);
+		if (!*out)
+			ERROR("Internal test error: %s\n", strerror(ENOMEM)); /* $covered$ */
+	}
+
+	if (keylen > 64)
+		ERROR("Internal test error: corrupted test at line %zu in file %s, key is too long\n", test_lineno, path); /* $covered$ */
+
+	memset(*out, 0xCC, *outsize);
+	libblake_blake2b(*out, *outlen, *msg, msglen, *key, keylen);
+}
+
+static void
+hash_blake2s_prekeyed(unsigned char **msg, size_t msglen, size_t *msgsize,
+                      unsigned char **key, size_t keylen, size_t *keysize,
+                      size_t hashlen,
+                      unsigned char **out, size_t *outlen, size_t *outsize,
+                      size_t testno, size_t test_lineno, const char *path)
+{
+	struct libblake_blake2s_params params;
+	struct libblake_blake2s_prekeyed prekeyed;
+	struct libblake_blake2s_state state;
+
+	memset(&params, 0, sizeof(params));
+	params.digest_len = (uint_least8_t)hashlen;
+	params.fanout = 1;
+	params.depth = 1;
+	params.key_len = (uint_least8_t)keylen;
+
+	*outlen = hashlen;
+	if (*outlen > *outsize) {
+		*out = realloc(*out, *outsize = *outlen);
+		if (!*out)
+			ERROR("Internal test error: %s\n", strerror(ENOMEM)); /* $covered$ */
+	}
+
+	if (keylen > 32)
+		ERROR("Internal test error: corrupted test at line %zu in file %s, key is too long\n", test_lineno, path); /* $covered$ */
+
+	libblake_blake2s_prekey(&prekeyed, &params, *key);
+
+	/* Use the state twice to check that it is reusable */
+	memset(*out, 0xCC, *outsize);
+	libblake_blake2s_prekeyed_digest(&prekeyed, *msg, msglen, 0, *outlen, *out);
+	memset(*out, 0xCC, *outsize);
+	if (msglen && (testno & 1)) {
+		libblake_blake2s_prekeyed_init(&state, &prekeyed);
+		libblake_blake2s_digest_const(&state, *msg, msglen, 0, *outlen, *out);
+	} else {
+		libblake_blake2s_prekeyed_digest(&prekeyed, *msg, msglen, 0, *outlen, *out);
+	}
+}
+
+static void
+hash_blake2b_prekeyed(unsigned char **msg, size_t msglen, size_t *msgsize,
+                      unsigned char **key, size_t keylen, size_t *keysize,
+                      size_t hashlen,
+                      unsigned char **out, size_t *outlen, size_t *outsize,
+                      size_t testno, size_t test_lineno, const char *path)
+{
+	struct libblake_blake2b_params params;
+	struct libblake_blake2b_prekeyed prekeyed;
+	struct libblake_blake2b_state state;
+
+	memset(&params, 0, sizeof(params));
+	params.digest_len = (uint_least8_t)hashlen;
+	params.fanout = 1;
+	params.depth = 1;
+	params.key_len = (uint_least8_t)keylen;
+
+	*outlen = hashlen;
+	if (*outlen > *outsize) {
+		*out = realloc(*out, *outsize = *outlen);
+		if (!*out)
+			ERROR("Internal test error: %s\n", strerror(ENOMEM)); /* $covered$ */
+	}
+
+	if (keylen > 64)
+		ERROR("Internal test error: corrupted test at line %zu in file %s, key is too long\n", test_lineno, path); /* $covered$ */
+
+	libblake_blake2b_prekey(&prekeyed, &params, *key);
+
+	/* Use the state twice to check that it is reusable */
+	memset(*out, 0xCC, *outsize);
+	libblake_blake2b_prekeyed_digest(&prekeyed, *msg, msglen, 0, *outlen, *out);
+	memset(*out, 0xCC, *outsize);
+	if (msglen && (testno & 1)) {
+		libblake_blake2b_prekeyed_init(&state, &prekeyed);
+		libblake_blake2b_digest_const(&state, *msg, msglen, 0, *outlen, *out);
+	} else {
+		libblake_blake2b_prekeyed_digest(&prekeyed, *msg, msglen, 0, *outlen, *out);
+	}
+}
+
+static int
+check_blake2s_verify_batch(void)
+{
+	static unsigned char msgbuf[37 * 300];
+	struct libblake_blake2s_params params;
+	struct libblake_blake2s_prekeyed prekeyed;
+	unsigned char key[32], tagbuf[37][32], bitmap[(37 + 7) / 8];
+	const void *messages[37], *tags[37];
+	size_t lens[37], i, passed, expected;
+	int failed = 0;
+	unsigned int key_len;
+
+	fill_pattern(msgbuf, sizeof(msgbuf), 3);
+	fill_pattern(key, sizeof(key), 4);
+
+	for (key_len = 0; key_len <= 32; key_len += 32) {
+		memset(&params, 0, sizeof(params));
+		params.digest_len = (uint_least8_t)(key_len ? 32 : 20);
+		params.fanout = 1;
+		params.depth = 1;
+		params.key_len = (uint_least8_t)key_len;
+		libblake_blake2s_prekey(&prekeyed, &params, key);
+
+		expected = 0;
+		for (i = 0; i < 37; i++) {
+			lens[i] = i * 8 % 300;
+			messages[i] = lens[i] ? &msgbuf[i * 300] : NULL;
+			libblake_blake2s_prekeyed_digest(&prekeyed, messages[i], lens[i], 0, params.digest_len, tagbuf[i]);
+			if (i % 5 == 2)
+				tagbuf[i][i % params.digest_len] ^= 0x10;
+			else
+				expected += 1;
+			tags[i] = tagbuf[i];
+		}
+
+		memset(bitmap, 0xAA, sizeof(bitmap));
+		passed = libblake_blake2s_prekeyed_verify_batch(&prekeyed, 37, messages, lens, tags, params.digest_len, bitmap);
+		if (passed != expected) {
+			/* $covered{$ */
+			fprintf(stderr, "libblake_blake2s_prekeyed_verify_batch returned %zu, expected %zu\n", passed, expected);
+			failed = 1;
+			/* $covered}$ */
+		}
+		for (i = 0; i < 37; i++) {
+			if (((bitmap[i / 8] >> (i % 8)) & 1) != (i % 5 != 2)) {
+				/* $covered{$ */
+				fprintf(stderr, "libblake_blake2s_prekeyed_verify_batch gave wrong result for message %zu\n", i);
+				failed = 1;
+				/* $covered}$ */
+			}
+		}
+	}
+
+	return failed;
+}
+
+static int
+check_blake2_compact(void)
+{
+	static unsigned char msg[100 * 700];
+	unsigned char expected[64], result[64];
+	size_t off[100], len, i, n;
+	int failed = 0, round;
+
+	fill_pattern(msg, sizeof(msg), 5);
+
+#define CHECK(F, BS, OUTLEN)\
+	do {\
+		struct libblake_blake2##F##_params params;\
+		struct libblake_blake2##F##_state state;\
+		struct libblake_blake2##F##_compact_state compact;\
+		struct libblake_blake2##F##_table table;\
+		memset(&params, 0, sizeof(params));\
+		params.digest_len = OUTLEN;\
+		params.fanout = 1;\
+		params.depth = 1;\
+		if (libblake_blake2##F##_table_create(&table, 100))\
+			ERROR("libblake_blake2" #F "_table_create: %s\n", strerror(errno)); /* $covered$ */\
+		for (i = 0; i < 100; i++) {\
+			libblake_blake2##F##_init(&state, &params);\
+			libblake_blake2##F##_table_store(&table, i, &state);\
+			off[i] = 0;\
+		}\
+		/* Interleave the streams, as if the data was arriving over the network */\
+		for (round = 0; round < 8; round++) {\
+			for (i = 0; i < 100; i++) {\
+				len = i * 7;\
+				n = (size_t)round * 97 % 211;\
+				if (off[i] + n > len)\
+					n = len - off[i];\
+				off[i] += libblake_blake2##F##_table_update(&table, i, &msg[i * 700 + off[i]], n);\
+			}\
+		}\
+		for (i = 0; i < 100; i++) {\
+			len = i * 7;\
+			libblake_blake2##F(expected, OUTLEN, &msg[i * 700], len, NULL, 0);\
+			libblake_blake2##F##_table_load(&table, i, &state);\
+			libblake_blake2##F##_compact(&compact, &state);\
+			memset(&state, 0xAA, sizeof(state));\
+			libblake_blake2##F##_expand(&state, &compact);\
+			libblake_blake2##F##_digest_const(&state, &msg[i * 700 + off[i]], len - off[i], 0, OUTLEN, result);\
+			if (memcmp(result, expected, OUTLEN)) {\
+				/* $covered{$ */\
+				fprintf(stderr, "libblake_blake2" #F "_table_update failed for stream %zu\n", i);\
+				failed = 1;\
+				/* $covered}$ */\
+			}\
+		}\
+		libblake_blake2##F##_table_destroy(&table);\
+	} while (0)
+
+	CHECK(s, 64, 32);
+	CHECK(b, 128, 64);
+
+#undef CHECK
+
+#define CHECK(F, BS, OUTLEN)\
+	do {\
+		struct libblake_blake2x##F##_params params;\
+		struct libblake_blake2x##F##_state state1, state2;\
+		struct libblake_blake2x##F##_compact_state compact;\
+		memset(&params, 0, sizeof(params));\
+		params.digest_len = OUTLEN;\
+		params.fanout = 1;\
+		params.depth = 1;\
+		params.xof_len = 100;\
+		libblake_blake2x##F##_init(&state1, &params);\
+		n = libblake_blake2x##F##_update(&state1, msg, 5 * BS + 1);\
+		libblake_blake2x##F##_compact(&compact, &state1, &params);\
+		libblake_blake2x##F##_expand(&state2, &compact);\
+		libblake_blake2x##F##_predigest_const(&state1, &msg[n], 5 * BS + 1 - n, 0);\
+		libblake_blake2x##F##_predigest_const(&state2, &msg[n], 5 * BS + 1 - n, 0);\
+		for (i = 0; i * OUTLEN < 100; i++) {\
+			len = 100 - i * OUTLEN < OUTLEN ? 100 - i * OUTLEN : OUTLEN;\
+			libblake_blake2x##F##_digest(&state1, (uint_least32_t)i, len, expected);\
+			libblake_blake2x##F##_digest(&state2, (uint_least32_t)i, len, result);\
+			if (memcmp(result, expected, len)) {\
+				/* $covered{$ */\
+				fprintf(stderr, "libblake_blake2x" #F "_expand failed\n");\
+				failed = 1;\
+				/* $covered}$ */\
+			}\
+		}\
+	} while (0)
+
+	CHECK(s, 64, 32);
+	CHECK(b, 128, 64);
+
+#undef CHECK
+
+	return failed;
+}
+
+static int
+check_blake2_scheduler(void)
+{
+	static unsigned char msg[50 * 2000];
+	unsigned char expected[64], result[64];
+	size_t off[50], len, i, n;
+	int failed = 0, round, rep;
+
+	fill_pattern(msg, sizeof(msg), 6);
+
+#define CHECK(F, OUTLEN)\
+	do {\
+		struct libblake_blake2##F##_params params;\
+		struct libblake_blake2##F##_state state;\
+		struct libblake_blake2##F##_table table;\
+		struct libblake_blake2##F##_scheduler scheduler;\
+		memset(&params, 0, sizeof(params));\
+		params.digest_len = OUTLEN;\
+		params.fanout = 1;\
+		params.depth = 1;\
+		if (libblake_blake2##F##_table_create(&table, 50))\
+			ERROR("libblake_blake2" #F "_table_create: %s\n", strerror(errno)); /* $covered$ */\
+		if (libblake_blake2##F##_scheduler_create(&scheduler, &table, 16))\
+			ERROR("libblake_blake2" #F "_scheduler_create: %s\n", strerror(errno)); /* $covered$ */\
+		for (i = 0; i < 50; i++) {\
+			libblake_blake2##F##_init(&state, &params);\
+			libblake_blake2##F##_table_store(&table, i, &state);\
+			off[i] = 0;\
+		}\
+		for (round = 0; round < 6; round++) {\
+			for (i = 0; i < 50; i++) {\
+				/* Some streams are queued more than once per run */\
+				for (rep = 0; rep < 1 + (int)(i % 3); rep++) {\
+					len = i * 37 + 1;\
+					n = (size_t)(round + rep) * 131 % 400;\
+					if (off[i] + n > len)\
+						n = len - off[i];\
+					off[i] += libblake_blake2##F##_scheduler_enqueue(&scheduler, i, &msg[i * 2000 + off[i]], n);\
+				}\
+			}\
+			libblake_blake2##F##_scheduler_run(&scheduler);\
+		}\
+		for (i = 0; i < 50; i++) {\
+			len = i * 37 + 1;\
+			libblake_blake2##F(expected, OUTLEN, &msg[i * 2000], len, NULL, 0);\
+			libblake_blake2##F##_table_load(&table, i, &state);\
+			libblake_blake2##F##_digest_const(&state, &msg[i * 2000 + off[i]], len - off[i], 0, OUTLEN, result);\
+			if (memcmp(result, expected, OUTLEN)) {\
+				/* $covered{$ */\
+				fprintf(stderr, "libblake_blake2" #F "_scheduler_run failed for stream %zu\n", i);\
+				failed = 1;\
+				/* $covered}$ */\
+			}\
+		}\
+		libblake_blake2##F##_scheduler_destroy(&scheduler);\
+		libblake_blake2##F##_table_destroy(&table);\
+	} while (0)
+
+	CHECK(s, 32);
+	CHECK(b, 64);
+
+#undef CHECK
+
+	return failed;
+}
+
+static int
+check_state_export(void)
+{
+	static unsigned char msg[1000];
+	unsigned char expected[128], result[128], buf[512];
+	size_t len, cut, n, i;
+	int failed = 0;
+
+	fill_pattern(msg, sizeof(msg), 7);
+
+#define CHECK_IMPORT(NAME, VAR, RESUMED)\
+	do {\
+		n = libblake_##NAME##_export(&VAR, NULL, 0);\
+		if (n > sizeof(buf) || libblake_##NAME##_export(&VAR, buf, sizeof(buf)) != n)\
+			ERROR("libblake_" #NAME "_export returned inconsistent sizes\n"); /* $covered$ */\
+		memset(&RESUMED, 0xAA, sizeof(RESUMED));\
+		if (libblake_##NAME##_import(&RESUMED, buf, n))\
+			ERROR("libblake_" #NAME "_import: %s\n", strerror(errno)); /* $covered$ */\
+		buf[2] ^= 0x40;\
+		errno = 0;\
+		if (!libblake_##NAME##_import(&RESUMED, buf, n) || errno != EINVAL) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_" #NAME "_import accepted an unsupported version\n");\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+		buf[2] ^= 0x40;\
+		errno = 0;\
+		if (!libblake_##NAME##_import(&RESUMED, buf, n - 1) || errno != EINVAL) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_" #NAME "_import accepted truncated input\n");\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+	} while (0)
+
+#define CHECK_RESULT(NAME, OUTLEN)\
+	do {\
+		if (memcmp(result, expected, OUTLEN)) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_" NAME " failed to resume after %zu of %zu bytes\n", cut, len);\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+	} while (0)
+
+#define CHECK_BLAKE1(BITS)\
+	do {\
+		struct libblake_blake##BITS##_stream st, st2;\
+		struct libblake_blake##BITS##_state s, s2;\
+		libblake_blake##BITS##_stream_init(&st);\
+		libblake_blake##BITS##_stream_update(&st, msg, cut);\
+		CHECK_IMPORT(blake##BITS##_stream, st, st2);\
+		libblake_blake##BITS##_stream_digest(&st, &msg[cut], len - cut, 0, NULL, expected);\
+		libblake_blake##BITS##_stream_digest(&st2, &msg[cut], len - cut, 0, NULL, result);\
+		CHECK_RESULT("blake" #BITS "_stream_import", LIBBLAKE_BLAKE##BITS##_OUTPUT_SIZE);\
+		libblake_blake##BITS##_init(&s);\
+		libblake_blake##BITS##_update(&s, msg, cut);\
+		CHECK_IMPORT(blake##BITS, s, s2);\
+		if (libblake_blake##BITS##_export(&s2, result, sizeof(result)) != n || memcmp(result, buf, n)) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_blake%i_import did not restore the state\n", BITS);\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+	} while (0)
+
+#define CHECK_BLAKE2(F, OUTLEN)\
+	do {\
+		struct libblake_blake2##F##_params params;\
+		struct libblake_blake2##F##_stream st, st2;\
+		struct libblake_blake2##F##_state s, s2;\
+		memset(&params, 0, sizeof(params));\
+		params.digest_len = OUTLEN;\
+		params.fanout = 1;\
+		params.depth = 1;\
+		params.salt[1] = 0x5A;\
+		libblake_blake2##F##_stream_init(&st, &params);\
+		libblake_blake2##F##_stream_update(&st, msg, cut);\
+		CHECK_IMPORT(blake2##F##_stream, st, st2);\
+		libblake_blake2##F##_stream_digest(&st, &msg[cut], len - cut, 0, OUTLEN, expected);\
+		libblake_blake2##F##_stream_digest(&st2, &msg[cut], len - cut, 0, OUTLEN, result);\
+		CHECK_RESULT("blake2" #F "_stream_import", OUTLEN);\
+		libblake_blake2##F##_init(&s, &params);\
+		i = libblake_blake2##F##_update(&s, msg, cut);\
+		CHECK_IMPORT(blake2##F, s, s2);\
+		libblake_blake2##F##_digest_const(&s2, &msg[i], len - i, 0, OUTLEN, result);\
+		CHECK_RESULT("blake2" #F "_import", OUTLEN);\
+	} while (0)
+
+#define CHECK_BLAKE2X(F, OUTLEN, XOFLEN)\
+	do {\
+		struct libblake_blake2x##F##_params params;\
+		struct libblake_blake2x##F##_stream st, st2;\
+		memset(&params, 0, sizeof(params));\
+		params.digest_len = OUTLEN;\
+		params.fanout = 1;\
+		params.depth = 1;\
+		params.xof_len = XOFLEN;\
+		params.pepper[3] = 0xA5;\
+		libblake_blake2x##F##_stream_init(&st, &params);\
+		libblake_blake2x##F##_stream_update(&st, msg, cut);\
+		CHECK_IMPORT(blake2x##F##_stream, st, st2);\
+		libblake_blake2x##F##_stream_predigest(&st, &msg[cut], len - cut, 0);\
+		libblake_blake2x##F##_stream_predigest(&st2, &msg[cut], len - cut, 0);\
+		libblake_blake2x##F##_stream_digest(&st, 1, OUTLEN, expected);\
+		libblake_blake2x##F##_stream_digest(&st2, 1, OUTLEN, result);\
+		CHECK_RESULT("blake2x" #F "_stream_import", OUTLEN);\
+		/* Resuming between output blocks must also work */\
+		CHECK_IMPORT(blake2x##F##_stream, st, st2);\
+		libblake_blake2x##F##_stream_digest(&st2, 1, OUTLEN, result);\
+		CHECK_RESULT("blake2x" #F "_stream_import", OUTLEN);\
+	} while (0)
+
+	for (len = 0; len < sizeof(msg); len += len < 300 ? 13 : 97) {
+		for (cut = 0; cut <= len; cut += cut < 140 ? 1 : 61) {
+			CHECK_BLAKE1(224);
+			CHECK_BLAKE1(256);
+			CHECK_BLAKE1(384);
+			CHECK_BLAKE1(512);
+			CHECK_BLAKE2(s, 32);
+			CHECK_BLAKE2(b, 64);
+			CHECK_BLAKE2X(s, 32, 1000);
+			CHECK_BLAKE2X(b, 64, 1000);
+		}
+	}
+
+#undef CHECK_IMPORT
+#undef CHECK_RESULT
+#undef CHECK_BLAKE1
+#undef CHECK_BLAKE2
+#undef CHECK_BLAKE2X
+
+	return failed;
+}
+
+static int
+check_stream_peek(void)
+{
+	static unsigned char msg[1000];
+	unsigned char expected[128], result[128];
+	size_t off, n, k;
+	int failed = 0;
+
+	fill_pattern(msg, sizeof(msg), 8);
+
+#define CHECK_RESULT(NAME, STREAM, SAVED, OUTLEN)\
+	do {\
+		if (memcmp(result, expected, OUTLEN)) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_" NAME "_stream_peek failed after %zu bytes\n", off);\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+		if (memcmp(&STREAM, &SAVED, sizeof(STREAM))) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_" NAME "_stream_peek modified the stream after %zu bytes\n", off);\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+	} while (0)
+
+#define CHECK_BLAKE1(BITS)\
+	do {\
+		struct libblake_blake##BITS##_stream st, saved;\
+		memset(&st, 0, sizeof(st));\
+		libblake_blake##BITS##_stream_init(&st);\
+		for (off = 0, k = 0; off < sizeof(msg); off += n) {\
+			saved = st;\
+			libblake_blake##BITS##_stream_digest(&saved, NULL, 0, 0, NULL, expected);\
+			saved = st;\
+			libblake_blake##BITS##_stream_peek(&st, result);\
+			CHECK_RESULT("blake" #BITS, st, saved, LIBBLAKE_BLAKE##BITS##_OUTPUT_SIZE);\
+			n = next_chunk_size(&k) % 97 + 1;\
+			if (n > sizeof(msg) - off)\
+				n = sizeof(msg) - off;\
+			libblake_blake##BITS##_stream_update(&st, &msg[off], n);\
+		}\
+	} while (0)
+
+#define CHECK_BLAKE2(F, OUTLEN)\
+	do {\
+		struct libblake_blake2##F##_params params;\
+		struct libblake_blake2##F##_stream st, saved;\
+		memset(&params, 0, sizeof(params));\
+		params.digest_len = OUTLEN;\
+		params.fanout = 1;\
+		params.depth = 1;\
+		memset(&st, 0, sizeof(st));\
+		libblake_blake2##F##_stream_init(&st, &params);\
+		for (off = 0, k = 0; off < sizeof(msg); off += n) {\
+			saved = st;\
+			libblake_blake2##F##_stream_digest(&saved, NULL, 0, 0, OUTLEN, expected);\
+			saved = st;\
+			libblake_blake2##F##_stream_peek(&st, 0, OUTLEN, result);\
+			CHECK_RESULT("blake2" #F, st, saved, OUTLEN);\
+			n = next_chunk_size(&k) % 97 + 1;\
+			if (n > sizeof(msg) - off)\
+				n = sizeof(msg) - off;\
+			libblake_blake2##F##_stream_update(&st, &msg[off], n);\
+		}\
+	} while (0)
+
+#define CHECK_BLAKE2X(F, OUTLEN)\
+	do {\
+		struct libblake_blake2x##F##_params params;\
+		struct libblake_blake2x##F##_stream st, saved;\
+		struct libblake_blake2x##F##_state snapshot;\
+		memset(&params, 0, sizeof(params));\
+		params.digest_len = OUTLEN;\
+		params.fanout = 1;\
+		params.depth = 1;\
+		params.xof_len = 3 * OUTLEN;\
+		memset(&st, 0, sizeof(st));\
+		libblake_blake2x##F##_stream_init(&st, &params);\
+		for (off = 0, k = 0; off < sizeof(msg); off += n) {\
+			saved = st;\
+			libblake_blake2x##F##_stream_predigest(&saved, NULL, 0, 0);\
+			libblake_blake2x##F##_stream_digest(&saved, 2, OUTLEN, expected);\
+			saved = st;\
+			libblake_blake2x##F##_stream_peek(&st, 0, &snapshot);\
+			libblake_blake2x##F##_digest(&snapshot, 2, OUTLEN, result);\
+			CHECK_RESULT("blake2x" #F, st, saved, OUTLEN);\
+			n = next_chunk_size(&k) % 97 + 1;\
+			if (n > sizeof(msg) - off)\
+				n = sizeof(msg) - off;\
+			libblake_blake2x##F##_stream_update(&st, &msg[off], n);\
+		}\
+	} while (0)
+
+	CHECK_BLAKE1(224);
+	CHECK_BLAKE1(256);
+	CHECK_BLAKE1(384);
+	CHECK_BLAKE1(512);
+	CHECK_BLAKE2(s, 32);
+	CHECK_BLAKE2(b, 64);
+	CHECK_BLAKE2X(s, 32);
+	CHECK_BLAKE2X(b, 64);
+
+#undef CHECK_RESULT
+#undef CHECK_BLAKE1
+#undef CHECK_BLAKE2
+#undef CHECK_BLAKE2X
+
+	return failed;
+}
+
+static int
+check_blake2_checkpoints(void)
+{
+	static unsigned char input[128 + 5000];
+	unsigned char expected[64], result[64], key[64], *buf, *msg;
+	size_t off, n, k, len, size, total, key_off;
+	int failed = 0;
+
+	fill_pattern(key, sizeof(key), 10);
+
+	/* A key is fed as the first block of the input */
+#define CHECK(F, OUTLEN, BLOCK, INTERVAL, KEY_LEN)\
+	do {\
+		struct libblake_blake2##F##_params params;\
+		struct libblake_blake2##F##_state state;\
+		struct libblake_blake2##F##_prekeyed prekeyed;\
+		struct libblake_blake2##F##_checkpoints index, index2;\
+		memset(&params, 0, sizeof(params));\
+		params.digest_len = OUTLEN;\
+		params.key_len = KEY_LEN;\
+		params.fanout = 1;\
+		params.depth = 1;\
+		key_off = KEY_LEN ? BLOCK : 0;\
+		memset(input, 0, key_off);\
+		memcpy(input, key, KEY_LEN);\
+		msg = &input[key_off];\
+		fill_pattern(msg, 5000, 9);\
+		total = key_off + 5000;\
+		libblake_blake2##F##_init(&state, &params);\
+		if (libblake_blake2##F##_checkpoints_create(&index, &state, INTERVAL))\
+			ERROR("libblake_blake2" #F "_checkpoints_create: %s\n", strerror(errno)); /* $covered$ */\
+		for (off = 0, k = 0; off < total; off += n) {\
+			len = next_chunk_size(&k);\
+			if (len > total - off)\
+				len = total - off;\
+			if (libblake_blake2##F##_checkpoints_update(&index, &state, &input[off], len, &n))\
+				ERROR("libblake_blake2" #F "_checkpoints_update: %s\n", strerror(errno)); /* $covered$ */\
+			if (!n && len == total - off)\
+				break;\
+		}\
+		size = libblake_blake2##F##_checkpoints_export(&index, NULL, 0);\
+		buf = malloc(size);\
+		if (!buf)\
+			ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */\
+		if (libblake_blake2##F##_checkpoints_export(&index, buf, size) != size)\
+			ERROR("libblake_blake2" #F "_checkpoints_export returned inconsistent sizes\n"); /* $covered$ */\
+		buf[3] ^= 1;\
+		errno = 0;\
+		if (!libblake_blake2##F##_checkpoints_import(&index2, buf, size) || errno != EINVAL) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_blake2" #F "_checkpoints_import accepted the wrong algorithm\n");\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+		buf[3] ^= 1;\
+		if (libblake_blake2##F##_checkpoints_import(&index2, buf, size))\
+			ERROR("libblake_blake2" #F "_checkpoints_import: %s\n", strerror(errno)); /* $covered$ */\
+		free(buf);\
+		for (len = 0; len <= 5000; len += len < 600 ? 1 : 53) {\
+			libblake_blake2##F(expected, OUTLEN, msg, len, key, KEY_LEN);\
+			libblake_blake2##F##_checkpoints_digest(&index, input, key_off + len, 0, OUTLEN, result);\
+			if (memcmp(result, expected, OUTLEN)) {\
+				/* $covered{$ */\
+				fprintf(stderr, "libblake_blake2" #F "_checkpoints_digest failed for %zu bytes (key length: %i)\n",\
+				        len, KEY_LEN);\
+				failed = 1;\
+				/* $covered}$ */\
+			}\
+			libblake_blake2##F##_checkpoints_digest(&index2, input, key_off + len, 0, OUTLEN, result);\
+			if (memcmp(result, expected, OUTLEN)) {\
+				/* $covered{$ */\
+				fprintf(stderr, "libblake_blake2" #F "_checkpoints_import failed for %zu bytes\n", len);\
+				failed = 1;\
+				/* $covered}$ */\
+			}\
+			if (key_off + len - libblake_blake2##F##_checkpoints_seek(&index, key_off + len, &state) > INTERVAL * BLOCK) {\
+				/* $covered{$ */\
+				fprintf(stderr, "libblake_blake2" #F "_checkpoints_seek did not use the closest state for %zu bytes\n", len);\
+				failed = 1;\
+				/* $covered}$ */\
+			}\
+		}\
+		libblake_blake2##F##_checkpoints_destroy(&index);\
+		libblake_blake2##F##_checkpoints_destroy(&index2);\
+		/* The offsets are counted from the start of the
+		 * hashing, so states that have already processed
+		 * data, such as a prekeyed state, are rejected */\
+		if (KEY_LEN) {\
+			libblake_blake2##F##_prekey(&prekeyed, &params, key);\
+			libblake_blake2##F##_prekeyed_init(&state, &prekeyed);\
+			errno = 0;\
+			if (!libblake_blake2##F##_checkpoints_create(&index, &state, INTERVAL) || errno != EINVAL) {\
+				/* $covered{$ */\
+				fprintf(stderr, "libblake_blake2" #F "_checkpoints_create accepted a prekeyed state\n");\
+				failed = 1;\
+				/* $covered}$ */\
+			}\
+		}\
+	} while (0)
+
+	CHECK(s, 32, 64, 1, 0);
+	CHECK(s, 32, 64, 3, 0);
+	CHECK(s, 32, 64, 3, 17);
+	CHECK(b, 64, 128, 1, 0);
+	CHECK(b, 64, 128, 5, 0);
+	CHECK(b, 64, 128, 5, 17);
+
+#undef CHECK
+
+	return failed;
+}
+
+static unsigned char update_fd_msg[(1 << 20) + 3 * 4096 + 777];
+
+static int
+open_update_fd_input(int use_pipe, int filefd, size_t off, size_t len)
+{
+	int fds[2];
+	if (!use_pipe) {
+		if (lseek(filefd, (off_t)off, SEEK_SET) < 0)
+			ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+		return filefd;
+	}
+	if (pipe(fds))
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	if (len > 60000) {
+		/* Too large for the pipe's buffer, so the data is written by another process */
+		switch (fork()) {
+		case -1:
+			ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+		case 0:
+			close(fds[0]);
+			while (len) {
+				ssize_t r = write(fds[1], &update_fd_msg[off], len < 5000 ? len : 5000);
+				if (r <= 0)
+					_exit(1); /* $covered$ */
+				off += (size_t)r;
+				len -= (size_t)r;
+			}
+			_exit(0);
+		default:
+			break;
+		}
+	} else if (len && write(fds[1], &update_fd_msg[off], len) != (ssize_t)len) {
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	}
+	close(fds[1]);
+	return fds[0];
+}
+
+static int
+check_stream_update_fd(void)
+{
+	static const size_t file_offsets[] = {0, 5000, sizeof(update_fd_msg) - 1000, sizeof(update_fd_msg)};
+	static const size_t pipe_lengths[] = {0, 1000, 60000, sizeof(update_fd_msg)};
+	unsigned char *msg = update_fd_msg;
+	unsigned char expected[64], result[64];
+	char path[] = "/tmp/libblake-test-XXXXXX";
+	struct libblake_blake2b_params params2b;
+	struct libblake_blake2xs_params params2xs;
+	size_t i, off, len, n;
+	int filefd, fd, use_pipe, status, failed = 0;
+	ssize_t r;
+
+	fill_pattern(msg, sizeof(update_fd_msg), 10);
+	memset(&params2b, 0, sizeof(params2b));
+	params2b.digest_len = 64;
+	params2b.fanout = 1;
+	params2b.depth = 1;
+	memset(&params2xs, 0, sizeof(params2xs));
+	params2xs.digest_len = 32;
+	params2xs.fanout = 1;
+	params2xs.depth = 1;
+	params2xs.xof_len = 32;
+	filefd = mkstemp(path);
+	if (filefd < 0)
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	for (off = 0; off < sizeof(update_fd_msg); off += (size_t)r) {
+		r = write(filefd, &msg[off], sizeof(update_fd_msg) - off);
+		if (r <= 0)
+			ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	}
+
+#define DIGEST_BLAKE256(OUT)\
+	libblake_blake256_stream_digest(&stream, NULL, 0, 0, NULL, OUT)
+#define DIGEST_BLAKE2B(OUT)\
+	libblake_blake2b_stream_digest(&stream, NULL, 0, 0, 64, OUT)
+#define DIGEST_BLAKE2XS(OUT)\
+	(libblake_blake2xs_stream_predigest(&stream, NULL, 0, 0), libblake_blake2xs_stream_digest(&stream, 0, 32, OUT))
+
+#define CHECK(ALG, INIT, DIGEST, OUTLEN, HOW, SOURCE)\
+	do {\
+		struct libblake_##ALG##_stream stream;\
+		INIT;\
+		libblake_##ALG##_stream_update(&stream, &msg[off], len);\
+		DIGEST(expected);\
+		INIT;\
+		if (libblake_##ALG##_stream_update_##HOW(&stream, SOURCE))\
+			ERROR("libblake_" #ALG "_stream_update_" #HOW ": %s\n", strerror(errno)); /* $covered$ */\
+		DIGEST(result);\
+		if (memcmp(result, expected, OUTLEN)) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_" #ALG "_stream_update_" #HOW " failed for %zu bytes from offset %zu%s\n",\
+			        len, off, use_pipe ? " of a pipe" : "");\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+	} while (0)
+
+#define CHECK_FD(ALG, INIT, DIGEST, OUTLEN)\
+	do {\
+		fd = open_update_fd_input(use_pipe, filefd, off, len);\
+		CHECK(ALG, INIT, DIGEST, OUTLEN, fd, fd);\
+		if (use_pipe) {\
+			close(fd);\
+			if (len > 60000 && (wait(&status) < 0 || status))\
+				ERROR("Internal test error: writer failed\n"); /* $covered$ */\
+		}\
+	} while (0)
+
+	n = sizeof(file_offsets) / sizeof(*file_offsets) + sizeof(pipe_lengths) / sizeof(*pipe_lengths);
+	for (i = 0; i < n; i++) {
+		use_pipe = i >= sizeof(file_offsets) / sizeof(*file_offsets);
+		if (use_pipe) {
+			off = 0;
+			len = pipe_lengths[i - sizeof(file_offsets) / sizeof(*file_offsets)];
+		} else {
+			off = file_offsets[i];
+			len = sizeof(update_fd_msg) - off;
+		}
+		CHECK_FD(blake256, libblake_blake256_stream_init(&stream), DIGEST_BLAKE256, 32);
+		CHECK_FD(blake2b, libblake_blake2b_stream_init(&stream, &params2b), DIGEST_BLAKE2B, 64);
+		CHECK_FD(blake2xs, libblake_blake2xs_stream_init(&stream, &params2xs), DIGEST_BLAKE2XS, 32);
+	}
+
+	use_pipe = 0;
+	off = 0;
+	len = sizeof(update_fd_msg);
+	CHECK(blake2b, libblake_blake2b_stream_init(&stream, &params2b), DIGEST_BLAKE2B, 64, path, path);
+
+#if defined(MFD_ALLOW_SEALING) && defined(F_SEAL_SHRINK)
+	/* Only files that cannot be truncated while they are hashed are mapped into memory */
+	fd = memfd_create("libblake-test", MFD_ALLOW_SEALING);
+	if (fd < 0 || pwrite(fd, msg, len, 0) != (ssize_t)len || fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK))
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	CHECK(blake2b, libblake_blake2b_stream_init(&stream, &params2b), DIGEST_BLAKE2B, 64, fd, fd);
+	close(fd);
+#endif
+
+	errno = 0;
+	if (!libblake_blake2b_stream_update_path(NULL, "/nonexistent/libblake-test") || errno != ENOENT) {
+		/* $covered{$ */
+		fprintf(stderr, "libblake_blake2b_stream_update_path did not fail with ENOENT\n");
+		failed = 1;
+		/* $covered}$ */
+	}
+
+#undef DIGEST_BLAKE256
+#undef DIGEST_BLAKE2B
+#undef DIGEST_BLAKE2XS
+#undef CHECK
+#undef CHECK_FD
+
+	close(filefd);
+	unlink(path);
+	return failed;
+}
+
+static int
+check_stream_update_sparse(void)
+{
+	/* Data at [0x3000, 0x3100), [0x200000, 0x380000), [0x500000, 0x500001) */
+	static unsigned char msg[(size_t)0x700000];
+	static const size_t segments[][2] = {{0x3000, 0x100}, {0x200000, 0x180000}, {0x500000, 1}};
+	static const size_t offsets[] = {0, 0x2000, 0x3010, 0x250000, 0x600000};
+	struct libblake_blake2b_params params;
+	struct libblake_blake2b_stream stream;
+	unsigned char expected[64], result[64];
+	char path[] = "/tmp/libblake-test-XXXXXX";
+	size_t i, off;
+	int fd, failed = 0;
+
+	memset(&params, 0, sizeof(params));
+	params.digest_len = 64;
+	params.fanout = 1;
+	params.depth = 1;
+
+	fd = mkstemp(path);
+	if (fd < 0)
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	unlink(path);
+	if (ftruncate(fd, (off_t)sizeof(msg)))
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	for (i = 0; i < sizeof(segments) / sizeof(*segments); i++) {
+		fill_pattern(&msg[segments[i][0]], segments[i][1], (unsigned int)i + 12);
+		if (pwrite(fd, &msg[segments[i][0]], segments[i][1], (off_t)segments[i][0]) != (ssize_t)segments[i][1])
+			ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	}
+
+	for (i = 0; i < sizeof(offsets) / sizeof(*offsets); i++) {
+		off = offsets[i];
+		libblake_blake2b_stream_init(&stream, &params);
+		libblake_blake2b_stream_update(&stream, &msg[off], sizeof(msg) - off);
+		libblake_blake2b_stream_digest(&stream, NULL, 0, 0, 64, expected);
+		libblake_blake2b_stream_init(&stream, &params);
+		if (lseek(fd, (off_t)off, SEEK_SET) < 0)
+			ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+		if (libblake_blake2b_stream_update_fd(&stream, fd))
+			ERROR("libblake_blake2b_stream_update_fd: %s\n", strerror(errno)); /* $covered$ */
+		libblake_blake2b_stream_digest(&stream, NULL, 0, 0, 64, result);
+		if (memcmp(result, expected, 64)) {
+			/* $covered{$ */
+			fprintf(stderr, "libblake_blake2b_stream_update_fd failed for sparse file from offset %zu\n", off);
+			failed = 1;
+			/* $covered}$ */
+		}
+		if (lseek(fd, 0, SEEK_CUR) != (off_t)sizeof(msg)) {
+			/* $covered{$ */
+			fprintf(stderr, "libblake_blake2b_stream_update_fd did not leave the offset at the end of the file\n");
+			failed = 1;
+			/* $covered}$ */
+		}
+	}
+
+	close(fd);
+	return failed;
+}
+
+/* Not public, but linked in statically, so that the file
+ * can be truncated at an exact point while it is hashed */
+int libblake_internal_update_fd(int fd, void (*update)(void *stream, const void *data, size_t len), void *stream);
+
+struct truncating_update {
+	int fd;
+	size_t calls;
+	size_t truncate_at_call;
+	off_t truncate_to;
+};
+
+static void
+truncating_update(void *stream, const void *data, size_t len)
+{
+	struct truncating_update *t = stream;
+	(void) data;
+	(void) len;
+	if (++t->calls == t->truncate_at_call && ftruncate(t->fd, t->truncate_to))
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+}
+
+static int
+check_update_fd_truncated(void)
+{
+	/* Data at [0x10000, 0x50000), in two reads, between holes; the first
+	 * truncation is found when the data is read, the second when the file
+	 * seems to end with a hole */
+	static const struct { size_t call; off_t size; } truncations[] = {{2, 0x30000}, {3, 0x50000}};
+	static unsigned char data[0x40000];
+	struct truncating_update t;
+	char path[] = "/tmp/libblake-test-XXXXXX";
+	size_t i;
+	int failed = 0;
+
+	fill_pattern(data, sizeof(data), 14);
+
+	for (i = 0; i < sizeof(truncations) / sizeof(*truncations); i++) {
+		t.fd = mkstemp(path);
+		if (t.fd < 0)
+			ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+		unlink(path);
+		memcpy(&path[sizeof(path) - 7], "XXXXXX", 6);
+		if (ftruncate(t.fd, 0x200000) ||
+		    pwrite(t.fd, data, sizeof(data), 0x10000) != (ssize_t)sizeof(data))
+			ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+		if (lseek(t.fd, 0, SEEK_HOLE) != 0) {
+			/* $covered{$ */
+			close(t.fd);
+			return 0; /* The file system does not report holes */
+			/* $covered}$ */
+		}
+		if (lseek(t.fd, 0, SEEK_SET))
+			ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+		t.calls = 0;
+		t.truncate_at_call = truncations[i].call;
+		t.truncate_to = truncations[i].size;
+		errno = 0;
+		if (!libblake_internal_update_fd(t.fd, &truncating_update, &t) || errno != EIO) {
+			/* $covered{$ */
+			fprintf(stderr, "libblake_internal_update_fd did not fail with EIO when the "
+			                "file was truncated to %lli bytes\n", (long long int)t.truncate_to);
+			failed = 1;
+			/* $covered}$ */
+		}
+		close(t.fd);
+	}
+
+	return failed;
+}
+
+#define HASH_FILES_COUNT 150
+
+struct hash_files_result {
+	unsigned char digest[64];
+	size_t digest_len;
+	int error;
+	int called;
+	int failed;
+};
+
+static void
+hash_files_callback(void *user, size_t i, const unsigned char *digest, int error)
+{
+	struct hash_files_result *results = user;
+	if (results[i].called++)
+		results[i].failed = 1; /* $covered$ */
+	results[i].error = error;
+	if (digest)
+		memcpy(results[i].digest, digest, results[i].digest_len);
+}
+
+static size_t
+hash_files_size(size_t i)
+{
+	return i == 7 ? ((size_t)1 << 20) + 300 : i * i * 37 % 9000;
+}
+
+static int
+check_blake2_hash_files(void)
+{
+	static unsigned char data[((size_t)1 << 20) + 300];
+	static struct hash_files_result results[HASH_FILES_COUNT];
+	static char pathbufs[HASH_FILES_COUNT][64];
+	const char *paths[HASH_FILES_COUNT];
+	unsigned char expected[64], key[64];
+	char dir[] = "/tmp/libblake-test-XXXXXX";
+	size_t i, n, off;
+	int fd, flags, keyed, failed = 0;
+	ssize_t r;
+
+	if (!mkdtemp(dir))
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	fill_pattern(key, sizeof(key), 11);
+	for (i = 0; i < HASH_FILES_COUNT; i++) {
+		sprintf(pathbufs[i], "%s/%zu", dir, i);
+		paths[i] = pathbufs[i];
+		if (i == 5)
+			continue; /* Does not exist */
+		fd = open(paths[i], O_WRONLY | O_CREAT | O_EXCL, 0600);
+		if (fd < 0)
+			ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+		n = hash_files_size(i);
+		fill_pattern(data, n, (unsigned int)i);
+		for (off = 0; off < n; off += (size_t)r) {
+			r = write(fd, &data[off], n - off);
+			if (r <= 0)
+				ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+		}
+		close(fd);
+	}
+
+#define CHECK(F, OUTLEN)\
+	do {\
+		struct libblake_blake2##F##_params params;\
+		memset(&params, 0, sizeof(params));\
+		params.digest_len = OUTLEN;\
+		params.key_len = keyed ? 17 : 0;\
+		params.fanout = 1;\
+		params.depth = 1;\
+		memset(results, 0, sizeof(results));\
+		for (i = 0; i < HASH_FILES_COUNT; i++)\
+			results[i].digest_len = OUTLEN;\
+		if (libblake_blake2##F##_hash_files(paths, HASH_FILES_COUNT, &params, key, flags, &hash_files_callback, results))\
+			ERROR("libblake_blake2" #F "_hash_files: %s\n", strerror(errno)); /* $covered$ */\
+		for (i = 0; i < HASH_FILES_COUNT; i++) {\
+			n = hash_files_size(i);\
+			fill_pattern(data, n, (unsigned int)i);\
+			libblake_blake2##F(expected, OUTLEN, data, n, keyed ? key : NULL, keyed ? 17 : 0);\
+			if (results[i].failed || !results[i].called) {\
+				/* $covered{$ */\
+				fprintf(stderr, "libblake_blake2" #F "_hash_files called the callback %i times for file %zu\n",\
+				        results[i].called, i);\
+				failed = 1;\
+				/* $covered}$ */\
+			} else if (i == 5 ? results[i].error != ENOENT : results[i].error || memcmp(results[i].digest, expected, OUTLEN)) {\
+				/* $covered{$ */\
+				fprintf(stderr, "libblake_blake2" #F "_hash_files failed for %zu bytes (flags: %i, keyed: %i)\n",\
+				        n, flags, keyed);\
+				failed = 1;\
+				/* $covered}$ */\
+			}\
+		}\
+	} while (0)
+
+	for (flags = 0; flags <= LIBBLAKE_HASH_FILES_DIRECT; flags += LIBBLAKE_HASH_FILES_DIRECT) {
+		for (keyed = 0; keyed < 2; keyed++) {
+			CHECK(s, 32);
+			CHECK(b, 64);
+		}
+	}
+
+#undef CHECK
+
+	for (i = 0; i < HASH_FILES_COUNT; i++)
+		unlink(paths[i]);
+	rmdir(dir);
+	return failed;
+}
+
+static void
+write_test_file(const char *path, size_t len, unsigned int seed)
+{
+	static unsigned char data[((size_t)1 << 20) + 5];
+	size_t off;
+	ssize_t r;
+	int fd;
+
+	fd = open(path, O_WRONLY | O_CREAT | O_EXCL, 0600);
+	if (fd < 0)
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	fill_pattern(data, len, seed);
+	for (off = 0; off < len; off += (size_t)r) {
+		r = write(fd, &data[off], len - off);
+		if (r <= 0)
+			ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	}
+	close(fd);
+}
+
+static int
+check_blake2_hash_tree(void)
+{
+	static unsigned char data[((size_t)1 << 20) + 5];
+	static const size_t nthreads[] = {0, 1, 4};
+	unsigned char key[64], h_x[64], h_big[64], h_b[64], h_l[64], h_a[64], h_e[64], expected[64], result[64];
+	char dir[] = "/tmp/libblake-test-XXXXXX", path[256];
+	size_t i, block_size;
+	int keyed, failed = 0;
+
+	/* dir/a/x, dir/a/big, dir/b, dir/e/, dir/l -> b */
+	if (!mkdtemp(dir))
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	fill_pattern(key, sizeof(key), 21);
+	sprintf(path, "%s/a", dir);
+	if (mkdir(path, 0700))
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	sprintf(path, "%s/e", dir);
+	if (mkdir(path, 0700))
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	sprintf(path, "%s/a/x", dir);
+	write_test_file(path, 100, 22);
+	sprintf(path, "%s/a/big", dir);
+	write_test_file(path, sizeof(data), 23);
+	sprintf(path, "%s/b", dir);
+	write_test_file(path, 1000, 24);
+	sprintf(path, "%s/l", dir);
+	if (symlink("b", path))
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+
+#define HASH(F, DIRECTORY, OUTLEN, OUT, ...)\
+	do {\
+		struct libblake_blake2##F##_stream stream;\
+		const struct iovec iov[] = {__VA_ARGS__};\
+		size_t j;\
+		params.node_depth = DIRECTORY;\
+		libblake_blake2##F##_stream_init(&stream, &params);\
+		if (keyed) {\
+			unsigned char key_block[128];\
+			memset(key_block, 0, sizeof(key_block));\
+			memcpy(key_block, key, 17);\
+			libblake_blake2##F##_stream_update(&stream, key_block, block_size);\
+		}\
+		for (j = 0; j < sizeof(iov) / sizeof(*iov); j++)\
+			libblake_blake2##F##_stream_update(&stream, iov[j].iov_base, iov[j].iov_len);\
+		libblake_blake2##F##_stream_digest(&stream, NULL, 0, 0, OUTLEN, OUT);\
+	} while (0)
+
+#define ENTRY(TYPE_AND_NAME, DIGEST, OUTLEN)\
+	{(void *)TYPE_AND_NAME, sizeof(TYPE_AND_NAME)}, {DIGEST, OUTLEN}
+
+#define CHECK(F, OUTLEN, BLOCK_SIZE)\
+	do {\
+		struct libblake_blake2##F##_params params;\
+		memset(&params, 0, sizeof(params));\
+		params.digest_len = OUTLEN;\
+		params.key_len = keyed ? 17 : 0;\
+		params.fanout = 1;\
+		params.depth = 1;\
+		block_size = BLOCK_SIZE;\
+		fill_pattern(data, 100, 22);\
+		HASH(F, 0, OUTLEN, h_x, {data, 100});\
+		fill_pattern(data, sizeof(data), 23);\
+		HASH(F, 0, OUTLEN, h_big, {data, sizeof(data)});\
+		fill_pattern(data, 1000, 24);\
+		HASH(F, 0, OUTLEN, h_b, {data, 1000});\
+		HASH(F, 0, OUTLEN, h_l, {(void *)"b", 1});\
+		HASH(F, 1, OUTLEN, h_a, ENTRY("fbig", h_big, OUTLEN), ENTRY("fx", h_x, OUTLEN));\
+		HASH(F, 1, OUTLEN, h_e, {NULL, 0});\
+		HASH(F, 1, OUTLEN, expected, ENTRY("da", h_a, OUTLEN), ENTRY("fb", h_b, OUTLEN),\
+		                             ENTRY("de", h_e, OUTLEN), ENTRY("ll", h_l, OUTLEN));\
+		params.node_depth = 0;\
+		for (i = 0; i < sizeof(nthreads) / sizeof(*nthreads); i++) {\
+			memset(result, 0, sizeof(result));\
+			if (libblake_blake2##F##_hash_tree(dir, &params, key, NULL, nthreads[i], result))\
+				ERROR("libblake_blake2" #F "_hash_tree: %s\n", strerror(errno)); /* $covered$ */\
+			if (memcmp(result, expected, OUTLEN)) {\
+				/* $covered{$ */\
+				fprintf(stderr, "libblake_blake2" #F "_hash_tree failed with %zu threads (keyed: %i)\n",\
+				        nthreads[i], keyed);\
+				failed = 1;\
+				/* $covered}$ */\
+			}\
+		}\
+		sprintf(path, "%s/b", dir);\
+		if (libblake_blake2##F##_hash_tree(path, &params, key, NULL, 1, result) || memcmp(result, h_b, OUTLEN)) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_blake2" #F "_hash_tree failed for a file (keyed: %i)\n", keyed);\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+		sprintf(path, "%s/e/fifo", dir);\
+		if (mkfifo(path, 0600))\
+			ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */\
+		if (!libblake_blake2##F##_hash_tree(dir, &params, key, NULL, 4, result) || errno != EINVAL) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_blake2" #F "_hash_tree did not fail with EINVAL for a FIFO\n");\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+		unlink(path);\
+	} while (0)
+
+	for (keyed = 0; keyed < 2; keyed++) {
+		CHECK(s, 32, 64);
+		CHECK(b, 64, 128);
+	}
+
+#undef CHECK
+#undef ENTRY
+#undef HASH
+
+	sprintf(path, "%s/l", dir);
+	unlink(path);
+	sprintf(path, "%s/b", dir);
+	unlink(path);
+	sprintf(path, "%s/a/big", dir);
+	unlink(path);
+	sprintf(path, "%s/a/x", dir);
+	unlink(path);
+	sprintf(path, "%s/a", dir);
+	rmdir(path);
+	sprintf(path, "%s/e", dir);
+	rmdir(path);
+	rmdir(dir);
+	return failed;
+}
+
+#define DIGEST_CACHE_FILES 1000
+
+static int
+check_digest_cache(void)
+{
+	static char paths[DIGEST_CACHE_FILES][64];
+	struct libblake_blake2b_params params;
+	struct libblake_digest_cache cache;
+	unsigned char key[64], expected[64], result[64], uncached[64], data[1000];
+	char dir[] = "/tmp/libblake-test-XXXXXX", tree[64], cache_path[64], racy_path[64];
+	unsigned char *cache_data, *cached;
+	struct timespec times[2];
+	struct stat st;
+	size_t i, pass;
+	int keyed, fd, failed = 0;
+
+	if (!mkdtemp(dir))
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	sprintf(tree, "%s/tree", dir);
+	sprintf(cache_path, "%s/cache", dir);
+	if (mkdir(tree, 0700))
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	for (i = 0; i < DIGEST_CACHE_FILES; i++) {
+		sprintf(paths[i], "%s/%zu", tree, i);
+		write_test_file(paths[i], i % 300, (unsigned int)i);
+	}
+	fill_pattern(key, sizeof(key), 31);
+
+	memset(&params, 0, sizeof(params));
+	params.fanout = 1;
+	params.depth = 1;
+
+	/* Enough files are hashed for the cache to grow */
+	for (keyed = 0; keyed < 2; keyed++) {
+		params.key_len = keyed ? 17 : 0;
+		params.digest_len = 64;
+		if (libblake_blake2b_hash_tree(tree, &params, key, NULL, 4, expected))
+			ERROR("libblake_blake2b_hash_tree: %s\n", strerror(errno)); /* $covered$ */
+		for (pass = 0; pass < 2; pass++) {
+			if (libblake_digest_cache_open(&cache, cache_path))
+				ERROR("libblake_digest_cache_open: %s\n", strerror(errno)); /* $covered$ */
+			if (libblake_blake2b_hash_tree(tree, &params, key, &cache, 4, result))
+				ERROR("libblake_blake2b_hash_tree: %s\n", strerror(errno)); /* $covered$ */
+			libblake_digest_cache_close(&cache);
+			if (memcmp(result, expected, 64)) {
+				/* $covered{$ */
+				fprintf(stderr, "libblake_blake2b_hash_tree failed with a cache (pass: %zu, keyed: %i)\n", pass, keyed);
+				failed = 1;
+				/* $covered}$ */
+			}
+		}
+	}
+
+	if (libblake_digest_cache_open(&cache, cache_path))
+		ERROR("libblake_digest_cache_open: %s\n", strerror(errno)); /* $covered$ */
+
+	/* The cached hash must not be used for other parameters */
+	params.key_len = 0;
+	params.digest_len = 32;
+	for (pass = 0; pass < 2; pass++) {
+		if (libblake_blake2b_hash_file(paths[299], &params, NULL, &cache, result))
+			ERROR("libblake_blake2b_hash_file: %s\n", strerror(errno)); /* $covered$ */
+		if (libblake_blake2b_hash_file(paths[299], &params, NULL, NULL, uncached))
+			ERROR("libblake_blake2b_hash_file: %s\n", strerror(errno)); /* $covered$ */
+		if (memcmp(result, uncached, 32)) {
+			/* $covered{$ */
+			fprintf(stderr, "libblake_blake2b_hash_file returned a hash cached for other parameters\n");
+			failed = 1;
+			/* $covered}$ */
+		}
+		params.salt[0] = 1;
+	}
+
+	/* Modifying a file, even without changing its size, must invalidate its cached hash */
+	params.salt[0] = 0;
+	params.digest_len = 64;
+	if (libblake_blake2b_hash_file(paths[299], &params, NULL, &cache, result))
+		ERROR("libblake_blake2b_hash_file: %s\n", strerror(errno)); /* $covered$ */
+	unlink(paths[299]);
+	write_test_file(paths[299], 299, 1);
+	if (libblake_blake2b_hash_file(paths[299], &params, NULL, &cache, result))
+		ERROR("libblake_blake2b_hash_file: %s\n", strerror(errno)); /* $covered$ */
+	if (libblake_blake2b_hash_file(paths[299], &params, NULL, NULL, expected))
+		ERROR("libblake_blake2b_hash_file: %s\n", strerror(errno)); /* $covered$ */
+	if (memcmp(result, expected, 64)) {
+		/* $covered{$ */
+		fprintf(stderr, "libblake_blake2b_hash_file returned the hash cached for a modified file\n");
+		failed = 1;
+		/* $covered}$ */
+	}
+
+	/* Rewriting a file within the same second, and restoring its
+	 * (old) modification time, must not reuse its cached hash */
+	sprintf(racy_path, "%s/racy", dir);
+	write_test_file(racy_path, 1000, 33);
+	times[0].tv_sec = times[1].tv_sec = time(NULL) - 60;
+	times[0].tv_nsec = times[1].tv_nsec = 0;
+	if (utimensat(AT_FDCWD, racy_path, times, 0))
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	if (libblake_blake2b_hash_file(racy_path, &params, NULL, &cache, result))
+		ERROR("libblake_blake2b_hash_file: %s\n", strerror(errno)); /* $covered$ */
+	fd = open(racy_path, O_WRONLY);
+	if (fd < 0)
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	fill_pattern(data, sizeof(data), 34);
+	if (pwrite(fd, data, sizeof(data), 0) != (ssize_t)sizeof(data) || futimens(fd, times))
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	close(fd);
+	if (libblake_blake2b_hash_file(racy_path, &params, NULL, &cache, result))
+		ERROR("libblake_blake2b_hash_file: %s\n", strerror(errno)); /* $covered$ */
+	if (libblake_blake2b_hash_file(racy_path, &params, NULL, NULL, expected))
+		ERROR("libblake_blake2b_hash_file: %s\n", strerror(errno)); /* $covered$ */
+	if (memcmp(result, expected, 64)) {
+		/* $covered{$ */
+		fprintf(stderr, "libblake_blake2b_hash_file returned the hash cached for a racily clean file\n");
+		failed = 1;
+		/* $covered}$ */
+	}
+	unlink(racy_path);
+
+	/* The status change time of a file cannot be set, so a file from
+	 * the source tree, which is normally old enough for its hash to
+	 * be cached, is used to check that the cache is actually used */
+	if (stat("LICENSE", &st))
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	if (st.st_mtim.tv_sec > time(NULL) - 3 || st.st_ctim.tv_sec > time(NULL) - 3)
+		sleep(3); /* $covered$ */
+	params.digest_len = 64;
+	for (i = 0; i < DIGEST_CACHE_FILES; i++) {
+		params.salt[0] = (uint_least8_t)(i & 255);
+		params.salt[1] = (uint_least8_t)(i >> 8);
+		if (libblake_blake2b_hash_file("LICENSE", &params, NULL, &cache, result))
+			ERROR("libblake_blake2b_hash_file: %s\n", strerror(errno)); /* $covered$ */
+	}
+	if (libblake_blake2b_hash_file("LICENSE", &params, NULL, NULL, expected))
+		ERROR("libblake_blake2b_hash_file: %s\n", strerror(errno)); /* $covered$ */
+	fd = open(cache_path, O_RDWR);
+	if (fd < 0 || fstat(fd, &st))
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	cache_data = malloc((size_t)st.st_size);
+	if (!cache_data || pread(fd, cache_data, (size_t)st.st_size, 0) != (ssize_t)st.st_size)
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	cached = memmem(cache_data, (size_t)st.st_size, expected, 64);
+	if (!cached) {
+		/* $covered{$ */
+		fprintf(stderr, "libblake_blake2b_hash_file did not cache the hash of an unmodified file\n");
+		failed = 1;
+		/* $covered}$ */
+	} else {
+		/* The cached hash is altered, so that it is returned only if it is used */
+		expected[0] ^= 1;
+		if (pwrite(fd, expected, 1, (off_t)(cached - cache_data)) != 1)
+			ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+		if (libblake_blake2b_hash_file("LICENSE", &params, NULL, &cache, result))
+			ERROR("libblake_blake2b_hash_file: %s\n", strerror(errno)); /* $covered$ */
+		if (memcmp(result, expected, 64)) {
+			/* $covered{$ */
+			fprintf(stderr, "libblake_blake2b_hash_file did not use the cached hash of an unmodified file\n");
+			failed = 1;
+			/* $covered}$ */
+		}
+	}
+	free(cache_data);
+	close(fd);
+	memset(params.salt, 0, sizeof(params.salt));
+	libblake_digest_cache_close(&cache);
+
+	/* Unusable contents are discarded */
+	unlink(cache_path);
+	write_test_file(cache_path, 1000, 32);
+	if (libblake_digest_cache_open(&cache, cache_path))
+		ERROR("libblake_digest_cache_open: %s\n", strerror(errno)); /* $covered$ */
+	for (pass = 0; pass < 2; pass++) {
+		struct libblake_blake2s_params params2s;
+		memset(&params2s, 0, sizeof(params2s));
+		params2s.digest_len = 32;
+		params2s.fanout = 1;
+		params2s.depth = 1;
+		if (libblake_blake2s_hash_file(paths[299], &params2s, NULL, &cache, result))
+			ERROR("libblake_blake2s_hash_file: %s\n", strerror(errno)); /* $covered$ */
+		if (libblake_blake2s_hash_file(paths[299], &params2s, NULL, NULL, expected))
+			ERROR("libblake_blake2s_hash_file: %s\n", strerror(errno)); /* $covered$ */
+		if (memcmp(result, expected, 32)) {
+			/* $covered{$ */
+			fprintf(stderr, "libblake_blake2s_hash_file failed with a cache\n");
+			failed = 1;
+			/* $covered}$ */
+		}
+	}
+	libblake_digest_cache_close(&cache);
+
+	for (i = 0; i < DIGEST_CACHE_FILES; i++)
+		unlink(paths[i]);
+	unlink(cache_path);
+	rmdir(tree);
+	rmdir(dir);
+	return failed;
+}
+
+#define CHUNKER_MAX_CHUNKS 1024
+
+static int
+check_blake2b_chunker(void)
+{
+	static unsigned char data[((size_t)1 << 20) + 777 + 1];
+	static struct libblake_blake2b_chunk chunks[CHUNKER_MAX_CHUNKS], streamed[CHUNKER_MAX_CHUNKS];
+	static struct libblake_blake2b_chunk shifted[CHUNKER_MAX_CHUNKS];
+	struct libblake_blake2b_params params;
+	struct libblake_blake2b_chunker chunker;
+	unsigned char key[64], expected[64];
+	size_t len = sizeof(data) - 1, n, nstreamed, nshifted, m, i, j, off, end, piece, consumed;
+	uint_least64_t pos;
+	int keyed, failed = 0;
+
+	fill_pattern(data, len, 41);
+	fill_pattern(key, sizeof(key), 42);
+
+	memset(&params, 0, sizeof(params));
+	params.fanout = 1;
+	params.depth = 1;
+
+	if (!libblake_blake2b_chunker_create(&chunker, &params, NULL, 4096, 2048, 8192) || errno != EINVAL)
+		ERROR("libblake_blake2b_chunker_create did not fail with EINVAL for a minimum size above the average\n"); /* $covered$ */
+
+	for (keyed = 0; keyed < 2; keyed++) {
+		params.digest_len = keyed ? 32 : 64;
+		params.key_len = keyed ? 17 : 0;
+
+		/* All input at once */
+		if (libblake_blake2b_chunker_create(&chunker, &params, key, 2048, 8192, 65536))
+			ERROR("libblake_blake2b_chunker_create: %s\n", strerror(errno)); /* $covered$ */
+		consumed = libblake_blake2b_chunker_update(&chunker, data, len, 1, chunks, CHUNKER_MAX_CHUNKS, &n);
+		libblake_blake2b_chunker_destroy(&chunker);
+		if (consumed != len)
+			ERROR("libblake_blake2b_chunker_update did not consume all input\n"); /* $covered$ */
+		for (pos = 0, i = 0; i < n; i++) {
+			libblake_blake2b(expected, params.digest_len, &data[pos], chunks[i].length, key, params.key_len);
+			if (chunks[i].offset != pos || chunks[i].length > 65536 || (i + 1 < n && chunks[i].length < 2048) ||
+			    memcmp(chunks[i].digest, expected, params.digest_len)) {
+				/* $covered{$ */
+				fprintf(stderr, "libblake_blake2b_chunker_update failed for chunk %zu (keyed: %i)\n", i, keyed);
+				failed = 1;
+				/* $covered}$ */
+			}
+			pos += chunks[i].length;
+		}
+		if (n < len / 65536 || n > len / 2048)
+			ERROR("libblake_blake2b_chunker_update output %zu chunks\n", n); /* $covered$ */
+
+		/* Input in pieces of varying sizes, with few chunks output at a time */
+		if (libblake_blake2b_chunker_create(&chunker, &params, key, 2048, 8192, 65536))
+			ERROR("libblake_blake2b_chunker_create: %s\n", strerror(errno)); /* $covered$ */
+		for (nstreamed = 0, off = 0, end = 0, j = 0; off < len;) {
+			piece = next_chunk_size(&j) * 97;
+			end = end + piece < len ? end + piece : len;
+			consumed = libblake_blake2b_chunker_update(&chunker, &data[off], end - off, end == len,
+			                                           &streamed[nstreamed], j % 3 + 1, &m);
+			nstreamed += m;
+			off += consumed;
+		}
+		libblake_blake2b_chunker_destroy(&chunker);
+		if (nstreamed != n || memcmp(streamed, chunks, n * sizeof(*chunks))) {
+			/* $covered{$ */
+			fprintf(stderr, "libblake_blake2b_chunker_update failed for streamed input (keyed: %i)\n", keyed);
+			failed = 1;
+			/* $covered}$ */
+		}
+	}
+
+	/* An insertion only affects the chunks around it */
+	memmove(&data[101], &data[100], len - 100);
+	data[100] = 0x55;
+	if (libblake_blake2b_chunker_create(&chunker, &params, key, 2048, 8192, 65536))
+		ERROR("libblake_blake2b_chunker_create: %s\n", strerror(errno)); /* $covered$ */
+	libblake_blake2b_chunker_update(&chunker, data, len + 1, 1, shifted, CHUNKER_MAX_CHUNKS, &nshifted);
+	libblake_blake2b_chunker_destroy(&chunker);
+	for (m = 0, i = 0; i < n && i < nshifted; i++)
+		m += !memcmp(chunks[n - 1 - i].digest, shifted[nshifted - 1 - i].digest, params.digest_len);
+	if (m + 2 < n) {
+		/* $covered{$ */
+		fprintf(stderr, "libblake_blake2b_chunker_update: only %zu of %zu chunks were unaffected by an insertion\n", m, n);
+		failed = 1;
+		/* $covered}$ */
+	}
+
+	return failed;
+}
+
+static int
+check_blake2_verity(void)
+{
+	static unsigned char data[1001 * 512], tree[1 << 20], expected_tree[1 << 20], levels[8][1 << 17];
+	size_t levels_n[8], nlevels, size, slot, per, i, j, level, tree_size, nthreads;
+	unsigned char root[64], expected_root[64];
+	char data_path[] = "/tmp/libblake-test-XXXXXX", hash_path[] = "/tmp/libblake-test-XXXXXX";
+	int data_fd, hash_fd, failed = 0;
+	ssize_t r;
+
+	/* Reference implementation, hashing one block at a time */
+#define HASH_BLOCK(F, BLOCK, OUT)\
+	do {\
+		struct libblake_blake2##F##_state state;\
+		libblake_blake2##F##_init(&state, &params);\
+		libblake_blake2##F##_digest_const(&state, BLOCK, 512, 0, params.digest_len, OUT);\
+	} while (0)
+
+#define CHECK(F, DIGEST_LEN, SLOT)\
+	do {\
+		struct libblake_blake2##F##_params params;\
+		memset(&params, 0, sizeof(params));\
+		params.digest_len = DIGEST_LEN;\
+		params.fanout = 1;\
+		params.depth = 1;\
+		params.salt[0] = 0x5A;\
+		slot = SLOT;\
+		per = 512 / slot;\
+		memset(levels, 0, sizeof(levels));\
+		levels_n[0] = size / 512 + (size % 512 ? 1 : 0);\
+		for (i = 0; i < levels_n[0]; i++)\
+			HASH_BLOCK(F, &data[i * 512], &levels[0][i * slot]);\
+		for (nlevels = 1; levels_n[nlevels - 1] > per; nlevels++) {\
+			levels_n[nlevels] = levels_n[nlevels - 1] / per + (levels_n[nlevels - 1] % per ? 1 : 0);\
+			for (i = 0; i < levels_n[nlevels]; i++)\
+				HASH_BLOCK(F, &levels[nlevels - 1][i * 512], &levels[nlevels][i * slot]);\
+		}\
+		HASH_BLOCK(F, levels[nlevels - 1], expected_root);\
+		for (tree_size = 0, level = nlevels; level--;) {\
+			j = (levels_n[level] + per - 1) / per * 512;\
+			memcpy(&expected_tree[tree_size], levels[level], j);\
+			tree_size += j;\
+		}\
+		for (nthreads = 1; nthreads <= 3; nthreads += 2) {\
+			memset(root, 0, sizeof(root));\
+			if (libblake_blake2##F##_verity_build(data_fd, hash_fd, &params, 512, nthreads, root))\
+				ERROR("libblake_blake2" #F "_verity_build: %s\n", strerror(errno)); /* $covered$ */\
+			r = pread(hash_fd, tree, sizeof(tree), 0);\
+			if (r != (ssize_t)tree_size || memcmp(tree, expected_tree, tree_size) || memcmp(root, expected_root, DIGEST_LEN)) {\
+				/* $covered{$ */\
+				fprintf(stderr, "libblake_blake2" #F "_verity_build failed for %zu bytes with %zu threads\n", size, nthreads);\
+				failed = 1;\
+				/* $covered}$ */\
+			}\
+		}\
+		memset(&levels[0][0], 0, 512);\
+		memcpy(&levels[0][0], &data[(levels_n[0] - 1) * 512], size - (levels_n[0] - 1) * 512);\
+		if (libblake_blake2##F##_verity_verify(tree, tree_size, levels_n[0], &params, 512, root, 0, data) != 1 ||\
+		    libblake_blake2##F##_verity_verify(tree, tree_size, levels_n[0], &params, 512, root, levels_n[0] / 2,\
+		                                      &data[levels_n[0] / 2 * 512]) != 1 ||\
+		    libblake_blake2##F##_verity_verify(tree, tree_size, levels_n[0], &params, 512, root,\
+		                                      levels_n[0] - 1, &levels[0][0]) != 1 ||\
+		    libblake_blake2##F##_verity_verify(tree, tree_size, levels_n[0], &params, 512, root, 0, &data[512]) != 0) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_blake2" #F "_verity_verify failed\n");\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+		tree[0] ^= 1;\
+		if (libblake_blake2##F##_verity_verify(tree, tree_size, levels_n[0], &params, 512, root, 0, data) != 0) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_blake2" #F "_verity_verify accepted a corrupt tree\n");\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+		if (libblake_blake2##F##_verity_verify(tree, tree_size - 1, levels_n[0], &params, 512, root, 0, data) != -1 ||\
+		    errno != EINVAL) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_blake2" #F "_verity_verify did not fail with EINVAL for a truncated tree\n");\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+	} while (0)
+
+	data_fd = mkstemp(data_path);
+	hash_fd = mkstemp(hash_path);
+	if (data_fd < 0 || hash_fd < 0)
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	unlink(data_path);
+	unlink(hash_path);
+
+	/* A partial last block, and exactly one block */
+	for (size = sizeof(data) - 412; size; size = size == 512 ? 0 : 512) {
+		fill_pattern(data, sizeof(data), (unsigned int)size);
+		if (ftruncate(data_fd, 0) || pwrite(data_fd, data, size, 0) != (ssize_t)size)
+			ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+		memset(&data[size], 0, sizeof(data) - size);
+		CHECK(s, 20, 32);
+		CHECK(b, 64, 64);
+	}
+
+#undef CHECK
+#undef HASH_BLOCK
+
+	close(data_fd);
+	close(hash_fd);
+	return failed;
+}
+
+static int
+check_blake2_fixed(void)
+{
+	static unsigned char data[9 * 65536], output[9 * 64];
+	unsigned char key[64], expected[64];
+	size_t key_len, output_len, i;
+	int failed = 0;
+
+#define CHECK_ONE(F, LEN)\
+	do {\
+		libblake_blake2##F(expected, output_len, data, LEN, key, key_len);\
+		memset(output, 0, output_len);\
+		libblake_blake2##F##_fixed##LEN(output, output_len, data, key, key_len);\
+		if (memcmp(output, expected, output_len)) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_blake2" #F "_fixed" #LEN " failed for key length %zu\n", key_len);\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+	} while (0)
+
+	/* 9 messages fill the lanes at least once, and leave a remainder */
+#define CHECK_MANY(F, LEN)\
+	do {\
+		memset(output, 0, sizeof(output));\
+		libblake_blake2##F##_fixed##LEN##_many(output, output_len, data, 9, key, key_len);\
+		for (i = 0; i < 9; i++) {\
+			libblake_blake2##F(expected, output_len, &data[i * LEN], LEN, key, key_len);\
+			if (memcmp(&output[i * output_len], expected, output_len)) {\
+				/* $covered{$ */\
+				fprintf(stderr, "libblake_blake2" #F "_fixed" #LEN "_many failed for message %zu"\
+				        " with key length %zu\n", i, key_len);\
+				failed = 1;\
+				/* $covered}$ */\
+			}\
+		}\
+	} while (0)
+
+	fill_pattern(data, sizeof(data), 45);
+	fill_pattern(key, sizeof(key), 46);
+
+	for (key_len = 0; key_len <= 32; key_len += 32) {
+		for (output_len = 20; output_len <= 32; output_len += 12) {
+			CHECK_ONE(s, 32);
+			CHECK_ONE(s, 64);
+			CHECK_ONE(s, 4096);
+			CHECK_ONE(s, 65536);
+			CHECK_MANY(s, 4096);
+			CHECK_MANY(s, 65536);
+		}
+	}
+
+	for (key_len = 0; key_len <= 64; key_len += 64) {
+		for (output_len = 20; output_len <= 64; output_len += 44) {
+			CHECK_ONE(b, 32);
+			CHECK_ONE(b, 64);
+			CHECK_ONE(b, 4096);
+			CHECK_ONE(b, 65536);
+			CHECK_MANY(b, 4096);
+			CHECK_MANY(b, 65536);
+		}
+	}
+
+#undef CHECK_ONE
+#undef CHECK_MANY
+
+	return failed;
+}
+
+static int
+check_blake2_tree_update(void)
+{
+	static unsigned char data[60000], input[128 + 64 * 64], levels[2][100 * 64];
+	static const struct libblake_byte_range ranges[] = {{1500, 10}, {1505, 600}, {30000, 1}, {50000, 0}, {59999, 100}};
+	unsigned char key[64], expected[64], result[64], old_root[64];
+	char data_path[] = "/tmp/libblake-test-XXXXXX", store_path[] = "/tmp/libblake-test-XXXXXX";
+	size_t size, nodes, next, span, i, j, len, depth, test, key_block;
+	int data_fd, store_fd, failed = 0;
+
+	/* Reference implementation, hashing the whole tree level by level */
+#define HASH_NODE(F, DATA, LEN, OFFSET, DEPTH, LAST, OUT_LEN, OUT)\
+	do {\
+		struct libblake_blake2##F##_state state;\
+		struct libblake_blake2##F##_params node_params = params;\
+		node_params.node_offset = OFFSET;\
+		node_params.node_depth = (uint_least8_t)(DEPTH);\
+		node_params.digest_len = (uint_least8_t)(OUT_LEN);\
+		memset(input, 0, key_block);\
+		memcpy(input, key, params.key_len);\
+		memcpy(&input[key_block], DATA, LEN);\
+		libblake_blake2##F##_init(&state, &node_params);\
+		libblake_blake2##F##_digest_const(&state, input, key_block + (LEN), LAST, OUT_LEN, OUT);\
+	} while (0)
+
+#define REFERENCE(F)\
+	do {\
+		nodes = size / params.leaf_len + (size % params.leaf_len ? 1 : 0);\
+		nodes = nodes ? nodes : 1;\
+		for (i = 0; i < nodes; i++) {\
+			len = size - i * params.leaf_len < params.leaf_len ? size - i * params.leaf_len : params.leaf_len;\
+			HASH_NODE(F, &data[i * params.leaf_len], len, i, 0, i + 1 == nodes, params.inner_len,\
+			          &levels[0][i * params.inner_len]);\
+		}\
+		for (depth = 1;; depth++) {\
+			span = !params.fanout || depth + 1 == params.depth || nodes <= params.fanout ? nodes : params.fanout;\
+			next = nodes / span + (nodes % span ? 1 : 0);\
+			for (i = 0; i < next; i++) {\
+				len = (nodes - i * span < span ? nodes - i * span : span) * params.inner_len;\
+				HASH_NODE(F, &levels[(depth - 1) % 2][i * span * params.inner_len], len, i, depth, i + 1 == next,\
+				          next == 1 ? params.digest_len : params.inner_len,\
+				          next == 1 ? expected : &levels[depth % 2][i * params.inner_len]);\
+			}\
+			if (next == 1)\
+				break;\
+			nodes = next;\
+		}\
+	} while (0)
+
+#define CHECK_RESULT(F, FUNC, WHAT)\
+	do {\
+		REFERENCE(F);\
+		if (memcmp(result, expected, params.digest_len)) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_blake2" #F "_tree_" FUNC " failed %s (test %zu)\n", WHAT, test);\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+	} while (0)
+
+#define RESIZE(NEW_SIZE)\
+	do {\
+		size = NEW_SIZE;\
+		if (ftruncate(data_fd, 0) || pwrite(data_fd, data, size, 0) != (ssize_t)size)\
+			ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */\
+	} while (0)
+
+#define CHECK(F, BLOCK_SIZE, DIGEST_LEN, INNER_LEN, FANOUT, DEPTH, KEY_LEN)\
+	do {\
+		struct libblake_blake2##F##_params params;\
+		memset(&params, 0, sizeof(params));\
+		params.digest_len = DIGEST_LEN;\
+		params.key_len = KEY_LEN;\
+		key_block = KEY_LEN ? BLOCK_SIZE : 0;\
+		params.fanout = FANOUT;\
+		params.depth = DEPTH;\
+		params.leaf_len = 1000;\
+		params.inner_len = INNER_LEN;\
+		fill_pattern(data, sizeof(data), (unsigned int)test);\
+		RESIZE(sizeof(data) - 1234);\
+		if (libblake_blake2##F##_tree_build(data_fd, store_fd, &params, key, result))\
+			ERROR("libblake_blake2" #F "_tree_build: %s\n", strerror(errno)); /* $covered$ */\
+		CHECK_RESULT(F, "build", "");\
+		memcpy(old_root, result, params.digest_len);\
+		/* Only the listed ranges are rehashed */\
+		for (i = 0; i < sizeof(ranges) / sizeof(*ranges); i++)\
+			for (j = 0; j < ranges[i].length && ranges[i].offset + j < size; j++)\
+				data[ranges[i].offset + j] ^= 0x55;\
+		RESIZE(size);\
+		if (libblake_blake2##F##_tree_update(data_fd, store_fd, &params, key, NULL, 0, result))\
+			ERROR("libblake_blake2" #F "_tree_update: %s\n", strerror(errno)); /* $covered$ */\
+		if (memcmp(result, old_root, params.digest_len)) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_blake2" #F "_tree_update rehashed unmodified leaves (test %zu)\n", test);\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+		if (libblake_blake2##F##_tree_update(data_fd, store_fd, &params, key, ranges,\
+		                                     sizeof(ranges) / sizeof(*ranges), result))\
+			ERROR("libblake_blake2" #F "_tree_update: %s\n", strerror(errno)); /* $covered$ */\
+		CHECK_RESULT(F, "update", "after modification");\
+		RESIZE(sizeof(data));\
+		if (libblake_blake2##F##_tree_update(data_fd, store_fd, &params, key, NULL, 0, result))\
+			ERROR("libblake_blake2" #F "_tree_update: %s\n", strerror(errno)); /* $covered$ */\
+		CHECK_RESULT(F, "update", "after growth");\
+		RESIZE(sizeof(data) - 100);\
+		if (libblake_blake2##F##_tree_update(data_fd, store_fd, &params, key, NULL, 0, result))\
+			ERROR("libblake_blake2" #F "_tree_update: %s\n", strerror(errno)); /* $covered$ */\
+		CHECK_RESULT(F, "update", "after shrinking");\
+		RESIZE(0);\
+		if (libblake_blake2##F##_tree_update(data_fd, store_fd, &params, key, NULL, 0, result))\
+			ERROR("libblake_blake2" #F "_tree_update: %s\n", strerror(errno)); /* $covered$ */\
+		CHECK_RESULT(F, "update", "for an empty file");\
+		/* A store for other parameters is not used */\
+		RESIZE(sizeof(data));\
+		params.salt[0] ^= 1;\
+		if (libblake_blake2##F##_tree_update(data_fd, store_fd, &params, key, NULL, 0, result))\
+			ERROR("libblake_blake2" #F "_tree_update: %s\n", strerror(errno)); /* $covered$ */\
+		CHECK_RESULT(F, "update", "with a store for other parameters");\
+		params.fanout = 1;\
+		if (libblake_blake2##F##_tree_build(data_fd, store_fd, &params, key, result) != -1 || errno != EINVAL) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_blake2" #F "_tree_build did not fail with EINVAL for a fan-out of 1\n");\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+		test++;\
+	} while (0)
+
+	data_fd = mkstemp(data_path);
+	store_fd = mkstemp(store_path);
+	if (data_fd < 0 || store_fd < 0)
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	unlink(data_path);
+	unlink(store_path);
+	fill_pattern(key, sizeof(key), 47);
+
+	test = 0;
+	CHECK(s, 64, 32, 32, 3, 255, 0);
+	CHECK(s, 64, 32, 20, 2, 3, 32);
+	CHECK(s, 64, 32, 32, 0, 2, 7);
+	CHECK(b, 128, 64, 64, 3, 255, 0);
+	CHECK(b, 128, 64, 32, 2, 3, 64);
+	CHECK(b, 128, 64, 64, 0, 2, 7);
+	CHECK(b, 128, 20, 48, 64, 255, 1);
+
+#undef CHECK
+#undef RESIZE
+#undef CHECK_RESULT
+#undef REFERENCE
+#undef HASH_NODE
+
+	close(data_fd);
+	close(store_fd);
+	return failed;
+}
+
+static int
+check_blake2_tree_merge(void)
+{
+	static unsigned char data[60000];
+	static struct libblake_tree_node nodes[100];
+	unsigned char key[64], expected[64], buffer[256];
+	char data_path[] = "/tmp/libblake-test-XXXXXX", store_path[] = "/tmp/libblake-test-XXXXXX";
+	struct libblake_tree_node node;
+	struct libblake_byte_range range;
+	size_t size, end, n, i, j, span, len, depth, test = 0;
+	int data_fd, store_fd, failed = 0;
+
+	/* The nodes on level 2 (or 1, or the leaves) are calculated
+	 * as if by separate workers, then serialised and sent to a coordinator
+	 * that merges them into the root, which must match the tree hash */
+#define CHECK(F, DIGEST_LEN, INNER_LEN, FANOUT, DEPTH, KEY_LEN)\
+	do {\
+		struct libblake_blake2##F##_params params;\
+		memset(&params, 0, sizeof(params));\
+		params.digest_len = DIGEST_LEN;\
+		params.key_len = KEY_LEN;\
+		params.fanout = FANOUT;\
+		params.depth = DEPTH;\
+		params.leaf_len = 1000;\
+		params.inner_len = INNER_LEN;\
+		if (ftruncate(data_fd, 0) || pwrite(data_fd, data, size, 0) != (ssize_t)size)\
+			ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */\
+		if (libblake_blake2##F##_tree_build(data_fd, store_fd, &params, key, expected))\
+			ERROR("libblake_blake2" #F "_tree_build: %s\n", strerror(errno)); /* $covered$ */\
+		depth = size < 10000 ? 0 : DEPTH > 3 ? 2 : 1;\
+		for (n = 0, end = 0;; n++, end += range.length) {\
+			if (libblake_blake2##F##_tree_node_range(&params, size, n, depth, &range))\
+				break;\
+			if (range.offset != end) {\
+				/* $covered{$ */\
+				fprintf(stderr, "libblake_blake2" #F "_tree_node_range failed (test %zu)\n", test);\
+				failed = 1;\
+				/* $covered}$ */\
+			}\
+			if (libblake_blake2##F##_tree_node(&node, &params, key, size, n, depth,\
+			                                   &data[range.offset], (size_t)range.length))\
+				ERROR("libblake_blake2" #F "_tree_node: %s\n", strerror(errno)); /* $covered$ */\
+			len = libblake_tree_node_export(&node, buffer, sizeof(buffer));\
+			if (len > sizeof(buffer) || libblake_tree_node_import(&nodes[n], buffer, len))\
+				ERROR("libblake_tree_node_import: %s\n", strerror(errno)); /* $covered$ */\
+		}\
+		if (errno != EINVAL || end != size) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_blake2" #F "_tree_node_range failed at the end (test %zu)\n", test);\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+		while (!nodes[0].root) {\
+			depth++;\
+			span = !FANOUT || depth + 1 == DEPTH ? n : FANOUT;\
+			for (i = 0, j = 0; i < n; i += span, j++)\
+				if (libblake_blake2##F##_tree_merge(&nodes[j], &params, key, &nodes[i], n - i < span ? n - i : span))\
+					ERROR("libblake_blake2" #F "_tree_merge: %s\n", strerror(errno)); /* $covered$ */\
+			n = j;\
+		}\
+		if (n != 1 || nodes[0].digest_len != DIGEST_LEN || memcmp(nodes[0].digest, expected, DIGEST_LEN)) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_blake2" #F "_tree_merge failed (test %zu)\n", test);\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+		if (libblake_blake2##F##_tree_node(&node, &params, key, size, 0, nodes[0].node_depth, data, size) ||\
+		    !node.root || memcmp(node.digest, expected, DIGEST_LEN)) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_blake2" #F "_tree_node failed for the root (test %zu)\n", test);\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+		if (size > 2000 &&\
+		    (libblake_blake2##F##_tree_node(&node, &params, key, size, 1, 0, data, 1000) ||\
+		     libblake_blake2##F##_tree_merge(&node, &params, key, &node, 1) != -1 || errno != EINVAL)) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_blake2" #F "_tree_merge did not fail with EINVAL (test %zu)\n", test);\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+		test++;\
+	} while (0)
+
+	data_fd = mkstemp(data_path);
+	store_fd = mkstemp(store_path);
+	if (data_fd < 0 || store_fd < 0)
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	unlink(data_path);
+	unlink(store_path);
+	fill_pattern(data, sizeof(data), 48);
+	fill_pattern(key, sizeof(key), 49);
+
+	for (size = sizeof(data) - 123; size; size = size > 1000 ? 1000 : 0) {
+		CHECK(s, 32, 32, 3, 255, 0);
+		CHECK(s, 20, 24, 2, 3, 32);
+		CHECK(s, 32, 32, 0, 2, 5);
+		CHECK(b, 64, 64, 3, 255, 0);
+		CHECK(b, 32, 48, 2, 3, 64);
+		CHECK(b, 64, 64, 0, 2, 5);
+	}
+
+	len = libblake_tree_node_export(&nodes[0], buffer, sizeof(buffer));
+	buffer[len - 1] ^= 1;
+	if (libblake_tree_node_import(&node, buffer, len - 1) != -1 || errno != EINVAL) {
+		/* $covered{$ */
+		fprintf(stderr, "libblake_tree_node_import did not fail with EINVAL for a truncated node\n");
+		failed = 1;
+		/* $covered}$ */
+	}
+
+#undef CHECK
+
+	close(data_fd);
+	close(store_fd);
+	return failed;
+}
+
+static int
+check_blake2b_signature(void)
+{
+	static unsigned char data[300123], moved[sizeof(data) + 3];
+	struct libblake_blake2b_params params;
+	struct libblake_blake2b_signature sig, sig_fd;
+	unsigned char key[64], block[700];
+	char path[] = "/tmp/libblake-test-XXXXXX";
+	size_t len = sizeof(data), nblocks = (len + 699) / 700, i, n, blen, pos, found;
+	uint_least32_t weak;
+	int keyed, fd, failed = 0;
+
+	fill_pattern(data, len, 50);
+	fill_pattern(key, sizeof(key), 51);
+	memcpy(&data[20 * 700], &data[5 * 700], 700);
+	fill_pattern(moved, 3, 52);
+	memcpy(&moved[3], data, len);
+
+	fd = mkstemp(path);
+	if (fd < 0)
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+	unlink(path);
+	if (pwrite(fd, data, len, 0) != (ssize_t)len)
+		ERROR("Internal test error: %s\n", strerror(errno)); /* $covered$ */
+
+	memset(&params, 0, sizeof(params));
+	params.fanout = 1;
+	params.depth = 1;
+	params.digest_len = 8;
+
+	if (!libblake_blake2b_signature_create(&sig, &params, NULL, 0, data, len) || errno != EINVAL)
+		ERROR("libblake_blake2b_signature_create did not fail with EINVAL for a block size of 0\n"); /* $covered$ */
+
+	for (keyed = 0; keyed < 2; keyed++) {
+		params.key_len = keyed ? 32 : 0;
+		if (libblake_blake2b_signature_create(&sig, &params, key, 700, data, len))
+			ERROR("libblake_blake2b_signature_create: %s\n", strerror(errno)); /* $covered$ */
+
+		/* Every block is found, the duplicate as its first occurrence */
+		for (i = 0; i < nblocks; i++) {
+			blen = i + 1 < nblocks ? 700 : len % 700;
+			weak = libblake_rolling_checksum(&data[i * 700], blen);
+			if (libblake_blake2b_signature_find(&sig, weak, &data[i * 700], blen, &n) != 1 || n != (i == 20 ? 5 : i)) {
+				/* $covered{$ */
+				fprintf(stderr, "libblake_blake2b_signature_find failed for block %zu (keyed: %i)\n", i, keyed);
+				failed = 1;
+				/* $covered}$ */
+			}
+		}
+		memcpy(block, &data[7 * 700], 700);
+		block[300] ^= 1;
+		weak = libblake_rolling_checksum(block, 700);
+		if (libblake_blake2b_signature_find(&sig, weak, block, 700, &n) ||
+		    libblake_blake2b_signature_find(&sig, libblake_rolling_checksum(data, 699), data, 699, &n)) {
+			/* $covered{$ */
+			fprintf(stderr, "libblake_blake2b_signature_find found a modified block (keyed: %i)\n", keyed);
+			failed = 1;
+			/* $covered}$ */
+		}
+
+		/* The same signature is created when the file is read */
+		if (lseek(fd, 0, SEEK_SET) || libblake_blake2b_signature_create_fd(&sig_fd, &params, key, 700, fd))
+			ERROR("libblake_blake2b_signature_create_fd: %s\n", strerror(errno)); /* $covered$ */
+		if (sig_fd.nblocks != sig.nblocks || sig_fd.index_bits != sig.index_bits ||
+		    memcmp(sig_fd.index, sig.index, (((size_t)1 << sig.index_bits) + 1) * sizeof(*sig.index)) ||
+		    memcmp(sig_fd.weak, sig.weak, nblocks * sizeof(*sig.weak)) ||
+		    memcmp(sig_fd.blocks, sig.blocks, nblocks * sizeof(*sig.blocks)) ||
+		    memcmp(sig_fd.digests, sig.digests, nblocks * 8)) {
+			/* $covered{$ */
+			fprintf(stderr, "libblake_blake2b_signature_create_fd and libblake_blake2b_signature_create differ\n");
+			failed = 1;
+			/* $covered}$ */
+		}
+		libblake_blake2b_signature_destroy(&sig_fd);
+
+		/* Scan a file, with 3 bytes inserted at the beginning,
+		 * for blocks in the signature, as rsync does */
+		for (pos = 0, found = 0; pos + 700 <= sizeof(moved);) {
+			if (!pos || found) {
+				weak = libblake_rolling_checksum(&moved[pos], 700);
+				found = 0;
+			} else if (pos % 97 == 0 && weak != libblake_rolling_checksum(&moved[pos], 700)) {
+				/* $covered{$ */
+				fprintf(stderr, "libblake_rolling_checksum_roll failed at %zu\n", pos);
+				failed = 1;
+				break;
+				/* $covered}$ */
+			}
+			if (libblake_blake2b_signature_find(&sig, weak, &moved[pos], 700, &n)) {
+				i = (pos - 3) / 700;
+				if (pos % 700 != 3 || n != (i == 20 ? 5 : i)) {
+					/* $covered{$ */
+					fprintf(stderr, "libblake_blake2b_signature_find matched %zu at %zu\n", n, pos);
+					failed = 1;
+					/* $covered}$ */
+				}
+				pos += 700;
+				found = 1;
+			} else {
+				weak = libblake_rolling_checksum_roll(weak, 700, moved[pos], pos + 700 < sizeof(moved) ? moved[pos + 700] : 0);
+				pos++;
+			}
+		}
+		if (pos != 3 + (nblocks - 1) * 700) {
+			/* $covered{$ */
+			fprintf(stderr, "libblake_blake2b_signature_find did not find all blocks (keyed: %i)\n", keyed);
+			failed = 1;
+			/* $covered}$ */
+		}
+
+		libblake_blake2b_signature_destroy(&sig);
+	}
+
+	close(fd);
+	return failed;
+}
+
+static int
+check_blake2_iterate(void)
+{
+	static const size_t output_lens[] = {1, 7, 20, 32, 64};
+	static const uint_least64_t iterations[] = {0, 1, 100};
+	unsigned char data[11 * 64], output[11 * 64], key[64], expected[64], message[64];
+	size_t key_len, output_len, i, j, k, l;
+	uint_least64_t n;
+	int failed = 0;
+
+	/* 11 chains fill the lanes at least once, and leave a remainder;
+	 * the chains are also advanced in place */
+#define CHECK(F, MAX)\
+	do {\
+		if (output_len > MAX)\
+			break;\
+		libblake_blake2##F##_iterate(output, output_len, data, n, key, key_len);\
+		libblake_blake2##F##_iterate_many(&output[output_len], output_len, &data[output_len], 10, n, key, key_len);\
+		for (i = 0; i < 11; i++) {\
+			memcpy(expected, &data[i * output_len], output_len);\
+			for (k = 0; k < n; k++) {\
+				memcpy(message, expected, output_len);\
+				libblake_blake2##F(expected, output_len, message, output_len, key, key_len);\
+			}\
+			if (memcmp(&output[i * output_len], expected, output_len)) {\
+				/* $covered{$ */\
+				fprintf(stderr, "libblake_blake2" #F "_iterate%s failed for chain %zu with output length %zu,"\
+				        " key length %zu, and %lu iterations\n", i ? "_many" : "", i, output_len, key_len,\
+				        (unsigned long int)n);\
+				failed = 1;\
+				/* $covered}$ */\
+			}\
+		}\
+		libblake_blake2##F##_iterate_many(data, output_len, data, 11, n, key, key_len);\
+		if (memcmp(data, output, 11 * output_len)) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_blake2" #F "_iterate_many failed in place with output length %zu,"\
+			        " key length %zu, and %lu iterations\n", output_len, key_len, (unsigned long int)n);\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+		fill_pattern(data, sizeof(data), 54);\
+	} while (0)
+
+	fill_pattern(data, sizeof(data), 54);
+	fill_pattern(key, sizeof(key), 55);
+
+	for (key_len = 0; key_len <= 17; key_len += 17) {
+		for (l = 0; l < sizeof(output_lens) / sizeof(*output_lens); l++) {
+			output_len = output_lens[l];
+			for (j = 0; j < sizeof(iterations) / sizeof(*iterations); j++) {
+				n = iterations[j];
+				CHECK(s, 32);
+				CHECK(b, 64);
+			}
+		}
+	}
+
+#undef CHECK
+
+	return failed;
+}
+
+static int
+check_blake2_nonce_search(void)
+{
+	static const size_t prefix_lens[] = {0, 50, 60, 121, 128, 300};
+	static const size_t nonce_lens[] = {1, 4, 8};
+	unsigned char prefix[300 + 8], key[64], target[64], expected[64], output[64];
+	size_t key_len, prefix_len, nonce_len, i, j, k;
+	uint_least64_t nonce, found, first;
+	int failed = 0, r;
+
+	/* The reference hashes the message in one piece, and
+	 * searches the nonces one by one; the prefixes are chosen
+	 * so that the nonce is sometimes split between two blocks */
+#define CHECK(F, DIGEST_LEN)\
+	do {\
+		struct libblake_blake2##F##_params params;\
+		struct libblake_blake2##F##_midstate midstate;\
+		memset(&params, 0, sizeof(params));\
+		params.digest_len = DIGEST_LEN;\
+		params.key_len = (uint_least8_t)key_len;\
+		params.fanout = 1;\
+		params.depth = 1;\
+		libblake_blake2##F##_midstate_init(&midstate, &params, key, prefix, prefix_len);\
+		memset(target, 0xFF, sizeof(target));\
+		target[0] = 0x10;\
+		first = 250;\
+		for (found = 0, nonce = first; nonce < first + 300 && !found; nonce++) {\
+			for (k = 0; k < nonce_len; k++)\
+				prefix[prefix_len + k] = (unsigned char)((nonce >> (k * 8)) & 255);\
+			libblake_blake2##F(expected, DIGEST_LEN, prefix, prefix_len + nonce_len, key, key_len);\
+			libblake_blake2##F##_midstate_digest(&midstate, nonce, nonce_len, output);\
+			if (memcmp(output, expected, DIGEST_LEN)) {\
+				/* $covered{$ */\
+				fprintf(stderr, "libblake_blake2" #F "_midstate_digest failed for prefix length %zu,"\
+				        " nonce length %zu, and key length %zu\n", prefix_len, nonce_len, key_len);\
+				failed = 1;\
+				break;\
+				/* $covered}$ */\
+			}\
+			if (memcmp(expected, target, DIGEST_LEN) < 0)\
+				found = nonce + 1;\
+		}\
+		memset(output, 0, sizeof(output));\
+		r = libblake_blake2##F##_nonce_search(&midstate, nonce_len, first, 300, target, &nonce, output);\
+		if (r != !!found || (found && (nonce != found - 1 || memcmp(output, expected, DIGEST_LEN)))) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_blake2" #F "_nonce_search failed for prefix length %zu,"\
+			        " nonce length %zu, and key length %zu\n", prefix_len, nonce_len, key_len);\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+		memset(target, 0, sizeof(target));\
+		if (libblake_blake2##F##_nonce_search(&midstate, nonce_len, first, 11, target, &nonce, NULL)) {\
+			/* $covered{$ */\
+			fprintf(stderr, "libblake_blake2" #F "_nonce_search found a hash below zero\n");\
+			failed = 1;\
+			/* $covered}$ */\
+		}\
+	} while (0)
+
+	fill_pattern(prefix, sizeof(prefix), 56);
+	fill_pattern(key, sizeof(key), 57);
+
+	for (key_len = 0; key_len <= 32; key_len += 32) {
+		for (i = 0; i < sizeof(prefix_lens) / sizeof(*prefix_lens); i++) {
+			prefix_len = prefix_lens[i];
+			for (j = 0; j < sizeof(nonce_lens) / sizeof(*nonce_lens); j++) {
+				nonce_len = nonce_lens[j];
+				CHECK(s, 32);
+				CHECK(s, 17);
+				CHECK(b, 64);
+				CHECK(b, 20);
+			}
+		}
+	}
+
+#undef CHECK
+
+	return failed;
+}
+
+int
+main(void)
+{
+	int failed = 0;
+
+	libblake_init();
+
+	/* TODO check macro constants */
+
+	CHECK_HEX(1, 00, 12, 32, 00, 45, 67, 82, 9A, B0, CD, FE, FF, 80, 08, CC, 28);
+	CHECK_HEX(0, 00, 12, 32, 00, 45, 67, 82, 9a, b0, cd, fe, ff, 80, 08, cc, 28);
+
+	failed |= check_blake1();
+	/* TODO need tests for BLAKE1 with salt and suffix */
+	failed |= check_kat_file("kat/blake2s", "BLAKE2s", &hash_blake2s);
+	failed |= check_kat_file("kat/blake2b", "BLAKE2b", &hash_blake2b);
+	/* TODO need tests for BLAKE2[sb] with salt and pepper */
+	failed |= check_kat_file("kat/blake2xs", "BLAKE2Xs", &hash_blake2xs);
+	failed |= check_kat_file("kat/blake2xb", "BLAKE2Xb", &hash_blake2xb);
+
+	failed |= check_blake1_stream();
+	failed |= check_kat_file("kat/blake2s", "BLAKE2s (stream)", &hash_blake2s_stream);
+	failed |= check_kat_file("kat/blake2b", "BLAKE2b (stream)", &hash_blake2b_stream);
+	failed |= check_kat_file("kat/blake2xs", "BLAKE2Xs (stream)", &hash_blake2xs_stream);
+	failed |= check_kat_file("kat/blake2xb", "BLAKE2Xb (stream)", &hash_blake2xb_stream);
+
+	failed |= check_blake1_unpadded();
+	failed |= check_kat_file("kat/blake2s", "BLAKE2s (iovec)", &hash_blake2s_iovec);
+	failed |= check_kat_file("kat/blake2b", "BLAKE2b (iovec)", &hash_blake2b_iovec);
+
+	failed |= check_kat_file("kat/blake2s", "BLAKE2s (const)", &hash_blake2s_const);
+	failed |= check_kat_file("kat/blake2b", "BLAKE2b (const)", &hash_blake2b_const);
+	failed |= check_kat_file("kat/blake2xs", "BLAKE2Xs (const)", &hash_blake2xs_const);
+	failed |= check_kat_file("kat/blake2xb", "BLAKE2Xb (const)", &hash_blake2xb_const);
+
+	failed |= check_kat_file("kat/blake2s", "BLAKE2s (one-shot)", &hash_blake2s_oneshot);
+	failed |= check_kat_file("kat/blake2b", "BLAKE2b (one-shot)", &hash_blake2b_oneshot);
+
+	failed |= check_kat_file("kat/blake2s", "BLAKE2s (prekeyed)", &hash_blake2s_prekeyed);
+	failed |= check_kat_file("kat/blake2b", "BLAKE2b (prekeyed)", &hash_blake2b_prekeyed);
+	failed |= check_blake2s_verify_batch();
+	failed |= check_blake2_compact();
+	failed |= check_blake2_scheduler();
+	failed |= check_state_export();
+	failed |= check_stream_peek();
+	failed |= check_blake2_checkpoints();
+	failed |= check_stream_update_fd();
+	failed |= check_stream_update_sparse();
+	failed |= check_update_fd_truncated();
+	failed |= check_blake2_hash_files();
+	failed |= check_blake2_hash_tree();
+	failed |= check_digest_cache();
+	failed |= check_blake2b_chunker();
+	failed |= check_blake2_verity();
+	failed |= check_blake2_fixed();
+	failed |= check_blake2_tree_update();
+	failed |= check_blake2_tree_merge();
+	failed |= check_blake2b_signature();
+	failed |= check_blake2_iterate();
+	failed |= check_blake2_nonce_search();
 
 	/* TODO test libblake_blake224_update */
 	/* TODO test libblake_blake256_update */